@@ -17,6 +17,7 @@
 #include "ns3/network-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/mpi-interface.h"
 #include "ns3/internet-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/mobility-module.h"
@@ -174,6 +175,7 @@ uint32_t g_totalHost = ((g_K * g_K * g_K) / 4) * g_ratio;
 uint32_t g_totalToR = g_numToR * g_numPod;
 uint32_t g_totalAggr = g_numAggr * g_numPod;
 uint32_t g_totalCore = g_numCore * g_numGroup;
+uint32_t g_partitions = 1;                // Partitions for distributed runs
 
 // [Second][Metrics][Node][Dev]
 double core_data[25][2][1024][64];
@@ -3124,6 +3126,72 @@ SetLinkDelay (std::string input)
   return true;
 }
 
+bool
+SetPartitions (std::string input)
+{
+  cout << "Partitions       : " << g_partitions << " -> " << input << endl;
+  g_partitions = atoi (input.c_str ());
+  return true;
+}
+
+// Nodes are created layer by layer, hosts first
+Layers_t
+GetLayer (Ptr<Node> node)
+{
+  uint32_t id = node->GetId ();
+  if (id >= core_c.Get (0)->GetId ())
+    return Core;
+  if (id >= Aggr_c.Get (0)->GetId ())
+    return Aggr;
+  if (id >= Tor_c.Get (0)->GetId ())
+    return Tor;
+  return Host;
+}
+
+// Packets expected on a link per packet sent by each host, if every host
+// sends to every other host alike: some of the traffic of a rack or a pod
+// stays in it, so links are lighter towards the core.
+double
+ExpectedTraffic (Ptr<Node> a, Ptr<Node> b)
+{
+  Layers_t upper = std::min (GetLayer (a), GetLayer (b));
+  double hostsPerPod = g_numToR * g_numHost;
+  double outOfRack = (g_totalHost - g_numHost) / (g_totalHost - 1.0);
+  double outOfPod = (g_totalHost - hostsPerPod) / (g_totalHost - 1.0);
+  switch (upper)
+    {
+  case Tor:
+    return 2;
+  case Aggr:
+    return 2 * g_numHost * outOfRack / g_numAggr;
+  default:
+    return 2 * hostsPerPod * outOfPod / (g_numAggr * g_numCore);
+    }
+}
+
+// Split the nodes between partitions which keep the pods whole
+void
+PartitionTopology (PointToPointHelper &p2p)
+{
+  NodeContainer all (Host_c, Tor_c, Aggr_c, core_c);
+  TopologyPartitioner partitioner;
+  partitioner.Add (all);
+  partitioner.SetLinkWeightCallback (MakeCallback (&ExpectedTraffic));
+  partitioner.Partition (g_partitions);
+  cout << "Partitions       : " << g_partitions << " cut links " << partitioner.GetNCutLinks ()
+       << " (weight " << partitioner.GetCutWeight () << ") loads";
+  for (uint32_t i = 0; i < g_partitions; i++)
+    cout << " " << partitioner.GetLoad (i);
+  cout << endl;
+  // Distributed runs enable MPI before the topology is built; the others
+  // only report the partitions.
+  if (MpiInterface::IsEnabled ())
+    {
+      partitioner.Assign ();
+      p2p.UpdateChannels (all);
+    }
+}
+
 // Main
 int
 main(int argc, char *argv[])
@@ -3203,6 +3271,7 @@ main(int argc, char *argv[])
   cmd.AddValue("maxtlf" ," Maximum number of total large flows", MakeCallback(SetMaxTotalLargeFlows));
   cmd.AddValue("gamma"," XMP's gamma", MakeCallback(SetXmpGamma));
   cmd.AddValue("beta" ," XMP's beta",  MakeCallback(SetXmpBeta));
+  cmd.AddValue("partitions", "Partitions for distributed runs", MakeCallback(SetPartitions));
 
   cmd.Parse(argc, argv);
 
@@ -3565,6 +3634,9 @@ main(int argc, char *argv[])
         }
     }NS_LOG_INFO("Finished connecting core and aggregation");
 
+  if (g_partitions > 1)
+    PartitionTopology (p2p);
+
 // Populate Global Routing
   Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
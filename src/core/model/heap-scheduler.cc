@@ -144,10 +144,10 @@ HeapScheduler::IsEmpty (void) const
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (uint32_t start)
 {
-  NS_LOG_FUNCTION (this);
-  uint32_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  uint32_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -197,7 +197,7 @@ HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
 }
 
 Scheduler::Event
@@ -230,7 +230,15 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          // The former last item may belong above the hole as well as below it.
+          if (!IsBottom (i) && !IsRoot (i) && IsLessStrictly (i, Parent (i)))
+            {
+              BottomUp (i);
+            }
+          else
+            {
+              TopDown (i);
+            }
           return;
         }
     }
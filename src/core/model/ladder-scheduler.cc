@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "nstime.h"
+#include "assert.h"
+#include "log.h"
+#include "unused.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler)
+  ;
+
+const uint32_t LadderScheduler::THRESHOLD;
+const uint32_t LadderScheduler::MAX_RUNGS;
+const uint32_t LadderScheduler::NIL;
+
+namespace {
+
+// Orders node indexes from the last event to the next one
+class LaterFirst
+{
+public:
+  LaterFirst (const std::vector<LadderScheduler::Event> &events)
+    : m_events (events)
+  {
+  }
+  bool operator () (uint32_t a, uint32_t b) const
+  {
+    return m_events[b].key < m_events[a].key;
+  }
+private:
+  const std::vector<LadderScheduler::Event> &m_events;
+};
+
+} // anonymous namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_free (NIL),
+    m_top (NIL),
+    m_topCount (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_size (0),
+    m_now (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::Allocate (const Event &ev)
+{
+  uint32_t node = m_free;
+  if (node == NIL)
+    {
+      node = m_events.size ();
+      m_events.push_back (ev);
+      m_next.push_back (NIL);
+    }
+  else
+    {
+      m_free = m_next[node];
+      m_events[node] = ev;
+      m_next[node] = NIL;
+    }
+  return node;
+}
+
+void
+LadderScheduler::Free (uint32_t node)
+{
+  m_events[node].impl = 0;
+  m_next[node] = m_free;
+  m_free = node;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t r = 0; r < m_nRungs; r++)
+    {
+      const Rung &rung = m_rungs[r];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          return r;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::AddToRung (Rung &rung, uint32_t node)
+{
+  uint64_t bucket = (m_events[node].key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (bucket >= rung.current && bucket < rung.heads.size ());
+  m_next[node] = rung.heads[bucket];
+  rung.heads[bucket] = node;
+  rung.count++;
+}
+
+void
+LadderScheduler::AddToBottom (uint32_t node)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), node, LaterFirst (m_events)), node);
+  if (m_bottom.size () <= THRESHOLD || m_nRungs == MAX_RUNGS)
+    {
+      return;
+    }
+  uint64_t min = m_events[m_bottom.back ()].key.m_ts;
+  if (m_events[m_bottom.front ()].key.m_ts == min)
+    {
+      return;
+    }
+  // Too many events for a sorted array: they go to a new rung, up to the
+  // time from which the lowest rung (or top) takes over.
+  uint64_t end = m_topStart;
+  if (m_nRungs != 0)
+    {
+      const Rung &last = m_rungs[m_nRungs - 1];
+      end = last.start + last.current * last.width;
+    }
+  uint32_t list = NIL;
+  for (std::vector<uint32_t>::const_iterator i = m_bottom.begin (); i != m_bottom.end (); ++i)
+    {
+      m_next[*i] = list;
+      list = *i;
+    }
+  uint32_t count = m_bottom.size ();
+  m_bottom.clear ();
+  Spawn (list, count, min, end - 1);
+}
+
+void
+LadderScheduler::Spawn (uint32_t list, uint32_t count, uint64_t min, uint64_t max)
+{
+  NS_LOG_FUNCTION (this << count << min << max);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && count != 0 && min <= max);
+  Rung &rung = m_rungs[m_nRungs++];
+  rung.start = min;
+  rung.width = (max - min) / count + 1;
+  rung.current = 0;
+  rung.count = 0;
+  rung.heads.assign (count, NIL);
+  while (list != NIL)
+    {
+      uint32_t node = list;
+      list = m_next[node];
+      AddToRung (rung, node);
+    }
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_topCount == 0)
+            {
+              return;
+            }
+          uint32_t list = m_top;
+          uint32_t count = m_topCount;
+          m_top = NIL;
+          m_topCount = 0;
+          Spawn (list, count, m_topMin, m_topMax);
+          m_topStart = m_rungs[0].start + m_rungs[0].heads.size () * m_rungs[0].width;
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.heads[rung.current] == NIL)
+        {
+          rung.current++;
+        }
+      uint32_t list = rung.heads[rung.current];
+      rung.heads[rung.current] = NIL;
+      uint64_t start = rung.start + rung.current * rung.width;
+      rung.current++;
+      uint32_t count = 0;
+      for (uint32_t node = list; node != NIL; node = m_next[node])
+        {
+          count++;
+        }
+      rung.count -= count;
+      if (count > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          Spawn (list, count, start, start + rung.width - 1);
+          continue;
+        }
+      for (uint32_t node = list; node != NIL; node = m_next[node])
+        {
+          m_bottom.push_back (node);
+        }
+      std::sort (m_bottom.begin (), m_bottom.end (), LaterFirst (m_events));
+    }
+}
+
+bool
+LadderScheduler::UnlinkFrom (uint32_t &head, uint32_t uid)
+{
+  for (uint32_t *link = &head; *link != NIL; link = &m_next[*link])
+    {
+      uint32_t node = *link;
+      if (m_events[node].key.m_uid == uid)
+        {
+          *link = m_next[node];
+          Free (node);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_LOG_LOGIC ("delay " << TimeStep (ev.key.m_ts - m_now).GetSeconds ());
+  uint64_t ts = ev.key.m_ts;
+  uint32_t node = Allocate (ev);
+  m_size++;
+  if (ts >= m_topStart)
+    {
+      if (m_topCount == 0)
+        {
+          m_topMin = m_topMax = ts;
+        }
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_next[node] = m_top;
+      m_top = node;
+      m_topCount++;
+      return;
+    }
+  uint32_t r = FindRung (ts);
+  if (r < m_nRungs)
+    {
+      AddToRung (m_rungs[r], node);
+    }
+  else
+    {
+      AddToBottom (node);
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_size != 0);
+  // Finding the next event may move events down the ladder, which changes
+  // the layout of the queue but not its content.
+  const_cast<LadderScheduler *> (this)->Refill ();
+  return m_events[m_bottom.back ()];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_size != 0);
+  Refill ();
+  uint32_t node = m_bottom.back ();
+  m_bottom.pop_back ();
+  Event next = m_events[node];
+  Free (node);
+  m_size--;
+  m_now = next.key.m_ts;
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  uint32_t uid = ev.key.m_uid;
+  m_size--;
+  if (ts >= m_topStart)
+    {
+      bool found = UnlinkFrom (m_top, uid);
+      NS_ASSERT (found);
+      NS_UNUSED (found);
+      m_topCount--;
+      return;
+    }
+  uint32_t r = FindRung (ts);
+  if (r < m_nRungs)
+    {
+      Rung &rung = m_rungs[r];
+      bool found = UnlinkFrom (rung.heads[(ts - rung.start) / rung.width], uid);
+      NS_ASSERT (found);
+      NS_UNUSED (found);
+      rung.count--;
+      return;
+    }
+  for (std::vector<uint32_t>::iterator i = m_bottom.begin (); i != m_bottom.end (); ++i)
+    {
+      if (m_events[*i].key.m_uid == uid)
+        {
+          Free (*i);
+          m_bottom.erase (i);
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler for large event populations
+ *
+ * This is the ladder queue of W. T. Tang, R. S. M. Goh and I. L.-J. Thng,
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale Discrete
+ * Event Simulation", ACM TOMACS 15(3), 2005. Like the CalendarScheduler it
+ * sorts the events into buckets of time, but the bucket width is never
+ * guessed from samples: it is derived from the events at hand, and buckets
+ * which still hold too many events are split again into a finer rung of the
+ * ladder, up to 8 rungs.
+ *  - Top is an unsorted list of the events beyond the time covered by the
+ *    rungs. It is only looked at when the rungs run out, then all its events
+ *    are spread over a new first rung, one bucket per event.
+ *  - Each rung is an array of buckets, unsorted lists, visited in order.
+ *  - Bottom holds the events of the bucket being consumed, sorted. There are
+ *    at most 50 of them, unless they share one timestamp or all 8 rungs
+ *    are in use.
+ *
+ * Insert and RemoveNext take O(1) amortized time whatever the population and
+ * the distribution of the timestamps, where the heaps need O(log(n)).
+ * Events are linked by index into one pool, so moving them between top,
+ * rungs and bottom neither copies them nor allocates memory.
+ *
+ * Remove () searches the one bucket (or top, or bottom) the event belongs to.
+ *
+ * With logging enabled at the LOGIC level, every insertion prints
+ * "delay <seconds>", the time from the current event to the new one, which
+ * is the input of utils/bench-simulator --file to replay the event
+ * population of a real simulation.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  /* Events in a bucket above which the bucket is split into a new rung. */
+  static const uint32_t THRESHOLD = 50;
+  static const uint32_t MAX_RUNGS = 8;
+  static const uint32_t NIL = 0xffffffff;
+
+  struct Rung
+  {
+    uint64_t start;               //!< timestamp of the start of the first bucket
+    uint64_t width;               //!< time covered by each bucket
+    uint32_t current;             //!< first bucket which may hold events
+    uint32_t count;               //!< events in the buckets
+    std::vector<uint32_t> heads;  //!< first node of each bucket, NIL if empty
+  };
+
+  uint32_t Allocate (const Event &ev);
+  void Free (uint32_t node);
+  /* Return the rung whose current bucket or later ones hold ts, m_nRungs if none. */
+  uint32_t FindRung (uint64_t ts) const;
+  void AddToRung (Rung &rung, uint32_t node);
+  void AddToBottom (uint32_t node);
+  /* Spread a list of count nodes, between min and max, over a new rung. */
+  void Spawn (uint32_t list, uint32_t count, uint64_t min, uint64_t max);
+  /* Make sure bottom holds the next events, if there are any. */
+  void Refill (void);
+  bool UnlinkFrom (uint32_t &head, uint32_t uid);
+
+  /* Node pool, a node is an event and the index of the next node in its list. */
+  std::vector<Event> m_events;
+  std::vector<uint32_t> m_next;
+  uint32_t m_free;                //!< list of the unused nodes
+
+  uint32_t m_top;                 //!< list of the events at or after m_topStart
+  uint32_t m_topCount;
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+  uint64_t m_topStart;
+
+  Rung m_rungs[MAX_RUNGS];
+  uint32_t m_nRungs;
+
+  std::vector<uint32_t> m_bottom; //!< nodes sorted from the last event to the next one
+  uint32_t m_size;                //!< number of events in the queue
+  uint64_t m_now;                 //!< timestamp of the last event removed from the queue
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
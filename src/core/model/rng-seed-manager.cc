@@ -52,9 +52,8 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint64_t next = g_nextStreamIndex;
-  g_nextStreamIndex++;
-  return next;
+  // Streams may be created by the threads of a parallel simulation at once
+  return __sync_fetch_and_add (&g_nextStreamIndex, 1);
 }
 
 } // namespace ns3
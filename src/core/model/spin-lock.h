@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPIN_LOCK_H
+#define SPIN_LOCK_H
+
+namespace ns3 {
+
+/**
+ * @brief A lock for critical sections of a few instructions.
+ *
+ * A thread which finds the lock taken spins until it is released instead
+ * of sleeping, which costs much less than a SystemMutex when the holder
+ * is about to release it. It suits the free lists and counters which the
+ * threads of a parallel simulation share but seldom contend for, and it
+ * is available even without thread support in the build.
+ *
+ * A SpinLock is not recursive.
+ */
+class SpinLock
+{
+public:
+  SpinLock ()
+    : m_locked (0)
+  {
+  }
+  void Lock (void)
+  {
+    while (__sync_lock_test_and_set (&m_locked, 1))
+      {
+        while (m_locked)
+          {
+          }
+      }
+  }
+  void Unlock (void)
+  {
+    __sync_lock_release (&m_locked);
+  }
+private:
+  volatile int m_locked;
+};
+
+} // namespace ns3
+
+#endif /* SPIN_LOCK_H */
@@ -21,8 +21,12 @@
 #include "ns3/simulator.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +463,70 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that a large population of events, some removed, comes out in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  std::vector<Scheduler::EventKey> expected;
+  uint32_t uid = 0;
+  uint64_t now = 0;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      // Mostly timestamps from a small range, so that many of them are equal,
+      // and a few far away
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + rand->GetInteger (0, (i % 10 == 0) ? 1000000 : 1000);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          expected.push_back (ev.key);
+        }
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          uint32_t victim = rand->GetInteger (0, expected.size () - 1);
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key = expected[victim];
+          scheduler->Remove (ev);
+          expected.erase (expected.begin () + victim);
+        }
+      std::sort (expected.begin (), expected.end ());
+      for (uint32_t i = 0; i < 300; i++)
+        {
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected[0].m_uid, "Events out of order");
+          now = ev.key.m_ts;
+          expected.erase (expected.begin ());
+        }
+    }
+  std::sort (expected.begin (), expected.end ());
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Events lost");
+      NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, expected[i].m_uid, "Events out of order");
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Events left over");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +543,20 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    const char *schedulerTypes[] = {
+      "ns3::ListScheduler",
+      "ns3::MapScheduler",
+      "ns3::HeapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
+    };
+    for (uint32_t i = 0; i < sizeof (schedulerTypes) / sizeof (schedulerTypes[0]); i++)
+      {
+        factory.SetTypeId (schedulerTypes[i]);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
@@ -366,6 +366,42 @@ CsmaNetDevice::AddHeader (Ptr<Packet> p,   Mac48Address source,  Mac48Address de
   p->AddTrailer (trailer);
 }
 
+bool
+CsmaNetDevice::MarkEcn (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (p);
+  if (m_node == 0)
+    {
+      return false;
+    }
+  EthernetTrailer trailer;
+  p->RemoveTrailer (trailer);
+  EthernetHeader header (false);
+  p->RemoveHeader (header);
+
+  bool marked;
+  if (header.GetLengthType () <= 1500)
+    {
+      LlcSnapHeader llc;
+      p->RemoveHeader (llc);
+      marked = m_node->MarkEcn (p, llc.GetType ());
+      p->AddHeader (llc);
+    }
+  else
+    {
+      marked = m_node->MarkEcn (p, header.GetLengthType ());
+    }
+
+  p->AddHeader (header);
+  if (Node::ChecksumEnabled ())
+    {
+      trailer.EnableFcs (true);
+    }
+  trailer.CalcFcs (p);
+  p->AddTrailer (trailer);
+  return marked;
+}
+
 #if 0
 bool
 CsmaNetDevice::ProcessHeader (Ptr<Packet> p, uint16_t & param)
@@ -641,6 +677,7 @@ CsmaNetDevice::SetQueue (Ptr<Queue> q)
 {
   NS_LOG_FUNCTION (q);
   m_queue = q;
+  m_queue->SetMarkCallback (MakeCallback (&CsmaNetDevice::MarkEcn, this));
 }
 
 void
@@ -350,6 +350,16 @@ protected:
    */
   void AddHeader (Ptr<Packet> p, Mac48Address source, Mac48Address dest, uint16_t protocolNumber);
 
+  /**
+   * Marks a frame of the transmit queue Congestion Experienced, see
+   * Queue::SetMarkCallback (). The Ethernet header and trailer, and the
+   * LLC/SNAP header if any, are set aside while the node's marker for the
+   * frame's protocol rewrites its header, then the FCS is computed again.
+   * \param p Packet with its Ethernet header and trailer
+   * \return Returns false if the packet is not ECN capable.
+   */
+  bool MarkEcn (Ptr<Packet> p);
+
 private:
 
   /**
@@ -81,6 +81,11 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * With the GlobalRoutingIncremental global value set, the SPF trees of
+   * the last computation are kept: when only point-to-point links changed,
+   * the routes are only computed again for the routers whose tree they
+   * affect, and only the routing tables whose routes changed are rewritten.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -30,6 +30,13 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -44,6 +51,19 @@ NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
 namespace ns3 {
 
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads the SPF calculations of the global "
+                                           "routing run on. Always 1 without thread support",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> (1));
+
+static GlobalValue g_globalRoutingIncremental ("GlobalRoutingIncremental",
+                                               "Keep the SPF trees of the global routing, so that "
+                                               "RecomputeRoutingTables () only calculates again the ones "
+                                               "a link change affects",
+                                               BooleanValue (false),
+                                               MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -423,7 +443,9 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_linkDataIndex (),
+    m_linkDataIndexValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -446,6 +468,7 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
@@ -458,6 +481,7 @@ GlobalRouteManagerLSDB::Initialize ()
       GlobalRoutingLSA* temp = i->second;
       temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     }
+  UpdateLinkDataIndex ();
 }
 
 void
@@ -471,6 +495,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_linkDataIndexValid = false;
     }
 }
 
@@ -495,13 +520,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -510,9 +532,33 @@ GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
+  UpdateLinkDataIndex ();
 //
 // Look up an LSA by its address.
 //
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
+    {
+      return i->second;
+    }
+  return 0;
+}
+
+void
+GlobalRouteManagerLSDB::UpdateLinkDataIndex () const
+{
+//
+// Index the LinkData of all TransitNetwork link records the first time we are
+// called after the database changed.  Walking the database in order and
+// keeping the first LSA seen for a given address returns the same LSA as a
+// linear search would.
+//
+  if (m_linkDataIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_linkDataIndex.clear ();
   LSDBMap_t::const_iterator i;
   for (i= m_database.begin (); i!= m_database.end (); i++)
     {
@@ -521,14 +567,219 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
       for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
         {
           GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
             {
-              return temp;
+              m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), temp));
             }
         }
     }
-  return 0;
+  m_linkDataIndexValid = true;
+}
+
+//
+// Point-to-point link records are grouped by the neighbor they lead to, in the
+// order of the LSA.  The link to a neighbor changed when its group differs.
+// Everything else but stub network records must be the same.
+//
+bool
+GlobalRouteManagerLSDB::GetChangedLinks (const GlobalRouteManagerLSDB& older, LinkSet_t& links) const
+{
+  NS_LOG_FUNCTION (this << &older);
+  typedef std::vector<std::pair<Ipv4Address, uint16_t> > Records_t;
+  typedef std::map<Ipv4Address, Records_t> Neighbors_t;
+
+  if (m_database.size () != older.m_database.size ())
+    {
+      NS_LOG_LOGIC ("Routers or networks added or removed");
+      return false;
+    }
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* lsa = i->second;
+      GlobalRoutingLSA* old = older.GetLSA (i->first);
+      if (old == 0 || old->GetLSType () != lsa->GetLSType ())
+        {
+          NS_LOG_LOGIC ("LSA " << i->first << " added or changed type");
+          return false;
+        }
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          if (lsa->GetNetworkLSANetworkMask () != old->GetNetworkLSANetworkMask ()
+              || lsa->GetNAttachedRouters () != old->GetNAttachedRouters ())
+            {
+              return false;
+            }
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              if (lsa->GetAttachedRouter (j) != old->GetAttachedRouter (j))
+                {
+                  return false;
+                }
+            }
+          continue;
+        }
+      GlobalRoutingLSA* both[] = { lsa, old };
+      Neighbors_t neighbors[2];
+      Records_t transits[2];
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          for (uint32_t j = 0; j < both[k]->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = both[k]->GetLinkRecord (j);
+              std::pair<Ipv4Address, uint16_t> record (lr->GetLinkData (), lr->GetMetric ());
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  neighbors[k][lr->GetLinkId ()].push_back (record);
+                }
+              else if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  transits[k].push_back (record);
+                  transits[k].push_back (std::make_pair (lr->GetLinkId (), 0));
+                }
+            }
+        }
+      if (transits[0] != transits[1])
+        {
+          NS_LOG_LOGIC ("Transit network records of " << i->first << " changed");
+          return false;
+        }
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          for (Neighbors_t::const_iterator j = neighbors[k].begin (); j != neighbors[k].end (); j++)
+            {
+              Neighbors_t::const_iterator other = neighbors[1 - k].find (j->first);
+              if (other == neighbors[1 - k].end () || other->second != j->second)
+                {
+                  Ipv4Address a = i->first;
+                  Ipv4Address b = j->first;
+                  links.insert (a < b ? std::make_pair (a, b) : std::make_pair (b, a));
+                }
+            }
+        }
+    }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+//
+// SPFCalculation Implementation
+//
+// ---------------------------------------------------------------------------
+
+bool
+SPFCalculation::Route::operator== (const Route& route) const
+{
+  return type == route.type && dest == route.dest && mask == route.mask
+         && nextHop == route.nextHop && outIf == route.outIf;
+}
+
+SPFCalculation::SPFCalculation (Ipv4Address rootId, uint32_t nodeId)
+  : m_root (0),
+    m_checkStub (false),
+    m_calculated (false),
+    m_rootId (rootId),
+    m_nodeId (nodeId)
+{
+  NS_LOG_FUNCTION (this << rootId << nodeId);
+}
+
+SPFCalculation::~SPFCalculation ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteTree ();
+}
+
+Ipv4Address
+SPFCalculation::GetRootId (void) const
+{
+  return m_rootId;
+}
+
+uint32_t
+SPFCalculation::GetNodeId (void) const
+{
+  return m_nodeId;
+}
+
+void
+SPFCalculation::SetInterfaces (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+  m_interfaces.clear ();
+  if (ipv4 == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          m_interfaces.push_back (std::make_pair (i, ipv4->GetAddress (i, j).GetLocal ()));
+        }
+    }
+}
+
+int32_t
+SPFCalculation::GetInterfaceForPrefix (Ipv4Address a, Ipv4Mask mask) const
+{
+  for (uint32_t i = 0; i < m_interfaces.size (); i++)
+    {
+      if (m_interfaces[i].second.CombineMask (mask) == a.CombineMask (mask))
+        {
+          return m_interfaces[i].first;
+        }
+    }
+  return -1;
+}
+
+GlobalRoutingLSA::SPFStatus
+SPFCalculation::GetStatus (GlobalRoutingLSA* lsa) const
+{
+  StatusMap_t::const_iterator i = m_status.find (lsa);
+  if (i != m_status.end ())
+    {
+      return i->second;
+    }
+  return GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+}
+
+void
+SPFCalculation::SetStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_status[lsa] = status;
+}
+
+void
+SPFCalculation::AddRoute (Route::Type type, Ipv4Address dest, Ipv4Mask mask,
+                          Ipv4Address nextHop, uint32_t outIf)
+{
+  Route route;
+  route.type = type;
+  route.dest = dest;
+  route.mask = mask;
+  route.nextHop = nextHop;
+  route.outIf = outIf;
+  m_routes.push_back (route);
+}
+
+void
+SPFCalculation::ClearStatus (void)
+{
+  m_status.clear ();
+}
+
+void
+SPFCalculation::DeleteTree (void)
+{
+  NS_LOG_FUNCTION (this);
+//
+// Deleting the root deletes all of the vertices below it.
+//
+  delete m_root;
+  m_root = 0;
+  m_tree.clear ();
+  m_used.clear ();
+  m_status.clear ();
 }
 
 // ---------------------------------------------------------------------------
@@ -539,7 +790,10 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_prevLsdb (0),
+    m_nThreads (1),
+    m_keepTrees (false),
+    m_nCalculated (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -548,6 +802,7 @@ GlobalRouteManagerImpl::GlobalRouteManagerImpl ()
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
+  DeleteCalculations ();
   if (m_lsdb)
     {
       delete m_lsdb;
@@ -558,6 +813,7 @@ void
 GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
 {
   NS_LOG_FUNCTION (this << lsdb);
+  DeleteCalculations ();
   if (m_lsdb)
     {
       delete m_lsdb;
@@ -565,6 +821,12 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+uint32_t
+GlobalRouteManagerImpl::DebugGetNCalculated (void) const
+{
+  return m_nCalculated;
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -572,26 +834,12 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (*i);
     }
+//
+// The SPF trees kept refer to the LSDB deleted below.
+//
+  DeleteCalculations ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -600,6 +848,30 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -697,9 +969,88 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
 //
-// Walk the list of nodes in the system.
+// Trees kept from an earlier calculation were built on another LSDB.
 //
+  DeleteCalculations ();
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFCalculation*> spfs;
+  CreateCalculations (spfs);
+  RunCalculations (spfs);
+//
+// The routes are written by this thread only, root after root in node order,
+// so the routing tables are the same whatever the number of threads.
+//
+  for (uint32_t i = 0; i < spfs.size (); i++)
+    {
+      InstallRoutes (*spfs[i], NodeList::GetNode (spfs[i]->GetNodeId ()));
+    }
+  KeepCalculations (spfs);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_calculations.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Build the new LSDB next to the one the kept trees were calculated on, and
+// find what changed between them.
+//
+  m_prevLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  m_changedLinks.clear ();
+  bool linksOnly = m_lsdb->GetChangedLinks (*m_prevLsdb, m_changedLinks);
+  NS_LOG_LOGIC (m_changedLinks.size () << " links changed, " << 
+                (linksOnly ? "nothing else" : "and more"));
+  std::vector<SPFCalculation*> spfs;
+  CreateCalculations (spfs);
+//
+// Routers that are gone keep no route.
+//
+  for (SPFCalculationMap_t::iterator i = m_calculations.begin (); i != m_calculations.end (); i++)
+    {
+      DeleteRoutes (NodeList::GetNode (i->second->GetNodeId ()));
+    }
+  DeleteCalculations ();
+  std::vector<std::vector<SPFCalculation::Route> > previous (spfs.size ());
+  for (uint32_t i = 0; i < spfs.size (); i++)
+    {
+      previous[i].swap (spfs[i]->m_routes);
+      if (!linksOnly)
+        {
+          spfs[i]->DeleteTree ();
+        }
+    }
+  RunCalculations (spfs);
+  for (uint32_t i = 0; i < spfs.size (); i++)
+    {
+      if (spfs[i]->m_routes == previous[i])
+        {
+          continue;
+        }
+      Ptr<Node> node = NodeList::GetNode (spfs[i]->GetNodeId ());
+      DeleteRoutes (node);
+      InstallRoutes (*spfs[i], node);
+    }
+  delete m_prevLsdb;
+  m_prevLsdb = 0;
+  m_changedLinks.clear ();
+  KeepCalculations (spfs);
+}
+
+void
+GlobalRouteManagerImpl::CreateCalculations (std::vector<SPFCalculation*>& spfs)
+{
+  NS_LOG_FUNCTION (this);
+  bool checkStub = NodeList::GetNNodes () > 0;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -711,23 +1062,247 @@ GlobalRouteManagerImpl::InitializeRoutes ()
       Ptr<GlobalRouter> rtr = 
         node->GetObject<GlobalRouter> ();
 
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      // Ignore nodes that are not simulated by this process (distributed sim)
+      if (!MpiInterface::IsLocal (node->GetSystemId ()))
+        {
+          continue;
+        }
+
+//
+// if the node has a global router interface, then run the global routing
+// algorithms.
+//
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          SPFCalculation* spf = 0;
+          SPFCalculationMap_t::iterator kept = m_calculations.find (rtr->GetRouterId ());
+          if (kept != m_calculations.end () && kept->second->GetNodeId () == node->GetId ())
+            {
+              spf = kept->second;
+              m_calculations.erase (kept);
+            }
+          else
+            {
+              spf = new SPFCalculation (rtr->GetRouterId (), node->GetId ());
+            }
+//
+// Everything the calculation needs from the node is looked up here, as the
+// node cannot be used from the threads running the calculations.
+//
+          spf->SetInterfaces (node->GetObject<Ipv4> ());
+          spf->m_checkStub = checkStub;
+          spfs.push_back (spf);
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RunCalculations (const std::vector<SPFCalculation*>& spfs)
+{
+  NS_LOG_FUNCTION (this << spfs.size ());
+//
+// Nothing changes the LSDB from now on: the calculations only read it.
+//
+  m_lsdb->Initialize ();
+  m_running = spfs;
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  m_keepTrees = incremental.Get ();
+  UintegerValue threads;
+  g_globalRoutingThreads.GetValue (threads);
+  m_nThreads = std::max<uint32_t> (1, std::min<uint32_t> (threads.Get (), spfs.size ()));
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > workers;
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Callback<void, uint32_t> run = MakeCallback (&GlobalRouteManagerImpl::RunEveryNth, this);
+      workers.push_back (Create<SystemThread> (run.Bind (i)));
+      workers.back ()->Start ();
+    }
+#else
+  m_nThreads = 1;
+#endif
+  RunEveryNth (0);
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t i = 0; i < workers.size (); i++)
+    {
+      workers[i]->Join ();
+    }
+#endif
+  m_running.clear ();
+  m_nCalculated = 0;
+  for (uint32_t i = 0; i < spfs.size (); i++)
+    {
+      if (spfs[i]->m_calculated)
+        {
+          m_nCalculated++;
+        }
+    }
+  NS_LOG_LOGIC ("Calculated " << m_nCalculated << " of " << spfs.size () << 
+                " SPF trees on " << m_nThreads << " threads");
+}
+
+//
+// Roots with many routers next to each other in the node list tend to cost
+// about the same, so taking every n-th one shares the work out evenly enough.
+//
+void
+GlobalRouteManagerImpl::RunEveryNth (uint32_t first)
+{
+  NS_LOG_FUNCTION (this << first);
+  for (uint32_t i = first; i < m_running.size (); i += m_nThreads)
+    {
+      Calculate (*m_running[i]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::Calculate (SPFCalculation& spf)
+{
+  NS_LOG_FUNCTION (this << spf.GetRootId ());
+  if (m_prevLsdb != 0 && spf.m_root != 0 && !SPFTreeAffected (spf))
+    {
+//
+// Same tree as before: point it to the new LSAs and find the routes along it
+// again, in case the stub networks or the external LSAs changed.
+//
+      NS_LOG_LOGIC ("SPF tree of " << spf.GetRootId () << " is not affected");
+      spf.m_root->SetLSA (m_lsdb->GetLSA (spf.GetRootId ()));
+      for (uint32_t i = 0; i < spf.m_tree.size (); i++)
+        {
+          SPFVertex* v = spf.m_tree[i];
+          v->SetLSA (m_lsdb->GetLSA (v->GetVertexId ()));
+          NS_ASSERT (v->GetLSA ());
+        }
+      spf.m_routes.clear ();
+      SPFAddRoutes (spf);
+      spf.m_calculated = false;
+      return;
+    }
+  spf.DeleteTree ();
+  spf.m_routes.clear ();
+  SPFCalculate (spf);
+  spf.m_calculated = true;
+  if (!m_keepTrees)
+    {
+      spf.DeleteTree ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::KeepCalculations (const std::vector<SPFCalculation*>& spfs)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < spfs.size (); i++)
+    {
+      if (m_keepTrees)
+        {
+          m_calculations[spfs[i]->GetRootId ()] = spfs[i];
+        }
+      else
+        {
+          delete spfs[i];
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::DeleteCalculations (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (SPFCalculationMap_t::iterator i = m_calculations.begin (); i != m_calculations.end (); i++)
+    {
+      delete i->second;
+    }
+  m_calculations.clear ();
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (const SPFCalculation& spf, Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << spf.GetRootId () << node);
+  if (node == 0)
+    {
+      NS_LOG_LOGIC ("No node for router " << spf.GetRootId ());
+      return;
+    }
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  NS_LOG_LOGIC ("Setting " << spf.m_routes.size () << " routes for node " << node->GetId ());
+  for (uint32_t i = 0; i < spf.m_routes.size (); i++)
+    {
+      const SPFCalculation::Route& route = spf.m_routes[i];
+      switch (route.type)
+        {
+        case SPFCalculation::Route::HostRoute:
+          gr->AddHostRouteTo (route.dest, route.nextHop, route.outIf);
+          break;
+        case SPFCalculation::Route::NetworkRoute:
+          gr->AddNetworkRouteTo (route.dest, route.mask, route.nextHop, route.outIf);
+          break;
+        case SPFCalculation::Route::ExternalRoute:
+          gr->AddASExternalRouteTo (route.dest, route.mask, route.nextHop, route.outIf);
+          break;
+        }
+    }
+}
+
+//
+// Replaying the calculation on the new LSDB gives the old tree, in the same
+// order, as long as every vertex gets the same parents.  Only the links from
+// the parents matter: a candidate lowered to a shorter distance drops its
+// parents and lands in the queue where a vertex pushed at that distance would,
+// so the links it was found through before can go, and a new link from v to w
+// does nothing unless it brings w at least as close as it was.
+//
+bool
+GlobalRouteManagerImpl::SPFTreeAffected (const SPFCalculation& spf) const
+{
+  NS_LOG_FUNCTION (this << spf.GetRootId ());
+  if (m_changedLinks.empty ())
+    {
+      return false;
+    }
+  std::map<Ipv4Address, uint32_t> distances;
+  distances[spf.GetRootId ()] = 0;
+  for (uint32_t i = 0; i < spf.m_tree.size (); i++)
+    {
+      distances[spf.m_tree[i]->GetVertexId ()] = spf.m_tree[i]->GetDistanceFromRoot ();
+    }
+
+  for (GlobalRouteManagerLSDB::LinkSet_t::const_iterator i = m_changedLinks.begin ();
+       i != m_changedLinks.end (); i++)
+    {
+      if (spf.m_used.count (*i) || spf.m_used.count (std::make_pair (i->second, i->first)))
         {
-          continue;
+          NS_LOG_LOGIC ("Link " << i->first << "-" << i->second << " is in the tree of " << spf.GetRootId ());
+          return true;
         }
-
-//
-// if the node has a global router interface, then run the global routing
-// algorithms.
-//
-      if (rtr && rtr->GetNumLSAs () )
+      Ipv4Address ends[] = { i->first, i->second };
+      for (uint32_t k = 0; k < 2; k++)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          std::map<Ipv4Address, uint32_t>::const_iterator v = distances.find (ends[k]);
+          if (v == distances.end ())
+            {
+              continue;
+            }
+          std::map<Ipv4Address, uint32_t>::const_iterator w = distances.find (ends[1 - k]);
+          GlobalRoutingLSA* vLsa = m_lsdb->GetLSA (v->first);
+          for (uint32_t j = 0; j < vLsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = vLsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint && l->GetLinkId () == ends[1 - k]
+                  && (w == distances.end () || w->second >= v->second + l->GetMetric ()))
+                {
+                  NS_LOG_LOGIC ("Link " << v->first << "-" << ends[1 - k] << " would change the tree of " << spf.GetRootId ());
+                  return true;
+                }
+            }
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  return false;
 }
 
 //
@@ -744,7 +1319,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // vertex already on the candidate list, store the new (lower) cost.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::SPFNext (SPFCalculation& spf, SPFVertex* v, CandidateQueue& candidate)
 {
   NS_LOG_FUNCTION (this << v << &candidate);
 
@@ -836,7 +1411,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (spf.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1436,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (spf.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -871,9 +1446,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
+          if (SPFNexthopCalculation (spf, v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              spf.SetStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1463,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (spf.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -935,7 +1510,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
-              SPFNexthopCalculation (v, w, l, distance);
+              SPFNexthopCalculation (spf, v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
 // SPFVertexAddParent (w) is necessary as the destructor of 
@@ -954,9 +1529,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
 // it will call spf_add_parents, which will flush the old parents
 //
-              if (SPFNexthopCalculation (v, cw, l, distance))
+              if (SPFNexthopCalculation (spf, v, cw, l, distance))
                 {
-//
+    //
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
@@ -979,6 +1554,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 //
 int
 GlobalRouteManagerImpl::SPFNexthopCalculation (
+  const SPFCalculation& spf,
   SPFVertex* v, 
   SPFVertex* w,
   GlobalRoutingLinkRecord* l,
@@ -995,7 +1571,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 */
 
 //
-// The vertex m_spfroot is a distinguished vertex representing the node at
+// The root vertex of spf is a distinguished vertex representing the node at
 // the root of the calculations.  That is, it is the node for which we are
 // calculating the routes.
 //
@@ -1017,7 +1593,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // The point-to-point link information is only useful in this calculation when
 // we are examining the root node. 
 //
-  if (v == m_spfroot)
+  if (v == spf.m_root)
     {
 //
 // In this case <v> is the root node, which means it is the starting point
@@ -1062,7 +1638,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // from the perspective of <v> -- remember that <l> is the link "from"
 // <v> "to" <w>.
 //
-          uint32_t outIf = FindOutgoingInterfaceId (l->GetLinkData ());
+          uint32_t outIf = FindOutgoingInterfaceId (spf, l->GetLinkData ());
 
           w->SetRootExitDirection (nextHop, outIf);
           w->SetDistanceFromRoot (distance);
@@ -1080,8 +1656,8 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
           GlobalRoutingLSA* w_lsa = w->GetLSA ();
           NS_ASSERT (w_lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA);
 // Find outgoing interface ID for this network
-          uint32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), 
-                                                    w_lsa->GetNetworkLSANetworkMask () );
+          uint32_t outIf = FindOutgoingInterfaceId (spf, w_lsa->GetLinkStateId (), 
+                                                         w_lsa->GetNetworkLSANetworkMask () );
 // Set the next hop to 0.0.0.0 meaning "not exist"
           Ipv4Address nextHop = Ipv4Address::GetZero ();
           w->SetRootExitDirection (nextHop, outIf);
@@ -1097,7 +1673,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
   else if (v->GetVertexType () == SPFVertex::VertexNetwork) 
     {
 // See if any of v's parents are the root
-      if (v->GetParent () == m_spfroot)
+      if (v->GetParent () == spf.m_root)
         {
 // 16.1.1 para 5. ...the parent vertex is a network that
 // directly connects the calculating router to the destination
@@ -1247,7 +1823,13 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  Ptr<Node> node = FindRouterNode (root);
+  SPFCalculation spf (root, node ? node->GetId () : 0);
+  spf.SetInterfaces (node ? node->GetObject<Ipv4> () : 0);
+  spf.m_checkStub = NodeList::GetNNodes () > 0;
+  m_lsdb->Initialize ();
+  SPFCalculate (spf);
+  InstallRoutes (spf, node);
 }
 
 //
@@ -1257,8 +1839,9 @@ GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 // to be run
 //
 bool
-GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
+GlobalRouteManagerImpl::CheckForStubNode (SPFCalculation& spf)
 {
+  Ipv4Address root = spf.GetRootId ();
   NS_LOG_FUNCTION (this << root);
   GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
   Ipv4Address myRouterId = rlsa->GetLinkStateId ();
@@ -1320,15 +1903,12 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  spf.AddRoute (SPFCalculation::Route::NetworkRoute,
+                                Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                                FindOutgoingInterfaceId (spf, transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                                FindOutgoingInterfaceId (spf, transitLink->GetLinkData ()));
                   return true;
                 }
             }
@@ -1337,17 +1917,45 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
+//
+// Walk the list of nodes in the system looking for the one whose GlobalRouter
+// has the given router ID.
+//
+Ptr<Node>
+GlobalRouteManagerImpl::FindRouterNode (Ipv4Address routerId) const
+{
+  NS_LOG_FUNCTION (this << routerId);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0)
+        {
+          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
+          continue;
+        }
+      if (rtr->GetRouterId () == routerId)
+        {
+          return node;
+        }
+    }
+  NS_LOG_LOGIC ("Can't find node for router " << routerId);
+  return 0;
+}
+
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (SPFCalculation& spf)
 {
+  Ipv4Address root = spf.GetRootId ();
   NS_LOG_FUNCTION (this << root);
+  NS_ASSERT (spf.m_root == 0);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
-//
-  m_lsdb->Initialize ();
+// The LSDB was initialized before the calculations started, and it is not
+// changed here: the status of the LSAs is kept in spf.
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1365,9 +1973,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
-  m_spfroot= v;
+  spf.m_root = v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  spf.SetStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +1985,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (spf.m_checkStub && CheckForStubNode (spf))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
-      delete m_spfroot;
+      spf.DeleteTree ();
       return;
     }
 
@@ -1400,7 +2008,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // shortest path).  If the new vertices represent shorter paths, we use them
 // and update the path cost.
 //
-      SPFNext (v, candidate);
+      SPFNext (spf, v, candidate);
 //
 // RFC2328 16.1. (3). 
 //
@@ -1428,7 +2036,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      spf.SetStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1438,74 +2046,88 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
       SPFVertexAddParent (v);
 //
+// Nothing changes a vertex once it is in the tree, so the routes to it can be
+// added later, along the tree (see SPFAddRoutes ()).  The links from each of
+// its parents are the ones SPFTreeAffected () looks for.
+//
+      spf.m_tree.push_back (v);
+      for (uint32_t i = 0; v->GetParent (i) != 0; i++)
+        {
+          spf.m_used.insert (std::make_pair (v->GetParent (i)->GetVertexId (), v->GetVertexId ()));
+        }
+//
+// RFC2328 16.1. (5). 
+//
+// Iterate the algorithm by returning to Step 2 until there are no more
+// candidate vertices.
+
+    }  // end for loop
+
+  spf.ClearStatus ();
+  SPFAddRoutes (spf);
+}
+
+void
+GlobalRouteManagerImpl::SPFAddRoutes (SPFCalculation& spf)
+{
+  NS_LOG_FUNCTION (this << spf.GetRootId ());
+  NS_ASSERT (spf.m_root);
+//
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
 // find all equal-cost paths. 
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// This is the method that actually adds the routes.  We are only adding
+// routes for the node at the root of the SPF tree.
 //
-// We're going to pop of a pointer to every vertex in the tree except the 
-// root in order of distance from the root.  For each of the vertices, we call
-// SPFIntraAddRouter ().  Down in SPFIntraAddRouter, we look at all of the 
-// point-to-point Global Router Link Records (the links to nodes adjacent to
-// the node represented by the vertex).  We add a route to the IP address 
-// specified by the m_linkData field of each of those link records.  This will
-// be the *local* IP address associated with the interface attached to the 
-// link.  We use the outbound interface and next hop information present in 
-// the vertex <v> which have possibly been inherited from the root.
+// We're going to walk every vertex in the tree except the root in the order
+// it joined the tree, which is in order of distance from the root.  For each
+// of the vertices, we call SPFIntraAddRouter ().  Down in SPFIntraAddRouter,
+// we look at all of the point-to-point Global Router Link Records (the links
+// to nodes adjacent to the node represented by the vertex).  We add a route
+// to the IP address specified by the m_linkData field of each of those link
+// records.  This will be the *local* IP address associated with the interface
+// attached to the link.  We use the outbound interface and next hop
+// information present in the vertex <v> which have possibly been inherited
+// from the root.
 //
 // To summarize, we're going to look at the node represented by <v> and loop
 // through its point-to-point links, adding a *host* route to the local IP
 // address (at the <v> side) for each of those links.
 //
+  for (uint32_t i = 0; i < spf.m_tree.size (); i++)
+    {
+      SPFVertex* v = spf.m_tree[i];
       if (v->GetVertexType () == SPFVertex::VertexRouter)
         {
-          SPFIntraAddRouter (v);
+          SPFIntraAddRouter (spf, v);
         }
       else if (v->GetVertexType () == SPFVertex::VertexNetwork)
         {
-          SPFIntraAddTransit (v);
+          SPFIntraAddTransit (spf, v);
         }
       else
         {
           NS_ASSERT_MSG (0, "illegal SPFVertex type");
         }
-//
-// RFC2328 16.1. (5). 
-//
-// Iterate the algorithm by returning to Step 2 until there are no more
-// candidate vertices.
-
-    }  // end for loop
+    }
 
 // Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
+  spf.m_root->ClearVertexProcessed ();
+  SPFProcessStubs (spf, spf.m_root);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
-      m_spfroot->ClearVertexProcessed ();
+      spf.m_root->ClearVertexProcessed ();
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      ProcessASExternals (spf, spf.m_root, extlsa);
     }
-
-//
-// We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
-//
-  delete m_spfroot;
-  m_spfroot = 0;
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::ProcessASExternals (SPFCalculation& spf, SPFVertex* v, GlobalRoutingLSA* extlsa)
 {
   NS_LOG_FUNCTION (this << v << extlsa);
   NS_LOG_LOGIC ("Processing external for destination " << 
@@ -1519,7 +2141,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
         {
           NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          SPFAddASExternal (spf, extlsa, v);
         }
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
@@ -1527,7 +2149,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
           NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          ProcessASExternals (spf, v->GetChild (i), extlsa);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1539,15 +2161,15 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (SPFCalculation& spf, GlobalRoutingLSA *extlsa, SPFVertex *v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (spf.m_root, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == spf.m_root->GetVertexId ())
     {
       NS_LOG_LOGIC ("External is on local host: " 
                     << v->GetVertexId () << "; returning");
@@ -1556,62 +2178,21 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = spf.m_root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2207,29 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          spf.AddRoute (SPFCalculation::Route::ExternalRoute, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1666,7 +2237,7 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (SPFCalculation& spf, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
@@ -1683,7 +2254,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
               NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
+              SPFIntraAddStub (spf, l, v);
               continue;
             }
         }
@@ -1692,7 +2263,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          SPFProcessStubs (v->GetChild (i));
+          SPFProcessStubs (spf, v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1700,11 +2271,11 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (SPFCalculation& spf, GlobalRoutingLinkRecord *l, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (spf.m_root, 
                  "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
@@ -1712,77 +2283,32 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == spf.m_root->GetVertexId ())
     {
       NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
       return;
     }
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// The root of the Shortest Path First tree is the router for which we are 
+// finding the routes.  The vertex corresponding to this router has a vertex
+// ID which is the router ID of that node.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = spf.m_root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,118 +2322,57 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          spf.AddRoute (SPFCalculation::Route::NetworkRoute, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix() on the root node of the
+// calculation, whose interfaces were looked up before it started.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
 int32_t
-GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
+GlobalRouteManagerImpl::FindOutgoingInterfaceId (const SPFCalculation& spf, Ipv4Address a, Ipv4Mask amask) const
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+// Look through the interfaces on the root node for one that has the IP
+// address we're looking for.  If we find one, return the corresponding
+// interface index, or -1 if not found (or if the node was not found).
 //
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = spf.GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1927,77 +2392,32 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (SPFCalculation& spf, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (spf.m_root, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// The root of the Shortest Path First tree is the router for which we are 
+// finding the routes.  The vertex corresponding to this router has a vertex
+// ID which is the router ID of that node.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = spf.m_root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2426,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,153 +2451,86 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              spf.AddRoute (SPFCalculation::Route::HostRoute, lr->GetLinkData (), Ipv4Mask::GetOnes (),
+                            nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (SPFCalculation& spf, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (spf.m_root, 
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// The root of the Shortest Path First tree is the router for which we are 
+// finding the routes.  The vertex corresponding to this router has a vertex
+// ID which is the router ID of that node.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = spf.m_root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          spf.AddRoute (SPFCalculation::Route::NetworkRoute, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
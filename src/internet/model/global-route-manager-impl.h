@@ -26,6 +26,8 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
+#include <utility>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,7 +39,9 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -652,6 +656,9 @@ public:
  * of the TransitNetwork link record.
  * @internal
  *
+ * The link data index is rebuilt on the first lookup following an Insert (),
+ * so that SPF runs do not have to walk every link record of the database.
+ *
  * @see GetLSA
  * @param addr The IP address associated with the LSA.  Typically the Router 
  * @returns A pointer to the Link State Advertisement for the router specified
@@ -661,19 +668,41 @@ public:
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
 /**
- * @brief Set all LSA flags to an initialized state, for SPF computation
+ * @brief Prepare the database for SPF computations
  * @internal
  *
  * This function walks the database and resets the status flags of all of the
- * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
- * prior to each SPF calculation to reset the state of the SPFVertex structures
- * that will reference the LSAs during the calculation.
+ * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED, and builds the
+ * link data index of GetLSAByLinkData ().  SPF calculations keep their own
+ * LSA status (see SPFCalculation) and do not change the database once this
+ * is done, so several of them can read it at the same time.
  *
  * @see GlobalRoutingLSA
  * @see SPFVertex
  */
   void Initialize ();
 
+/**
+ * @brief Links, as the IDs of the vertices at both of their ends.
+ */
+  typedef std::set<std::pair<Ipv4Address, Ipv4Address> > LinkSet_t;
+
+/**
+ * @brief Find the point-to-point links that differ from an older database.
+ * @internal
+ *
+ * Point-to-point link records are compared by the routers they join: the
+ * link between two routers has changed when the records of either router
+ * to the other one were added, removed, or got another link data or metric.
+ * Stub network records and external LSAs are not compared.
+ *
+ * @param older the database to compare with
+ * @param links filled with the links that changed, lowest router ID first
+ * @returns false if the databases differ in anything else, such as their
+ * routers, network LSAs or transit network records
+ */
+  bool GetChangedLinks (const GlobalRouteManagerLSDB& older, LinkSet_t& links) const;
+
   /**
    * @brief Look up the External Link State Advertisement associated with the given
    * index.
@@ -703,6 +732,13 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  mutable LSDBMap_t m_linkDataIndex; //!< TransitNetwork link data / Link State Advertisements, see GetLSAByLinkData
+  mutable bool m_linkDataIndexValid; //!< false when m_linkDataIndex must be rebuilt
+
+/**
+ * @brief Rebuild m_linkDataIndex if the database changed since it was built.
+ */
+  void UpdateLinkDataIndex () const;
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -717,6 +753,152 @@ private:
   GlobalRouteManagerLSDB& operator= (GlobalRouteManagerLSDB& lsdb);
 };
 
+/**
+ * @brief The SPF calculation rooted at one router: its state and the routes
+ * it found.
+ * @internal
+ *
+ * The LSDB is only read by SPF calculations.  The status of each LSA (see
+ * GlobalRoutingLSA::SPFStatus), the SPF tree and the routes found are kept
+ * here instead, so that the calculations rooted at different routers can run
+ * at the same time on several threads.  Nothing in here refers to the root
+ * node itself: the routes are written to its Ipv4GlobalRouting afterwards,
+ * by the main thread.
+ *
+ * The SPF tree may be kept after the routes are written, so that the next
+ * calculation can tell whether a link change affects it (see
+ * GlobalRouteManagerImpl::RecomputeRoutes ()).
+ */
+class SPFCalculation
+{
+public:
+/**
+ * @brief A route to write to the routing table of the root node.
+ */
+  struct Route
+  {
+/**
+ * @brief The Ipv4GlobalRouting method adding the route
+ */
+    enum Type {
+      HostRoute,      /**< AddHostRouteTo () */
+      NetworkRoute,   /**< AddNetworkRouteTo () */
+      ExternalRoute   /**< AddASExternalRouteTo () */
+    };
+    Type type; //!< how the route is added
+    Ipv4Address dest; //!< destination host or network
+    Ipv4Mask mask; //!< network mask, unused for host routes
+    Ipv4Address nextHop; //!< next hop
+    uint32_t outIf; //!< outgoing interface
+/**
+ * @brief Compare two routes
+ * @param route the other route
+ * @returns true if both are the same route
+ */
+    bool operator== (const Route& route) const;
+  };
+
+/**
+ * @brief Construct the calculation rooted at a router.
+ * @param rootId the router ID of the root
+ * @param nodeId the ID of the node owning the router
+ */
+  SPFCalculation (Ipv4Address rootId, uint32_t nodeId);
+
+/**
+ * @brief Destroy the calculation and its SPF tree.
+ */
+  ~SPFCalculation ();
+
+/**
+ * @brief Get the router ID of the root.
+ * @returns the router ID
+ */
+  Ipv4Address GetRootId (void) const;
+
+/**
+ * @brief Get the ID of the node owning the root router.
+ * @returns the node ID
+ */
+  uint32_t GetNodeId (void) const;
+
+/**
+ * @brief Remember the addresses of the interfaces of the root node, for
+ * GetInterfaceForPrefix ().
+ * @param ipv4 the Ipv4 of the root node, or 0 if the root node is unknown
+ */
+  void SetInterfaces (Ptr<Ipv4> ipv4);
+
+/**
+ * @brief The same as Ipv4::GetInterfaceForPrefix () on the root node, as it
+ * was when SetInterfaces () was called.
+ * @param a the IP address
+ * @param mask the mask
+ * @returns the first interface with an address in the prefix, or -1
+ */
+  int32_t GetInterfaceForPrefix (Ipv4Address a, Ipv4Mask mask) const;
+
+/**
+ * @brief Get the SPF status of an LSA in this calculation.
+ * @param lsa the LSA
+ * @returns the status, LSA_SPF_NOT_EXPLORED if it was never set
+ */
+  GlobalRoutingLSA::SPFStatus GetStatus (GlobalRoutingLSA* lsa) const;
+
+/**
+ * @brief Set the SPF status of an LSA in this calculation.
+ * @param lsa the LSA
+ * @param status the status
+ */
+  void SetStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+/**
+ * @brief Add a route for the root node.
+ * @param type how the route is added
+ * @param dest the destination host or network
+ * @param mask the network mask
+ * @param nextHop the next hop
+ * @param outIf the outgoing interface
+ */
+  void AddRoute (Route::Type type, Ipv4Address dest, Ipv4Mask mask,
+                 Ipv4Address nextHop, uint32_t outIf);
+
+/**
+ * @brief Forget the SPF status of the LSAs, once the tree is built.
+ */
+  void ClearStatus (void);
+
+/**
+ * @brief Delete the SPF tree, the LSA status and the links used.
+ */
+  void DeleteTree (void);
+
+  SPFVertex* m_root; //!< the root of the SPF tree, 0 if there is none
+  std::vector<SPFVertex*> m_tree; //!< the other vertices, in the order they joined the tree
+  GlobalRouteManagerLSDB::LinkSet_t m_used; //!< links from a parent to its child (in this order) in the tree
+  std::vector<Route> m_routes; //!< the routes found
+  bool m_checkStub; //!< whether CheckForStubNode () may cut the calculation short
+  bool m_calculated; //!< false if the last routes were found with the tree of an earlier calculation
+
+private:
+  typedef std::map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> StatusMap_t; //!< container of LSA status
+
+  Ipv4Address m_rootId; //!< the router ID of the root
+  uint32_t m_nodeId; //!< the node owning the root router
+  std::vector<std::pair<int32_t, Ipv4Address> > m_interfaces; //!< interfaces and their local addresses
+  StatusMap_t m_status; //!< status of the LSAs
+
+/**
+ * @brief SPFCalculation copy construction is disallowed.
+ */
+  SPFCalculation (SPFCalculation& spf);
+
+/**
+ * @brief SPFCalculation copy assignment operator is disallowed.
+ */
+  SPFCalculation& operator= (SPFCalculation& spf);
+};
+
 /**
  * @brief A global router implementation.
  *
@@ -755,9 +937,28 @@ public:
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
  * @internal
+ *
+ * The SPF calculations run on as many threads as the GlobalRoutingThreads
+ * global value says.  Their SPF trees are kept for RecomputeRoutes () if
+ * GlobalRoutingIncremental is true.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the forwarding tables
+ * that changed
+ * @internal
+ *
+ * Without the SPF trees of the last calculation, this is the same as
+ * DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes ().  With them, when the database only differs by
+ * point-to-point links, the SPF calculation is only run again for the
+ * routers whose tree could change: the routes of the others are found
+ * again along their old tree.  Only the forwarding tables whose routes
+ * changed are written.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @internal
@@ -771,6 +972,14 @@ public:
  */
   void DebugSPFCalculate (Ipv4Address root);
 
+/**
+ * @brief Debugging routine; count the SPF calculations run by the last
+ * InitializeRoutes () or RecomputeRoutes ()
+ * @internal
+ * @returns the number of routers whose SPF tree was calculated
+ */
+  uint32_t DebugGetNCalculated (void) const;
+
 private:
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
@@ -786,8 +995,80 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  typedef std::map<Ipv4Address, SPFCalculation*> SPFCalculationMap_t; //!< container of router IDs / SPF calculations
+
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  GlobalRouteManagerLSDB* m_prevLsdb; //!< the LSDB the kept SPF trees were calculated on, during RecomputeRoutes ()
+  GlobalRouteManagerLSDB::LinkSet_t m_changedLinks; //!< links changed since m_prevLsdb
+  SPFCalculationMap_t m_calculations; //!< the calculations whose SPF trees are kept, by root router ID
+  std::vector<SPFCalculation*> m_running; //!< the calculations RunCalculations () is running
+  uint32_t m_nThreads; //!< the number of threads RunCalculations () runs them on
+  bool m_keepTrees; //!< whether the calculations keep their SPF trees, GlobalRoutingIncremental
+  uint32_t m_nCalculated; //!< SPF calculations run by the last InitializeRoutes () or RecomputeRoutes ()
+
+  /**
+   * \brief Create the calculations rooted at the routers of this process.
+   *
+   * Calculations kept in m_calculations are moved to the list instead of
+   * new ones, when their root is still there.
+   *
+   * \param spfs filled with the calculations, in node order
+   */
+  void CreateCalculations (std::vector<SPFCalculation*>& spfs);
+
+  /**
+   * \brief Run SPF calculations, on GlobalRoutingThreads threads
+   *
+   * \param spfs the calculations
+   */
+  void RunCalculations (const std::vector<SPFCalculation*>& spfs);
+
+  /**
+   * \brief Run every m_nThreads-th calculation of m_running
+   *
+   * This is what each thread of RunCalculations () does.
+   *
+   * \param first the index of the first calculation to run
+   */
+  void RunEveryNth (uint32_t first);
+
+  /**
+   * \brief Run one SPF calculation
+   *
+   * During RecomputeRoutes (), the SPF tree the calculation kept is used
+   * again if the changed links do not affect it.
+   *
+   * \param spf the calculation
+   */
+  void Calculate (SPFCalculation& spf);
+
+  /**
+   * \brief Keep the calculations and their SPF trees for RecomputeRoutes ()
+   * if m_keepTrees is set, delete them otherwise
+   *
+   * \param spfs the calculations
+   */
+  void KeepCalculations (const std::vector<SPFCalculation*>& spfs);
+
+  /**
+   * \brief Delete the calculations kept in m_calculations
+   */
+  void DeleteCalculations (void);
+
+  /**
+   * \brief Write the routes found by a calculation to a node
+   *
+   * \param spf the calculation
+   * \param node the node owning the root router, or 0
+   */
+  void InstallRoutes (const SPFCalculation& spf, Ptr<Node> node);
+
+  /**
+   * \brief Delete all routes of a node
+   *
+   * \param node the node
+   */
+  void DeleteRoutes (Ptr<Node> node);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -796,18 +1077,50 @@ private:
    * can safely be added to the next-hop router and SPF does not need
    * to be run
    *
-   * \param root the root node
+   * \param spf the calculation rooted at the node
    * \returns true if the node is a stub
    */
-  bool CheckForStubNode (Ipv4Address root);
+  bool CheckForStubNode (SPFCalculation& spf);
 
   /**
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param spf the calculation, with no tree yet
+   */
+  void SPFCalculate (SPFCalculation& spf);
+
+  /**
+   * \brief Find the routes along the SPF tree of a calculation
+   *
+   * \param spf the calculation
+   */
+  void SPFAddRoutes (SPFCalculation& spf);
+
+  /**
+   * \brief Test if the changed links can change the SPF tree of a
+   * calculation
+   *
+   * A link removed or changed affects the tree if it changed the candidates
+   * when the tree was calculated.  A link added or changed affects it if
+   * it would have: it reaches a router not in the tree yet when the router
+   * at its other end joined it, by a path no longer than the one found
+   * until then.  That path is only looked for through point-to-point links,
+   * so a router reached through a network may be found affected although it
+   * is not.
+   *
+   * \param spf the calculation, with the tree calculated on m_prevLsdb
+   * \returns true if the SPF calculation must be run again
+   */
+  bool SPFTreeAffected (const SPFCalculation& spf) const;
+
+  /**
+   * \brief Find the node whose GlobalRouter has the given router ID
+   *
+   * \param routerId the router ID of the SPF root
+   * \returns the node, or 0 if no node has this router ID
    */
-  void SPFCalculate (Ipv4Address root);
+  Ptr<Node> FindRouterNode (Ipv4Address routerId) const;
 
   /**
    * \brief Process Stub nodes
@@ -816,17 +1129,19 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
+   * \param spf the calculation
    * \param v vertex to be processed
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFCalculation& spf, SPFVertex* v);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
    *
+   * \param spf the calculation
    * \param v vertex to be processed
    * \param extlsa external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFCalculation& spf, SPFVertex* v, GlobalRoutingLSA* extlsa);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -846,10 +1161,11 @@ private:
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
+   * \param spf the calculation
    * \param v the vertex
    * \param candidate the SPF candidate queue
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFNext (SPFCalculation& spf, SPFVertex* v, CandidateQueue& candidate);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
@@ -858,13 +1174,14 @@ private:
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
    * For now, this is greatly simplified from the quagga code
    *
+   * \param spf the calculation
    * \param v the parent
    * \param w the destination
    * \param l the link record
    * \param distance the target distance
    * \returns 1 on success
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
+  int SPFNexthopCalculation (const SPFCalculation& spf, SPFVertex* v, SPFVertex* w,
                              GlobalRoutingLinkRecord* l, uint32_t distance);
 
   /**
@@ -924,48 +1241,53 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
+   * \param spf the calculation
    * \param v the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (SPFCalculation& spf, SPFVertex* v);
 
   /**
    * \brief Add a transit to the routing tables
    *
+   * \param spf the calculation
    * \param v the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (SPFCalculation& spf, SPFVertex* v);
 
   /**
    * \brief Add a stub to the routing tables
    *
+   * \param spf the calculation
    * \param l the global routing link record
    * \param v the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (SPFCalculation& spf, GlobalRoutingLinkRecord *l, SPFVertex* v);
 
   /**
    * \brief Add an external route to the routing tables
    *
+   * \param spf the calculation
    * \param extlsa the external LSA
    * \param v the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (SPFCalculation& spf, GlobalRoutingLSA *extlsa, SPFVertex *v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is a wrapper around GetInterfaceForPrefix() on the root node of
+   * the calculation.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
+   * \param spf the calculation
    * \param a the target IP address
    * \param amask the target subnet mask
    * \return the outgoing interface number
    */
-  int32_t FindOutgoingInterfaceId (Ipv4Address a, 
-                                   Ipv4Mask amask = Ipv4Mask ("255.255.255.255"));
+  int32_t FindOutgoingInterfaceId (const SPFCalculation& spf, Ipv4Address a, 
+                                   Ipv4Mask amask = Ipv4Mask ("255.255.255.255")) const;
 };
 
 } // namespace ns3
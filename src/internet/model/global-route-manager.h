@@ -67,6 +67,13 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables whose routes changed
+ * @internal
+ */
+  static void RecomputeRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -27,14 +27,12 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
-#include "udp-header.h"
-#include "tcp-header.h"
 #include "ns3/node.h"
 #include "ns3/ecmp-tag.h"
-//#include "ns3/hash.h"
-//#include <functional>
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
@@ -60,6 +58,17 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue(false),
                    MakeBooleanAccessor(&Ipv4GlobalRouting::m_flowEcmpRouting),
                    MakeBooleanChecker())
+    .AddAttribute ("EcmpHashSeed",
+                   "Seed mixed into the flow hash of FlowEcmpRouting; nodes with distinct seeds split flows independently. 0 uses the node id",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_ecmpHashSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EcmpHashFunction",
+                   "Hash function used by FlowEcmpRouting to select a route among ECMP routes",
+                   EnumValue (ECMP_HASH_MURMUR3),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::SetEcmpHashFunction),
+                   MakeEnumChecker (ECMP_HASH_MURMUR3, "Murmur3",
+                                    ECMP_HASH_FNV1A, "Fnv1a"))
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -72,14 +81,13 @@ Ipv4GlobalRouting::GetTypeId (void)
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
     m_flowEcmpRouting(false),
-    m_respondToInterfaceEvents (false)
+    m_ecmpHashSeed (0),
+    m_respondToInterfaceEvents (false),
+    m_fibDirty (true)
 {
   NS_LOG_FUNCTION (this);
 
   m_rand = CreateObject<UniformRandomVariable> ();
-  //Hasher hasher = Hasher(Create<Hash::Function::Fnv1a> ());
-  Hasher hasher = Hasher();
-  //uint32_t hash = Hasher.GetHash32 (data);
 }
 
 Ipv4GlobalRouting::~Ipv4GlobalRouting ()
@@ -96,6 +104,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_fibDirty = true;
 }
 
 void 
@@ -106,6 +115,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_fibDirty = true;
 }
 
 void 
@@ -121,6 +131,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_fibDirty = true;
 }
 
 void 
@@ -134,6 +145,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_fibDirty = true;
 }
 
 void 
@@ -149,86 +161,66 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_fibDirty = true;
+}
+
+void
+Ipv4GlobalRouting::SetEcmpHashFunction (EcmpHashFunction hashFunction)
+{
+  NS_LOG_FUNCTION (this << hashFunction);
+  switch (hashFunction)
+    {
+    case ECMP_HASH_FNV1A:
+      hasher = Hasher (Create<Hash::Function::Fnv1a> ());
+      break;
+    default:
+      hasher = Hasher (Create<Hash::Function::Murmur3> ());
+      break;
+    }
 }
 
 uint64_t
 Ipv4GlobalRouting::GetTupleValue(const Ipv4Header &header, Ptr<const Packet> ipPayload)
 {
   NS_LOG_FUNCTION(header);
-  Ptr<Node> node = m_ipv4->GetObject<Node>();
-  uint32_t node_id = node->GetId();
-
-  uint64_t fiveTuple = header.GetSource().Get()
-                     + header.GetDestination().Get()
-                     + header.GetProtocol();
-
-  switch (header.GetProtocol())
-    {
-  case UDP_PROT_NUMBER:
-    {
-      UdpHeader udpHeader;
-      ipPayload->PeekHeader(udpHeader);
-      NS_LOG_DEBUG ("FiveTuple() -> UDP: (src, dst, protNb, sPort, dPort) - "
-          << header.GetSource() << " , "
-          << header.GetDestination() << " , "
-          << (int)header.GetProtocol() << " , "
-          << (int)udpHeader.GetSourcePort () << " , "
-          << (int)udpHeader.GetDestinationPort ());
-      fiveTuple += udpHeader.GetSourcePort();
-      fiveTuple += udpHeader.GetDestinationPort();
-      break;
-    }
-  case TCP_PROT_NUMBER:
-    {
-      TcpHeader tcpHeader;
-      ipPayload->PeekHeader(tcpHeader);
-      NS_LOG_DEBUG ("FiveTuple() -> TCP: (src, dst, protNb, sPort, dPort) -  "
-          << header.GetSource() << " , "
-          << header.GetDestination() << " , "
-          << (int)header.GetProtocol() << " , "
-          << (int)tcpHeader.GetSourcePort () << " , "
-          << (int)tcpHeader.GetDestinationPort ());
-      fiveTuple += (uint32_t)tcpHeader.GetSourcePort();
-      fiveTuple += (uint32_t)tcpHeader.GetDestinationPort();
-      break;
+  uint8_t protocol = header.GetProtocol();
+  if (protocol != UDP_PROT_NUMBER && protocol != TCP_PROT_NUMBER)
+    {
+      NS_FATAL_ERROR("Udp or Tcp header not found " << (int) protocol);
     }
-  default:
+  uint32_t seed = m_ecmpHashSeed;
+  if (seed == 0)
     {
-      NS_FATAL_ERROR("Udp or Tcp header not found " << (int) header.GetProtocol());
-      break;
+      seed = m_ipv4->GetObject<Node>()->GetId();
     }
+
+  // Key layout: seed(4) src(4) dst(4) srcPort(2) dstPort(2) protocol(1), network byte order.
+  // The seed comes first so that it is mixed into every following byte.
+  // TCP and UDP headers both start with the source and destination ports.
+  uint8_t key[17];
+  uint32_t src = header.GetSource().Get();
+  uint32_t dst = header.GetDestination().Get();
+  key[0] = seed >> 24; key[1] = seed >> 16; key[2] = seed >> 8; key[3] = seed;
+  key[4] = src >> 24; key[5] = src >> 16; key[6] = src >> 8; key[7] = src;
+  key[8] = dst >> 24; key[9] = dst >> 16; key[10] = dst >> 8; key[11] = dst;
+  if (ipPayload == 0 || ipPayload->CopyData(key + 12, 4) != 4)
+    {
+      // RouteOutput() may be asked for a route before the segment exists
+      key[12] = key[13] = key[14] = key[15] = 0;
     }
-  //NS_LOG_DEBUG("FiveTuple() -> HashedValue: " <<  fiveTuple);
-  hasher.clear();
+  key[16] = protocol;
+  NS_LOG_DEBUG ("FiveTuple() -> (src, dst, protNb, sPort, dPort) - "
+      << header.GetSource() << " , "
+      << header.GetDestination() << " , "
+      << (int)protocol << " , "
+      << (key[12] << 8 | key[13]) << " , "
+      << (key[14] << 8 | key[15]) << " seed: " << seed);
 
-  TcpHeader tcpHeader;
-  ipPayload->PeekHeader(tcpHeader);
-
-//  char *buffer_to_hash = new char[12];
-//  uint32_t src_ip_to_hash = header.GetSource().Get();
-//  uint32_t dst_ip_to_hash = header.GetDestination().Get();
-//  uint16_t src_port_to_hash = tcpHeader.GetSourcePort();
-//  uint16_t dst_port_to_hash = tcpHeader.GetDestinationPort();
-//  memcpy(buffer_to_hash, &src_ip_to_hash,sizeof(uint32_t));
-//  memcpy(buffer_to_hash + sizeof(uint32_t), &dst_ip_to_hash,sizeof(uint32_t));
-//  memcpy(buffer_to_hash + sizeof(uint32_t) + sizeof(uint32_t), &src_port_to_hash,sizeof(uint16_t));
-//  memcpy(buffer_to_hash + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint16_t), &dst_port_to_hash,sizeof(uint16_t));
-//  std::hash<std::string> str_hash;
-
-  //uint64_t hash = hasher.GetHash64 ((const char *)buffer_to_hash, 12);
-//  delete buffer_to_hash;
-
-  ostringstream oss;
-  //oss << tcpHeader.GetDestinationPort() << tcpHeader.GetSourcePort() << header.GetSource() << header.GetDestination() << header.GetTtl();
-  oss << tcpHeader.GetDestinationPort() << tcpHeader.GetSourcePort() << header.GetSource() << header.GetDestination() << node_id;
-//  oss << fiveTuple;
-  std::string data = oss.str();
-  uint32_t hash = hasher.GetHash64(data);
-//  NS_LOG_INFO("Hash fro Hasher is: " << hash << " fiveTuple:" << fiveTuple << " Data: " << data);
-  oss.str("");
-  return hash;
-//  return fiveTuple;
-//  return tcpHeader.GetSourcePort();
+  hasher.clear();
+  uint32_t hash = hasher.GetHash32((const char *) key, sizeof (key));
+  // Routes are selected by hash % nRoutes; fold the high bits in since the low bits
+  // of Fnv1a only depend on the low bits of each key byte.
+  return hash ^ (hash >> 16);
 }
 
 //Ptr<Ipv4Route>
@@ -239,149 +231,188 @@ Ipv4GlobalRouting::LookupGlobal(const Ipv4Header &header, Ptr<const Packet> ipPa
 
   NS_LOG_FUNCTION (this << header.GetDestination() << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << header.GetDestination());
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  if (m_fibDirty)
+    {
+      BuildFib ();
+    }
+  Ipv4Address dest = header.GetDestination ();
+  // ECMP group of the destination; when oif is given, candidates holds its routes on oif
+  FibGroup *group = 0;
+  std::vector<FibRoute *> candidates;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  FibHostsI h = m_fibHosts.find (dest);
+  if (h != m_fibHosts.end () && SelectFibRoutes (h->second, oif, candidates))
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (header.GetDestination()))
+      NS_LOG_LOGIC ("Found global host route");
+      group = &h->second;
+    }
+  if (group == 0) // if no host route is found
+    {
+      // Walk the trie along the destination bits, then take the longest prefix with usable routes
+      int32_t matches[33];
+      uint32_t nMatches = 0;
+      uint32_t addr = dest.Get ();
+      uint32_t node = 0;
+      for (uint32_t depth = 0;; depth++)
         {
-          if (oif != 0)
+          if (m_fibNodes[node].group >= 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              matches[nMatches++] = m_fibNodes[node].group;
+            }
+          if (depth == 32 || (node = m_fibNodes[node].child[(addr >> (31 - depth)) & 1]) == 0)
+            {
+              break;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
-    }
-  if (allRoutes.size () == 0) // if no host route is found
-    {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      while (group == 0 && nMatches > 0)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (header.GetDestination(), entry))
+          FibGroup &g = m_fibGroups[matches[--nMatches]];
+          if (SelectFibRoutes (g, oif, candidates))
             {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              NS_LOG_LOGIC ("Found global network route, " << g.size () << " route(s)");
+              group = &g;
             }
         }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (group == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      for (uint32_t k = 0; k < m_fibExternal.size (); k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (header.GetDestination(), entry))
+          Ipv4RoutingTableEntry *entry = m_fibExternal[k][0].entry;
+          if (entry->GetDestNetworkMask ().IsMatch (dest, entry->GetDestNetwork ())
+              && SelectFibRoutes (m_fibExternal[k], oif, candidates))
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
+              NS_LOG_LOGIC ("Found external route" << entry);
+              group = &m_fibExternal[k];
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (group == 0)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          NS_FATAL_ERROR("At the moment this should not be run");
-          selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
-        }
-      else if (m_flowEcmpRouting && allRoutes.size() > 1)
+      return 0;
+    }
+
+  uint32_t nRoutes = (oif == 0 ? group->size () : candidates.size ());
+  // pick up one of the routes uniformly at random if random
+  // ECMP routing is enabled, or always select the first route
+  // consistently if random ECMP routing is disabled
+  uint32_t selectIndex;
+  if (m_randomEcmpRouting)
+    {
+      NS_FATAL_ERROR("At the moment this should not be run");
+      selectIndex = m_rand->GetInteger(0, nRoutes - 1);
+    }
+  else if (m_flowEcmpRouting && nRoutes > 1)
+    {
+      selectIndex = (GetTupleValue(header, ipPayload) % nRoutes);
+
+      EcmpTag ecmp;
+      bool found = ipPayload != 0 && ipPayload->PeekPacketTag(ecmp);
+      Ipv4RoutingTableEntry* route = (oif == 0 ? (*group)[selectIndex] : *candidates[selectIndex]).entry;
+      Ptr<NetDevice> NIC = m_ipv4->GetNetDevice(route->GetInterface());
+      if (found && Names::FindName (NIC->GetNode ()).find ("tor") != std::string::npos)
         {
-          selectIndex = (GetTupleValue(header, ipPayload) % (allRoutes.size()));
-         
-          TcpHeader tcpHeader;
-          EcmpTag ecmp;
-          ipPayload->PeekHeader(tcpHeader);
-          bool found = ipPayload->PeekPacketTag(ecmp);
-          Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex);
-          Ptr<NetDevice> NIC = m_ipv4->GetNetDevice(route->GetInterface());
-          std::string tmp = Names::FindName (NIC->GetNode ());
-          if (found && tmp.find ("tor") != std::string::npos)
-            {
-              /*
-              cout<< "Name("<<Names::FindName (NIC->GetNode ()) << ")  "
-                  << "Paths(" << allRoutes.size()<< ")  "
-                  << "OldIdx("<< selectIndex << ") "
-                  << "NewIdx("<< (int)ecmp.GetEcmp() % allRoutes.size() << ")  "
-                  << "NewGW(" << allRoutes.at(ecmp.GetEcmp() % allRoutes.size())->GetGateway()<< ")   \t"
-                  << header.GetSource() << ":"<< tcpHeader.GetSourcePort()
-                  << "  ->  "
-                  << header.GetDestination()<< ":"<< tcpHeader.GetDestinationPort() << "\t"
-                  << endl;
-              */
-              selectIndex = (int)ecmp.GetEcmp() % allRoutes.size();
-            }
-//          if (NIC->GetNode()->GetId() > 4 && NIC->GetNode()->GetId() <= 11)
-//            {
-//              for (uint32_t i = 0; i < allRoutes.size(); i++)
-//                {
-//                  Ipv4RoutingTableEntry* route = allRoutes.at(i);
-//                  NS_LOG_UNCOND(route->GetGateway ());
-//                }
-//              NS_LOG_UNCOND("");
-//            }
-//          if (NIC->GetNode()->GetId() == 4/* && NIC->GetNode()->GetId() <= 11*/)
-//            NS_LOG_UNCOND("Node("<< NIC->GetNode()->GetId() << ") LookupGlobal() -> selectIndex for ECMP is " << selectIndex << " AllRoute: " << allRoutes.size() <<" FiveTuple:" << GetTupleValue(header, ipPayload));
-//          if (header.GetDestination() == "10.10.11.2")
-//            cout << header.GetSource() << ":" << tcpHeader.GetSourcePort() << " -> " << allRoutes.at(selectIndex)->GetGateway() << " -> " << header.GetDestination() << " LookupGlobal() -> selectIndex for ECMP is " << selectIndex << " AllRoute: " << allRoutes.size() <<" FiveTuple:" << GetTupleValue(header, ipPayload) << endl;
+          selectIndex = (int)ecmp.GetEcmp() % nRoutes;
         }
-      else
+    }
+  else
+    {
+      selectIndex = 0;
+    }
+  return GetFibRoute (oif == 0 ? (*group)[selectIndex] : *candidates[selectIndex]);
+}
+
+bool
+Ipv4GlobalRouting::SelectFibRoutes (FibGroup &group, Ptr<NetDevice> oif, std::vector<FibRoute *> &candidates)
+{
+  if (oif == 0)
+    {
+      return !group.empty ();
+    }
+  candidates.clear ();
+  for (uint32_t i = 0; i < group.size (); i++)
+    {
+      if (oif != m_ipv4->GetNetDevice (group[i].entry->GetInterface ()))
         {
-          selectIndex = 0;
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          continue;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+      candidates.push_back (&group[i]);
+    }
+  return !candidates.empty ();
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::GetFibRoute (FibRoute &fibRoute)
+{
+  if (fibRoute.route == 0)
+    {
+      Ipv4RoutingTableEntry* route = fibRoute.entry;
       // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
+      Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
       /// \todo handle multi-address case
       rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
       rtentry->SetGateway (route->GetGateway ());
       uint32_t interfaceIdx = route->GetInterface ();
       rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
+      fibRoute.route = rtentry;
     }
-  else 
+  return fibRoute.route;
+}
+
+void
+Ipv4GlobalRouting::BuildFib (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fibHosts.clear ();
+  m_fibNodes.clear ();
+  m_fibGroups.clear ();
+  m_fibExternal.clear ();
+  FibNode root;
+  root.child[0] = root.child[1] = 0;
+  root.group = -1;
+  m_fibNodes.push_back (root);
+
+  FibRoute fibRoute;
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
     {
-      return 0;
+      NS_ASSERT ((*i)->IsHost ());
+      fibRoute.entry = *i;
+      m_fibHosts[(*i)->GetDest ()].push_back (fibRoute);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      Ipv4Mask mask = (*j)->GetDestNetworkMask ();
+      uint32_t addr = (*j)->GetDestNetwork ().CombineMask (mask).Get ();
+      uint32_t node = 0;
+      for (uint16_t depth = 0; depth < mask.GetPrefixLength (); depth++)
+        {
+          uint32_t bit = (addr >> (31 - depth)) & 1;
+          if (m_fibNodes[node].child[bit] == 0)
+            {
+              FibNode child = root;
+              m_fibNodes[node].child[bit] = m_fibNodes.size ();
+              m_fibNodes.push_back (child);
+            }
+          node = m_fibNodes[node].child[bit];
+        }
+      if (m_fibNodes[node].group < 0)
+        {
+          m_fibNodes[node].group = m_fibGroups.size ();
+          m_fibGroups.push_back (FibGroup ());
+        }
+      fibRoute.entry = *j;
+      m_fibGroups[m_fibNodes[node].group].push_back (fibRoute);
+    }
+  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+    {
+      fibRoute.entry = *k;
+      m_fibExternal.push_back (FibGroup (1, fibRoute));
     }
+  m_fibDirty = false;
+  NS_LOG_LOGIC ("FIB built: " << m_fibHosts.size () << " hosts, " << m_fibGroups.size () << " prefixes, " << m_fibNodes.size () << " trie nodes");
 }
 
 uint32_t 
@@ -448,6 +479,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_fibDirty = true;
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -531,6 +563,11 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_fibHosts.clear ();
+  m_fibNodes.clear ();
+  m_fibGroups.clear ();
+  m_fibExternal.clear ();
+  m_fibDirty = true;
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -700,11 +737,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_fibDirty = true; // Source addresses of the FIB routes may change
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -712,11 +748,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_fibDirty = true;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -724,11 +759,10 @@ void
 Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  m_fibDirty = true;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -736,11 +770,10 @@ void
 Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  m_fibDirty = true;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
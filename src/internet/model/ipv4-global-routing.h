@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/hash.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -74,6 +77,14 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// Hash functions available to FlowEcmpRouting
+  enum EcmpHashFunction
+  {
+    ECMP_HASH_MURMUR3,
+    ECMP_HASH_FNV1A
+  };
+
   /**
    * \brief Construct an empty Ipv4GlobalRouting routing protocol,
    *
@@ -226,8 +237,24 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Hash the 5-tuple of a packet to select one of its ECMP routes
+   *
+   * The addresses, protocol, ports and the hash seed are packed into a fixed
+   * width binary key, so no memory is allocated per forwarded packet.
+   *
+   * \param header the IPv4 header of the packet
+   * \param ipPayload the packet without its IPv4 header, may be 0
+   * \return the flow hash
+   */
   uint64_t GetTupleValue(const Ipv4Header &header, Ptr<const Packet> ipPayload);
 
+  /**
+   * \brief Select the hash function used by FlowEcmpRouting
+   * \param hashFunction the hash function
+   */
+  void SetEcmpHashFunction (EcmpHashFunction hashFunction);
+
 protected:
   void DoDispose (void);
 
@@ -236,6 +263,8 @@ private:
   bool m_randomEcmpRouting;
   /// Set to true if flows are randomly routed among ECMP; set to false for using only one route consistently
   bool m_flowEcmpRouting;
+  /// Seed mixed into the flow hash of FlowEcmpRouting, 0 uses the node id
+  uint32_t m_ecmpHashSeed;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
@@ -262,14 +291,60 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// Route of the FIB, its Ipv4Route is created on first use and then handed out again
+  struct FibRoute
+  {
+    Ipv4RoutingTableEntry *entry;
+    Ptr<Ipv4Route> route;
+  };
+  /// ECMP group of a prefix, routes in routing table order
+  typedef std::vector<FibRoute> FibGroup;
+  /// Node of the binary trie of network routes; child 0 means no child, group -1 means no route
+  struct FibNode
+  {
+    uint32_t child[2];
+    int32_t group;
+  };
+  /// container of FibGroup (routes to hosts) indexed by host address
+  typedef sgi::hash_map<Ipv4Address, FibGroup, Ipv4AddressHash> FibHosts;
+  /// iterator of container of FibGroup (routes to hosts)
+  typedef sgi::hash_map<Ipv4Address, FibGroup, Ipv4AddressHash>::iterator FibHostsI;
+
   //Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
   Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipPayload, Ptr<NetDevice> oif = 0);
-  Hasher hasher;
+  /**
+   * \brief Compile the routing table lists into the FIB used by LookupGlobal
+   *
+   * Host routes are hashed by destination, network routes are stored in a
+   * binary trie for longest prefix match and routes sharing a prefix form
+   * its ECMP group. Called on the first lookup after the routes changed.
+   */
+  void BuildFib (void);
+  /**
+   * \param group the ECMP group
+   * \param oif the requested output device, 0 for any
+   * \param candidates filled with the routes of group on oif, when oif is given
+   * \return true if group has a route usable on oif
+   */
+  bool SelectFibRoutes (FibGroup &group, Ptr<NetDevice> oif, std::vector<FibRoute *> &candidates);
+  /**
+   * \param fibRoute the route of the FIB
+   * \return the Ipv4Route of fibRoute
+   */
+  Ptr<Ipv4Route> GetFibRoute (FibRoute &fibRoute);
+
+  Hasher hasher;                       //!< Hash function of FlowEcmpRouting
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+
+  bool m_fibDirty;                     //!< Routes changed since the FIB was built
+  FibHosts m_fibHosts;                 //!< FIB host routes
+  std::vector<FibNode> m_fibNodes;     //!< FIB network routes trie, m_fibNodes[0] is 0.0.0.0/0
+  std::vector<FibGroup> m_fibGroups;   //!< FIB network routes ECMP groups
+  std::vector<FibGroup> m_fibExternal; //!< FIB external routes, one group per route in table order
 };
 
 } // Namespace ns3
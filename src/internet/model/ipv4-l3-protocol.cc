@@ -133,10 +133,34 @@ Ipv4L3Protocol::SetNode (Ptr<Node> node)
 {
   NS_LOG_FUNCTION (this << node);
   m_node = node;
+  m_node->RegisterEcnMarker (MakeCallback (&Ipv4L3Protocol::MarkEcn, this), Ipv4L3Protocol::PROT_NUMBER);
   // Add a LoopbackNetDevice if needed, and an Ipv4Interface on top of it
   SetupLoopback ();
 }
 
+bool
+Ipv4L3Protocol::MarkEcn (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  Ipv4Header ipHeader;
+  p->PeekHeader (ipHeader);
+  if (ipHeader.GetEcn () == Ipv4Header::ECN_NotECT)
+    {
+      return false;
+    }
+  if (ipHeader.GetEcn () != Ipv4Header::ECN_CE)
+    {
+      p->RemoveHeader (ipHeader);
+      ipHeader.SetEcn (Ipv4Header::ECN_CE);
+      if (Node::ChecksumEnabled ())
+        {
+          ipHeader.EnableChecksum ();
+        }
+      p->AddHeader (ipHeader);
+    }
+  return true;
+}
+
 Ptr<Socket> 
 Ipv4L3Protocol::CreateRawSocket (void)
 {
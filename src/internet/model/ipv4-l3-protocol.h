@@ -167,6 +167,16 @@ public:
   void Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from,
                  const Address &to, NetDevice::PacketType packetType);
 
+  /**
+   * \brief Set the ECN field of an ECN capable packet to CE
+   *
+   * Registered with the node for queues that mark rather than drop,
+   * see Node::MarkEcn ()
+   * \param p the packet, starting with its IPv4 header
+   * \returns false if the packet is not ECN capable
+   */
+  bool MarkEcn (Ptr<Packet> p);
+
   /**
    * \param packet packet to send
    * \param source source address of packet
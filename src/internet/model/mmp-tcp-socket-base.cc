@@ -117,7 +117,7 @@ MMpTcpSocketBase::DoForwardUp(Ptr<Packet> p, Ipv4Header header, uint16_t port, P
   p->RemoveHeader(mptcpHeader);
 
   // DCTCP
-  ExtractPacketTags(p);
+  ExtractEcn(p, header, mptcpHeader);
 
   m_localPort = mptcpHeader.GetDestinationPort();
   //NS_ASSERT(m_localPort == m_endPoint->GetLocalPort());
@@ -273,7 +273,9 @@ MMpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
       //cout <<Simulator::Now().GetSeconds() << " [" << m_node->GetId() << "](" << sFlow->routeId << ") "<< TcpStateName[sFlow->state] << " -> ESTABLISHED" << endl;
       sFlow->state = ESTABLISHED;
       sFlow->retxEvent.Cancel();
-      if ((m_largePlotting && (flowType.compare("Large") == 0)) || (m_shortPlotting && (flowType.compare("Short") == 0)))
+      sFlow->traceSink = m_traceSink;
+      sFlow->traceFlowId = flowId;
+      if (IsPlotting() || m_traceSink != 0)
         sFlow->StartTracing("cWindow");
       sFlow->rtt->Init(mptcpHeader.GetAckNumber());
       sFlow->initialSequnceNumber = (mptcpHeader.GetAckNumber().GetValue());
@@ -286,6 +288,7 @@ MMpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
       Time estimate;
       estimate = Seconds(1.5);
       sFlow->rtt->SetCurrentEstimate(estimate);
+      UpdateWindowAggregates(sFlowIdx);
 
       SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
 
@@ -317,6 +320,7 @@ MMpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
         {
           m_subflowInitiation = false;
           m_packetScatter = false;
+          RebuildWindowAggregates();
           InitiateMultipleSubflows();
         }
 
@@ -353,6 +357,7 @@ MMpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
           NS_LOG_UNCOND("["<< m_node->GetId() << "] -> Switched to MPTCP! CWND: " << subflows[0]->cwnd.Get());
           cout << Simulator::Now().GetSeconds() << " [" << m_node->GetId() << "](" << (int) sFlowIdx << ") -> Switched to MPTCP! CWND: " << subflows[0]->cwnd.Get()  << " TotalByteSent: "<< m_totalBytesSent << endl;
           m_packetScatter = false;
+          RebuildWindowAggregates();
         }
 
       if (subflows.size() > 1)
@@ -381,16 +386,17 @@ MMpTcpSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
 
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t ack = (mptcpHeader.GetAckNumber()).GetValue();
-  sFlow->g_AckSeqNumber = ack;
+  if (m_lossRecovery == Rack_Tlp)
+    RackUpdate(sFlowIdx, mptcpHeader);
 
   if (m_DCTCP)
     {
-      CalculateDCTCPAlpha (sFlowIdx, ack);
+      GetDctcpOps ()->UpdateAlpha (this, sFlowIdx, ack);
     }
 
 #ifdef PLOT
   uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_ACK, tmp);
 #endif
 
   //PS: InitiateSubflows first then switch to MPTCP
@@ -441,39 +447,21 @@ MMpTcpSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
   else if (ack <= sFlow->highestAck + 1)
     {
       NS_LOG_LOGIC ("This acknowlegment" << mptcpHeader.GetAckNumber () << "do not ack the latest data in subflow level");
-      list<DSNMapping *>::iterator current = sFlow->mapDSN.begin();
-      list<DSNMapping *>::iterator next = sFlow->mapDSN.begin();
-      while (current != sFlow->mapDSN.end())
-        {
-          ++next;
-          DSNMapping *ptrDSN = *current;
-          // All segments before ackSeqNum should be removed from the mapDSN list.
-          if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
-            { // Optional task ...
-              //next = sFlow->mapDSN.erase(current);
-              //delete ptrDSN;
-            }
-          // There is a sent segment with subflowSN equal to ack but the ack is smaller than already receveid acked!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack < sFlow->highestAck + 1))
-            { // Case 1: Old ACK, ignored.
-              NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
-              NS_ASSERT(3!=3);
-              break;
-            }
-          // There is a sent segment with requested SequenceNumber and ack is for first unacked byte!!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack == sFlow->highestAck + 1))
-            { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
-              if (ack < sFlow->TxSeqNumber)
-                {
-                  //NS_LOG_ERROR(Simulator::Now().GetSeconds()<< " [" << m_node->GetId()<< "] Duplicated ack received for SeqgNb: " << ack << " DUPACKs: " << sFlow->m_dupAckCount + 1);
-                  DupAck(sFlowIdx, ptrDSN);
-                  break;
-                }
-              // otherwise, the ACK is precisely equal to the nextTxSequence
-              NS_ASSERT(ack <= sFlow->TxSeqNumber);
-              break;
+      // Only the segment starting at ack matters, all segments before it are already acked.
+      DSNMapping *ptrDSN = sFlow->mapDSN.Find(ack);
+      if (ptrDSN != 0 && ack < sFlow->highestAck + 1)
+        { // Case 1: Old ACK, ignored.
+          NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
+          NS_ASSERT(3 != 3);
+        }
+      else if (ptrDSN != 0 && ack == sFlow->highestAck + 1)
+        { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
+          if (ack < sFlow->TxSeqNumber)
+            {
+              DupAck(sFlowIdx, ptrDSN);
             }
-          current = next;
+          // otherwise, the ACK is precisely equal to the nextTxSequence
+          NS_ASSERT(ack <= sFlow->TxSeqNumber);
         }
     }
   else if (ack > sFlow->highestAck + 1)
@@ -482,6 +470,8 @@ MMpTcpSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
       NewAckNewReno(sFlowIdx, mptcpHeader, 0);
       sFlow->m_dupAckCount = 0;
     }
+  if (m_lossRecovery == Rack_Tlp)
+    RackDetectLoss(sFlowIdx);
   // If there is any data piggybacked, store it into m_rxBuffer
   if (packet->GetSize() > 0)
     {
@@ -527,7 +517,7 @@ bool
 MMpTcpSocketBase::IsPktScattered(const TcpHeader &mptcpHeader)
 {
   NS_LOG_FUNCTION(this << mptcpHeader);
-  vector<TcpOptions*> mp_options = mptcpHeader.GetOptions();
+  const TcpOptionList &mp_options = mptcpHeader.GetOptions ();
   TcpOptions *opt;
   for (uint32_t j = 0; j < mp_options.size(); j++)
     {
@@ -546,30 +536,13 @@ MMpTcpSocketBase::IsPktScattered(const TcpHeader &mptcpHeader)
   return false;
 }
 
-uint8_t
-MMpTcpSocketBase::getSubflowToUse()
+uint32_t
+MMpTcpSocketBase::UsableWindow(uint8_t sFlowIdx)
 {
-  //NS_LOG_FUNCTION(this);
-  uint8_t nextSubflow = 0;
-  // PS: Send to subflow 0 when ps mode is active
-  if (m_packetScatter)
-    {
-      NS_ASSERT(subflows.size() == 1);
-      return nextSubflow; // return to subflow 0
-    }
-  else
-    {
-      nextSubflow = ((lastUsedsFlowIdx + 1) % subflows.size());
-    }
-
   // No data should be sent on subflow 0 if packetScatter is not active
-  if (nextSubflow == 0 && !m_packetScatter && subflows.size() > 1)
-    {
-      nextSubflow++;
-      return nextSubflow;
-    }
-  else
-    return nextSubflow;
+  if (sFlowIdx == 0 && !m_packetScatter)
+    return 0;
+  return MpTcpSocketBase::UsableWindow(sFlowIdx);
 }
 
 /**
@@ -595,19 +568,19 @@ MMpTcpSocketBase::SendPendingData(uint8_t sFlowIdx)
     {
       NS_LOG_UNCOND("["<< m_node->GetId()<< "] SendPendingData() -> !PacketScatter & MasterSubflow & SubflowBuffer = 0 -> State: " << TcpStateName[subflows[0]->state] << " -> Cancel reTxEvent!");
       cout << "["<< m_node->GetId()<< "]{" <<flowId << "} SendPendingData() -> !PacketScatter & MapDSN(0) -> State: " << TcpStateName[subflows[0]->state] << " -> Cancel reTxEvent!" << endl;
-      subflows[0]->retxEvent.Cancel();
+      subflows[0]->CancelRetx();
       return false;
     }
 
   // DCTCP: If we have received ECN echo in some of the received ACKs, halve the congestion window
   // TODO: Should we reduce the cwnd in the initial phase of MMPTCP??
   if (m_DCTCP && sFlowIdx < maxSubflows && m_eceBit > 0 && subflows[sFlowIdx]->state == ESTABLISHED
-      && subflows[sFlowIdx]->dctcp_maxseq < (subflows[sFlowIdx]->highestAck + 1))
+      && GetDctcpOps ()->SlowDownDue (this, sFlowIdx))
     {// @SendPendingData()
       if (m_slowDownEcnLike && sFlowIdx > 0 && !m_packetScatter)
-        SlowDownEcnLike (sFlowIdx); // use ecn only after switching; otherwise use dctcp for initial subflow
+        m_dctcpOps->SlowDownEcnLike (this, sFlowIdx); // use ecn only after switching; otherwise use dctcp for initial subflow
       else
-        SlowDown (sFlowIdx);
+        m_dctcpOps->SlowDown (this, sFlowIdx);
     }
 
   // This condition only valid when sendingBuffer is empty!
@@ -724,40 +697,14 @@ MMpTcpSocketBase::SendPendingData(uint8_t sFlowIdx)
       bool loop = true;
       while (!sendingBuffer.Empty() && loop)
         {
+          // Mode has been switched to MP-TCP, so it is not allowed to send further data packet via master sub-flow.
+          // UsableWindow() keeps the scheduler away from it, nothing is sent until a slave sub-flow has window.
           uint32_t window = 0;
-          // First if should be removed
-          if (lastUsedsFlowIdx == 0 && subflows.size() == 1)
-            {
-              NS_LOG_UNCOND("MP-TCP mode & lastUsedsFlowIdx is 0 & only master sub-flow exist.");
-              // Mode has been switched to MP-TCP, so it is not allowed to send further data packet via master sub-flow
-              // Also slave sub-flows still not yet created. Thus noting to send now, return from this function!
-              return false;
-            }
-          if (lastUsedsFlowIdx == 0 && subflows.size() > 1)
+          int nextSubflow = getSubflowToUse();
+          if (nextSubflow >= 0)
             {
-              NS_LOG_UNCOND("MP-TCP mode & lastUsedsFlowIdx is 0 & slave sub-flows exist.");
-              // Mode has been switched to MP-TCP, so it is not allowed to send further data packet via master sub-flow
-              // Luckily at least one slave sub-flows has been created. Thus we should get proper sub-flow to use.
-              lastUsedsFlowIdx = getSubflowToUse();
-              NS_ASSERT(lastUsedsFlowIdx == 1);
-            }
-
-          // Search for a subflow with available windows
-          for (uint32_t i = 1; i < subflows.size(); i++)
-            {
-              if (subflows[lastUsedsFlowIdx]->state != ESTABLISHED)
-                continue;
-              window = std::min(AvailableWindow(lastUsedsFlowIdx), sendingBuffer.PendingData()); // Get available window size
-              if (window == 0)
-                {  // No more available window in the current subflow, try with another one
-                  NS_LOG_LOGIC("SendPendingData -> No window available on (" << (int)lastUsedsFlowIdx << ") Try next one!");
-                  lastUsedsFlowIdx = getSubflowToUse();
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("SendPendingData -> Find subflow with spare window PendingData (" << sendingBuffer.PendingData() << ") Available window ("<<AvailableWindow (lastUsedsFlowIdx)<<")");
-                  break;
-                }
+              lastUsedsFlowIdx = nextSubflow;
+              window = UsableWindow(lastUsedsFlowIdx);
             }
 
           if (window == 0)
@@ -787,7 +734,6 @@ MMpTcpSocketBase::SendPendingData(uint8_t sFlowIdx)
               else
                 nOctetsSent += amountSent;  // Count total bytes sent in this loop
             } // end of if statement
-          lastUsedsFlowIdx = getSubflowToUse();
         } // end of main while loop
     } // end of else clause
       //NS_LOG_UNCOND ("["<< m_node->GetId() << "] SendPendingData -> amount data sent = " << nOctetsSent << "... Notify application.");
@@ -812,21 +758,14 @@ MMpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
 
   if (sFlow->maxSeqNb > sFlow->TxSeqNumber - 1)
     {
-      uint32_t IterNumber = 0;
-      for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin(); (it != sFlow->mapDSN.end() && guard == false); ++it)
-        { // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
-          IterNumber++;
-          DSNMapping * ptr = *it;
-          if (ptr->subflowSeqNumber == sFlow->TxSeqNumber)
-            {
-              ptrDSN = ptr;
-              //p = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-              p = Create<Packet>(ptrDSN->dataLevelLength);
-              packetSize = ptrDSN->dataLevelLength;
-              guard = true;
-              NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize << " IterNumInMapDSN: " << IterNumber <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
-              break;
-            }
+      // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
+      ptrDSN = sFlow->mapDSN.Find(sFlow->TxSeqNumber);
+      if (ptrDSN != 0)
+        {
+          p = ptrDSN->GetPayload();
+          packetSize = ptrDSN->dataLevelLength;
+          guard = true;
+          NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
         }
       if (p == 0)
         {
@@ -889,7 +828,7 @@ MMpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
   header.SetWindowSize(AdvertisedWindowSize());
   if (!guard)
     { // If packet is made from sendingBuffer, then we got to add the packet and its info to subflow's mapDSN.
-      sFlow->AddDSNMapping(sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber/*, p->Copy()*/);
+      sFlow->AddDSNMapping(sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber, sendingBuffer.GetPayloadMode() ? p : 0);
     }
 
   // PS: PACKET-SCATTER MODE
@@ -932,7 +871,7 @@ MMpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
 
   uint8_t hlen = 5;   // 5 --> 32-bit words = 20 Bytes == TcpHeader Size with out any option
   //uint8_t olen = 15;  // 15 because packet size is 2 bytes in size. 1 + 8 + 2+ 4 = 15
-  uint8_t olen = 20;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4; // (4 - (15 % 4)) 4 => 1
   olen = (olen + plen) / 4;    // (15 + 1) / 4 = 4
@@ -957,12 +896,13 @@ MMpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
 
 #ifdef PLOT
   uint32_t tmp = (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DATA.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_DATA, tmp);
 #endif
 
    NS_LOG_LOGIC(Simulator::Now().GetSeconds() << " ["<< m_node->GetId()<< "] SendDataPacket->  " << header <<" dSize: " << packetSize<< " sFlow: " << sFlow->routeId);
 
   // Do some updates.....
+  SegmentSent(sFlowIdx, guard ? ptrDSN : 0);
   sFlow->rtt->SentSeq(SequenceNumber32(sFlow->TxSeqNumber), packetSize); // Notify the RTT of a data packet sent
   sFlow->TxSeqNumber += packetSize; // Update subflow's nextSeqNum to send.
   sFlow->maxSeqNb = std::max(sFlow->maxSeqNb, sFlow->TxSeqNumber - 1);
@@ -991,7 +931,14 @@ Ptr<TcpSocketBase>
 MMpTcpSocketBase::Fork(void)
 {
   NS_LOG_FUNCTION_NOARGS();
-  return CopyObject<MMpTcpSocketBase>(this);
+  Ptr<MMpTcpSocketBase> newSock = CopyObject<MMpTcpSocketBase>(this);
+  newSock->m_scheduler = 0; // Schedulers keep per connection state
+  if (m_scheduler != 0)
+    newSock->SetScheduler(m_scheduler->Copy());
+  newSock->m_congestionOps = 0; // So do congestion ops
+  if (m_congestionOps != 0)
+    newSock->SetCongestionOps(m_congestionOps->Copy());
+  return newSock;
 }
 
 void
@@ -1036,8 +983,7 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx)
   NS_ASSERT(ptrDSN->subflowSeqNumber == sFlow->highestAck +1);
 
   // we retransmit only one lost pkt
-  //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload();
   TcpHeader header;
   if (m_shortFlowTCP && sFlow->routeId == 0 && flowType.compare("Short") == 0)
     {
@@ -1064,7 +1010,7 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx)
     header.AddOptDSN(OPT_DSN, ptrDSN->dataSeqNumber, ptrDSN->dataLevelLength, ptrDSN->subflowSeqNumber);
 
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -1087,16 +1033,17 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx)
 
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_RETRANSMIT, tmp);
   if (!sFlow->m_inFastRec)
     {
-      timeOutTrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
+      Trace(TRACE_TIMEOUT_CWND, sFlow->cwnd);
     }
 #endif
 
 
 
   // Update Rtt
+  SegmentSent(sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq(SequenceNumber32(ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -1117,8 +1064,7 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   SetReTxTimeout(sFlowIdx); // reset RTO
 
   // we retransmit only one lost pkt
-  //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload();
   if (pkt == 0)
     NS_ASSERT(3!=3);
 
@@ -1150,7 +1096,7 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
   NS_LOG_WARN (Simulator::Now().GetSeconds() <<" RetransmitSegment -> "<< " localToken "<< localToken<<" Subflow "<<(int) sFlowIdx<<" DataSeq "<< ptrDSN->dataSeqNumber <<" SubflowSeq " << ptrDSN->subflowSeqNumber <<" dataLength " << ptrDSN->dataLevelLength << " packet size " << pkt->GetSize() << " 3DupACK");
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -1172,10 +1118,11 @@ MMpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   //Plotting
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_RETRANSMIT, tmp);
 #endif
 
   // Notify RTT
+  SegmentSent(sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq(SequenceNumber32(ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -1201,7 +1148,7 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   //calculateTotalCWND();
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DUPACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_DUPACK, tmp);
 #endif
 
   // PS: Tuning DupAckThresh dynamically based on flight packets
@@ -1212,7 +1159,7 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
 //    }
 
   // congestion control algorithms
-  if (sFlow->m_dupAckCount == sFlow->m_retxThresh && !sFlow->m_inFastRec)
+  if (UseDupAckThresh() && sFlow->m_dupAckCount == sFlow->m_retxThresh && !sFlow->m_inFastRec)
     { // FastRetrasmsion
       NS_LOG_WARN (Simulator::Now().GetSeconds() <<" DupAck -> subflow ("<< (int)sFlowIdx <<") 3rd duplicated ACK for segment ("<<ptrDSN->subflowSeqNumber<<")");
       uint32_t oldCwnd = sFlow->cwnd.Get();
@@ -1221,8 +1168,7 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
         Retransmit(sFlowIdx);               // Go to TCP tahoe like loss recovery
       else if (m_mmptcpv3 && m_DCTCP && sFlowIdx == 0 && m_packetScatter)
         { // We do not cut cwnd in half; instead slowing down based on DCTCP-CC
-          string sockName = this->GetTypeId ().GetName();
-          SlowDownFastReTx(sFlowIdx, ptrDSN, sockName);
+          GetDctcpOps ()->SlowDownFastReTx (this, sFlowIdx, ptrDSN);
         }
       else
         {
@@ -1232,7 +1178,7 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
       // Record dctcp stats for initial subflow only at any setting (mmptcpv3 or normal)
       if (m_dctcpFastReTxRecord && sFlowIdx == 0 && m_packetScatter)
         {
-          RecordDctcpFastRetx(sFlowIdx, oldCwnd);
+          GetDctcpOps ()->RecordFastRetx (this, sFlowIdx, oldCwnd);
         }
 
       // PS: Initiate MPTCP subflows - preparing for switching
@@ -1246,7 +1192,7 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
         }
       // Plotting
 #ifdef PLOT
-      sFlow->_FReTx.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
+      Trace(sFlow, TRACE_FRETX, TimeScale);
 #endif
       FastReTxs++;
     }
@@ -1257,8 +1203,8 @@ MMpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
       sFlow->m_duplicatesSize += m_segmentSize; // cwnd blowup
       // Plotting
 #ifdef PLOT
-      DupAcks.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
+      Trace(TRACE_DUP_ACKS, sFlow->cwnd);
+      Trace(sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
 #endif
       NS_LOG_WARN ("DupAck-> FastRecovery. Increase cwnd by one MSS, from " << sFlow->cwnd.Get() <<" -> " << sFlow->cwnd << " AvailableWindow: " << AvailableWindow(sFlowIdx));
       FastRecoveries++;
@@ -1302,175 +1248,17 @@ MMpTcpSocketBase::OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes)
 {
   NS_LOG_FUNCTION(this << (int) sFlowIdx << ackedBytes);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-
-  double adder = 0;
   uint32_t cwnd = sFlow->cwnd.Get();
-  uint32_t ssthresh = sFlow->ssthresh;
-  uint32_t mss = sFlow->MSS;
-
-  // params used only for COUPLED_INC and COUPLED_EPS only
-  int tcp_inc = 0, tt = 0;
-  int tmp, total_cwnd, tmp2;
-  double tmp_float;
-
-  if (AlgoCC >= COUPLED_SCALABLE_TCP)
-    {
-      if (ackedBytes > mss)
-        ackedBytes = mss;
-      if (ackedBytes < 0)
-        {
-          exit(200);
-          return;
-        }
-      tcp_inc = (ackedBytes * mss) / cwnd;
-      tt = (ackedBytes * mss) % cwnd;
-      if (m_alphaPerAck)
-        {
-          a = compute_a_scaled(); // Per ACK for COUPLED_INC
-          alpha = compute_alfa(); // Per ACK for COUPLED_EPSILON
-        }
-    }
 
-  calculateTotalCWND();
-  if (cwnd < ssthresh)
-    { // Slow Start phase
-      sFlow->cwnd += sFlow->MSS;
-#ifdef PLOT
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-      sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-      sFlow->_ss.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
-      NS_LOG_WARN ("Congestion Control (Slow Start) increment by one segmentSize");
-    }
-  else if (sFlow->routeId == 0)
+  if (sFlow->routeId == 0 && cwnd >= sFlow->ssthresh)
     { // PS: MMPTCP uses TCP congestion control in its initial subflow (pScatter phase) for congestion avoidance.
-      adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd;
+      double adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd;
       adder = std::max(1.0, adder);
       sFlow->cwnd += static_cast<double>(adder);
-      NS_LOG_LOGIC ("Subflow "<<(int)sFlowIdx<<" pScatter Congestion Control (Uncoupled_TCPs) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
+      NS_LOG_LOGIC ("Subflow "<<(int)sFlowIdx<<" pScatter Congestion Control (Uncoupled_TCPs) increment is "<<adder<<" ssthresh "<< sFlow->ssthresh << " cwnd "<<cwnd);
       return;
     }
-  else
-    {
-      switch (AlgoCC)
-        {
-      case RTT_Compensator:
-        calculateAlpha(); // Calculate alpha per drop or RTT...RFC 6356 (Section 4.1)
-        adder = std::min(alpha * sFlow->MSS * sFlow->MSS / totalCwnd, static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd);
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Congestion Control (RTT_Compensator): alpha "<<alpha<<" ackedBytes (" << ackedBytes << ") totalCwnd ("<< totalCwnd / sFlow->MSS<<" packets) -> increment is "<<adder << " cwnd: " << sFlow->cwnd);
-        break;
-      case Linked_Increases:
-        calculateAlpha();
-        adder = alpha * sFlow->MSS * sFlow->MSS / totalCwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Linked_Increases): alpha "<<alpha<<" increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd );
-        break;
-      case Uncoupled_TCPs:
-        adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-        NS_LOG_WARN ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Uncoupled_TCPs) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-#endif
-        break;
-      case UNCOUPLED:
-        sFlow->cwnd += tcp_inc;
-        break;
-      case Fully_Coupled:
-        adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / totalCwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Fully_Coupled) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-        break;
-
-      case COUPLED_INC:
-        total_cwnd = compute_total_window();
-        tmp2 = (ackedBytes * mss * a) / total_cwnd;
-
-        tmp = tmp2 / A_SCALE;
-
-        if (tmp < 0)
-          {
-            printf("Negative increase!");
-            tmp = 0;
-          }
-
-        if (rand() % A_SCALE < tmp2 % A_SCALE)
-          tmp++;
-
-        if (tmp > tcp_inc)    //capping
-          tmp = tcp_inc;
-
-        if ((cwnd + tmp) / mss != cwnd / mss)
-          a = compute_a_scaled();
-
-        sFlow->cwnd = cwnd + tmp;
-        break;
-
-      case COUPLED_EPSILON: // RTT_Compensator
-        total_cwnd = compute_total_window();
-        tmp_float = ((double) ackedBytes * mss * alpha * pow(alpha * cwnd, 1 - _e)) / pow(total_cwnd, 2 - _e);
-        tmp = (int) floor(tmp_float);
-
-        if (drand() < tmp_float - tmp)
-          tmp++;
-
-        if (tmp > tcp_inc)    //capping
-          tmp = tcp_inc;
-
-        if ((cwnd + tmp) / mss != cwnd / mss)
-          {
-            if (_e > 0 && _e < 2)
-              alpha = compute_alfa();
-          }
-
-        sFlow->cwnd = cwnd + tmp;
-        break;
-
-      case COUPLED_SCALABLE_TCP:
-        sFlow->cwnd = cwnd + ackedBytes * 0.01;
-        break;
-
-      case COUPLED_FULLY:
-          total_cwnd = compute_total_window();
-          tt = (int) (ackedBytes * mss * A);
-          tmp = tt / total_cwnd;
-          if (tmp > tcp_inc)
-            tmp = tcp_inc;
-          sFlow->cwnd = cwnd + tmp;
-          break;
-      default:
-        NS_ASSERT(3!=3);
-        break;
-        }
-      //Plotting
-#ifdef PLOT
-      sFlow->_ca.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
-    }
-
+  MpTcpSocketBase::OpenCWND(sFlowIdx, ackedBytes);
 }
 
 /** Retransmit timeout */
@@ -1508,29 +1296,26 @@ MMpTcpSocketBase::Retransmit(uint8_t sFlowIdx)
     sFlow->cwnd = sFlow->MSS * 2;
   else
     sFlow->cwnd = sFlow->MSS; //  sFlow->cwnd = 1.0;
+  UpdateWindowAggregates(sFlowIdx);
 
   sFlow->TxSeqNumber = sFlow->highestAck + 1; // m_nextTxSequence = m_txBuffer.HeadSequence(); // Restart from highest Ack
   sFlow->m_highTxMark = sFlow->TxSeqNumber - 1; //m_highTxMark = m_nextTxSequence - m_segmentSize; //cwnd blowup
 
   // DCTCP update during Timeout
   if (m_DCTCP || m_dctcpFastReTxRecord)
-    { // Determine the next observation window for updating dctcp's alpha
-      sFlow->dctcp_alpha_update_seq = sFlow->TxSeqNumber;
-      sFlow->dctcp_maxseq = sFlow->dctcp_alpha_update_seq;
-    }
+    GetDctcpOps ()->OnTimeout (this, sFlowIdx); // Determine the next observation window for updating dctcp's alpha
 
   //if (m_isThinStream && sFlowIdx == 0)
   //  {}
   //else
   sFlow->rtt->IncreaseMultiplier();  // Double the next RTO
 
-  if (AlgoCC >= COUPLED_EPSILON)
-    window_changed();
+  GetCongestionOps()->OnTimeout(this, sFlowIdx);
 
   //
   DoRetransmit(sFlowIdx);  // Retransmit the packet
 #ifdef PLOT
-  sFlow->_TimeOut.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
+  Trace(sFlow, TRACE_TIMEOUT, TimeScale);
 #endif
   TimeOuts++;
   // rfc 3782 - Recovering from timeOut
@@ -1552,71 +1337,11 @@ MMpTcpSocketBase::SetFlowSizeThresh(uint32_t flowSizeThresh)
   m_flowSizeThresh = flowSizeThresh;
 }
 
-void
-MMpTcpSocketBase::calculateTotalCWND()
-{
-  totalCwnd = 0;
-  for (uint32_t i = 0; i < subflows.size(); i++)
-    {
-      // PS: bypass pScatter subflow if in MPTCP mode
-      if (m_packetScatter == false && i == 0)
-        continue;
-      // PS: make sure if in MPTCP mode then pScatter subflow is not being part of calculation of total window
-      if (m_packetScatter == false)
-        NS_ASSERT(subflows[i]->routeId != 0);
-
-      if (subflows[i]->m_inFastRec)
-        totalCwnd += subflows[i]->ssthresh;
-      else
-        totalCwnd += subflows[i]->cwnd.Get();
-
-      // PS: break if in pScatter mode!
-      if (m_packetScatter)
-        {
-          NS_ASSERT(subflows[i]->routeId == 0);
-          break;
-        }
-    }
-}
-
-/*
- * This method is called whenever a congestion happen in order to regulate the agressivety of subflows
- * alpha = cwnd_total * MAX(cwnd_i / rtt_i^2) / {SUM(cwnd_i / rtt_i))^2}   //RFC 6356 formula (2)
- */
-void
-MMpTcpSocketBase::calculateAlpha()
+// PS: only the pScatter subflow is coupled in pScatter mode, all subflows but the pScatter one in MPTCP mode
+bool
+MMpTcpSocketBase::IsCoupledSubflow(uint8_t sFlowIdx) const
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  alpha = 0;
-  double maxi = 0;
-  double sumi = 0;
-  for (uint32_t i = 0; i < subflows.size(); i++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[i];
-
-      // PS: bypass pScatter subflow if in MPTCP mode
-      if (m_packetScatter == false && i == 0)
-        continue;
-      // PS: make sure if in MPTCP mode then pScatter subflow is not be considered
-      if (m_packetScatter == false)
-        NS_ASSERT(sFlow->routeId != 0);
-
-      Time time = sFlow->rtt->GetCurrentEstimate();
-      double rtt = time.GetSeconds();
-      double tmpi = sFlow->cwnd.Get() / (rtt * rtt);
-      if (maxi < tmpi)
-        maxi = tmpi;
-
-      sumi += sFlow->cwnd.Get() / rtt;
-
-      // PS: break if in pScatter mode!
-      if (m_packetScatter)
-        {
-          NS_ASSERT(sFlow->routeId == 0);
-          break;
-        }
-    }
-  alpha = (totalCwnd * maxi) / (sumi * sumi);
+  return m_packetScatter ? sFlowIdx == 0 : sFlowIdx != 0;
 }
 
 void
@@ -33,7 +33,7 @@ protected:
   virtual void DupAck         (uint8_t sFlowIdx, DSNMapping * ptrDSN);
   virtual void ProcessSynSent (uint8_t sFlowIdx, Ptr<Packet>, const TcpHeader&);
   virtual void OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes);
-  virtual uint8_t getSubflowToUse();
+  virtual uint32_t UsableWindow(uint8_t sFlowIdx);
   virtual void Retransmit(uint8_t sFlowIdx);
 
   void SetSwitchingMode(SwitchingMode_t);
@@ -45,8 +45,7 @@ protected:
   bool IsCwndExceedThresh(uint8_t sFlowIdx);
 
   // Congestion control stuff
-  virtual void calculateAlpha();
-  virtual void calculateTotalCWND();
+  virtual bool IsCoupledSubflow(uint8_t sFlowIdx) const;
 
 private:
   bool m_packetScatter;
@@ -0,0 +1,1144 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mp-tcp-congestion-ops.h"
+#include "ns3/mp-tcp-socket-base.h"
+
+//#define PLOT_DCTCP // Same switch as in mp-tcp-socket-base.cc
+
+NS_LOG_COMPONENT_DEFINE("MpTcpCongestionOps");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCongestionOps);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpUncoupledReno);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpLia);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpRttCompensator);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpFullyCoupled);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpXca);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpFastUncoupled);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpFastIncreases);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCoupledScalable);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpUncoupledInc);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCoupledEpsilon);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCoupledInc);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCoupledFully);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpXmp);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpOlia);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpBalia);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpDctcp);
+
+// RTT of a subflow in seconds, never zero
+static double
+GetRttSeconds(const Ptr<MpTcpSubFlow> &sFlow)
+{
+  double rtt = sFlow->rtt->GetCurrentEstimate().GetSeconds();
+  return (rtt > 0) ? rtt : 0.000001;
+}
+
+TypeId
+MpTcpCongestionOps::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCongestionOps")
+      .SetParent<Object>();
+  return tid;
+}
+
+MpTcpCongestionOps::~MpTcpCongestionOps()
+{
+}
+
+void
+MpTcpCongestionOps::IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  if (sFlow->cwnd.Get() < sFlow->ssthresh)
+    {
+      sFlow->cwnd += sFlow->MSS;
+      NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " slow start, cwnd " << sFlow->cwnd);
+    }
+  else
+    CongestionAvoidance(socket, sFlowIdx, ackedBytes);
+}
+
+uint32_t
+MpTcpCongestionOps::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  return std::max(2 * GetSubflows(socket)[sFlowIdx]->MSS, flightSize / 2);
+}
+
+void
+MpTcpCongestionOps::EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+}
+
+void
+MpTcpCongestionOps::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+}
+
+void
+MpTcpCongestionOps::EcnEcho(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+}
+
+void
+MpTcpCongestionOps::AddToCwnd(const Ptr<MpTcpSubFlow> &sFlow, double adder)
+{
+  adder = std::max(1.0, adder);
+  sFlow->cwnd += static_cast<double>(adder);
+}
+
+const std::vector<Ptr<MpTcpSubFlow> > &
+MpTcpCongestionOps::GetSubflows(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->subflows;
+}
+
+bool
+MpTcpCongestionOps::IsCoupledSubflow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx)
+{
+  return socket->IsCoupledSubflow(sFlowIdx);
+}
+
+uint32_t
+MpTcpCongestionOps::GetTotalCwnd(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->totalCwnd;
+}
+
+uint32_t
+MpTcpCongestionOps::ComputeTotalWindow(const Ptr<MpTcpSocketBase> &socket)
+{
+  socket->AttachSubflows();
+  return socket->m_totalWindow;
+}
+
+double
+MpTcpCongestionOps::GetCoupledRate(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_coupledRate;
+}
+
+double
+MpTcpCongestionOps::GetCoupledMaxRate2(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_coupledMaxRate2;
+}
+
+bool
+MpTcpCongestionOps::GetAlphaPerAck(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_alphaPerAck;
+}
+
+double
+MpTcpCongestionOps::GetUniformRandom(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->drand();
+}
+
+uint32_t
+MpTcpCongestionOps::GetBackoffBeta(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_backoffBeta;
+}
+
+uint32_t
+MpTcpCongestionOps::GetInitGamma(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_initGamma;
+}
+
+uint32_t
+MpTcpCongestionOps::GetCwndMin(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->m_cwndMin;
+}
+
+void
+MpTcpCongestionOps::SetInstantRate(const Ptr<MpTcpSocketBase> &socket, double rate)
+{
+  socket->m_instRate = rate;
+}
+
+double
+MpTcpCongestionOps::GetMarkedFraction(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx)
+{
+  return (socket->m_dctcpOps != 0) ? socket->m_dctcpOps->GetMarkedFraction(sFlowIdx) : 0.0;
+}
+
+TypeId
+MpTcpUncoupledReno::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpUncoupledReno")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpUncoupledReno>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpUncoupledReno::Copy() const
+{
+  return CopyObject<MpTcpUncoupledReno>(this);
+}
+
+void
+MpTcpUncoupledReno::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  AddToCwnd(sFlow, static_cast<double>(sFlow->MSS * sFlow->MSS) / sFlow->cwnd.Get());
+}
+
+TypeId
+MpTcpLia::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpLia")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpLia>();
+  return tid;
+}
+
+MpTcpLia::MpTcpLia() :
+    m_alpha(1.0)
+{
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpLia::Copy() const
+{
+  return CopyObject<MpTcpLia>(this);
+}
+
+// alpha = cwnd_total * MAX(cwnd_i / rtt_i^2) / {SUM(cwnd_i / rtt_i))^2}, from the socket's running aggregates
+void
+MpTcpLia::CalculateAlpha(Ptr<MpTcpSocketBase> socket)
+{
+  double sumi = GetCoupledRate(socket);
+  m_alpha = (GetTotalCwnd(socket) * GetCoupledMaxRate2(socket)) / (sumi * sumi);
+}
+
+void
+MpTcpLia::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  CalculateAlpha(socket);
+  double adder = m_alpha * sFlow->MSS * sFlow->MSS / GetTotalCwnd(socket);
+  AddToCwnd(sFlow, adder);
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " Linked_Increases: alpha " << m_alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+TypeId
+MpTcpRttCompensator::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpRttCompensator")
+      .SetParent<MpTcpLia>()
+      .AddConstructor<MpTcpRttCompensator>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpRttCompensator::Copy() const
+{
+  return CopyObject<MpTcpRttCompensator>(this);
+}
+
+void
+MpTcpRttCompensator::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  CalculateAlpha(socket); // Calculate alpha per drop or RTT...RFC 6356 (Section 4.1)
+  double adder = std::min(m_alpha * sFlow->MSS * sFlow->MSS / GetTotalCwnd(socket),
+      static_cast<double>(sFlow->MSS * sFlow->MSS) / sFlow->cwnd.Get());
+  AddToCwnd(sFlow, adder);
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " RTT_Compensator: alpha " << m_alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+TypeId
+MpTcpFullyCoupled::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpFullyCoupled")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpFullyCoupled>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpFullyCoupled::Copy() const
+{
+  return CopyObject<MpTcpFullyCoupled>(this);
+}
+
+void
+MpTcpFullyCoupled::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  AddToCwnd(sFlow, static_cast<double>(sFlow->MSS * sFlow->MSS) / GetTotalCwnd(socket));
+}
+
+uint32_t
+MpTcpFullyCoupled::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  int d = sFlow->cwnd.Get() - GetTotalCwnd(socket) / 2;
+  if (d < 0)
+    d = 0;
+  return std::max(2 * sFlow->MSS, (uint32_t) d);
+}
+
+TypeId
+MpTcpXca::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpXca")
+      .SetParent<MpTcpFullyCoupled>()
+      .AddConstructor<MpTcpXca>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpXca::Copy() const
+{
+  return CopyObject<MpTcpXca>(this);
+}
+
+uint32_t
+MpTcpXca::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  return MpTcpCongestionOps::GetSsThresh(socket, sFlowIdx, flightSize);
+}
+
+TypeId
+MpTcpFastUncoupled::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpFastUncoupled")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpFastUncoupled>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpFastUncoupled::Copy() const
+{
+  return CopyObject<MpTcpFastUncoupled>(this);
+}
+
+void
+MpTcpFastUncoupled::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  AddToCwnd(sFlow, ((1 - GetMarkedFraction(socket, sFlowIdx)) * sFlow->MSS * sFlow->MSS) / sFlow->cwnd.Get());
+}
+
+TypeId
+MpTcpFastIncreases::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpFastIncreases")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpFastIncreases>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpFastIncreases::Copy() const
+{
+  return CopyObject<MpTcpFastIncreases>(this);
+}
+
+void
+MpTcpFastIncreases::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  AddToCwnd(sFlow, ((1 - GetMarkedFraction(socket, sFlowIdx)) * sFlow->MSS * sFlow->MSS) / GetTotalCwnd(socket));
+}
+
+TypeId
+MpTcpCoupledScalable::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCoupledScalable")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpCoupledScalable>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpCoupledScalable::Copy() const
+{
+  return CopyObject<MpTcpCoupledScalable>(this);
+}
+
+void
+MpTcpCoupledScalable::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  ackedBytes = std::min(ackedBytes, sFlow->MSS);
+  sFlow->cwnd = sFlow->cwnd.Get() + ackedBytes * 0.01;
+}
+
+uint32_t
+MpTcpCoupledScalable::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  int d = (int) sFlow->cwnd.Get() - (ComputeTotalWindow(socket) >> 3);
+  if (d < 0)
+    d = 0;
+  return std::max(2 * sFlow->MSS, (uint32_t) d);
+}
+
+TypeId
+MpTcpUncoupledInc::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpUncoupledInc")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpUncoupledInc>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpUncoupledInc::Copy() const
+{
+  return CopyObject<MpTcpUncoupledInc>(this);
+}
+
+void
+MpTcpUncoupledInc::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  ackedBytes = std::min(ackedBytes, sFlow->MSS);
+  int tcp_inc = (ackedBytes * sFlow->MSS) / sFlow->cwnd.Get();
+  sFlow->cwnd += tcp_inc;
+}
+
+TypeId
+MpTcpCoupledEpsilon::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCoupledEpsilon")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpCoupledEpsilon>()
+      .AddAttribute("Epsilon", "Coupling between 0 (fully coupled) and 2 (uncoupled)",
+          DoubleValue(1.0),
+          MakeDoubleAccessor(&MpTcpCoupledEpsilon::m_epsilon),
+          MakeDoubleChecker<double>(0.0, 2.0));
+  return tid;
+}
+
+MpTcpCoupledEpsilon::MpTcpCoupledEpsilon() :
+    m_epsilon(1.0), m_alpha(1.0)
+{
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpCoupledEpsilon::Copy() const
+{
+  return CopyObject<MpTcpCoupledEpsilon>(this);
+}
+
+double
+MpTcpCoupledEpsilon::ComputeAlpha(Ptr<MpTcpSocketBase> socket)
+{
+  const std::vector<Ptr<MpTcpSubFlow> > &subflows = GetSubflows(socket);
+  if (subflows.size() == 1)
+    return 1;
+
+  double maxt = 0, sum_denominator = 0;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      uint32_t cwnd = sFlow->m_inFastRec ? sFlow->ssthresh : sFlow->cwnd.Get();
+      uint32_t rtt = sFlow->rtt->GetCurrentEstimate().GetMilliSeconds();
+      if (rtt == 0)
+        rtt = 1;
+      double t = pow(cwnd, m_epsilon / 2) / rtt;
+      if (t > maxt)
+        maxt = t;
+      sum_denominator += ((double) cwnd / rtt);
+    }
+  return (double) ComputeTotalWindow(socket) * pow(maxt, 1 / (1 - m_epsilon / 2)) / pow(sum_denominator, 1 / (1 - m_epsilon / 2));
+}
+
+void
+MpTcpCoupledEpsilon::IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  if (GetAlphaPerAck(socket))
+    m_alpha = ComputeAlpha(socket);
+  MpTcpCongestionOps::IncreaseWindow(socket, sFlowIdx, ackedBytes);
+}
+
+void
+MpTcpCoupledEpsilon::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  uint32_t cwnd = sFlow->cwnd.Get();
+  uint32_t mss = sFlow->MSS;
+  ackedBytes = std::min(ackedBytes, mss);
+  int tcp_inc = (ackedBytes * mss) / cwnd;
+  int total_cwnd = ComputeTotalWindow(socket);
+  double tmp_float = ((double) ackedBytes * mss * m_alpha * pow(m_alpha * cwnd, 1 - m_epsilon)) / pow(total_cwnd, 2 - m_epsilon);
+  int tmp = (int) floor(tmp_float);
+
+  if (GetUniformRandom(socket) < tmp_float - tmp)
+    tmp++;
+
+  if (tmp > tcp_inc)    //capping
+    tmp = tcp_inc;
+
+  if ((cwnd + tmp) / mss != cwnd / mss)
+    {
+      if (m_epsilon > 0 && m_epsilon < 2)
+        m_alpha = ComputeAlpha(socket);
+    }
+  sFlow->cwnd = cwnd + tmp;
+}
+
+void
+MpTcpCoupledEpsilon::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  if (m_epsilon > 0 && m_epsilon < 2)
+    m_alpha = ComputeAlpha(socket);
+}
+
+TypeId
+MpTcpCoupledInc::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCoupledInc")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpCoupledInc>();
+  return tid;
+}
+
+MpTcpCoupledInc::MpTcpCoupledInc() :
+    m_a(A_SCALE)
+{
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpCoupledInc::Copy() const
+{
+  return CopyObject<MpTcpCoupledInc>(this);
+}
+
+uint32_t
+MpTcpCoupledInc::ComputeAScaled(Ptr<MpTcpSocketBase> socket)
+{
+  const std::vector<Ptr<MpTcpSubFlow> > &subflows = GetSubflows(socket);
+  uint32_t sum_denominator = 0;
+  uint64_t t = 0;
+  uint64_t cwndSum = 0;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      uint32_t rtt = sFlow->rtt->GetCurrentEstimate().GetMicroSeconds() / 10;
+      if (rtt == 0)
+        rtt = 1;
+
+      uint32_t cwnd = sFlow->m_inFastRec ? sFlow->ssthresh : sFlow->cwnd.Get();
+      uint32_t mss = sFlow->MSS;
+
+      t = std::max(t, (uint64_t) cwnd * mss * mss / rtt / rtt);
+      sum_denominator += cwnd * mss / rtt;
+      cwndSum += cwnd;
+    }
+  return (uint32_t) (A_SCALE * (uint64_t) cwndSum * t / sum_denominator / sum_denominator);
+}
+
+void
+MpTcpCoupledInc::IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  if (GetAlphaPerAck(socket))
+    m_a = ComputeAScaled(socket);
+  MpTcpCongestionOps::IncreaseWindow(socket, sFlowIdx, ackedBytes);
+}
+
+void
+MpTcpCoupledInc::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  uint32_t cwnd = sFlow->cwnd.Get();
+  uint32_t mss = sFlow->MSS;
+  ackedBytes = std::min(ackedBytes, mss);
+  int tcp_inc = (ackedBytes * mss) / cwnd;
+  int total_cwnd = ComputeTotalWindow(socket);
+  int tmp2 = (ackedBytes * mss * m_a) / total_cwnd;
+  int tmp = tmp2 / A_SCALE;
+
+  if (tmp < 0)
+    {
+      NS_LOG_WARN("Negative increase!");
+      tmp = 0;
+    }
+
+  if (rand() % A_SCALE < tmp2 % A_SCALE)
+    tmp++;
+
+  if (tmp > tcp_inc)    //capping
+    tmp = tcp_inc;
+
+  if ((cwnd + tmp) / mss != cwnd / mss)
+    m_a = ComputeAScaled(socket);
+
+  sFlow->cwnd = cwnd + tmp;
+}
+
+void
+MpTcpCoupledInc::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  m_a = ComputeAScaled(socket);
+}
+
+TypeId
+MpTcpCoupledFully::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCoupledFully")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpCoupledFully>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpCoupledFully::Copy() const
+{
+  return CopyObject<MpTcpCoupledFully>(this);
+}
+
+void
+MpTcpCoupledFully::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  uint32_t cwnd = sFlow->cwnd.Get();
+  uint32_t mss = sFlow->MSS;
+  ackedBytes = std::min(ackedBytes, mss);
+  int tcp_inc = (ackedBytes * mss) / cwnd;
+  int total_cwnd = ComputeTotalWindow(socket);
+  int tt = (int) (ackedBytes * mss * A);
+  int tmp = tt / total_cwnd;
+  if (tmp > tcp_inc)
+    tmp = tcp_inc;
+  sFlow->cwnd = cwnd + tmp;
+}
+
+uint32_t
+MpTcpCoupledFully::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  int d = (int) sFlow->cwnd.Get() - ComputeTotalWindow(socket) / B;
+  if (d < 0)
+    d = 0;
+  return std::max(2 * sFlow->MSS, (uint32_t) d);
+}
+
+TypeId
+MpTcpXmp::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpXmp")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpXmp>();
+  return tid;
+}
+
+MpTcpXmp::SubflowState::SubflowState() :
+    begSeq(0), rounds(0), weight(1.0), equilibrium(0), instantRate(0), cwr(1), refWin(0), incCum(0.0), cwrHighSeq(0)
+{
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpXmp::Copy() const
+{
+  return CopyObject<MpTcpXmp>(this);
+}
+
+MpTcpXmp::SubflowState &
+MpTcpXmp::GetState(uint8_t sFlowIdx)
+{
+  if (m_state.size() <= sFlowIdx)
+    m_state.resize(sFlowIdx + 1);
+  return m_state[sFlowIdx];
+}
+
+// Congestion window increase once per round, adapted to the subflow weight
+void
+MpTcpXmp::IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  const std::vector<Ptr<MpTcpSubFlow> > &subflows = GetSubflows(socket);
+  Ptr<MpTcpSubFlow> subflow = subflows[sFlowIdx];
+  uint32_t ack = subflow->highestAck + 1 + ackedBytes;
+  if (m_state.size() < subflows.size())
+    m_state.resize(subflows.size());
+  SubflowState &state = m_state[sFlowIdx];
+  if (ack > state.begSeq)
+    {
+      state.rounds++;
+      // cwnd of the last round
+      double cwnd = subflow->cwnd.Get() / subflow->MSS;
+      if (state.cwr == 2)
+        cwnd = state.refWin;
+
+      // measurement parameters.
+      uint32_t rtt = subflow->rtt->GetCurrentEstimate().GetMicroSeconds();
+
+      // update rates in the last round.
+      double lastRate = 8.0 * cwnd * subflow->MSS / rtt; // Mbps
+      state.instantRate = state.instantRate * 0.875 + 0.125 * lastRate;
+      state.equilibrium = lastRate;
+
+      double totalRate = 0;
+      double instRate = 0;
+      Time minRTT = Seconds(60.0);
+      for (uint32_t i = 0; i < subflows.size(); i++)
+        {
+          if (!(subflows[i]->state == ESTABLISHED) || m_state[i].equilibrium == 0) // otherwise, minRTT may be zero
+            continue;
+          totalRate += m_state[i].equilibrium;
+          instRate += m_state[i].instantRate;
+          minRTT = Min(minRTT, subflows[i]->rtt->GetCurrentEstimate());
+        }
+      SetInstantRate(socket, instRate);
+
+      // update weights for next round
+      if (totalRate > 0)
+        {
+          state.weight = rtt * state.equilibrium / totalRate;
+          state.weight /= minRTT.GetMicroSeconds();
+          NS_ASSERT(state.weight > 0);
+        }
+
+      // In the safe area, increase cwnd.
+      if (state.cwr == 1)
+        {
+          if (subflow->cwnd < subflow->ssthresh)
+            subflow->cwnd += subflow->MSS; // ss
+          else
+            { // ca
+              state.incCum += state.weight * GetInitGamma(socket);
+              uint32_t a = state.incCum;
+              state.incCum -= a;
+              subflow->cwnd += a * subflow->MSS;
+            }
+        }
+
+      // prepare for next round
+      state.refWin = subflow->cwnd.Get() / subflow->MSS;
+      state.begSeq = subflow->TxSeqNumber;
+    }
+  else if (state.cwr == 1 && subflow->cwnd < subflow->ssthresh)
+    subflow->cwnd += subflow->MSS; // ss
+
+  // quit from cwr
+  if (state.cwr == 2 && ack >= state.cwrHighSeq)
+    state.cwr = 1;
+}
+
+void
+MpTcpXmp::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  NS_FATAL_ERROR("XMP grows its windows once per round in IncreaseWindow()");
+}
+
+void
+MpTcpXmp::EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  SubflowState &state = GetState(sFlowIdx);
+  uint32_t rtt = sFlow->rtt->GetCurrentEstimate().GetMicroSeconds();
+  double curRate = 0;
+  if (rtt > 0)
+    curRate = 8.0 * sFlow->ssthresh / rtt; // Mbps
+  state.instantRate = state.instantRate * 0.875 + 0.125 * curRate;
+  state.equilibrium = curRate;
+}
+
+void
+MpTcpXmp::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  SubflowState &state = GetState(sFlowIdx);
+  if (state.cwr > 0)
+    state.cwr = 1;
+  state.begSeq = GetSubflows(socket)[sFlowIdx]->TxSeqNumber;
+}
+
+// Cut cwnd by 1/beta at most once per round
+void
+MpTcpXmp::EcnEcho(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  SubflowState &state = GetState(sFlowIdx);
+  if (state.cwr != 1)
+    return;
+  state.cwr = 2;
+  state.cwrHighSeq = GetSubflows(socket)[sFlowIdx]->TxSeqNumber;
+  EnterCwr(socket, sFlowIdx);
+}
+
+// Congestion window decrease multiplicatively
+void
+MpTcpXmp::EnterCwr(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  socket->SlowDownHits++;
+  Ptr<MpTcpSubFlow> subflow = GetSubflows(socket)[sFlowIdx];
+  uint32_t cwnd = subflow->cwnd.Get() / subflow->MSS;
+  GetState(sFlowIdx).refWin = cwnd;
+  if (subflow->cwnd >= subflow->ssthresh)
+    { // shrink cwnd
+      uint32_t reduced = cwnd / float(GetBackoffBeta(socket));
+      reduced = (reduced == 0) ? 1 : reduced;
+      cwnd = (cwnd > reduced) ? cwnd - reduced : 0;
+      cwnd = (cwnd < GetCwndMin(socket)) ? GetCwndMin(socket) : cwnd;
+      subflow->cwnd = cwnd * subflow->MSS;
+    }
+  if (subflow->cwnd < subflow->ssthresh)
+    subflow->ssthresh = subflow->cwnd.Get();
+}
+
+TypeId
+MpTcpOlia::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpOlia")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpOlia>();
+  return tid;
+}
+
+MpTcpOlia::SubflowState::SubflowState() :
+    lastLossBytes(0), sinceLoss(0)
+{
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpOlia::Copy() const
+{
+  return CopyObject<MpTcpOlia>(this);
+}
+
+MpTcpOlia::SubflowState &
+MpTcpOlia::GetState(uint8_t sFlowIdx)
+{
+  if (m_state.size() <= sFlowIdx)
+    m_state.resize(sFlowIdx + 1);
+  return m_state[sFlowIdx];
+}
+
+void
+MpTcpOlia::Loss(uint8_t sFlowIdx)
+{
+  SubflowState &state = GetState(sFlowIdx);
+  state.lastLossBytes = state.sinceLoss;
+  state.sinceLoss = 0;
+}
+
+void
+MpTcpOlia::IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  GetState(sFlowIdx).sinceLoss += ackedBytes;
+  MpTcpCongestionOps::IncreaseWindow(socket, sFlowIdx, ackedBytes);
+}
+
+void
+MpTcpOlia::EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  Loss(sFlowIdx);
+}
+
+void
+MpTcpOlia::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  Loss(sFlowIdx);
+}
+
+// cwnd_r += MSS^2 * (cwnd_r / rtt_r^2) / (SUM(cwnd_p / rtt_p))^2 + alpha_r * MSS^2 / cwnd_r
+void
+MpTcpOlia::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  const std::vector<Ptr<MpTcpSubFlow> > &subflows = GetSubflows(socket);
+  if (m_state.size() < subflows.size())
+    m_state.resize(subflows.size());
+
+  // Best paths have the largest inter-loss distance l_p / rtt_p^2, max paths the largest window
+  double sum = 0, bestRate = 0;
+  uint32_t maxCwnd = 0, paths = 0;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      if (!IsCoupledSubflow(socket, i) || subflows[i]->state != ESTABLISHED)
+        continue;
+      double rtt = GetRttSeconds(subflows[i]);
+      uint64_t l = std::max(m_state[i].lastLossBytes, m_state[i].sinceLoss);
+      sum += subflows[i]->cwnd.Get() / rtt;
+      bestRate = std::max(bestRate, l / (rtt * rtt));
+      maxCwnd = std::max(maxCwnd, subflows[i]->cwnd.Get());
+      paths++;
+    }
+  uint32_t maxPaths = 0, collected = 0; // collected: best paths that do not have the largest window
+  bool isMax = false, isCollected = false;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      if (!IsCoupledSubflow(socket, i) || subflows[i]->state != ESTABLISHED)
+        continue;
+      double rtt = GetRttSeconds(subflows[i]);
+      uint64_t l = std::max(m_state[i].lastLossBytes, m_state[i].sinceLoss);
+      bool max = subflows[i]->cwnd.Get() == maxCwnd;
+      bool best = l / (rtt * rtt) == bestRate;
+      maxPaths += max;
+      collected += (best && !max);
+      if (i == sFlowIdx)
+        {
+          isMax = max;
+          isCollected = best && !max;
+        }
+    }
+  double alpha = 0;
+  if (isCollected)
+    alpha = 1.0 / (paths * collected);
+  else if (isMax && collected > 0)
+    alpha = -1.0 / (paths * maxPaths);
+
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  double rtt = GetRttSeconds(sFlow);
+  double mss2 = (double) sFlow->MSS * sFlow->MSS;
+  double adder = mss2 * (sFlow->cwnd.Get() / (rtt * rtt)) / (sum * sum) + alpha * mss2 / sFlow->cwnd.Get();
+  if (adder >= 0)
+    AddToCwnd(sFlow, adder);
+  else
+    sFlow->cwnd = std::max(sFlow->MSS, sFlow->cwnd.Get() - (uint32_t) (-adder));
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " OLIA: alpha " << alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+TypeId
+MpTcpBalia::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpBalia")
+      .SetParent<MpTcpCongestionOps>()
+      .AddConstructor<MpTcpBalia>();
+  return tid;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpBalia::Copy() const
+{
+  return CopyObject<MpTcpBalia>(this);
+}
+
+double
+MpTcpBalia::GetAlpha(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, double &rate, double &totalRate)
+{
+  const std::vector<Ptr<MpTcpSubFlow> > &subflows = GetSubflows(socket);
+  double maxRate = 0;
+  totalRate = 0;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      if (!IsCoupledSubflow(socket, i) || subflows[i]->state != ESTABLISHED)
+        continue;
+      double x = subflows[i]->cwnd.Get() / GetRttSeconds(subflows[i]);
+      maxRate = std::max(maxRate, x);
+      totalRate += x;
+    }
+  rate = subflows[sFlowIdx]->cwnd.Get() / GetRttSeconds(subflows[sFlowIdx]);
+  return (rate > 0) ? maxRate / rate : 1.0;
+}
+
+// cwnd_r += MSS^2 * (x_r / rtt_r) / (SUM(x_k))^2 * (1 + alpha_r) / 2 * (4 + alpha_r) / 5, with x = cwnd / rtt
+void
+MpTcpBalia::CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = GetSubflows(socket)[sFlowIdx];
+  double rate, totalRate;
+  double alpha = GetAlpha(socket, sFlowIdx, rate, totalRate);
+  if (totalRate == 0)
+    totalRate = rate;
+  double adder = (double) sFlow->MSS * sFlow->MSS * (rate / GetRttSeconds(sFlow)) / (totalRate * totalRate)
+      * (1 + alpha) / 2 * (4 + alpha) / 5;
+  AddToCwnd(sFlow, adder);
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " BALIA: alpha " << alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+// cwnd_r -= cwnd_r / 2 * min(alpha_r, 1.5)
+uint32_t
+MpTcpBalia::GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize)
+{
+  double rate, totalRate;
+  double alpha = GetAlpha(socket, sFlowIdx, rate, totalRate);
+  uint32_t decrease = flightSize / 2 * std::min(alpha, 1.5);
+  uint32_t ssthresh = (flightSize > decrease) ? flightSize - decrease : 0;
+  return std::max(2 * GetSubflows(socket)[sFlowIdx]->MSS, ssthresh);
+}
+
+TypeId
+MpTcpDctcp::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpDctcp")
+      .SetParent<Object>()
+      .AddConstructor<MpTcpDctcp>();
+  return tid;
+}
+
+MpTcpDctcp::SubflowState::SubflowState() :
+    total(0), marked(0), alphaUpdateSeq(0), maxSeq(0), alpha(0.0), lastFraction(0.0)
+{
+}
+
+MpTcpDctcp::SubflowState &
+MpTcpDctcp::GetState(uint8_t sFlowIdx)
+{
+  if (m_state.size() <= sFlowIdx)
+    m_state.resize(sFlowIdx + 1);
+  return m_state[sFlowIdx];
+}
+
+double
+MpTcpDctcp::GetAlpha(uint8_t sFlowIdx) const
+{
+  return (sFlowIdx < m_state.size()) ? m_state[sFlowIdx].alpha : 0.0;
+}
+
+double
+MpTcpDctcp::GetMarkedFraction(uint8_t sFlowIdx) const
+{
+  return (sFlowIdx < m_state.size()) ? m_state[sFlowIdx].lastFraction : 0.0;
+}
+
+void
+MpTcpDctcp::UpdateAlpha(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ack)
+{
+  NS_LOG_FUNCTION((int) sFlowIdx << ack);
+  Ptr<MpTcpSubFlow> sFlow = socket->subflows[sFlowIdx];
+  SubflowState &state = GetState(sFlowIdx);
+  // Tracking total and marked segments. A delayed ACK covers several of them, the peer is
+  // expected to run the same DelayedAckCount so by default each ACK counts once
+  uint32_t segments = 1;
+  if (socket->m_delayedAckCount > 1 && ack > sFlow->highestAck + 1)
+    segments = std::max<uint32_t>(1, (ack - (sFlow->highestAck + 1) + sFlow->MSS / 2) / sFlow->MSS);
+  state.total += segments;
+  if (socket->m_eceBit > 0)
+    {
+      state.marked += segments;
+#ifdef PLOT_DCTCP
+      uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % socket->mod;
+      socket->Trace(sFlow, TRACE_ECN_ECHO, tmp);
+#endif
+    }
+  // New alpha roughly once per RTT, when the data sent at the last update is acknowledged
+  if (ack <= state.alphaUpdateSeq)
+    return;
+  double fraction = (state.total > 0) ? ((double) state.marked) / state.total : 0.0;
+  state.lastFraction = fraction;
+  state.alpha = std::min(1.0, (1 - socket->m_g) * state.alpha + socket->m_g * fraction);
+  if (socket->m_dctcpFastAlpha)
+    state.alpha = fraction;
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " DCTCP marked " << state.marked << " of " << state.total << " alpha " << state.alpha);
+
+  if (socket->m_dynamicSubflow && sFlowIdx == 0 && socket->maxSubflows >= 2)
+    socket->CheckIncast(sFlowIdx);
+  state.marked = 0;
+  state.total = 0;
+  state.alphaUpdateSeq = sFlow->TxSeqNumber;
+#ifdef PLOT_DCTCP
+  socket->Trace(sFlow, TRACE_DCTCP_ALPHA, state.alpha);
+  socket->Trace(sFlow, TRACE_DCTCP_FRACTION, fraction);
+  uint32_t pktNumber = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % socket->mod;
+  socket->Trace(sFlow, TRACE_BEG, pktNumber); // ROUND for ECN and DCTCP
+#endif
+}
+
+bool
+MpTcpDctcp::SlowDownDue(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  return GetState(sFlowIdx).maxSeq < socket->subflows[sFlowIdx]->highestAck + 1;
+}
+
+void
+MpTcpDctcp::ReduceCwnd(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, double factor)
+{
+  socket->SlowDownHits++;
+  Ptr<MpTcpSubFlow> sFlow = socket->subflows[sFlowIdx];
+  double tmp = sFlow->cwnd.Get() * factor;
+  if (tmp < 0)
+    tmp = 0;
+  sFlow->cwnd = std::max((uint32_t) tmp, socket->m_cwndMin * sFlow->MSS);
+  sFlow->ssthresh = std::max(sFlow->MSS, sFlow->cwnd.Get());
+  socket->UpdateWindowAggregates(sFlowIdx);
+  GetState(sFlowIdx).maxSeq = sFlow->TxSeqNumber;
+#ifdef PLOT_DCTCP
+  uint32_t pkt_tmp = ((sFlow->highestAck + 1 - sFlow->initialSequnceNumber) / sFlow->MSS) % socket->mod;
+  socket->Trace(sFlow, TRACE_ECN_CWND_CUT_POINT, pkt_tmp);
+#endif
+}
+
+void
+MpTcpDctcp::SlowDown(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  NS_ASSERT(!socket->m_slowDownXmpLike);
+  NS_ASSERT(socket->AlgoCC != XMP && socket->m_DCTCP);
+  double alpha = GetState(sFlowIdx).alpha;
+  if (socket->m_dctcpAlphaPerAck)
+    alpha = socket->subflows[sFlowIdx]->rtt->GetAlpha();
+  NS_LOG_LOGIC("Subflow " << (int) sFlowIdx << " DCTCP cut, alpha " << alpha);
+  ReduceCwnd(socket, sFlowIdx, 1 - alpha / 2);
+}
+
+void
+MpTcpDctcp::SlowDownXmpLike(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  NS_ASSERT(socket->AlgoCC != XMP && socket->m_DCTCP);
+  Ptr<MpTcpSubFlow> sFlow = socket->subflows[sFlowIdx];
+  SubflowState &state = GetState(sFlowIdx);
+  if (sFlow->cwnd >= sFlow->ssthresh)
+    {
+      double tmp = sFlow->cwnd.Get() * (1 - state.alpha / 2);
+      sFlow->cwnd = std::max((uint32_t) tmp, socket->m_cwndMin * sFlow->MSS);
+    }
+  if (sFlow->cwnd < sFlow->ssthresh)
+    sFlow->ssthresh = sFlow->cwnd.Get();
+  socket->UpdateWindowAggregates(sFlowIdx);
+  state.maxSeq = sFlow->TxSeqNumber;
+}
+
+void
+MpTcpDctcp::SlowDownEcnLike(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  NS_ASSERT(!socket->m_slowDownXmpLike);
+  NS_ASSERT(socket->m_initGamma < socket->m_backoffBeta);
+  NS_ASSERT(socket->m_backoffBeta != 0 && socket->m_initGamma != 0);
+  NS_ASSERT(socket->AlgoCC != XMP && socket->m_DCTCP);
+  ReduceCwnd(socket, sFlowIdx, 1 - socket->m_initGamma / (float) socket->m_backoffBeta);
+}
+
+void
+MpTcpDctcp::SlowDownFastReTx(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, DSNMapping *ptrDSN)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  socket->SlowDownHits++;
+  Ptr<MpTcpSubFlow> sFlow = socket->subflows[sFlowIdx];
+  double tmpCwnd = sFlow->cwnd.Get() * (1 - GetState(sFlowIdx).alpha / 2);
+  sFlow->ssthresh = std::max(2 * sFlow->MSS, (uint32_t) tmpCwnd);
+  sFlow->cwnd = sFlow->ssthresh + 3 * sFlow->MSS;
+  socket->DoRetransmit(sFlowIdx, ptrDSN);
+  sFlow->m_recover = SequenceNumber32(sFlow->m_highTxMark + 1);
+  sFlow->m_inFastRec = true;
+  socket->UpdateWindowAggregates(sFlowIdx);
+}
+
+void
+MpTcpDctcp::OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  SubflowState &state = GetState(sFlowIdx);
+  state.alphaUpdateSeq = socket->subflows[sFlowIdx]->TxSeqNumber;
+  state.maxSeq = state.alphaUpdateSeq;
+}
+
+void
+MpTcpDctcp::RecordFastRetx(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t oldCwnd)
+{
+  Ptr<MpTcpSubFlow> sFlow = socket->subflows[sFlowIdx];
+  SubflowState &state = GetState(sFlowIdx);
+  double currentF = (state.total > 0) ? (double) state.marked / state.total : 0.0;
+
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper>(socket->outputFileNameDctcp, std::ios::out | std::ios::app);
+  std::ostream* os = stream->GetStream();
+  *os << socket->flowId << "\t" << socket->m_node->GetId() << "\t" << (int) sFlow->routeId << "\t" << Simulator::Now().GetSeconds() << "\t"
+      << currentF << "\t" << state.lastFraction << "\t" << state.alpha << "\t" << oldCwnd << "\t" << sFlow->cwnd.Get() << std::endl;
+}
+
+} //namespace ns3
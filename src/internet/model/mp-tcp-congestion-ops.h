@@ -0,0 +1,354 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_CONGESTION_OPS_H
+#define MP_TCP_CONGESTION_OPS_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+namespace ns3
+{
+
+class MpTcpSocketBase;
+class MpTcpSubFlow;
+class DSNMapping;
+
+/*
+ * Congestion window management of the subflows of a connection.
+ * The socket keeps the loss recovery machinery (NewReno fast recovery, RTO) and calls into
+ * the congestion ops for what differs between algorithms. DCTCP's ECN reaction is a layer
+ * over them, see MpTcpDctcp.
+ * An instance belongs to a single connection, so algorithms keep their own connection
+ * and per subflow state here instead of in MpTcpSocketBase/MpTcpSubFlow.
+ */
+class MpTcpCongestionOps : public Object
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual ~MpTcpCongestionOps();
+  // New ACK for ackedBytes outside fast recovery. Default: slow start, then CongestionAvoidance()
+  virtual void IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  // New ssthresh on fast retransmit. Default: half of flightSize, at least 2 segments
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual void EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx); // After the fast retransmit window cut
+  virtual void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);     // After the window is reset by an RTO
+  virtual void EcnEcho(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);       // ACK with ECE received on an established subflow
+  virtual Ptr<MpTcpCongestionOps> Copy() const = 0;                          // Same algorithm and configuration, for a forked socket
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes) = 0;
+  static void AddToCwnd(const Ptr<MpTcpSubFlow> &sFlow, double adder); // Grow cwnd by adder bytes, at least one byte
+
+  // Access to the connection, shared by all algorithms
+  static const std::vector<Ptr<MpTcpSubFlow> > &GetSubflows(const Ptr<MpTcpSocketBase> &socket);
+  static bool IsCoupledSubflow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx);
+  static uint32_t GetTotalCwnd(const Ptr<MpTcpSocketBase> &socket);      // Coupled window, as last computed by the socket
+  static uint32_t ComputeTotalWindow(const Ptr<MpTcpSocketBase> &socket); // Sum of all subflow windows (ssthresh while in fast recovery)
+  static double GetCoupledRate(const Ptr<MpTcpSocketBase> &socket);       // SUM(cwnd_i / rtt_i) over the coupled subflows, rtt in us
+  static double GetCoupledMaxRate2(const Ptr<MpTcpSocketBase> &socket);   // MAX(cwnd_i / rtt_i^2) over the coupled subflows
+  static bool GetAlphaPerAck(const Ptr<MpTcpSocketBase> &socket);
+  static double GetUniformRandom(const Ptr<MpTcpSocketBase> &socket);
+  static uint32_t GetBackoffBeta(const Ptr<MpTcpSocketBase> &socket);
+  static uint32_t GetInitGamma(const Ptr<MpTcpSocketBase> &socket);
+  static uint32_t GetCwndMin(const Ptr<MpTcpSocketBase> &socket);
+  static void SetInstantRate(const Ptr<MpTcpSocketBase> &socket, double rate);
+  static double GetMarkedFraction(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx); // DCTCP's, 0 without DCTCP
+};
+
+/*
+ * Regular TCP (Reno) congestion avoidance on every subflow (Uncoupled_TCPs).
+ */
+class MpTcpUncoupledReno : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * Linked Increases Algorithm, RFC 6356 (Linked_Increases).
+ */
+class MpTcpLia : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpLia();
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  void CalculateAlpha(Ptr<MpTcpSocketBase> socket); // RFC 6356 formula (2)
+
+  double m_alpha;
+};
+
+/*
+ * LIA whose increase is capped by the one of regular TCP on the same path (RTT_Compensator).
+ */
+class MpTcpRttCompensator : public MpTcpLia
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * Increase and decrease driven by the total window of the connection (Fully_Coupled).
+ */
+class MpTcpFullyCoupled : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * Fully coupled increase with the regular TCP decrease (XCA).
+ */
+class MpTcpXca : public MpTcpFullyCoupled
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+};
+
+/*
+ * Reno increase scaled down by the fraction of ECN marked segments of the last window (Fast_Uncoupled).
+ */
+class MpTcpFastUncoupled : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * Fully coupled increase scaled down by the fraction of ECN marked segments (Fast_Increases).
+ */
+class MpTcpFastIncreases : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * Algorithms from the htsim MPTCP model. Increases are computed per ACK of at most one
+ * segment and never exceed the one of regular TCP.
+ */
+class MpTcpCoupledScalable : public MpTcpCongestionOps // COUPLED_SCALABLE_TCP
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+class MpTcpUncoupledInc : public MpTcpCongestionOps // UNCOUPLED
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+class MpTcpCoupledEpsilon : public MpTcpCongestionOps // COUPLED_EPSILON
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpCoupledEpsilon();
+  virtual void IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+
+private:
+  double ComputeAlpha(Ptr<MpTcpSocketBase> socket);
+  double m_epsilon;
+  double m_alpha;
+};
+
+class MpTcpCoupledInc : public MpTcpCongestionOps // COUPLED_INC
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpCoupledInc();
+  virtual void IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+
+private:
+  uint32_t ComputeAScaled(Ptr<MpTcpSocketBase> socket);
+  uint32_t m_a; // Aggressiveness, scaled by A_SCALE
+};
+
+class MpTcpCoupledFully : public MpTcpCongestionOps // COUPLED_FULLY
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+};
+
+/*
+ * XMP (Cao et al., "Explicit multipath congestion control for data center networks",
+ * CoNEXT 2013). Windows grow once per round by the subflow weight and shrink by 1/beta
+ * once per round on ECN echoes.
+ */
+class MpTcpXmp : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual void IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual void EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual void EcnEcho(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+
+private:
+  struct SubflowState
+  {
+    SubflowState();
+    uint32_t begSeq;      // Sequence number that ends the current round
+    uint64_t rounds;
+    double weight;
+    double equilibrium;   // Rate of the last round, Mbps
+    double instantRate;   // Smoothed rate, Mbps
+    uint32_t cwr;         // 0: disable, 1: normal, 2: cwr
+    uint32_t refWin;      // cwnd in segments at the start of the round
+    double incCum;        // Increase not applied yet, in segments
+    uint32_t cwrHighSeq;  // Quit cwr once acknowledged
+  };
+  SubflowState &GetState(uint8_t sFlowIdx);
+  void EnterCwr(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+
+  std::vector<SubflowState> m_state; // Indexed by subflow
+};
+
+/*
+ * OLIA (Khalili et al., "MPTCP is not Pareto-optimal: performance issues and a possible
+ * solution", CoNEXT 2012). LIA like coupling, plus a term that moves window from the
+ * subflows with the largest windows to the presumably best subflows.
+ */
+class MpTcpOlia : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual void IncreaseWindow(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual void EnterRecovery(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+
+private:
+  struct SubflowState
+  {
+    SubflowState();
+    uint64_t lastLossBytes; // Bytes acknowledged between the last two losses
+    uint64_t sinceLoss;     // Bytes acknowledged since the last loss
+  };
+  SubflowState &GetState(uint8_t sFlowIdx);
+  void Loss(uint8_t sFlowIdx);
+
+  std::vector<SubflowState> m_state; // Indexed by subflow
+};
+
+/*
+ * BALIA (Peng et al., "Multipath TCP: analysis, design, and implementation",
+ * IEEE/ACM ToN 2016), balances friendliness and responsiveness between LIA and OLIA.
+ */
+class MpTcpBalia : public MpTcpCongestionOps
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual uint32_t GetSsThresh(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t flightSize);
+  virtual Ptr<MpTcpCongestionOps> Copy() const;
+
+protected:
+  virtual void CongestionAvoidance(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ackedBytes);
+
+private:
+  double GetAlpha(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, double &rate, double &totalRate); // max_k x_k / x_r
+};
+
+/*
+ * DCTCP (Alizadeh et al., "Data center TCP (DCTCP)", SIGCOMM 2010) on top of any of the
+ * congestion ops above. The fraction of segments echoed with ECE is measured once per
+ * window and smoothed into alpha, cwnd is then cut by alpha / 2 at most once per window.
+ * The socket creates it once DCTCP is enabled, its configuration stays in the socket
+ * attributes (DCTCPWeight, DctcpAlphaPerAck, SlowDownXmpLike, ...).
+ */
+class MpTcpDctcp : public Object
+{
+public:
+  static TypeId GetTypeId(void);
+  void UpdateAlpha(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t ack); // Count the segments acknowledged, new alpha at the end of the window
+  bool SlowDownDue(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);              // The window of the last cut has been acknowledged
+  void SlowDown(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);                  // cwnd * (1 - alpha / 2)
+  void SlowDownXmpLike(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);           // Same, only in congestion avoidance
+  void SlowDownEcnLike(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);           // cwnd * (1 - gamma / beta), whatever alpha is
+  void SlowDownFastReTx(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, DSNMapping *ptrDSN); // Fast retransmit, DCTCP cut instead of halving
+  void OnTimeout(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);                 // Next window starts at the retransmission
+  void RecordFastRetx(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, uint32_t oldCwnd); // Debugging, appends to the socket's DCTCP output file
+  double GetAlpha(uint8_t sFlowIdx) const;
+  double GetMarkedFraction(uint8_t sFlowIdx) const; // Over the last complete window
+
+private:
+  struct SubflowState
+  {
+    SubflowState();
+    uint32_t total;        // Segments acknowledged in the current window
+    uint32_t marked;       // Of which with ECE
+    uint32_t alphaUpdateSeq; // Ends the current window
+    uint32_t maxSeq;       // No other cut until acknowledged
+    double alpha;
+    double lastFraction;   // marked / total of the last window
+  };
+  SubflowState &GetState(uint8_t sFlowIdx);
+  void ReduceCwnd(Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx, double factor); // cwnd and ssthresh to cwnd * factor
+
+  std::vector<SubflowState> m_state; // Indexed by subflow
+};
+
+} //namespace ns3
+#endif //MP_TCP_CONGESTION_OPS_H
@@ -0,0 +1,184 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include <cmath>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/mp-tcp-rtt-stats.h"
+
+namespace ns3
+{
+
+const uint32_t MpTcpRttStats::BUCKETS;
+
+MpTcpRttStats::MpTcpRttStats() :
+    window(Seconds(10).GetNanoSeconds())
+{
+  Reset();
+}
+
+void
+MpTcpRttStats::Reset()
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      minSample[i].time = 0;
+      minSample[i].rtt = 0;
+    }
+  latest = 0;
+  srtt = 0;
+  rttvar = 0;
+  samples = 0;
+  for (uint32_t i = 0; i < BUCKETS; i++)
+    histogram[i] = 0;
+}
+
+void
+MpTcpRttStats::SetMinWindow(Time w)
+{
+  NS_ASSERT(w.IsStrictlyPositive());
+  window = w.GetNanoSeconds();
+}
+
+void
+MpTcpRttStats::AddSample(Time rtt, Time now)
+{
+  int64_t r = rtt.GetNanoSeconds();
+  int64_t t = now.GetNanoSeconds();
+  if (r <= 0)
+    return;
+  latest = r;
+
+  // RFC 6298
+  if (srtt == 0)
+    {
+      srtt = r;
+      rttvar = r / 2;
+    }
+  else
+    {
+      int64_t delta = (srtt > r) ? srtt - r : r - srtt;
+      rttvar = (3 * rttvar + delta) / 4;
+      srtt = (7 * srtt + r) / 8;
+    }
+
+  // Windowed min, minSample[0] is the minimum and [1], [2] the best candidates of the later
+  // quarter and half of the window, which take over when the minimum gets too old
+  MinSample_t s;
+  s.time = t;
+  s.rtt = r;
+  if (samples == 0 || r <= minSample[0].rtt || t - minSample[2].time > window)
+    minSample[0] = minSample[1] = minSample[2] = s;
+  else
+    {
+      if (r <= minSample[1].rtt)
+        minSample[1] = minSample[2] = s;
+      else if (r <= minSample[2].rtt)
+        minSample[2] = s;
+      int64_t dt = t - minSample[0].time;
+      if (dt > window)
+        {
+          minSample[0] = minSample[1];
+          minSample[1] = minSample[2];
+          minSample[2] = s;
+          if (t - minSample[0].time > window)
+            {
+              minSample[0] = minSample[1];
+              minSample[1] = minSample[2];
+            }
+        }
+      else if (minSample[1].time == minSample[0].time && dt > window / 4)
+        minSample[1] = minSample[2] = s;
+      else if (minSample[2].time == minSample[1].time && dt > window / 2)
+        minSample[2] = s;
+    }
+
+  histogram[BucketOf(r)]++;
+  samples++;
+}
+
+void
+MpTcpRttStats::Merge(const MpTcpRttStats &stats)
+{
+  for (uint32_t i = 0; i < BUCKETS; i++)
+    histogram[i] += stats.histogram[i];
+  samples += stats.samples;
+}
+
+uint64_t
+MpTcpRttStats::GetSampleCount() const
+{
+  return samples;
+}
+
+Time
+MpTcpRttStats::GetLatest() const
+{
+  return NanoSeconds(latest);
+}
+
+Time
+MpTcpRttStats::GetSmoothed() const
+{
+  return NanoSeconds(srtt);
+}
+
+Time
+MpTcpRttStats::GetVariation() const
+{
+  return NanoSeconds(rttvar);
+}
+
+Time
+MpTcpRttStats::GetMin() const
+{
+  return NanoSeconds(minSample[0].rtt);
+}
+
+// Middle of the bucket holding the sample of rank ceil(p * samples)
+Time
+MpTcpRttStats::GetPercentile(double p) const
+{
+  if (samples == 0)
+    return Seconds(0);
+  p = std::min(std::max(p, 0.0), 1.0);
+  uint64_t rank = std::max((uint64_t) std::ceil(p * samples), (uint64_t) 1);
+  uint64_t seen = 0;
+  uint32_t bucket = 0;
+  for (; bucket < BUCKETS - 1; bucket++)
+    {
+      seen += histogram[bucket];
+      if (seen >= rank)
+        break;
+    }
+  if (bucket == BUCKETS - 1)
+    return NanoSeconds(BucketLow(bucket));
+  return NanoSeconds((BucketLow(bucket) + BucketLow(bucket + 1)) / 2);
+}
+
+// Bucket 0 holds everything below 1024ns, bucket 1 + 4 * octave + quarter the rest
+uint32_t
+MpTcpRttStats::BucketOf(uint64_t ns)
+{
+  if (ns < 1024)
+    return 0;
+  uint32_t msb = 63;
+  while (!(ns >> msb))
+    msb--;
+  uint32_t bucket = 1 + 4 * (msb - 10) + ((ns >> (msb - 2)) & 3);
+  return std::min(bucket, BUCKETS - 1);
+}
+
+uint64_t
+MpTcpRttStats::BucketLow(uint32_t bucket)
+{
+  if (bucket == 0)
+    return 0;
+  uint32_t octave = (bucket - 1) / 4;
+  uint64_t quarter = (bucket - 1) % 4;
+  return (4 + quarter) << (octave + 8);
+}
+
+} //namespace ns3
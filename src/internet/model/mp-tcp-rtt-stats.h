@@ -0,0 +1,59 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_RTT_STATS_H
+#define MP_TCP_RTT_STATS_H
+
+#include <stdint.h>
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+
+/*
+ * Summary of the RTT samples of a subflow, in constant memory whatever the number of samples.
+ * Keeps the windowed minimum (the three sample min filter of Linux win_minmax), the RFC 6298
+ * smoothed RTT and variation, and a histogram with logarithmic buckets, 4 per octave from 1us,
+ * which answers percentiles within half a bucket, 12.5% of the value at most.
+ * Histograms of several subflows can be merged for percentiles of a whole connection.
+ */
+class MpTcpRttStats
+{
+public:
+  static const uint32_t BUCKETS = 4 * 26 + 1; // Below 1us, then 4 per octave up to about 69s
+
+  MpTcpRttStats();
+  void Reset();
+  void AddSample(Time rtt, Time now);
+  void Merge(const MpTcpRttStats &stats);   // Adds the histogram of stats, the other estimates are left as they are
+  void SetMinWindow(Time window);           // 10s by default
+  uint64_t GetSampleCount() const;
+  Time GetLatest() const;
+  Time GetSmoothed() const;                 // Zero before the first sample
+  Time GetVariation() const;
+  Time GetMin() const;                      // Smallest sample of the last window
+  Time GetPercentile(double p) const;       // p in [0, 1], zero before the first sample
+
+  static uint32_t BucketOf(uint64_t ns);
+  static uint64_t BucketLow(uint32_t bucket); // Smallest value of the bucket in ns
+
+private:
+  struct MinSample_t
+  {
+    int64_t time;
+    int64_t rtt;
+  };
+
+  int64_t window;
+  MinSample_t minSample[3];       // Best, second best and third best of the window, in ns
+  int64_t latest;
+  int64_t srtt;
+  int64_t rttvar;
+  uint64_t samples;
+  uint32_t histogram[BUCKETS];
+};
+
+} //namespace ns3
+#endif //MP_TCP_RTT_STATS_H
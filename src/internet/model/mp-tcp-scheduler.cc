@@ -0,0 +1,241 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/mp-tcp-scheduler.h"
+#include "ns3/mp-tcp-socket-base.h"
+
+NS_LOG_COMPONENT_DEFINE("MpTcpScheduler");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(MpTcpScheduler);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpRoundRobinScheduler);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpLowestRttScheduler);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpBlestScheduler);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpCwndWeightedScheduler);
+
+TypeId
+MpTcpScheduler::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpScheduler")
+      .SetParent<Object>();
+  return tid;
+}
+
+MpTcpScheduler::~MpTcpScheduler()
+{
+}
+
+uint32_t
+MpTcpScheduler::GetSubflowCount(const Ptr<MpTcpSocketBase> &socket)
+{
+  return socket->subflows.size();
+}
+
+Ptr<MpTcpSubFlow>
+MpTcpScheduler::GetSubflow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx)
+{
+  return socket->subflows[sFlowIdx];
+}
+
+uint32_t
+MpTcpScheduler::GetUsableWindow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx)
+{
+  return socket->UsableWindow(sFlowIdx);
+}
+
+uint32_t
+MpTcpScheduler::GetBytesInFlight(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx)
+{
+  return socket->BytesInFlight(sFlowIdx);
+}
+
+double
+MpTcpScheduler::GetSendWindow(const Ptr<MpTcpSocketBase> &socket)
+{
+  double window = (double) socket->m_rwndScale * socket->remoteRecvWnd;
+  for (uint32_t i = 0; i < socket->subflows.size(); i++)
+    window -= socket->BytesInFlight(i);
+  return window;
+}
+
+TypeId
+MpTcpRoundRobinScheduler::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpRoundRobinScheduler")
+      .SetParent<MpTcpScheduler>()
+      .AddConstructor<MpTcpRoundRobinScheduler>();
+  return tid;
+}
+
+MpTcpRoundRobinScheduler::MpTcpRoundRobinScheduler() :
+    nextSubflow(0)
+{
+}
+
+Ptr<MpTcpScheduler>
+MpTcpRoundRobinScheduler::Copy() const
+{
+  return CopyObject<MpTcpRoundRobinScheduler>(this);
+}
+
+int
+MpTcpRoundRobinScheduler::GetSubflowToUse(Ptr<MpTcpSocketBase> socket)
+{
+  uint32_t n = GetSubflowCount(socket);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint8_t sFlowIdx = (nextSubflow + i) % n;
+      if (GetUsableWindow(socket, sFlowIdx) > 0)
+        {
+          nextSubflow = (sFlowIdx + 1) % n;
+          return sFlowIdx;
+        }
+    }
+  return -1;
+}
+
+TypeId
+MpTcpLowestRttScheduler::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpLowestRttScheduler")
+      .SetParent<MpTcpScheduler>()
+      .AddConstructor<MpTcpLowestRttScheduler>();
+  return tid;
+}
+
+Ptr<MpTcpScheduler>
+MpTcpLowestRttScheduler::Copy() const
+{
+  return CopyObject<MpTcpLowestRttScheduler>(this);
+}
+
+int
+MpTcpLowestRttScheduler::GetSubflowToUse(Ptr<MpTcpSocketBase> socket)
+{
+  int best = -1;
+  Time bestRtt;
+  for (uint32_t i = 0; i < GetSubflowCount(socket); i++)
+    {
+      if (GetUsableWindow(socket, i) == 0)
+        continue;
+      Time rtt = GetSubflow(socket, i)->rtt->GetCurrentEstimate();
+      if (best < 0 || rtt < bestRtt)
+        {
+          best = i;
+          bestRtt = rtt;
+        }
+    }
+  return best;
+}
+
+TypeId
+MpTcpBlestScheduler::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpBlestScheduler")
+      .SetParent<MpTcpScheduler>()
+      .AddConstructor<MpTcpBlestScheduler>()
+      .AddAttribute("Lambda", "Scaling of the data the fast subflow is expected to send during one RTT of the slow subflow",
+          DoubleValue(1.0),
+          MakeDoubleAccessor(&MpTcpBlestScheduler::m_lambda),
+          MakeDoubleChecker<double>(0.0));
+  return tid;
+}
+
+MpTcpBlestScheduler::MpTcpBlestScheduler() :
+    m_lambda(1.0)
+{
+}
+
+Ptr<MpTcpScheduler>
+MpTcpBlestScheduler::Copy() const
+{
+  return CopyObject<MpTcpBlestScheduler>(this);
+}
+
+int
+MpTcpBlestScheduler::GetSubflowToUse(Ptr<MpTcpSocketBase> socket)
+{
+  int fast = -1;  // Lowest RTT subflow, whether it can send or not
+  int slow = -1;  // Lowest RTT subflow that can send
+  Time fastRtt, slowRtt;
+  for (uint32_t i = 0; i < GetSubflowCount(socket); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = GetSubflow(socket, i);
+      if (sFlow->state != ESTABLISHED)
+        continue;
+      Time rtt = sFlow->rtt->GetCurrentEstimate();
+      if (fast < 0 || rtt < fastRtt)
+        {
+          fast = i;
+          fastRtt = rtt;
+        }
+      if (GetUsableWindow(socket, i) > 0 && (slow < 0 || rtt < slowRtt))
+        {
+          slow = i;
+          slowRtt = rtt;
+        }
+    }
+  if (slow < 0 || slow == fast)
+    return slow;
+
+  // Would the fast subflow be blocked by the send window while the segment is in flight on the slow one?
+  Ptr<MpTcpSubFlow> fastFlow = GetSubflow(socket, fast);
+  Ptr<MpTcpSubFlow> slowFlow = GetSubflow(socket, slow);
+  double ratio = fastRtt.IsZero() ? 1.0 : slowRtt.GetSeconds() / fastRtt.GetSeconds();
+  double fastCwnd = (double) fastFlow->cwnd.Get() / fastFlow->MSS;
+  double fastBytes = fastFlow->MSS * (fastCwnd + (ratio - 1.0) / 2.0) * ratio;
+  double slowBytes = GetBytesInFlight(socket, slow) + slowFlow->MSS;
+  if (fastBytes * m_lambda > GetSendWindow(socket) - slowBytes)
+    {
+      NS_LOG_LOGIC("BLEST: holding segment for subflow " << fast << " instead of " << slow);
+      return -1;
+    }
+  return slow;
+}
+
+TypeId
+MpTcpCwndWeightedScheduler::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpCwndWeightedScheduler")
+      .SetParent<MpTcpScheduler>()
+      .AddConstructor<MpTcpCwndWeightedScheduler>();
+  return tid;
+}
+
+Ptr<MpTcpScheduler>
+MpTcpCwndWeightedScheduler::Copy() const
+{
+  return CopyObject<MpTcpCwndWeightedScheduler>(this);
+}
+
+int
+MpTcpCwndWeightedScheduler::GetSubflowToUse(Ptr<MpTcpSocketBase> socket)
+{
+  uint32_t n = GetSubflowCount(socket);
+  if (credit.size() < n)
+    credit.resize(n, 0);
+  int best = -1;
+  int64_t total = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (GetUsableWindow(socket, i) == 0)
+        continue;
+      Ptr<MpTcpSubFlow> sFlow = GetSubflow(socket, i);
+      int64_t weight = std::max<uint32_t>(sFlow->cwnd.Get() / sFlow->MSS, 1);
+      credit[i] += weight;
+      total += weight;
+      if (best < 0 || credit[i] > credit[best])
+        best = i;
+    }
+  if (best >= 0)
+    credit[best] -= total;
+  return best;
+}
+
+} //namespace ns3
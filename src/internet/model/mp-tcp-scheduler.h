@@ -0,0 +1,104 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_SCHEDULER_H
+#define MP_TCP_SCHEDULER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+namespace ns3
+{
+
+class MpTcpSocketBase;
+class MpTcpSubFlow;
+
+/*
+ * Picks the subflow that carries the next segment of a connection.
+ * Schedulers only return subflows that can send right now (established and with
+ * usable window), so the sender never has to probe subflows one after the other.
+ * A scheduler instance belongs to a single connection and may keep per connection state.
+ */
+class MpTcpScheduler : public Object
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual ~MpTcpScheduler();
+  virtual int GetSubflowToUse(Ptr<MpTcpSocketBase> socket) = 0; // Subflow index, -1 if no subflow should send now
+  virtual Ptr<MpTcpScheduler> Copy() const = 0;                  // Same scheduler and configuration, for a forked socket
+
+protected:
+  // Read access to the connection, shared by all schedulers
+  static uint32_t GetSubflowCount(const Ptr<MpTcpSocketBase> &socket);
+  static Ptr<MpTcpSubFlow> GetSubflow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx);
+  static uint32_t GetUsableWindow(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx); // 0 if sFlowIdx cannot send now
+  static uint32_t GetBytesInFlight(const Ptr<MpTcpSocketBase> &socket, uint8_t sFlowIdx);
+  static double GetSendWindow(const Ptr<MpTcpSocketBase> &socket);   // Peer window left at connection level
+};
+
+/*
+ * Next subflow after the last one used that can send, i.e. the historical Round_Robin.
+ */
+class MpTcpRoundRobinScheduler : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpRoundRobinScheduler();
+  virtual int GetSubflowToUse(Ptr<MpTcpSocketBase> socket);
+  virtual Ptr<MpTcpScheduler> Copy() const;
+
+private:
+  uint8_t nextSubflow;
+};
+
+/*
+ * Subflow with the lowest smoothed RTT among those that can send.
+ */
+class MpTcpLowestRttScheduler : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual int GetSubflowToUse(Ptr<MpTcpSocketBase> socket);
+  virtual Ptr<MpTcpScheduler> Copy() const;
+};
+
+/*
+ * BLEST (Ferlin et al., "BLEST: Blocking estimation-based MPTCP scheduler for
+ * heterogeneous networks", IFIP Networking 2016).
+ * Uses the lowest RTT subflow when it can send. Otherwise the next fastest subflow is
+ * only used if the data the fast subflow can send during one slow subflow RTT still
+ * fits in the connection send window, else the segment waits for the fast subflow.
+ */
+class MpTcpBlestScheduler : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpBlestScheduler();
+  virtual int GetSubflowToUse(Ptr<MpTcpSocketBase> socket);
+  virtual Ptr<MpTcpScheduler> Copy() const;
+
+private:
+  double m_lambda; // Scales the estimate of what the fast subflow sends during a slow subflow RTT
+};
+
+/*
+ * Smooth weighted round robin over the subflows that can send, weighted by their cwnd,
+ * so each subflow gets a share of the segments proportional to its congestion window.
+ */
+class MpTcpCwndWeightedScheduler : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual int GetSubflowToUse(Ptr<MpTcpSocketBase> socket);
+  virtual Ptr<MpTcpScheduler> Copy() const;
+
+private:
+  std::vector<int64_t> credit; // Indexed by subflow
+};
+
+} //namespace ns3
+#endif //MP_TCP_SCHEDULER_H
@@ -0,0 +1,211 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/mp-tcp-scoreboard.h"
+
+namespace ns3
+{
+
+MpTcpScoreboard::MpTcpScoreboard() :
+    covered(0), highRxt(0), coveredBelowRxt(0)
+{
+}
+
+void
+MpTcpScoreboard::Clear()
+{
+  ranges.clear();
+  covered = 0;
+  highRxt = 0;
+  coveredBelowRxt = 0;
+}
+
+uint32_t
+MpTcpScoreboard::Add(uint32_t left, uint32_t right)
+{
+  if (left >= right)
+    return 0;
+  // First range that overlaps or touches [left, right)
+  RangeMap_t::iterator it = ranges.upper_bound(left);
+  if (it != ranges.begin())
+    {
+      RangeMap_t::iterator prev = it;
+      --prev;
+      if (prev->second >= left)
+        it = prev;
+    }
+  uint32_t newLeft = left;
+  uint32_t newRight = right;
+  uint32_t added = 0;
+  uint32_t pos = left; // Bytes below pos are already accounted for
+  while (it != ranges.end() && it->first <= right)
+    {
+      if (it->first > pos)
+        { // Gap [pos, it->first) gets covered
+          added += it->first - pos;
+          if (pos < highRxt)
+            coveredBelowRxt += std::min(it->first, highRxt) - pos;
+        }
+      pos = std::max(pos, it->second);
+      newLeft = std::min(newLeft, it->first);
+      newRight = std::max(newRight, it->second);
+      ranges.erase(it++);
+    }
+  if (pos < right)
+    {
+      added += right - pos;
+      if (pos < highRxt)
+        coveredBelowRxt += std::min(right, highRxt) - pos;
+    }
+  ranges[newLeft] = newRight;
+  covered += added;
+  return added;
+}
+
+void
+MpTcpScoreboard::DiscardBelow(uint32_t seq)
+{
+  while (!ranges.empty() && ranges.begin()->first < seq)
+    {
+      uint32_t left = ranges.begin()->first;
+      uint32_t right = ranges.begin()->second;
+      uint32_t cut = std::min(right, seq);
+      covered -= cut - left;
+      if (left < highRxt)
+        coveredBelowRxt -= std::min(cut, highRxt) - left;
+      ranges.erase(ranges.begin());
+      if (right > seq)
+        {
+          ranges[seq] = right;
+          break;
+        }
+    }
+  if (seq > highRxt)
+    { // Nothing is covered below seq anymore
+      highRxt = seq;
+      coveredBelowRxt = 0;
+    }
+}
+
+bool
+MpTcpScoreboard::GetRange(uint32_t seq, uint32_t &left, uint32_t &right) const
+{
+  RangeMap_t::const_iterator it = ranges.upper_bound(seq);
+  if (it == ranges.begin())
+    return false;
+  --it;
+  if (it->second <= seq)
+    return false;
+  left = it->first;
+  right = it->second;
+  return true;
+}
+
+bool
+MpTcpScoreboard::GetFirstRange(uint32_t &left, uint32_t &right) const
+{
+  if (ranges.empty())
+    return false;
+  left = ranges.begin()->first;
+  right = ranges.begin()->second;
+  return true;
+}
+
+uint32_t
+MpTcpScoreboard::NextHole(uint32_t seq) const
+{
+  uint32_t left, right;
+  if (GetRange(seq, left, right))
+    return right; // Touching ranges are merged, so right is not covered
+  return seq;
+}
+
+uint32_t
+MpTcpScoreboard::GetCoveredBytes() const
+{
+  return covered;
+}
+
+uint32_t
+MpTcpScoreboard::GetRangeCount() const
+{
+  return ranges.size();
+}
+
+uint32_t
+MpTcpScoreboard::GetHighRxt() const
+{
+  return highRxt;
+}
+
+void
+MpTcpScoreboard::SetHighRxt(uint32_t seq)
+{
+  if (seq < highRxt)
+    { // Only moves back when recovery starts over, count from scratch
+      highRxt = 0;
+      coveredBelowRxt = 0;
+    }
+  RangeMap_t::const_iterator it = ranges.upper_bound(highRxt);
+  if (it != ranges.begin())
+    {
+      RangeMap_t::const_iterator prev = it;
+      --prev;
+      if (prev->second > highRxt)
+        it = prev;
+    }
+  for (; it != ranges.end() && it->first < seq; ++it)
+    coveredBelowRxt += std::min(it->second, seq) - std::max(it->first, highRxt);
+  highRxt = seq;
+}
+
+// Walks down from the highest range, which stops after at most dupThresh ranges
+uint32_t
+MpTcpScoreboard::Frontier(uint32_t dupThresh, uint32_t mss, uint32_t &coveredAbove) const
+{
+  uint32_t count = 0;
+  coveredAbove = 0;
+  for (RangeMap_t::const_reverse_iterator it = ranges.rbegin(); it != ranges.rend(); ++it)
+    {
+      coveredAbove += it->second - it->first;
+      if (++count >= dupThresh || coveredAbove > (dupThresh - 1) * mss)
+        return it->first;
+    }
+  return 0;
+}
+
+// RFC 6675 IsLost(): dupThresh discontiguous SACKed ranges or more than (dupThresh - 1) * mss SACKed bytes above
+uint32_t
+MpTcpScoreboard::GetLossFrontier(uint32_t dupThresh, uint32_t mss) const
+{
+  uint32_t coveredAbove;
+  return Frontier(dupThresh, mss, coveredAbove);
+}
+
+/*
+ * RFC 6675 SetPipe(): every byte in flight counts once, except SACKed bytes and bytes that are
+ * lost and not retransmitted yet, which do not count. The holes below HighRxt have all been
+ * retransmitted, so only the holes between HighRxt and the loss frontier are left out.
+ */
+uint32_t
+MpTcpScoreboard::GetPipe(uint32_t highAck, uint32_t highData, uint32_t dupThresh, uint32_t mss) const
+{
+  NS_ASSERT(highData - highAck >= covered);
+  uint32_t pipe = highData - highAck - covered;
+  uint32_t coveredAbove;
+  uint32_t frontier = Frontier(dupThresh, mss, coveredAbove);
+  uint32_t rxt = std::max(highRxt, highAck);
+  if (frontier > rxt)
+    {
+      uint32_t coveredBelow = (rxt == highRxt) ? coveredBelowRxt : 0;
+      uint32_t lost = (frontier - rxt) - (covered - coveredBelow - coveredAbove);
+      pipe -= std::min(pipe, lost);
+    }
+  return pipe;
+}
+
+} //namespace ns3
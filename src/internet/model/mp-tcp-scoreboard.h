@@ -0,0 +1,54 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_SCOREBOARD_H
+#define MP_TCP_SCOREBOARD_H
+
+#include <stdint.h>
+#include <map>
+
+namespace ns3
+{
+
+/*
+ * Subflow sequence ranges covered by SACK blocks.
+ * A sender keeps one per subflow as its RFC 6675 scoreboard, a receiver one for the segments
+ * it holds above RxSeqNumber, which it reports in its SACK blocks.
+ * Ranges are kept merged in a map keyed by their left edge, and the byte counts the loss and
+ * pipe estimates need are kept up to date as ranges come and go, so handling an ACK costs
+ * O(log n) (amortized) in the number of ranges rather than a walk over the window.
+ */
+class MpTcpScoreboard
+{
+public:
+  MpTcpScoreboard();
+  void Clear();
+  uint32_t Add(uint32_t left, uint32_t right);  // Covers [left, right), returns the bytes that were not covered yet
+  void DiscardBelow(uint32_t seq);              // Forgets everything below seq, e.g. on a cumulative ACK
+  bool GetRange(uint32_t seq, uint32_t &left, uint32_t &right) const; // Range holding seq
+  bool GetFirstRange(uint32_t &left, uint32_t &right) const;
+  uint32_t NextHole(uint32_t seq) const;        // Lowest sequence number >= seq that is not covered
+  uint32_t GetCoveredBytes() const;
+  uint32_t GetRangeCount() const;
+
+  // RFC 6675 sender side, sequence numbers are those of the subflow
+  uint32_t GetHighRxt() const;
+  void SetHighRxt(uint32_t seq);                // One past the highest retransmitted byte
+  uint32_t GetLossFrontier(uint32_t dupThresh, uint32_t mss) const; // IsLost() holds for the holes below it, 0 if none
+  uint32_t GetPipe(uint32_t highAck, uint32_t highData, uint32_t dupThresh, uint32_t mss) const; // Bytes in flight, highAck is the
+                                                                                                 // first unacked byte, highData one past the last sent
+
+private:
+  typedef std::map<uint32_t, uint32_t> RangeMap_t; // Left edge -> right edge (excluded)
+  uint32_t Frontier(uint32_t dupThresh, uint32_t mss, uint32_t &coveredAbove) const;
+
+  RangeMap_t ranges;
+  uint32_t covered;         // Bytes in ranges
+  uint32_t highRxt;
+  uint32_t coveredBelowRxt; // Bytes in ranges below highRxt
+};
+
+} //namespace ns3
+#endif //MP_TCP_SCOREBOARD_H
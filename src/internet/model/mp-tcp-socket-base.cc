@@ -25,9 +25,6 @@
 #include "ns3/drop-tail-queue.h"
 #include "ns3/object-vector.h"
 #include "ns3/flow-id-tag.h"
-#include "ns3/ce-tag.h"
-#include "ns3/ece-tag.h"
-#include "ns3/ect-tag.h"
 #include "ns3/control-tag.h"
 #include "ns3/ecmp-tag.h"
 
@@ -56,12 +53,13 @@ MpTcpSocketBase::GetTypeId (void)
                      MakeEnumAccessor (&MpTcpSocketBase::SetCongestionCtrlAlgo),
                      MakeEnumChecker (Uncoupled_TCPs, "Uncoupled_TCPs", Fully_Coupled, "Fully_Coupled", RTT_Compensator, "RTT_Compensator",
                            Linked_Increases, "Linked_Increases", COUPLED_INC, "COUPLED_INC", COUPLED_EPSILON, "COUPLED_EPSILON",
-                           COUPLED_SCALABLE_TCP, "COUPLED_SCALABLE_TCP", COUPLED_FULLY, "COUPLED_FULLY", UNCOUPLED, "UNCOUPLED", XMP, "XMP", Fast_Uncoupled, "Fast_Uncoupled", Fast_Increases, "Fast_Increases", XCA, "XCA"))
+                           COUPLED_SCALABLE_TCP, "COUPLED_SCALABLE_TCP", COUPLED_FULLY, "COUPLED_FULLY", UNCOUPLED, "UNCOUPLED", XMP, "XMP", Fast_Uncoupled, "Fast_Uncoupled", Fast_Increases, "Fast_Increases", XCA, "XCA",
+                           OLIA, "OLIA", BALIA, "BALIA"))
       .AddAttribute ("SchedulingAlgorithm",
                      "Algorithm for data distribution between sub-flows",
                      EnumValue (Round_Robin),
                      MakeEnumAccessor (&MpTcpSocketBase::SetDataDistribAlgo),
-                     MakeEnumChecker (Round_Robin, "Round_Robin"))
+                     MakeEnumChecker (Round_Robin, "Round_Robin", Lowest_RTT, "Lowest_RTT", Blest, "Blest", Cwnd_Weighted, "Cwnd_Weighted"))
       .AddAttribute ("PathManagement",
                      "Mechanism for establishing new sub-flows",
                      EnumValue (NdiffPorts),
@@ -123,6 +121,11 @@ MpTcpSocketBase::GetTypeId (void)
                      DoubleValue (0.1),
                      MakeDoubleAccessor (&MpTcpSocketBase::m_rateInterval),
                      MakeDoubleChecker<double>())
+      .AddAttribute ("TraceSink",
+                     "Sink receiving the plotting samples of the socket instead of its in memory vectors, e.g. ns3::MpTcpFileTraceSink",
+                     PointerValue (),
+                     MakePointerAccessor (&MpTcpSocketBase::m_traceSink),
+                     MakePointerChecker<MpTcpTraceSink> ())
       .AddAttribute ("DCTCP",
                      "DCTCP flavored socket",
                      BooleanValue (false),
@@ -202,6 +205,63 @@ MpTcpSocketBase::GetTypeId (void)
                    UintegerValue (10000000), // 10MB
                    MakeUintegerAccessor (&MpTcpSocketBase::m_ADCTthresh),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DelayedAckCount",
+                   "Number of in order segments a subflow acknowledges with one ACK, 1 acknowledges every segment",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MpTcpSocketBase::m_delayedAckCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DelayedAckTimeout",
+                   "Longest time an ACK is held back when DelayedAckCount is larger than 1",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&MpTcpSocketBase::m_delayedAckTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("SendBurst",
+                   "Send back to back segments on the picked subflow until its usable window, computed once, is used up",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::m_sendBurst),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SegmentOffload",
+                   "With SendBurst, read each burst from the sending buffer at once and cut its segments out of it",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::m_segmentOffload),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Sack",
+                   "Receivers report out of order segments in SACK blocks and senders recover from loss with a scoreboard (RFC 6675), both ends must enable it",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::m_sack),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LossRecovery",
+                   "How subflows detect lost segments: after dupAckThresh duplicated ACKs, or from the send times of delivered segments with a tail loss probe (RACK-TLP). Without Sack the duplicated ACK threshold still applies",
+                   EnumValue (DupAck_Recovery),
+                   MakeEnumAccessor (&MpTcpSocketBase::m_lossRecovery),
+                   MakeEnumChecker (DupAck_Recovery, "DupAck_Recovery", Rack_Tlp, "Rack_Tlp"))
+    .AddAttribute ("Payload",
+                   "Carry the application's bytes end to end (FillBuffer/RecvPacket with packets), segments are fragments of the queued data rather than zero-filled",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::SetPayloadMode, &MpTcpSocketBase::GetPayloadMode),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimerWheel",
+                   "Run the subflow retransmission timers on a timer wheel shared by the node, so restarting them on every new ACK does not touch the simulator event queue. Timers expire up to one wheel tick late",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::m_timerWheel),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Timestamps",
+                   "Subflow segments carry timestamps which ACKs echo (RFC 7323), so every ACK yields an RTT sample rather than one per window. Both ends need it",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpSocketBase::m_timestamps),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("TotalWindow",
+                     "Sum of the subflow windows (ssthresh while in fast recovery)",
+                     MakeTraceSourceAccessor (&MpTcpSocketBase::m_totalWindow))
+    .AddTraceSource ("CoupledWindow",
+                     "Sum of the coupled subflow windows (ssthresh while in fast recovery)",
+                     MakeTraceSourceAccessor (&MpTcpSocketBase::m_coupledWindow))
+    .AddTraceSource ("CoupledRate",
+                     "Sum of cwnd / rtt over the coupled subflows, rtt in microseconds",
+                     MakeTraceSourceAccessor (&MpTcpSocketBase::m_coupledRate))
+    .AddTraceSource ("CoupledMaxRate2",
+                     "Largest cwnd / rtt^2 among the coupled subflows, rtt in microseconds",
+                     MakeTraceSourceAccessor (&MpTcpSocketBase::m_coupledMaxRate2))
 //     .AddAttribute ("SlowDownEcnLike",
 //                    "Slow down sending rate based on ECN",
 //                    BooleanValue (false),
@@ -232,7 +292,15 @@ MpTcpSocketBase::MpTcpSocketBase () :
   addrAdvertised = false;
   mpTokenRegister = false;
   lastUsedsFlowIdx = 0;
+  distribAlgo = Round_Robin;
   totalCwnd = 0;
+  m_totalWindow = 0;
+  m_coupledWindow = 0;
+  m_coupledRate = 0;
+  m_coupledMaxRate2 = 0;
+  m_coupledMaxIdx = -1;
+  m_attachedSubflows = 0;
+  m_burstOffset = 0;
   localToken = 0;
   remoteToken = 0;
   client = false;
@@ -262,9 +330,6 @@ MpTcpSocketBase::MpTcpSocketBase () :
   hasSampleListDone = false;
   flowSize = 0;
   m_totalSentBytes = 0;
-  alpha = 1; // alpha is 1 by default
-  _e = 1;    // epsilon 1 by default
-  a = A_SCALE;
   m_slowDownEcnLike = false;
   m_dctcpFastAlpha  = false;
   m_initialRand = rand() % 230;
@@ -340,6 +405,8 @@ MpTcpSocketBase::~MpTcpSocketBase (void)
     }
   m_tcp = 0;
   CancelAllSubflowTimers ();
+  DestroyUnOrdered ();
+  DetachSubflows ();
   NS_LOG_INFO(Simulator::Now().GetSeconds() << " ["<< this << "] ~MpTcpSocketBase -> m_node: " << m_node << " m_tcp: " << m_tcp << " m_endPoint: " << m_endPoint);
 }
 
@@ -396,41 +463,65 @@ MpTcpSocketBase::EstimateRtt (uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
 
   bool isECNEcho = (mptcpHeader.GetFlags () == (TcpHeader::ACK) && (m_eceBit > 0));
   Time nextRtt = sFlow->rtt->AckSeq (mptcpHeader.GetAckNumber (), isECNEcho);
+  AttachSubflows ();
+  UpdateWindowAggregates (sFlowIdx);
 
   sFlow->lastMeasuredRtt = nextRtt;
-  // XMP: lastMeasuredRtt == m_sampleRTT from nampt-subflow.cc
-  if (sFlow->lastMeasuredRtt != Seconds (0.0))
-    {
-      sFlow->m_baseRTT = Min (sFlow->m_baseRTT, sFlow->lastMeasuredRtt);
-      sFlow->m_minRTT = Min (sFlow->m_minRTT, sFlow->lastMeasuredRtt);
-      //sFlow->m_cnRTT++;
-      //sFlow->m_sumRTT += sFlow->lastMeasuredRtt.GetMicroSeconds ();
-    }
-
+  uint64_t tsval, tsecr;
+  if (m_timestamps && ReadTimestamp (mptcpHeader, tsval, tsecr) && tsecr != 0)
+    sFlow->rttStats.AddSample (Simulator::Now () - TimeStep (tsecr), Simulator::Now ());
+  else if (!nextRtt.IsZero ())
+    sFlow->rttStats.AddSample (nextRtt, Simulator::Now ());
   //sFlow->lastMeasuredRtt = sFlow->rtt->AckSeq(mptcpHeader.GetAckNumber()); // temp comment in favor of above
 
   //sFlow->measuredRTT.insert(sFlow->measuredRTT.end(), sFlow->rtt->GetCurrentEstimate().GetSeconds());
 
   // Plotting
 #ifdef PLOT
-  sFlow->_RTT.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->lastMeasuredRtt.GetMilliSeconds ()));
-  sFlow->_AvgRTT.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->rtt->GetCurrentEstimate ().GetMilliSeconds ()));
-  sFlow->_RTO.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->rtt->RetransmitTimeout ().GetMilliSeconds ()));
+  Trace (sFlow, TRACE_RTT, sFlow->lastMeasuredRtt.GetMilliSeconds ());
+  Trace (sFlow, TRACE_AVG_RTT, sFlow->rtt->GetCurrentEstimate ().GetMilliSeconds ());
+  Trace (sFlow, TRACE_RTO, sFlow->rtt->RetransmitTimeout ().GetMilliSeconds ());
 #endif
 
 #ifdef PLOT_DCTCP
-  sFlow->DCTCP_ALPHA_RTT.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->rtt->m_alpha));
-  sFlow->DCTCP_FRACTION_RTT.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->rtt->m_fracMarkPkt));
+  Trace (sFlow, TRACE_DCTCP_ALPHA_RTT, sFlow->rtt->m_alpha);
+  Trace (sFlow, TRACE_DCTCP_FRACTION_RTT, sFlow->rtt->m_fracMarkPkt);
 #endif
 }
 
+// Stamps a segment with the current time, a simulator time step, and echoes tsRecent (RFC 7323)
+uint8_t
+MpTcpSocketBase::AddTimestamp (uint8_t sFlowIdx, TcpHeader& header)
+{
+  if (!m_timestamps)
+    return 0;
+  header.AddOptTT (OPT_TT, Simulator::Now ().GetTimeStep (), subflows[sFlowIdx]->tsRecent);
+  return 17;
+}
+
+bool
+MpTcpSocketBase::ReadTimestamp (const TcpHeader& header, uint64_t &tsval, uint64_t &tsecr) const
+{
+  const TcpOptionList &options = header.GetOptions ();
+  for (uint32_t i = 0; i < options.size (); i++)
+    {
+      if (options[i]->optName == OPT_TT)
+        {
+          tsval = ((OptTimesTamp *) options[i])->TSval;
+          tsecr = ((OptTimesTamp *) options[i])->TSecr;
+          return true;
+        }
+    }
+  return false;
+}
+
 /* Read options from incoming packets */
 bool
 MpTcpSocketBase::ReadOptions (Ptr<Packet> pkt, const TcpHeader& mptcpHeader)
 { // Any packet without SYN and MP_CAPABLE is not being processed!
   NS_LOG_FUNCTION(this << mptcpHeader);
   NS_ASSERT(remoteToken == 0 && mpEnabled == false);
-  vector<TcpOptions*> mp_options = mptcpHeader.GetOptions ();
+  const TcpOptionList &mp_options = mptcpHeader.GetOptions ();
   uint8_t flags = mptcpHeader.GetFlags ();
   TcpOptions *opt;
   bool hasSyn = flags & TcpHeader::SYN;
@@ -460,7 +551,7 @@ MpTcpSocketBase::ReadOptions (uint8_t sFlowIdx, Ptr<Packet> pkt, const TcpHeader
 {
   NS_LOG_FUNCTION(this << (int)sFlowIdx << mptcpHeader);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  vector<TcpOptions*> options = mptcpHeader.GetOptions ();
+  const TcpOptionList &options = mptcpHeader.GetOptions ();
   uint8_t flags = mptcpHeader.GetFlags ();
   TcpOptions *opt;
   bool hasSyn = flags & TcpHeader::SYN;
@@ -649,7 +740,7 @@ MpTcpSocketBase::CompleteFork (Ptr<Packet> p, const TcpHeader& mptcpHeader, cons
   sFlow->rtt->SetG (m_g);
   sFlow->m_endPoint = m_endPoint; // This is master subsock, its endpoint is the same as connection endpoint.
   NS_LOG_INFO ("("<< (int)sFlow->routeId<<") LISTEN -> SYN_RCVD");
-  subflows.insert (subflows.end (), sFlow);
+  InsertSubflow (sFlow);
   sFlow->RxSeqNumber = (mptcpHeader.GetSequenceNumber ()).GetValue () + 1; //Set the subflow sequence number and send SYN+ACK
   NS_LOG_DEBUG("CompleteFork -> RxSeqNb: " << sFlow->RxSeqNumber << " highestAck: " << sFlow->highestAck);
   SendEmptyPacket (sFlow->routeId, TcpHeader::SYN | TcpHeader::ACK);
@@ -728,7 +819,9 @@ MpTcpSocketBase::ProcessSynSent (uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
         }NS_LOG_INFO("(" << sFlow->routeId << ") "<< TcpStateName[sFlow->state] << " -> ESTABLISHED");
       sFlow->state = ESTABLISHED;
       sFlow->retxEvent.Cancel ();
-      if ((m_largePlotting && (flowType.compare ("Large") == 0)) || (m_shortPlotting && (flowType.compare ("Short") == 0)))
+      sFlow->traceSink = m_traceSink;
+      sFlow->traceFlowId = flowId;
+      if (IsPlotting () || m_traceSink != 0)
         sFlow->StartTracing ("cWindow");
       sFlow->rtt->Init (mptcpHeader.GetAckNumber ());
       sFlow->initialSequnceNumber = (mptcpHeader.GetAckNumber ().GetValue ());
@@ -745,6 +838,7 @@ MpTcpSocketBase::ProcessSynSent (uint8_t sFlowIdx, Ptr<Packet> packet, const Tcp
       Time estimate;
       estimate = Seconds (1.5);
       sFlow->rtt->SetCurrentEstimate (estimate);
+      UpdateWindowAggregates (sFlowIdx);
 
       SendEmptyPacket (sFlowIdx, TcpHeader::ACK);
 
@@ -957,9 +1051,12 @@ MpTcpSocketBase::CancelAllTimers (uint8_t sFlowIdx)
 {
   NS_LOG_FUNCTION((int) sFlowIdx);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  sFlow->retxEvent.Cancel ();
+  sFlow->CancelRetx ();
   sFlow->m_lastAckEvent.Cancel ();
   sFlow->m_timewaitEvent.Cancel ();
+  sFlow->delAckEvent.Cancel ();
+  sFlow->rackEvent.Cancel ();
+  sFlow->tlpEvent.Cancel ();
   NS_LOG_LOGIC( "(" << (int)sFlow->routeId<<")" << "CancelAllTimers");
 }
 
@@ -972,9 +1069,12 @@ MpTcpSocketBase::CancelAllSubflowTimers (void)
       Ptr<MpTcpSubFlow> sFlow = subflows[i];
       if (sFlow->state != CLOSED)
         {
-          sFlow->retxEvent.Cancel ();
+          sFlow->CancelRetx ();
           sFlow->m_lastAckEvent.Cancel ();
           sFlow->m_timewaitEvent.Cancel ();
+          sFlow->delAckEvent.Cancel ();
+          sFlow->rackEvent.Cancel ();
+          sFlow->tlpEvent.Cancel ();
           NS_LOG_INFO("CancelAllSubflowTimers() -> Subflow:" << sFlow->routeId);
         }
     }
@@ -1029,9 +1129,12 @@ MpTcpSocketBase::ReceivedData (uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t expectedSeq = sFlow->RxSeqNumber;
   uint32_t Seq = mptcpHeader.GetSequenceNumber ().GetValue ();
-  vector<TcpOptions*> options = mptcpHeader.GetOptions ();
+  const TcpOptionList &options = mptcpHeader.GetOptions ();
   TcpOptions* opt;
   bool stored = true;
+  uint64_t tsval, tsecr;
+  if (m_timestamps && Seq <= sFlow->tsLastAckSent && ReadTimestamp (mptcpHeader, tsval, tsecr))
+    sFlow->tsRecent = tsval; // RFC 7323 sec.4.3, the next ACK echoes the earliest segment it acknowledges
   for (uint32_t i = 0; i < options.size (); i++)
     {
       opt = options[i];
@@ -1060,7 +1163,8 @@ MpTcpSocketBase::ReceivedData (uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
                     {
                       NotifyDataRecv ();
                     }
-                  SendEmptyPacket (sFlowIdx, TcpHeader::ACK);
+                  // Segment filled a hole at sub-flow level if stored segments were read behind it
+                  SendDataAck (sFlowIdx, Seq, sFlow->RxSeqNumber != expectedSeq + amountRead);
 
                   if (sFlow->Finished () && (mptcpHeader.GetFlags () & TcpHeader::FIN) == 0)
                     { // If we received FIN before and now completed all "holes" in RX buffer, invoke peer close
@@ -1073,7 +1177,7 @@ MpTcpSocketBase::ReceivedData (uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
                 { /** Received packet is out of sequence at connection level but in-order at sub-flow level **/
                   stored = StoreUnOrderedData (
                       new DSNMapping (sFlowIdx, optDSN->dataSeqNumber, optDSN->dataLevelLength, optDSN->subflowSeqNumber,
-                                      mptcpHeader.GetAckNumber ().GetValue ()/*, p*/));
+                                      mptcpHeader.GetAckNumber ().GetValue ()), p);
                   // For allowing sub-flow to progress, RxSeqNb should be advanced even though packet is not in-order of connection level.
                   if (stored)
                     {
@@ -1083,7 +1187,7 @@ MpTcpSocketBase::ReceivedData (uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
 
                     }
                   // We need to send ACK here to indicate that a packet leaves a network and signaling to sender that which sequence number is expected to receive at sub-flow level.
-                  SendEmptyPacket (sFlowIdx, TcpHeader::ACK);
+                  SendDataAck (sFlowIdx, Seq, !stored);
                 }
               else
                 { /** Received packet is duplicated in connection level! */
@@ -1098,24 +1202,70 @@ MpTcpSocketBase::ReceivedData (uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
               NS_ASSERT(optDSN->dataSeqNumber > nextRxSequence);
               StoreUnOrderedData (
                   new DSNMapping (sFlowIdx, optDSN->dataSeqNumber, optDSN->dataLevelLength, optDSN->subflowSeqNumber,
-                                  mptcpHeader.GetAckNumber ().GetValue ()/*, p*/));
-              SendEmptyPacket (sFlowIdx, TcpHeader::ACK); // We need to send ACK regardless of whether segment has already stored in unOrdered or not!
+                                  mptcpHeader.GetAckNumber ().GetValue ()), p);
+              if (m_sack)
+                { // The first SACK block reports this segment, the second the one received before in another range
+                  uint32_t left, right;
+                  if (!sFlow->sackRcv.GetRange (sFlow->sackRcvLast, left, right) || Seq < left || Seq > right)
+                    sFlow->sackRcvPrev = sFlow->sackRcvLast;
+                  sFlow->sackRcvLast = Seq;
+                  sFlow->sackRcv.Add (Seq, Seq + optDSN->dataLevelLength);
+                }
+              SendDataAck (sFlowIdx, Seq, true); // We need to send ACK regardless of whether segment has already stored in unOrdered or not!
             }
           else if (optDSN->subflowSeqNumber < sFlow->RxSeqNumber)
             { /* Received packet is duplicated at sub-flow level. It should be rejected!*/
               NS_LOG_INFO("Data received is duplicated in Subflow Layer so it has been rejected! subflowSeq: " << optDSN->subflowSeqNumber << " dataSeq: " << optDSN->dataSeqNumber);
-              SendEmptyPacket (sFlowIdx, TcpHeader::ACK);  // Ask for next expected sub-flow sequence number to receive.
+              SendDataAck (sFlowIdx, Seq, true);  // Ask for next expected sub-flow sequence number to receive.
             }
           else
             NS_FATAL_ERROR_NO_MSG()
             ; // There should not be any other condition!
         } // end of if clause
-      else
+      else if (opt->optName != OPT_TT) // Timestamps were read above
         NS_FATAL_ERROR(
             "ReceivedData() has called when there is no DSN option in the packet - Currently only DSN option is sent in each data packet!");
     } // end of for loop over TCP options
 }
 
+/*
+ * ACKs a data segment starting at seq received on a subflow, at most every DelayedAckCount in order
+ * segments or after DelayedAckTimeout. Segments out of order at sub-flow level, duplicates and
+ * segments filling a hole are acknowledged at once (quickAck) so the sender sees its dupacks without delay.
+ * DCTCP: an ACK only covers segments with the same CE state, so when it changes the pending
+ * segments are acknowledged first with the previous state, up to seq only.
+ */
+void
+MpTcpSocketBase::SendDataAck (uint8_t sFlowIdx, uint32_t seq, bool quickAck)
+{
+  NS_LOG_FUNCTION (this << (int)sFlowIdx << seq << quickAck);
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  bool ce = m_ceBit > 0;
+  if (sFlow->delAckCount > 0 && ce != sFlow->delAckCe)
+    { // RxSeqNumber already covers this segment when it was in order
+      uint32_t rxSeq = sFlow->RxSeqNumber;
+      sFlow->RxSeqNumber = std::min (rxSeq, seq);
+      SendDelayedAck (sFlowIdx);
+      sFlow->RxSeqNumber = rxSeq;
+    }
+  sFlow->delAckCe = ce;
+  if (quickAck || ++sFlow->delAckCount >= m_delayedAckCount)
+    SendEmptyPacket (sFlowIdx, TcpHeader::ACK); // Also resets delAckCount
+  else if (!sFlow->delAckEvent.IsRunning ())
+    sFlow->delAckEvent = Simulator::Schedule (m_delayedAckTimeout, &MpTcpSocketBase::SendDelayedAck, this, sFlowIdx);
+}
+
+// Sends the ACK held back by SendDataAck(), its ECE reflects the segments it covers rather than the last received packet
+void
+MpTcpSocketBase::SendDelayedAck (uint8_t sFlowIdx)
+{
+  NS_LOG_FUNCTION (this << (int)sFlowIdx);
+  uint8_t ceBit = m_ceBit;
+  m_ceBit = subflows[sFlowIdx]->delAckCe ? 1 : 0;
+  SendEmptyPacket (sFlowIdx, TcpHeader::ACK);
+  m_ceBit = ceBit;
+}
+
 void
 MpTcpSocketBase::SendAccumulativeAck (uint8_t sFlowIdx)
 {
@@ -1139,7 +1289,10 @@ MpTcpSocketBase::ReceivedAck (uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
 
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t ack = (mptcpHeader.GetAckNumber ()).GetValue ();
-  sFlow->g_AckSeqNumber = ack;
+  if (m_sack)
+    UpdateScoreboard (sFlowIdx, mptcpHeader);
+  if (m_lossRecovery == Rack_Tlp)
+    RackUpdate (sFlowIdx, mptcpHeader);
 
   if ((m_DCTCP && sFlow->state == ESTABLISHED) || m_dctcpFastReTxRecord)
     { // Danger: m_dctcpFastReTxRecord should off in normal run
@@ -1149,12 +1302,12 @@ MpTcpSocketBase::ReceivedAck (uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
           m_g = m_ADCTg;
           m_ADCTcontrol = false;
         }
-      CalculateDCTCPAlpha (sFlowIdx, ack);
+      GetDctcpOps ()->UpdateAlpha (this, sFlowIdx, ack);
     }
 
 #ifdef PLOT
   uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ACK.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+  Trace (sFlow, TRACE_ACK, tmp);
 #endif
 
   // Stop execution if TCPheader is not ACK at all.
@@ -1166,39 +1319,21 @@ MpTcpSocketBase::ReceivedAck (uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
   else if (ack <= sFlow->highestAck + 1)
     {
       NS_LOG_LOGIC ("This acknowlegment" << mptcpHeader.GetAckNumber () << "do not ack the latest data in subflow level");
-      list<DSNMapping *>::iterator current = sFlow->mapDSN.begin ();
-      list<DSNMapping *>::iterator next = sFlow->mapDSN.begin ();
-      while (current != sFlow->mapDSN.end ())
-        {
-          ++next;
-          DSNMapping *ptrDSN = *current;
-          // All segments before ackSeqNum should be removed from the mapDSN list.
-          if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
-            { // Optional task ...
-              //next = sFlow->mapDSN.erase(current);
-              //delete ptrDSN;
-            }
-          // There is a sent segment with subflowSN equal to ack but the ack is smaller than already receveid acked!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack < sFlow->highestAck + 1))
-            { // Case 1: Old ACK, ignored.
-              NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
-              NS_ASSERT(3 != 3);
-              break;
-            }
-          // There is a sent segment with requested SequenceNumber and ack is for first unacked byte!!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack == sFlow->highestAck + 1))
-            { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
-              if (ack < sFlow->TxSeqNumber)
-                {
-                  //NS_LOG_ERROR(Simulator::Now().GetSeconds()<< " [" << m_node->GetId()<< "] Duplicated ack received for SeqgNb: " << ack << " DUPACKs: " << sFlow->m_dupAckCount + 1);
-                  DupAck (sFlowIdx, ptrDSN);
-                  break;
-                }
-              // otherwise, the ACK is precisely equal to the nextTxSequence
-              NS_ASSERT(ack <= sFlow->TxSeqNumber);
-              break;
+      // Only the segment starting at ack matters, all segments before it are already acked.
+      DSNMapping *ptrDSN = sFlow->mapDSN.Find (ack);
+      if (ptrDSN != 0 && ack < sFlow->highestAck + 1)
+        { // Case 1: Old ACK, ignored.
+          NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
+          NS_ASSERT(3 != 3);
+        }
+      else if (ptrDSN != 0 && ack == sFlow->highestAck + 1)
+        { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
+          if (ack < sFlow->TxSeqNumber)
+            {
+              DupAck (sFlowIdx, ptrDSN);
             }
-          current = next;
+          // otherwise, the ACK is precisely equal to the nextTxSequence
+          NS_ASSERT(ack <= sFlow->TxSeqNumber);
         }
     }
   else if (ack > sFlow->highestAck + 1)
@@ -1207,6 +1342,8 @@ MpTcpSocketBase::ReceivedAck (uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
       NewAckNewReno (sFlowIdx, mptcpHeader, 0);
       sFlow->m_dupAckCount = 0;
     }
+  if (m_lossRecovery == Rack_Tlp)
+    RackDetectLoss (sFlowIdx);
   // If there is any data piggy-backed, store it into m_rxBuffer
   if (packet->GetSize () > 0)
     {
@@ -1219,151 +1356,17 @@ MpTcpSocketBase::ReceivedAck (uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHea
 
 }
 
-// XMP: Congestion Window Decrease Multiplicatively
-void
-MpTcpSocketBase::DoXMPEnterCWR (uint8_t sFlowIdx)
-{
-  assert (!m_DCTCP);
-  NS_LOG_FUNCTION((int) sFlowIdx);
-  SlowDownHits++;
-  Ptr<MpTcpSubFlow> subflow = subflows[sFlowIdx];
-  uint32_t cwnd = subflow->cwnd.Get () / subflow->MSS;
-  subflow->m_refWin = cwnd;
-  if (subflow->cwnd >= subflow->ssthresh)
-    { // shrink cwnd
-      uint32_t reduced = cwnd / float (m_backoffBeta);
-      reduced = (reduced == 0) ? 1 : reduced;
-      cwnd = (cwnd > reduced) ? cwnd - reduced : 0;
-      cwnd = (cwnd < m_cwndMin) ? m_cwndMin : cwnd;
-      subflow->cwnd = cwnd * subflow->MSS;
-    }
-  if (subflow->cwnd < subflow->ssthresh)
-    subflow->ssthresh = subflow->cwnd.Get ();
-}
-
-// XMP: Congestion Window Increase Adoptively
-void
-MpTcpSocketBase::DoSubflowNewAck (uint8_t sFlowIdx, uint32_t ack)
-{
-  assert (!m_DCTCP);
-  NS_LOG_FUNCTION((int) sFlowIdx << ack);
-  Ptr<MpTcpSubFlow> subflow = subflows[sFlowIdx];
-  if (ack > subflow->m_begSeq)
-    {
-#ifdef PLOT_DCTCP
-      uint32_t pkt_tmp = ((subflow->g_AckSeqNumber - subflow->initialSequnceNumber) / subflow->MSS) % mod;
-      subflow->BEG.push_back (make_pair (Simulator::Now ().GetSeconds (), pkt_tmp)); // ROUND For XMP
-#endif
-      subflow->m_rounds++;
-      // cwnd of the last round
-      double cwnd = subflow->cwnd.Get () / subflow->MSS;
-      if (subflow->m_cwr == 2)
-        cwnd = subflow->m_refWin;
-
-      // measurement parameters.
-      uint32_t rtt = subflow->rtt->GetCurrentEstimate ().GetMicroSeconds ();
-
-      // update rates in the last round.
-      double lastRate = 8.0 * cwnd * subflow->MSS / rtt; // Mbps
-      subflow->m_instantRate = subflow->m_instantRate * 0.875 + 0.125 * lastRate;
-      subflow->m_equilibrium = lastRate;
-
-      double totalRate = 0;
-      m_instRate = 0;
-      Time minRTT = Seconds (60.0);
-      for (uint32_t i = 0; i < subflows.size (); i++)
-        { // m_bAvailable@NaMPTSocket is equal to subflow->state@ESTABLISHED
-          if (!(subflows[i]->state == ESTABLISHED) || subflows[i]->m_equilibrium == 0) // otherwise, minRTT may be zero
-            continue;
-          totalRate += subflows[i]->m_equilibrium;
-          m_instRate += subflows[i]->m_instantRate;
-          minRTT = Min (minRTT, subflows[i]->rtt->GetCurrentEstimate ());
-        }
-
-      // update weights for next round
-      if (totalRate > 0)
-        {
-          subflow->m_weight = rtt * subflow->m_equilibrium / totalRate;
-          subflow->m_weight /= minRTT.GetMicroSeconds ();
-          NS_ASSERT(subflow->m_weight > 0);
-        }
-
-      // In the safe area, increase cwnd.
-      if (subflow->m_cwr == 1)
-        {
-          if (subflow->cwnd < subflow->ssthresh)
-            {
-              subflow->cwnd += subflow->MSS; // ss
-#ifdef PLOT_DCTCP
-              subflow->_ss.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
-#endif
-            }
-          else
-            { // ca
-              subflow->m_incCum += subflow->m_weight * m_initGamma;
-              uint32_t a = subflow->m_incCum;
-              subflow->m_incCum -= a;
-              subflow->cwnd += a * subflow->MSS;
-#ifdef PLOT_DCTCP
-              subflow->_ca.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
-#endif
-            }
-        }
-
-      /*
-      cout << "[" << m_node->GetId () << "] " << "DIFF " << subflow->sAddr << "->" << subflow->dAddr << " " << 0 << " " << cwnd
-          << " " << subflow->ssthresh / subflow->MSS << " " << subflow->m_weight << " " << subflow->m_instantRate << " " << rtt
-          << "/" << subflow->m_baseRTT.GetMicroSeconds () << "/" << subflow->rtt->RetransmitTimeout ().GetMicroSeconds () << " "
-          << subflow->m_nECE << " " << subflow->m_rounds << " " << subflow->m_begSeq << "/" << subflow->TxSeqNumber << endl;
-      */
-
-      // repare for next round
-      subflow->m_refWin = subflow->cwnd.Get () / subflow->MSS;
-      subflow->m_begSeq = subflow->TxSeqNumber;
-      subflow->m_minRTT = Seconds (60.0);
-      //subflow->m_cnRTT = 0;
-      //subflow->m_sumRTT = 0;
-      //subflow->m_nECE = 0;
-    }
-  else if (subflow->m_cwr == 1 && subflow->cwnd < subflow->ssthresh)
-    {
-      subflow->cwnd += subflow->MSS; // ss
-#ifdef PLOT_DCTCP
-      subflow->_ss.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
-#endif
-    }
-  // quit from cwr
-  if (subflow->m_cwr == 2 && ack >= subflow->m_cwrHighSeq.GetValue ())
-    {
-     subflow->m_cwr = 1;
-#ifdef PLOT_DCTCP
-     uint32_t pkt_tmp = ((subflow->g_AckSeqNumber - subflow->initialSequnceNumber) / subflow->MSS) % mod;
-     subflow->XMP_CWR1.push_back (make_pair (Simulator::Now ().GetSeconds (), pkt_tmp));
-#endif
-    }
-}
-
 void
 MpTcpSocketBase::AddPacketTag (Ptr<Packet> p, PacketTag_t pt)
 {
-  EctTag ect;
-  CeTag ce;
-  EceTag ece;
+  SocketIpTosTag tos;
   ControlTag ct;
   switch (pt)
     {
-  case ECT_TAG:
-    ect.SetEct(1);
-    p->AddPacketTag(ect);
+  case ECT_TAG: // Ipv4L3Protocol::Send() removes it and sets ECT(0) in the IP header
+    tos.SetTos(Ipv4Header::ECN_ECT0);
+    p->AddPacketTag(tos);
     break;
-  case CE_TAG:
-    ce.SetCe(1);
-    p->AddPacketTag(ce);
-  break;
-  case ECE_TAG:
-    ece.SetEce (1);
-    p->AddPacketTag (ece);
-  break;
   case CP_TAG:
     ct.SetControlPkt(1);
     p->AddPacketTag(ct);
@@ -1406,7 +1409,7 @@ MpTcpSocketBase::CheckIncast (uint8_t sFlowIdx)
   if (m_incastCounter >= m_incastThreshold)
     { // Fallback mode... but now try to return to normal MPTCP operation
       Ptr<MpTcpSubFlow> sFlow = subflows[0];
-      if ((sFlow->cwnd.Get () / sFlow->MSS) > m_cwndMin && sFlow->dctcp_last_fraction == 0 && sFlow->m_inFastRec == false && !(sFlow->maxSeqNb > sFlow->TxSeqNumber - 1))
+      if ((sFlow->cwnd.Get () / sFlow->MSS) > m_cwndMin && GetDctcpOps ()->GetMarkedFraction (0) == 0 && sFlow->m_inFastRec == false && !(sFlow->maxSeqNb > sFlow->TxSeqNumber - 1))
         m_incastReDoCounter++;
       else
         m_incastReDoCounter = 0;
@@ -1426,7 +1429,7 @@ MpTcpSocketBase::CheckIncast (uint8_t sFlowIdx)
           Ptr<MpTcpSubFlow> sFlow = subflows[idx];
           if (sFlow->state == ESTABLISHED)
             { // cwnd == 1 and fractMark == 1 && No FastRecovery and Timeout
-              if (((uint32_t)(sFlow->cwnd.Get () / sFlow->MSS) == m_cwndMin) /*&& sFlow->dctcp_last_fraction == 1*/ && sFlow->m_inFastRec == false
+              if (((uint32_t)(sFlow->cwnd.Get () / sFlow->MSS) == m_cwndMin) && sFlow->m_inFastRec == false
                   && !(sFlow->maxSeqNb > sFlow->TxSeqNumber - 1))
                 {
                   localCounter++;
@@ -1444,66 +1447,6 @@ MpTcpSocketBase::CheckIncast (uint8_t sFlowIdx)
     }
 }
 
-void
-MpTcpSocketBase::CalculateDCTCPAlpha (uint8_t sFlowIdx, uint32_t ack)
-{
-  NS_LOG_FUNCTION((int) sFlowIdx << ack);
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  // Tracking total and marked ACK packets
-  sFlow->dctcp_total++;
-  if (m_eceBit > 0)
-    {
-      sFlow->dctcp_marked++;
-      sFlow->curEcnState = true;
-#ifdef PLOT_DCTCP
-      uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-      sFlow->ECN_ECHO.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
-#endif
-    }
-  /* Check for barrier indicating its time to recalculate alpha.
-   * This code basically updated alpha roughly once per RTT.
-   */
-  if (ack > sFlow->dctcp_alpha_update_seq)
-    {
-      double temp_alpha;
-      if (sFlow->dctcp_total > 0)
-        {
-          temp_alpha = ((double) sFlow->dctcp_marked) / sFlow->dctcp_total;
-        }
-      else
-        {
-          temp_alpha = 0.0;
-        }
-      sFlow->dctcp_last_fraction = temp_alpha; // for ploting
-      sFlow->dctcp_alpha = (1 - m_g) * sFlow->dctcp_alpha + m_g * temp_alpha;
-
-      if (sFlow->dctcp_alpha > 1.0)
-        sFlow->dctcp_alpha = 1.0;
-
-      if (m_dctcpFastAlpha)
-        sFlow->dctcp_alpha = sFlow->dctcp_last_fraction;
-
-      if (m_dynamicSubflow && (int)sFlowIdx == 0 && maxSubflows >= 2)
-        CheckIncast(sFlowIdx);
-      /*
-       cout << Simulator::Now ().GetSeconds () << " [" << m_node->GetId () << "] Subflow(" << (int) sFlow->routeId << ")"
-       << " dctcp_marked: " << sFlow->dctcp_marked << " dctcp_total: " << sFlow->dctcp_total << " alpha: "
-       << sFlow->dctcp_alpha << " OW: " << (uint32_t) sFlow->dctcp_alpha_update_seq - ack << " RTT_alpha: "
-       << sFlow->rtt->GetAlpha () << " TxSeqNum: " << sFlow->TxSeqNumber << endl;
-       */
-      sFlow->dctcp_marked = 0;
-      sFlow->dctcp_total = 0;
-      sFlow->dctcp_alpha_update_seq = sFlow->TxSeqNumber;
-      sFlow->curEcnState = m_eceBit > 0 ? true : false;
-#ifdef PLOT_DCTCP
-      sFlow->DCTCP_ALPHA.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->dctcp_alpha));
-      sFlow->DCTCP_FRACTION.push_back (make_pair (Simulator::Now ().GetSeconds (), temp_alpha));
-      uint32_t pktNumber = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-      sFlow->BEG.push_back (make_pair (Simulator::Now ().GetSeconds (), pktNumber)); // ROUND for ECN and DCTCP
-#endif
-    }
-}
-
 void
 MpTcpSocketBase::SetSegSize (uint32_t size)
 {
@@ -1537,21 +1480,14 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
    */
   if (sFlow->maxSeqNb > sFlow->TxSeqNumber - 1)
     {
-      uint32_t IterNumber = 0;
-      for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin (); (it != sFlow->mapDSN.end () && guard == false); ++it)
-        { // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
-          IterNumber++;
-          DSNMapping * ptr = *it;
-          if (ptr->subflowSeqNumber == sFlow->TxSeqNumber)
-            {
-              ptrDSN = ptr;
-              //p = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-              p = Create<Packet> (ptrDSN->dataLevelLength);
-              packetSize = ptrDSN->dataLevelLength;
-              guard = true;
-              NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize << " IterNumInMapDSN: " << IterNumber <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
-              break;
-            }
+      // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
+      ptrDSN = sFlow->mapDSN.Find (sFlow->TxSeqNumber);
+      if (ptrDSN != 0)
+        {
+          p = ptrDSN->GetPayload ();
+          packetSize = ptrDSN->dataLevelLength;
+          guard = true;
+          NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
         }
       if (p == 0)
         {
@@ -1571,7 +1507,13 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
     {
       NS_ASSERT(!guard);
       NS_ASSERT(sFlow->maxSeqNb == sFlow->TxSeqNumber - 1);
-      p = sendingBuffer.CreatePacket (size);
+      if (m_burstPacket != 0)
+        { // Cut the segment out of the burst SendDataBurst() read from the sending buffer
+          p = m_burstPacket->CreateFragment (m_burstOffset, std::min (size, m_burstPacket->GetSize () - m_burstOffset));
+          m_burstOffset += p->GetSize ();
+        }
+      else
+        p = sendingBuffer.CreatePacket (size);
       if (p == 0)
         { // TODO I guess we should not return from here - What do we do then kill ourself?
           NS_LOG_WARN("["<< m_node->GetId() << "] ("<< sFlow->routeId << ") No data is available in SendingBuffer to create a pkt from it! SendingBufferSize: " << sendingBuffer.PendingData());
@@ -1630,7 +1572,7 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
   header.SetWindowSize (AdvertisedWindowSize ());
   if (!guard)
     { // If packet is made from sendingBuffer, then we got to add the packet and its info to subflow's mapDSN.
-      sFlow->AddDSNMapping (sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber/*, p->Copy()*/);
+      sFlow->AddDSNMapping (sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber, sendingBuffer.GetPayloadMode () ? p : 0);
     }
   if (!guard)
     { // if packet is made from sendingBuffer, then we use nextTxSequence to OptDSN
@@ -1644,7 +1586,7 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
 
   uint8_t hlen = 5;   // 5 --> 32-bit words = 20 Bytes == TcpHeader Size with out any option
   //uint8_t olen = 15;  // 15 because packet size is 2 bytes in size. 1 + 8 + 2+ 4 = 15
-  uint8_t olen = 20;
+  uint8_t olen = 20 + AddTimestamp (sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4; // (4 - (15 % 4)) 4 => 1
   olen = (olen + plen) / 4;    // (15 + 1) / 4 = 4
@@ -1675,12 +1617,13 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
 
 #ifdef PLOT
   uint32_t tmp = (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DATA.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+  Trace (sFlow, TRACE_DATA, tmp);
 #endif
 
   NS_LOG_LOGIC(Simulator::Now().GetSeconds() << " ["<< m_node->GetId()<< "] SendDataPacket->  " << header <<" dSize: " << packetSize<< " sFlow: " << sFlow->routeId);
 
   // Do some updates.....
+  SegmentSent (sFlowIdx, guard ? ptrDSN : 0);
   sFlow->rtt->SentSeq (SequenceNumber32 (sFlow->TxSeqNumber), packetSize); // Notify the RTT of a data packet sent
   sFlow->TxSeqNumber += packetSize; // Update subflow's nextSeqNum to send.
   sFlow->maxSeqNb = std::max (sFlow->maxSeqNb, sFlow->TxSeqNumber - 1);
@@ -1694,6 +1637,8 @@ MpTcpSocketBase::SendDataPacket (uint8_t sFlowIdx, uint32_t size, bool withAck)
 
   // After data packet has been sent now look at remianing data in sending buffer
   uint32_t remainingData = sendingBuffer.PendingData ();
+  if (m_burstPacket != 0)
+    remainingData += m_burstPacket->GetSize () - m_burstOffset;
   if (m_closeOnEmpty && (remainingData == 0))
     {
       SendAllSubflowsFIN ();
@@ -1734,7 +1679,7 @@ MpTcpSocketBase::ManualPacketDrop (uint8_t sFlowIdx, Ptr<Packet> p, uint32_t pac
       if (std::find (sampleList.begin (), sampleList.end (), pktNumber) != sampleList.end ())
         {
           uint32_t tmp = (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-          sFlow->DROP.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+          Trace (sFlow, TRACE_DROP, tmp);
           sampleList.remove (pktNumber);
           return false;
         }
@@ -1834,7 +1779,7 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx)
 
   // we retransmit only one lost pkt
   //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet> (ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload ();
   TcpHeader header;
   header.SetSourcePort (sFlow->sPort);
   header.SetDestinationPort (sFlow->dPort);
@@ -1846,7 +1791,7 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx)
   header.AddOptDSN (OPT_DSN, ptrDSN->dataSeqNumber, ptrDSN->dataLevelLength, ptrDSN->subflowSeqNumber);
 
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp (sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -1869,16 +1814,17 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx)
 
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+  Trace (sFlow, TRACE_RETRANSMIT, tmp);
   if (!sFlow->m_inFastRec)
     {
-      timeOutTrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd));
+      Trace (TRACE_TIMEOUT_CWND, sFlow->cwnd);
     }
 #endif
 
   //TxBytes += ptrDSN->dataLevelLength + 62;
 
   // Update Rtt
+  SegmentSent (sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq (SequenceNumber32 (ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -1900,7 +1846,7 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
   // we retransmit only one lost pkt
   //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet> (ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload ();
   if (pkt == 0)
     NS_ASSERT(3 != 3);
 
@@ -1916,7 +1862,7 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
   NS_LOG_WARN (Simulator::Now().GetSeconds() <<" RetransmitSegment -> "<< " localToken "<< localToken<<" Subflow "<<(int) sFlowIdx<<" DataSeq "<< ptrDSN->dataSeqNumber <<" SubflowSeq " << ptrDSN->subflowSeqNumber <<" dataLength " << ptrDSN->dataLevelLength << " packet size " << pkt->GetSize() << " 3DupACK");
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp (sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -1936,12 +1882,13 @@ MpTcpSocketBase::DoRetransmit (uint8_t sFlowIdx, DSNMapping* ptrDSN)
   m_tcp->SendPacket (pkt, header, sFlow->sAddr, sFlow->dAddr, FindOutputNetDevice (sFlow->sAddr));
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+  Trace (sFlow, TRACE_RETRANSMIT, tmp);
 #endif
 
   //TxBytes += ptrDSN->dataLevelLength + 62;
 
   // Notify RTT
+  SegmentSent (sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq (SequenceNumber32 (ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -1957,24 +1904,8 @@ void
 MpTcpSocketBase::DiscardUpTo (uint8_t sFlowIdx, uint32_t ack)
 {
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  list<DSNMapping *>::iterator current = sFlow->mapDSN.begin ();
-  list<DSNMapping *>::iterator next = sFlow->mapDSN.begin ();
-  while (current != sFlow->mapDSN.end ())
-    {
-      ++next;
-      DSNMapping *ptrDSN = *current;
-      // All segments before ackSeqNum should be removed from the mapDSN list. Maybe equal part never run due to if condition above.
-      if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
-        {
-//          if (sFlowIdx == 0)
-//            NS_LOG_UNCOND("DiscardUp-> SeqNb: " << ptrDSN->subflowSeqNumber << " DSNMappingSize: " << sFlow->mapDSN.size() - 1 << " Subflow(" << (int)sFlow->routeId << ")");
-          //delete ptrDSN->packet;
-          //ptrDSN->packet = 0;
-          next = sFlow->mapDSN.erase (current);
-          delete ptrDSN;
-        }
-      current = next;
-    }
+  // All segments before ackSeqNum should be removed from the mapDSN list.
+  sFlow->mapDSN.DiscardUpTo (ack);
 }
 
 // .....................................................................................................
@@ -2022,7 +1953,15 @@ Ptr<TcpSocketBase>
 MpTcpSocketBase::Fork (void)
 {
   NS_LOG_FUNCTION_NOARGS();
-  return CopyObject<MpTcpSocketBase> (this);
+  Ptr<MpTcpSocketBase> newSock = CopyObject<MpTcpSocketBase> (this);
+  newSock->m_scheduler = 0; // Schedulers keep per connection state
+  if (m_scheduler != 0)
+    newSock->SetScheduler (m_scheduler->Copy ());
+  newSock->m_congestionOps = 0; // So do congestion ops
+  if (m_congestionOps != 0)
+    newSock->SetCongestionOps (m_congestionOps->Copy ());
+  newSock->m_dctcpOps = 0;      // And DCTCP, created again on first use
+  return newSock;
 }
 
 /** Cut cwnd and enter fast recovery mode upon triple dupack */
@@ -2100,7 +2039,7 @@ MpTcpSocketBase::Connect (Ipv4Address servAddr, uint16_t servPort)
 
   // This is master subsocket (master subflow) then its endpoint is the same as connection endpoint.
   sFlow->m_endPoint = m_endPoint;
-  subflows.insert (subflows.end (), sFlow);
+  InsertSubflow (sFlow);
 //  m_tcp->m_sockets.push_back(this); //TMP REMOVE
 
   sFlow->rtt->Reset (); // Dangerous ?!?!?! Not really?
@@ -2242,6 +2181,13 @@ MpTcpSocketBase::FillBuffer (uint32_t size)
   return sendingBuffer.Add (size);
 }
 
+int
+MpTcpSocketBase::FillBuffer (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION( this << p->GetSize () );
+  return sendingBuffer.Add (p);
+}
+
 /**
  * Sending data via subflows with available window size. It sends data only to ESTABLISHED subflows.
  * It sends data by calling SendDataPacket() function.
@@ -2254,34 +2200,17 @@ MpTcpSocketBase::SendPendingData (uint8_t sFlowIdx)
 
   // DCTCP: If we have received ECN echo in some of the received ACKs, halve the congestion window
   if (m_DCTCP && sFlowIdx < maxSubflows && m_eceBit > 0 && subflows[sFlowIdx]->state == ESTABLISHED
-      && subflows[sFlowIdx]->dctcp_maxseq < (subflows[sFlowIdx]->highestAck + 1))
+      && GetDctcpOps ()->SlowDownDue (this, sFlowIdx))
     {
       NS_LOG_INFO ("Halving CWND because we've received ECN Echo.");
       NS_ASSERT(client);
       if (m_slowDownXmpLike)
-        SlowDownXMPLike (sFlowIdx);
+        m_dctcpOps->SlowDownXmpLike (this, sFlowIdx);
       else if (m_slowDownEcnLike)
-        SlowDownEcnLike (sFlowIdx);
+        m_dctcpOps->SlowDownEcnLike (this, sFlowIdx);
       else
-        SlowDown (sFlowIdx);
-    }
-  /*
-  // XMP: If we have received ECN echo in some of the received ACKs, cut the cwnd by half only once per round
-  if (AlgoCC == XMP && sFlowIdx < maxSubflows && m_eceBit > 0 && subflows[sFlowIdx]->state == ESTABLISHED)
-    {
-      if (subflows[sFlowIdx]->m_cwr == 1)
-        {
-          subflows[sFlowIdx]->m_cwr = 2;
-          subflows[sFlowIdx]->m_cwrHighSeq = subflows[sFlowIdx]->TxSeqNumber; //m_baseSocket->m_nextTxSequence;
-          DoXMPEnterCWR (sFlowIdx); //sFlow->m_enterCWR (Ptr<NaMPTSubflow>(this), DynamicCast<NaMPTCC>(m_baseSocket));
-#ifdef PLOT_DCTCP
-          uint32_t pkt_tmp = ((subflows[sFlowIdx]->g_AckSeqNumber - subflows[sFlowIdx]->initialSequnceNumber) / subflows[sFlowIdx]->MSS) % mod;
-          subflows[sFlowIdx]->XMP_CWR2.push_back (make_pair (Simulator::Now ().GetSeconds (), pkt_tmp));
-#endif
-        }
+        m_dctcpOps->SlowDown (this, sFlowIdx);
     }
-  */
-
   // This condition only valid when sendingBuffer is empty!
   if (sendingBuffer.Empty () && sFlowIdx < maxSubflows)
     {
@@ -2336,23 +2265,13 @@ MpTcpSocketBase::SendPendingData (uint8_t sFlowIdx)
           window = std::min (AvailableWindow (lastUsedsFlowIdx), sendingBuffer.PendingData ()); // Get available window size
         }
       else
-        { // Normal operation
-          for (uint32_t i = 0; i < subflows.size (); i++)
-            {
-              if (subflows[lastUsedsFlowIdx]->state != ESTABLISHED)
-                continue;
-              window = std::min (AvailableWindow (lastUsedsFlowIdx), sendingBuffer.PendingData ()); // Get available window size
-              if (window == 0)
-                {  // No more available window in the current subflow, try with another one
-                  NS_LOG_LOGIC("SendPendingData -> No window available on (" << (int)lastUsedsFlowIdx << ") Try next one!");
-                  lastUsedsFlowIdx = getSubflowToUse ();
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("SendPendingData -> Find subflow with spare window PendingData (" << sendingBuffer.PendingData() << ") Available window ("<<AvailableWindow (lastUsedsFlowIdx)<<")");
-                  break;
-                }
-            }
+        { // Normal operation, the scheduler only returns subflows with usable window
+          int nextSubflow = getSubflowToUse ();
+          if (nextSubflow < 0)
+            break;
+          lastUsedsFlowIdx = nextSubflow;
+          window = UsableWindow (lastUsedsFlowIdx);
+          NS_LOG_LOGIC ("SendPendingData -> Scheduler picked (" << (int)lastUsedsFlowIdx << ") PendingData (" << sendingBuffer.PendingData() << ") Available window (" << window << ")");
         }
 
       if (window == 0)
@@ -2365,6 +2284,11 @@ MpTcpSocketBase::SendPendingData (uint8_t sFlowIdx)
       if (sFlow->state == ESTABLISHED)
         {
           currentSublow = sFlow->routeId;
+          if (m_sendBurst && sFlow->maxSeqNb == sFlow->TxSeqNumber - 1)
+            { // Not in timeout recovery, use up the window of this subflow before asking the scheduler again
+              nOctetsSent += SendDataBurst (lastUsedsFlowIdx, window);
+              continue;
+            }
           uint32_t s = std::min (window, sFlow->MSS);  // Send no more than window
           if (sFlow->maxSeqNb > sFlow->TxSeqNumber - 1 && sendingBuffer.PendingData () <= sFlow->MSS)
             { // When subflow is in timeout recovery and the last segment is not reached yet then segment size should be equal to MSS
@@ -2379,7 +2303,6 @@ MpTcpSocketBase::SendPendingData (uint8_t sFlowIdx)
           else
             nOctetsSent += amountSent;  // Count total bytes sent in this loop
         } // end of if statement
-      lastUsedsFlowIdx = getSubflowToUse ();
     } // end of main while loop
   //NS_LOG_UNCOND ("["<< m_node->GetId() << "] SendPendingData -> amount data sent = " << nOctetsSent << "... Notify application.");
   if (nOctetsSent > 0)
@@ -2387,20 +2310,46 @@ MpTcpSocketBase::SendPendingData (uint8_t sFlowIdx)
   return (nOctetsSent > 0);
 }
 
-uint8_t
-MpTcpSocketBase::getSubflowToUse ()
+/*
+ * Sends the whole usable window of a subflow as back to back segments, so the window, the
+ * scheduler and (with SegmentOffload) the sending buffer are visited once per burst instead of
+ * once per segment. Each segment still gets its own header and DSN mapping.
+ * Only called when the subflow sends new data, i.e. it is not in timeout recovery, with a window
+ * no larger than the pending data (as UsableWindow() returns it).
+ */
+uint32_t
+MpTcpSocketBase::SendDataBurst (uint8_t sFlowIdx, uint32_t window)
 {
-  NS_LOG_FUNCTION(this);
-  uint8_t nextSubFlow = 0;
-  switch (distribAlgo)
+  NS_LOG_FUNCTION (this << (int)sFlowIdx << window);
+  NS_ASSERT_MSG (window <= sendingBuffer.PendingData (), "Burst window larger than the pending data");
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  // Whole segments only, unless the last one drains the sending buffer (as AvailableWindow() does per segment)
+  uint32_t burst = window - window % sFlow->MSS;
+  if (sendingBuffer.PendingData () < burst + sFlow->MSS)
+    burst = window;
+  if (m_segmentOffload && burst > sFlow->MSS)
     {
-  case Round_Robin:
-    nextSubFlow = (lastUsedsFlowIdx + 1) % subflows.size ();
-    break;
-  default:
-    break;
+      m_burstPacket = sendingBuffer.CreatePacket (burst);
+      m_burstOffset = 0;
+    }
+  uint32_t sent = 0;
+  while (sent < burst)
+    {
+      int amountSent = SendDataPacket (sFlowIdx, std::min (burst - sent, sFlow->MSS), false);
+      if (amountSent <= 0)
+        break;
+      sent += amountSent;
     }
-  return nextSubFlow;
+  NS_ASSERT (m_burstPacket == 0 || m_burstOffset == m_burstPacket->GetSize ());
+  m_burstPacket = 0;
+  return sent;
+}
+
+int
+MpTcpSocketBase::getSubflowToUse ()
+{
+  NS_LOG_FUNCTION(this);
+  return GetScheduler ()->GetSubflowToUse (this);
 }
 
 /**
@@ -2435,6 +2384,9 @@ MpTcpSocketBase::ReTxTimeout (uint8_t sFlowIdx)
       //NS_ASSERT(3!=3); // DANGEROUS
       return;
     }
+  sFlow->scoreboard.Clear (); // RFC 6675 sec.5.1, SACK information may be reneged
+  sFlow->rackEvent.Cancel ();
+  sFlow->tlpEvent.Cancel ();
   Retransmit (sFlowIdx); // Retransmit the packet
 }
 
@@ -2444,189 +2396,349 @@ MpTcpSocketBase::ReduceCWND (uint8_t sFlowIdx, DSNMapping* ptrDSN)
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t mss = sFlow->MSS;
   uint32_t flightSize = std::min(BytesInFlight (sFlowIdx), sFlow->cwnd.Get()); //To avoid we need to take the min of flight size and c_wnd
-  int d = 0;
   calculateTotalCWND ();
+  sFlow->ssthresh = GetCongestionOps ()->GetSsThresh (this, sFlowIdx, flightSize);
+  // With SACK the pipe estimate replaces window inflation
+  sFlow->cwnd = m_sack ? sFlow->ssthresh : sFlow->ssthresh + 3 * mss;
 
-  switch (AlgoCC)
-    {
-  case Uncoupled_TCPs:
-  case Linked_Increases:
-  case RTT_Compensator:
-  case Fast_Uncoupled:
-  case Fast_Increases:
-  case COUPLED_INC:
-  case COUPLED_EPSILON:
-  case UNCOUPLED:
-  case XMP:
-  case XCA:
-  //sFlow->ssthresh = std::max (2 * mss, BytesInFlight (sFlowIdx) / 2);
-    sFlow->ssthresh = std::max (2 * mss, flightSize/2);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
-
-  case COUPLED_SCALABLE_TCP:
-    d = (int) sFlow->cwnd.Get () - (compute_total_window () >> 3);
-    if (d < 0)
-      d = 0;
-    sFlow->ssthresh = max (2 * mss, (uint32_t) d);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
-
-  case COUPLED_FULLY:
-    d = (int) sFlow->cwnd.Get () - compute_total_window () / B;
-    if (d < 0)
-      d = 0;
-    sFlow->ssthresh = max (2 * mss, (uint32_t) d);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
-
-  case Fully_Coupled:
-    d = sFlow->cwnd.Get () - totalCwnd / 2;
-    if (d < 0)
-      d = 0;
-    sFlow->ssthresh = std::max (2 * mss, (uint32_t) d);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
-
-  default:
-    NS_ASSERT(3 != 3);
-    break;
-    }
   // update
 //  sFlow->m_recover = SequenceNumber32 (sFlow->maxSeqNb + 1);
   sFlow->m_recover = SequenceNumber32 (sFlow->m_highTxMark + 1);
   sFlow->m_inFastRec = true;
+  UpdateWindowAggregates (sFlowIdx);
   //We have inflated the window by 3 segment sizes, record it
-  sFlow->m_duplicatesSize = 3 * mss;
-//  sFlow->m_ssThreshLastChange = Simulator::Now (); // DCTCP
+  sFlow->m_duplicatesSize = m_sack ? 0 : 3 * mss;
 
-  // XMP: updates during Fast Retransmission
-  if (AlgoCC == XMP)
-    {
-      uint32_t rtt = sFlow->rtt->GetCurrentEstimate ().GetMicroSeconds ();
-      double curRate = 0;
-      if (rtt > 0)
-        curRate = 8.0 * sFlow->ssthresh / rtt; // Mbps
-      sFlow->m_instantRate = sFlow->m_instantRate * 0.875 + 0.125 * curRate;
-      sFlow->m_equilibrium = curRate;
-    }
+  GetCongestionOps ()->EnterRecovery (this, sFlowIdx);
 
   // Retrasnmit a specific packet (lost segment)
   DoRetransmit (sFlowIdx, ptrDSN);
+  if (m_sack)
+    {
+      sFlow->scoreboard.SetHighRxt (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength);
+      SackRecoverySend (sFlowIdx);
+    }
 #ifdef PLOT
-  reTxTrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd));
-  sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
+  Trace (TRACE_RETX_CWND, sFlow->cwnd);
+  Trace (sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
 #endif
 }
 
-/** Retransmit timeout */
+// Adds the SACK blocks of an ACK to the scoreboard, clipped to what is still unacked and was sent
 void
-MpTcpSocketBase::Retransmit (uint8_t sFlowIdx)
+MpTcpSocketBase::UpdateScoreboard (uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
 {
-  NS_LOG_FUNCTION (this);  //
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  // Exit From Fast Recovery
-//  sFlow->m_inFastRec = false;
-  // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
-  // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
-  // TCP back to slow start
-//  sFlow->ssthresh = std::max (2 * sFlow->MSS, BytesInFlight (sFlowIdx) / 2);
-
-  if(!sFlow->m_inFastRec){
-      // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
-      // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
-      // TCP back to slow start
-      sFlow->ssthresh = std::max (2 * sFlow->MSS, BytesInFlight (sFlowIdx) / 2);
-    }
-    else{
-      //If already in fast recovery, halve ssThresh again
-      sFlow->ssthresh = sFlow->ssthresh / 2;
-      sFlow->m_duplicatesSize = 0;
-    }
-  sFlow->m_inFastRec = false;
-//sFlow->m_ssThreshLastChange = Simulator::Now (); // DCTCP
-  sFlow->cwnd = sFlow->MSS; //  sFlow->cwnd = 1.0;
-  sFlow->TxSeqNumber = sFlow->highestAck + 1; // m_nextTxSequence = m_txBuffer.HeadSequence(); // Restart from highest Ack
-  sFlow->m_highTxMark = sFlow->TxSeqNumber - 1; //m_highTxMark = m_nextTxSequence - m_segmentSize;
-
-  //DCTCP update duing Timeout
-  if (m_DCTCP || m_dctcpFastReTxRecord)
-    { // Determine the next observation window for updating dctcp's alpha
-      sFlow->dctcp_alpha_update_seq = sFlow->TxSeqNumber;
-      sFlow->dctcp_maxseq = sFlow->dctcp_alpha_update_seq;
-    }
-  // XMP: updates during Timeout
-  if (AlgoCC == XMP)
+  uint32_t ack = std::max (mptcpHeader.GetAckNumber ().GetValue (), sFlow->highestAck + 1);
+  sFlow->scoreboard.DiscardBelow (ack);
+  const TcpOptionList &options = mptcpHeader.GetOptions ();
+  for (uint32_t i = 0; i < options.size (); i++)
     {
-      if (sFlow->m_cwr > 0)
+      if (options[i]->optName != OPT_DSACK)
+        continue;
+      const OptDSACK* sack = (const OptDSACK*) options[i];
+      for (uint32_t j = 0; j + 1 < sack->nEdges; j += 2)
         {
-          sFlow->m_cwr = 1;
+          uint32_t left = std::max ((uint32_t) sack->blocks[j], ack);
+          uint32_t right = std::min ((uint32_t) sack->blocks[j + 1], sFlow->m_highTxMark + 1);
+          sFlow->scoreboard.Add (left, right); // Empty and stale blocks add nothing
         }
-      sFlow->m_begSeq = sFlow->TxSeqNumber; // sock->m_txBuffer.HeadSequence ();
-      sFlow->m_minRTT = Seconds (60.0);
-      //sFlow->m_cnRTT = 0;
-      //sFlow->m_sumRTT = 0;
-      //sFlow->m_nECE = 0;
     }
+}
 
-  //if (!(sendingBuffer->Empty() && sFlow->mapDSN.size() > 0))
-  sFlow->rtt->IncreaseMultiplier ();  // Double the next RTO
-
-  if (AlgoCC >= COUPLED_EPSILON && AlgoCC < XMP)
-    window_changed ();
-
-  DoRetransmit (sFlowIdx);  // Retransmit the packet
-#ifdef PLOT
-  sFlow->_TimeOut.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
-#endif
-  TimeOuts++;
-  // rfc 3782 - Recovering from timeOut
-  //sFlow->m_recover = SequenceNumber32(sFlow->maxSeqNb + 1);
+bool
+MpTcpSocketBase::SackLossDetected (uint8_t sFlowIdx)
+{
+  if (!m_sack)
+    return false;
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  return sFlow->highestAck + 1 < sFlow->scoreboard.GetLossFrontier (sFlow->m_retxThresh, sFlow->MSS);
 }
 
+/*
+ * RFC 6675 sec.5 NextSeg(): while cwnd - pipe allows a segment, retransmit the lowest hole above
+ * HighRxt the scoreboard deems lost, else send new data. Holes not deemed lost yet are left alone.
+ */
 void
-MpTcpSocketBase::SetReTxTimeout (uint8_t sFlowIdx)
+MpTcpSocketBase::SackRecoverySend (uint8_t sFlowIdx)
 {
+  NS_LOG_FUNCTION (this << (int)sFlowIdx);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  if (sFlow->retxEvent.IsExpired ())
+  MpTcpScoreboard &sb = sFlow->scoreboard;
+  uint32_t nOctetsSent = 0;
+  while (true)
     {
-      Time rto = sFlow->rtt->RetransmitTimeout ();
-      sFlow->retxEvent = Simulator::Schedule (rto, &MpTcpSocketBase::ReTxTimeout, this, sFlowIdx);
+      uint32_t highAck = sFlow->highestAck + 1;
+      uint32_t pipe = sb.GetPipe (highAck, sFlow->m_highTxMark + 1, sFlow->m_retxThresh, sFlow->MSS);
+      if (sFlow->cwnd.Get () < pipe + sFlow->MSS)
+        break;
+      uint32_t seq = sb.NextHole (std::max (sb.GetHighRxt (), highAck));
+      DSNMapping* ptrDSN = (seq < sb.GetLossFrontier (sFlow->m_retxThresh, sFlow->MSS)) ? sFlow->mapDSN.Find (seq) : 0;
+      if (ptrDSN != 0 && ptrDSN->subflowSeqNumber == seq && m_lossRecovery == DupAck_Recovery)
+        { // Rule 1, retransmit a lost segment (RACK retransmits the segments it deems lost itself)
+          DoRetransmit (sFlowIdx, ptrDSN);
+          sb.SetHighRxt (seq + ptrDSN->dataLevelLength);
+          continue;
+        }
+      // Rule 2, new data (the peer's window is not reduced by SACKed bytes, they are held for reordering)
+      uint32_t unAcked = sFlow->TxSeqNumber - highAck;
+      if (sendingBuffer.Empty () || sFlow->state != ESTABLISHED || sFlow->maxSeqNb != sFlow->TxSeqNumber - 1
+          || m_rwndScale * remoteRecvWnd < unAcked + sFlow->MSS)
+        break;
+      int amountSent = SendDataPacket (sFlowIdx, std::min (sFlow->MSS, sendingBuffer.PendingData ()), false);
+      if (amountSent <= 0)
+        break;
+      nOctetsSent += amountSent;
     }
+  if (nOctetsSent > 0)
+    NotifyDataSent (GetTxAvailable ());
 }
 
-DSNMapping*
-MpTcpSocketBase::getAckedSegment (uint8_t sFlowIdx, uint32_t ack)
+bool
+MpTcpSocketBase::UseDupAckThresh () const
+{
+  return m_lossRecovery == DupAck_Recovery || !m_sack;
+}
+
+void
+MpTcpSocketBase::SegmentSent (uint8_t sFlowIdx, DSNMapping* ptrDSN)
 {
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  DSNMapping* ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin (); it != sFlow->mapDSN.end (); ++it)
-    {
-      DSNMapping* dsn = *it;
-      if (dsn->subflowSeqNumber + dsn->dataLevelLength == ack)
-        {
-          ptrDSN = dsn;
-          break;
-        }
+  if (ptrDSN != 0)
+    { // New segments get their send time when their mapping is made
+      ptrDSN->xmitTime = Simulator::Now ();
+      ptrDSN->retransmitted = true;
     }
-  return ptrDSN;
+  if (m_lossRecovery == Rack_Tlp && !sFlow->tlpEvent.IsRunning ())
+    ScheduleTlp (sFlowIdx);
 }
 
-DSNMapping*
-MpTcpSocketBase::getSegmentOfACK (uint8_t sFlowIdx, uint32_t ack)
+/*
+ * RACK (RFC 8985 sec.6.2 step 2): the newest segment this ACK delivers, cumulatively or in a SACK
+ * block, sets RACK.xmit_ts. Retransmitted segments acked within min RTT are skipped, the ACK is
+ * likely for the original transmission. Must run before the ACK discards acked segments.
+ */
+void
+MpTcpSocketBase::RackUpdate (uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
 {
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  DSNMapping* ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin (); it != sFlow->mapDSN.end (); ++it)
+  uint32_t ack = mptcpHeader.GetAckNumber ().GetValue ();
+  DSNMapping* delivered[1 + OptDSACK::MAX_BLOCKS];
+  uint32_t count = 0;
+  // Segments are sent in order apart from retransmissions, so the last cumulatively acked one is the newest
+  DSNMapping* ptrDSN = (ack > sFlow->highestAck + 1) ? sFlow->mapDSN.FindByEnd (ack) : 0;
+  if (ptrDSN != 0)
+    delivered[count++] = ptrDSN;
+  const TcpOptionList &options = mptcpHeader.GetOptions ();
+  for (uint32_t i = 0; i < options.size (); i++)
     {
-      DSNMapping* dsn = *it;
-      if (dsn->subflowSeqNumber == ack)
+      if (options[i]->optName != OPT_DSACK)
+        continue;
+      const OptDSACK* sack = (const OptDSACK*) options[i];
+      for (uint32_t j = 0; j + 1 < sack->nEdges && count < 1 + OptDSACK::MAX_BLOCKS; j += 2)
         {
-          ptrDSN = dsn;
-          break;
+          ptrDSN = (sack->blocks[j + 1] > ack) ? sFlow->mapDSN.FindByEnd ((uint32_t) sack->blocks[j + 1]) : 0;
+          if (ptrDSN != 0)
+            delivered[count++] = ptrDSN;
+        }
+    }
+  Time now = Simulator::Now ();
+  for (uint32_t i = 0; i < count; i++)
+    {
+      DSNMapping* d = delivered[i];
+      Time rtt = now - d->xmitTime;
+      if (d->retransmitted && rtt < sFlow->rackMinRtt)
+        continue;
+      if (sFlow->rackMinRtt.IsZero () || rtt < sFlow->rackMinRtt)
+        sFlow->rackMinRtt = rtt;
+      uint32_t endSeq = d->subflowSeqNumber + d->dataLevelLength;
+      if (d->xmitTime > sFlow->rackXmitTime || (d->xmitTime == sFlow->rackXmitTime && endSeq > sFlow->rackEndSeq))
+        {
+          sFlow->rackXmitTime = d->xmitTime;
+          sFlow->rackEndSeq = endSeq;
+          sFlow->rackRtt = rtt;
+        }
+    }
+}
+
+/*
+ * RACK (RFC 8985 sec.6.2 step 5): an unacked segment sent more than RACK.rtt + reordering window
+ * (min RTT / 4) before the newest delivered one is lost, however few duplicated ACKs came back.
+ * Segments that would be lost a little later arm the reordering timer. The first loss enters
+ * recovery with the usual window cut, lost segments are retransmitted at once.
+ */
+void
+MpTcpSocketBase::RackDetectLoss (uint8_t sFlowIdx)
+{
+  NS_LOG_FUNCTION (this << (int)sFlowIdx);
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  sFlow->rackEvent.Cancel ();
+  if (sFlow->rackEndSeq == 0 || sFlow->state == CLOSED || sFlow->state == TIME_WAIT)
+    return;
+  Time now = Simulator::Now ();
+  Time reoWnd = NanoSeconds (sFlow->rackMinRtt.GetNanoSeconds () / 4);
+  Time timeout = Seconds (0);
+  vector<DSNMapping*> lost;
+  uint32_t left, right;
+  for (DSNMappingQueue::iterator it = sFlow->mapDSN.begin (); it != sFlow->mapDSN.end (); ++it)
+    {
+      DSNMapping* d = *it;
+      if (d->subflowSeqNumber >= sFlow->rackEndSeq)
+        break; // Not sent before the newest delivered segment (apart from retransmissions, skipped below)
+      if (d->subflowSeqNumber <= sFlow->highestAck || d->xmitTime > sFlow->rackXmitTime)
+        continue;
+      if (m_sack && sFlow->scoreboard.GetRange (d->subflowSeqNumber, left, right))
+        continue;
+      Time remaining = d->xmitTime + sFlow->rackRtt + reoWnd - now;
+      if (remaining.IsStrictlyPositive ())
+        timeout = Max (timeout, remaining);
+      else
+        lost.push_back (d);
+    }
+  // Sending may add mappings, so retransmit once the walk is over
+  for (uint32_t i = 0; i < lost.size (); i++)
+    {
+      DSNMapping* d = lost[i];
+      if (!sFlow->m_inFastRec)
+        {
+          FastReTxs++;
+          ReduceCWND (sFlowIdx, d);
         }
+      else
+        DoRetransmit (sFlowIdx, d);
+      uint32_t endSeq = d->subflowSeqNumber + d->dataLevelLength;
+      if (m_sack && endSeq > sFlow->scoreboard.GetHighRxt ())
+        sFlow->scoreboard.SetHighRxt (endSeq);
+    }
+  if (timeout.IsStrictlyPositive ())
+    sFlow->rackEvent = Simulator::Schedule (timeout, &MpTcpSocketBase::RackDetectLoss, this, sFlowIdx);
+}
+
+// TLP (RFC 8985 sec.7.2): probe after 2 * SRTT without ACK, plus the delayed ACK timeout when one segment is out, never after the RTO
+void
+MpTcpSocketBase::ScheduleTlp (uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  sFlow->tlpEvent.Cancel ();
+  if (sFlow->tlpProbed || sFlow->m_inFastRec || sFlow->mapDSN.empty ())
+    return;
+  Time srtt = sFlow->rtt->GetCurrentEstimate ();
+  Time pto = srtt + srtt;
+  if (sFlow->mapDSN.size () == 1 && m_delayedAckCount > 1)
+    pto += m_delayedAckTimeout;
+  pto = Min (pto, sFlow->rtt->RetransmitTimeout ());
+  sFlow->tlpEvent = Simulator::Schedule (pto, &MpTcpSocketBase::TlpTimeout, this, sFlowIdx);
+}
+
+// Sends one new segment if the peer window allows it, else retransmits the last one, so its ACK lets RACK find the tail losses
+void
+MpTcpSocketBase::TlpTimeout (uint8_t sFlowIdx)
+{
+  NS_LOG_FUNCTION (this << (int)sFlowIdx);
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  if (sFlow->state == CLOSED || sFlow->state == TIME_WAIT || sFlow->mapDSN.empty () || sFlow->m_inFastRec)
+    return;
+  sFlow->tlpProbed = true;
+  uint32_t unAcked = sFlow->TxSeqNumber - (sFlow->highestAck + 1);
+  if (!sendingBuffer.Empty () && sFlow->state == ESTABLISHED && sFlow->maxSeqNb == sFlow->TxSeqNumber - 1
+      && m_rwndScale * remoteRecvWnd >= unAcked + sFlow->MSS)
+    {
+      if (SendDataPacket (sFlowIdx, std::min (sFlow->MSS, sendingBuffer.PendingData ()), false) > 0)
+        NotifyDataSent (GetTxAvailable ());
+    }
+  else
+    DoRetransmit (sFlowIdx, sFlow->mapDSN.back ());
+}
+
+/** Retransmit timeout */
+void
+MpTcpSocketBase::Retransmit (uint8_t sFlowIdx)
+{
+  NS_LOG_FUNCTION (this);  //
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  // Exit From Fast Recovery
+//  sFlow->m_inFastRec = false;
+  // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
+  // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
+  // TCP back to slow start
+//  sFlow->ssthresh = std::max (2 * sFlow->MSS, BytesInFlight (sFlowIdx) / 2);
+
+  if(!sFlow->m_inFastRec){
+      // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
+      // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
+      // TCP back to slow start
+      sFlow->ssthresh = std::max (2 * sFlow->MSS, BytesInFlight (sFlowIdx) / 2);
     }
-  return ptrDSN;
+    else{
+      //If already in fast recovery, halve ssThresh again
+      sFlow->ssthresh = sFlow->ssthresh / 2;
+      sFlow->m_duplicatesSize = 0;
+    }
+  sFlow->m_inFastRec = false;
+  sFlow->cwnd = sFlow->MSS; //  sFlow->cwnd = 1.0;
+  UpdateWindowAggregates (sFlowIdx);
+  sFlow->TxSeqNumber = sFlow->highestAck + 1; // m_nextTxSequence = m_txBuffer.HeadSequence(); // Restart from highest Ack
+  sFlow->m_highTxMark = sFlow->TxSeqNumber - 1; //m_highTxMark = m_nextTxSequence - m_segmentSize;
+
+  //DCTCP update duing Timeout
+  if (m_DCTCP || m_dctcpFastReTxRecord)
+    GetDctcpOps ()->OnTimeout (this, sFlowIdx); // Determine the next observation window for updating dctcp's alpha
+  //if (!(sendingBuffer->Empty() && sFlow->mapDSN.size() > 0))
+  sFlow->rtt->IncreaseMultiplier ();  // Double the next RTO
+
+  GetCongestionOps ()->OnTimeout (this, sFlowIdx);
+
+  DoRetransmit (sFlowIdx);  // Retransmit the packet
+#ifdef PLOT
+  Trace (sFlow, TRACE_TIMEOUT, TimeScale);
+#endif
+  TimeOuts++;
+  // rfc 3782 - Recovering from timeOut
+  //sFlow->m_recover = SequenceNumber32(sFlow->maxSeqNb + 1);
+}
+
+void
+MpTcpSocketBase::SetReTxTimeout (uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  if (!sFlow->RetxPending ())
+    StartReTxTimer (sFlowIdx);
+}
+
+/*
+ * (Re)starts the retransmission timer of a subflow. With TimerWheel it runs on the node's
+ * timer wheel, where restarting a running timer on every new ACK is only a deadline update.
+ */
+void
+MpTcpSocketBase::StartReTxTimer (uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  Time rto = sFlow->rtt->RetransmitTimeout ();
+  NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time> " <<Simulator::Now ().GetSeconds () << " to expire at time " <<(Simulator::Now () + rto).GetSeconds ());
+  if (m_timerWheel)
+    {
+      if (m_wheel == 0)
+        m_wheel = MpTcpTimerWheel::GetWheel (m_node);
+      if (!sFlow->rtoTimer.HasFunction ())
+        sFlow->rtoTimer.SetFunction (MakeCallback (&MpTcpSocketBase::ReTxTimeout, this).Bind (sFlowIdx));
+      sFlow->rtoTimer.Schedule (m_wheel, rto);
+    }
+  else
+    sFlow->retxEvent = Simulator::Schedule (rto, &MpTcpSocketBase::ReTxTimeout, this, sFlowIdx);
+}
+
+DSNMapping*
+MpTcpSocketBase::getAckedSegment (uint8_t sFlowIdx, uint32_t ack)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  return sFlow->mapDSN.FindByEnd (ack);
+}
+
+DSNMapping*
+MpTcpSocketBase::getSegmentOfACK (uint8_t sFlowIdx, uint32_t ack)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  return sFlow->mapDSN.Find (ack);
 }
 void
 MpTcpSocketBase::NewAckNewReno (uint8_t sFlowIdx, const TcpHeader& mptcpHeader, TcpOptions* opt)
@@ -2638,7 +2750,14 @@ MpTcpSocketBase::NewAckNewReno (uint8_t sFlowIdx, const TcpHeader& mptcpHeader,
 
   NS_LOG_LOGIC ("TcpNewReno receieved ACK for seq " << ack <<" cwnd " << sFlow->cwnd <<" ssthresh " << sFlow->ssthresh);
   // Check for exit condition of fast recovery
-  if (sFlow->m_inFastRec && ack < sFlow->m_recover)
+  if (sFlow->m_inFastRec && ack < sFlow->m_recover && m_sack)
+    { // Partial ACK, the scoreboard tells which holes are left to retransmit (RFC 6675 sec.5 step C)
+      NewACK (sFlowIdx, mptcpHeader, opt);
+      SackRecoverySend (sFlowIdx);
+      pAck++;
+      return;
+    }
+  else if (sFlow->m_inFastRec && ack < sFlow->m_recover)
     { // Partial ACK, partial window deflation (RFC2582 sec.3 bullet #5 paragraph 3)
       NS_LOG_WARN("NewAckNewReno -> ");
 //      sFlow->cwnd -= ack.GetValue () - (sFlow->highestAck + 1); // data bytes where acked
@@ -2656,9 +2775,9 @@ MpTcpSocketBase::NewAckNewReno (uint8_t sFlowIdx, const TcpHeader& mptcpHeader,
 //      sFlow->cwnd += sFlow->MSS; // increase cwnd
 #ifdef PLOT
       NS_LOG_LOGIC ("Partial ACK in fast recovery: cwnd set to " << sFlow->cwnd.Get());
-      PartialAck.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd.Get ()));
-      sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
-      sFlow->_FR_PA.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
+      Trace (TRACE_PARTIAL_ACK, sFlow->cwnd.Get ());
+      Trace (sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
+      Trace (sFlow, TRACE_FR_PA, TimeScale);
 #endif
       DiscardUpTo (sFlowIdx, ack.GetValue ());
       DSNMapping* ptrDSN = getSegmentOfACK (sFlowIdx, ack.GetValue ());
@@ -2677,21 +2796,17 @@ MpTcpSocketBase::NewAckNewReno (uint8_t sFlowIdx, const TcpHeader& mptcpHeader,
       sFlow->m_duplicatesSize= 0; //Reset the duplicate size since we're leaving fast recovery
       // Exit from Fast recovery
       sFlow->m_inFastRec = false;
+      UpdateWindowAggregates (sFlowIdx);
       FullAcks++;
 #ifdef PLOT
-      FullAck.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd.Get ()));
-      sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
-      sFlow->_FR_FA.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
+      Trace (TRACE_FULL_ACK, sFlow->cwnd.Get ());
+      Trace (sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
+      Trace (sFlow, TRACE_FR_FA, TimeScale);
 #endif
     }
 
   if (!(sFlow->mapDSN.size () == 0 && sendingBuffer.Empty () && sFlow->state == FIN_WAIT_1))
-    { // Increase cwnd by XMP or others
-      if (AlgoCC == XMP)
-        DoSubflowNewAck (sFlowIdx, ack.GetValue ());
-      else
-        OpenCWND (sFlowIdx, ackedBytes);
-    }
+    OpenCWND (sFlowIdx, ackedBytes);
 
   // Complete newAck processing
   NewACK (sFlowIdx, mptcpHeader, opt);      // update m_nextTxSequence and send new data if allowed by window
@@ -2706,9 +2821,7 @@ MpTcpSocketBase::NewACK (uint8_t sFlowIdx, const TcpHeader& mptcpHeader, TcpOpti
 
   // On recieving a "New" ack we restart retransmission timer .. RFC 2988
   sFlow->retxEvent.Cancel ();
-  Time rto = sFlow->rtt->RetransmitTimeout ();
-  NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time> " <<Simulator::Now ().GetSeconds () << " to expire at time " <<(Simulator::Now () + rto).GetSeconds ());
-  sFlow->retxEvent = Simulator::Schedule (rto, &MpTcpSocketBase::ReTxTimeout, this, sFlowIdx);
+  StartReTxTimer (sFlowIdx);
 
   // Note the highest ACK and tell app to send more
   DiscardUpTo (sFlowIdx, ack);
@@ -2726,12 +2839,18 @@ MpTcpSocketBase::NewACK (uint8_t sFlowIdx, const TcpHeader& mptcpHeader, TcpOpti
   if (sendingBuffer.Empty () && sFlow->mapDSN.size () == 0 && sFlow->state != FIN_WAIT_1 && sFlow->state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_INFO ("("<< (int)sFlow->routeId << ") NewAck -> Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now () + Simulator::GetDelayLeft (sFlow->retxEvent)).GetSeconds () << ", DSNmap: " << sFlow->mapDSN.size());
-      sFlow->retxEvent.Cancel ();
+      sFlow->CancelRetx ();
     }
 
   sFlow->highestAck = std::max (sFlow->highestAck, ack - 1);
   NS_LOG_WARN("NewACK-> sFlow->highestAck: " << sFlow->highestAck);
 
+  if (m_lossRecovery == Rack_Tlp)
+    {
+      sFlow->tlpProbed = false;
+      ScheduleTlp (sFlowIdx);
+    }
+
   currentSublow = sFlow->routeId;
   SendPendingData (sFlow->routeId); // in newack()
 }
@@ -2835,6 +2954,30 @@ MpTcpSocketBase::SendEmptyPacket (uint8_t sFlowIdx, uint8_t flags)
       olen += 6;
     }
 
+  if (m_sack && isAck)
+    { // SACK blocks: the range of the latest out of order segment first (RFC 2018 sec.4), then another one
+      sFlow->sackRcv.DiscardBelow (sFlow->RxSeqNumber);
+      uint32_t left, right, left2, right2;
+      if (sFlow->sackRcv.GetRangeCount () > 0)
+        {
+          if (!sFlow->sackRcv.GetRange (sFlow->sackRcvLast, left, right))
+            sFlow->sackRcv.GetFirstRange (left, right);
+          OptDSACK sack (OPT_DSACK);
+          sack.AddBlock (left, right);
+          if ((sFlow->sackRcv.GetRange (sFlow->sackRcvPrev, left2, right2) && left2 != left)
+              || (sFlow->sackRcv.GetFirstRange (left2, right2) && left2 != left))
+            sack.AddBlock (left2, right2);
+          header.AddOptDSACK (OPT_DSACK, sack);
+          olen += 33;
+        }
+    }
+  if (m_timestamps && (flags & TcpHeader::ACK))
+    { // Segments up to RxSeqNumber may update tsRecent from now on
+      sFlow->tsLastAckSent = sFlow->RxSeqNumber;
+      if (sFlow->tsRecent != 0 && olen + 17 <= 40)
+        olen += AddTimestamp (sFlowIdx, header); // Left out when SACK blocks fill the option space
+    }
+
   uint8_t plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
   hlen = 5 + olen;
@@ -2843,7 +2986,12 @@ MpTcpSocketBase::SendEmptyPacket (uint8_t sFlowIdx, uint8_t flags)
   header.SetPaddingLength (plen);
   // @SendEmptyPacket
   if (m_ceBit > 0 && isAck && sFlow->state == ESTABLISHED && server)
-    AddPacketTag (p, ECE_TAG);
+    header.SetFlags (header.GetFlags () | TcpHeader::ECE);
+  if (isAck)
+    { // Any ACK covers the segments a delayed ACK is waiting for
+      sFlow->delAckCount = 0;
+      sFlow->delAckEvent.Cancel ();
+    }
 
   // @SendEmptyPacket -> Add control packet tag
   if (hasSyn || hasFin || (isAck && client))
@@ -2856,7 +3004,7 @@ MpTcpSocketBase::SendEmptyPacket (uint8_t sFlowIdx, uint8_t flags)
   m_tcp->SendPacket (p, header, sFlow->sAddr, sFlow->dAddr, FindOutputNetDevice (sFlow->sAddr));
   //sFlow->rtt->SentSeq (sFlow->TxSeqNumber, 1);           // notify the RTT
 
-  if (sFlow->retxEvent.IsExpired () && (hasFin || hasSyn) && !isAck)
+  if (!sFlow->RetxPending () && (hasFin || hasSyn) && !isAck)
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       //RTO = sFlow->rtt->RetransmitTimeout();
       sFlow->retxEvent = Simulator::Schedule (RTO, &MpTcpSocketBase::SendEmptyPacket, this, sFlowIdx, flags);
@@ -2933,6 +3081,14 @@ MpTcpSocketBase::Recv (uint32_t size)
   return recvingBuffer.Retrieve (toRead);
 }
 
+// Null packet means no data to read. In payload mode the packet is a fragment of what was received
+Ptr<Packet>
+MpTcpSocketBase::RecvPacket (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  return recvingBuffer.RetrievePacket (size);
+}
+
 //uint32_t
 //MpTcpSocketBase::Recv(uint8_t* buf, uint32_t size)
 //{
@@ -2949,29 +3105,14 @@ MpTcpSocketBase::ForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t port, Ptr
   NS_LOG_FUNCTION_NOARGS();
   DoForwardUp (p, header, port, interface);
 }
+// CE comes from the IP header, ECE from the TCP flags which are then cleared, so flag tests see the same flags as without ECN
 void
-MpTcpSocketBase::ExtractPacketTags (Ptr<Packet> p)
+MpTcpSocketBase::ExtractEcn (Ptr<Packet> p, const Ipv4Header& header, TcpHeader& mptcpHeader)
 {
-  m_ceBit = 0;
-  m_eceBit = 0;
-  CeTag tag;
-  bool done = p->RemovePacketTag (tag);
-  if (done)
-    {
-      m_ceBit = tag.GetCe ();
-    }
-  EceTag ece;
-  done = p->RemovePacketTag (ece);
-  if (done)
-    {
-      m_eceBit = ece.GetEce ();
-    }
-  ControlTag ct; // Just remove it from packet.
-  p->RemovePacketTag (ct);
-  EctTag ect;
-  p->RemovePacketTag(ect);
-  EcmpTag ecmp;
-  p->RemovePacketTag(ecmp);
+  m_ceBit = (header.GetEcn () == Ipv4Header::ECN_CE) ? 1 : 0;
+  m_eceBit = (mptcpHeader.GetFlags () & TcpHeader::ECE) ? 1 : 0;
+  mptcpHeader.SetFlags (mptcpHeader.GetFlags () & ~(TcpHeader::ECE | TcpHeader::CWR));
+  p->RemoveAllPacketTags (); // Control and ECMP tags are of no use above this point
 }
 void
 MpTcpSocketBase::DoForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t port, Ptr<Ipv4Interface> interface)
@@ -2992,7 +3133,7 @@ MpTcpSocketBase::DoForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t port, P
   p->RemoveHeader (mptcpHeader);
 
   // DCTCP
-  ExtractPacketTags(p);
+  ExtractEcn (p, header, mptcpHeader);
 
   m_remotePort = port;
   m_localPort = mptcpHeader.GetDestinationPort ();
@@ -3045,23 +3186,14 @@ MpTcpSocketBase::DoForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t port, P
   if (ReadOptions (sFlowIdx, p, mptcpHeader) == false)
     return;
 
-  if (AlgoCC == XMP && m_eceBit > 0 && sFlow->m_cwr == 1 && sFlow->state == ESTABLISHED && sFlow->routeId < maxSubflows && client)
-    { // XMP
-      assert(!m_DCTCP);
-      sFlow->m_cwr = 2;
-      sFlow->m_cwrHighSeq = sFlow->TxSeqNumber; // m_baseSocket->m_nextTxSequence;
-      DoXMPEnterCWR (sFlowIdx); // NaMPTSubflow::sFlow->m_enterCWR()
-#ifdef PLOT_DCTCP
-      uint32_t tmp = (((mptcpHeader.GetAckNumber ()).GetValue () - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-      sFlow->XMP_CWR2.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
-#endif
-    }
+  if (m_eceBit > 0 && sFlow->state == ESTABLISHED && sFlow->routeId < maxSubflows && client)
+    GetCongestionOps ()->EcnEcho (this, sFlowIdx);
 
   if (AlgoCC == XMP && m_eceBit > 0)
-    { // We do the same for DCTCP @ CalculateDCTCPAlpha()
+    { // We do the same for DCTCP @ MpTcpDctcp::UpdateAlpha()
 #ifdef PLOT_DCTCP
       uint32_t tmp = (((mptcpHeader.GetAckNumber ()).GetValue () - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-      sFlow->ECN_ECHO.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+      Trace (sFlow, TRACE_ECN_ECHO, tmp);
 #endif
     }
 
@@ -3164,7 +3296,7 @@ MpTcpSocketBase::InitiateSubflows ()
         if (sFlow->m_endPoint == 0)
           return -1;
         sFlow->m_endPoint->SetRxCallback (MakeCallback (&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase> (this)));
-        subflows.insert (subflows.end (), sFlow);
+        InsertSubflow (sFlow);
 
         // Create packet and add MP_JOIN option to it.
         Ptr<Packet> pkt = Create<Packet> ();
@@ -3220,7 +3352,7 @@ MpTcpSocketBase::InitiateSingleSubflows (uint16_t randomPort)
   if (sFlow->m_endPoint == 0)
     return -1;
   sFlow->m_endPoint->SetRxCallback (MakeCallback (&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase> (this)));
-  subflows.insert (subflows.end (), sFlow);
+  InsertSubflow (sFlow);
 
   // Create packet and add MP_JOIN option to it.
   Ptr<Packet> pkt = Create<Packet> ();
@@ -3318,42 +3450,124 @@ MpTcpSocketBase::InitiateMultipleSubflows()
 void
 MpTcpSocketBase::calculateTotalCWND ()
 {
-  totalCwnd = 0;
   if (m_dynamicSubflow && m_incastCounter >= m_incastThreshold)
     { // Look at subflow zero only as it should only be activated now...
       assert(maxSubflows >= 2);
       if (subflows[0]->m_inFastRec)
-        totalCwnd += subflows[0]->ssthresh;
+        totalCwnd = subflows[0]->ssthresh;
       else
-        totalCwnd += subflows[0]->cwnd.Get ();  // Should be this all the time
+        totalCwnd = subflows[0]->cwnd.Get ();  // Should be this all the time
     }
   else
     {
-      for (uint32_t i = 0; i < subflows.size (); i++)
-        {
-          if (subflows[i]->m_inFastRec)
-            totalCwnd += subflows[i]->ssthresh;
-          else
-            totalCwnd += subflows[i]->cwnd.Get ();  // Should be this all the time
-        }
+      AttachSubflows ();
+      totalCwnd = m_coupledWindow;
     }
 }
 
-uint32_t
-MpTcpSocketBase::compute_total_window ()
+void
+MpTcpSocketBase::AttachSubflows ()
 {
-  if (AlgoCC < COUPLED_SCALABLE_TCP)
-    exit (10);
+  while (m_attachedSubflows < subflows.size ())
+    {
+      uint8_t sFlowIdx = m_attachedSubflows++;
+      subflows[sFlowIdx]->cwnd.ConnectWithoutContext (MakeBoundCallback (&MpTcpSocketBase::CwndChanged, this, sFlowIdx));
+      UpdateWindowAggregates (sFlowIdx);
+    }
+}
 
-  totalCwnd = 0;
-  for (uint32_t i = 0; i < subflows.size (); i++)
+void
+MpTcpSocketBase::DetachSubflows ()
+{
+  for (uint32_t i = 0; i < m_attachedSubflows; i++)
+    subflows[i]->cwnd.DisconnectWithoutContext (MakeBoundCallback (&MpTcpSocketBase::CwndChanged, this, (uint8_t) i));
+  m_attachedSubflows = 0;
+}
+
+void
+MpTcpSocketBase::CwndChanged (MpTcpSocketBase *socket, uint8_t sFlowIdx, uint32_t oldCwnd, uint32_t newCwnd)
+{
+  socket->UpdateWindowAggregates (sFlowIdx, newCwnd); // Fired before cwnd holds the new value
+}
+
+/*
+ * Replaces the previous share of one subflow in the aggregates by its current one, so the
+ * per ACK congestion control never has to walk all subflows. Only a drop of the subflow
+ * holding the largest cwnd / rtt^2 needs a scan, over the cached shares.
+ */
+void
+MpTcpSocketBase::UpdateWindowAggregates (uint8_t sFlowIdx)
+{
+  if (sFlowIdx < m_attachedSubflows)
+    UpdateWindowAggregates (sFlowIdx, subflows[sFlowIdx]->cwnd.Get ());
+}
+
+void
+MpTcpSocketBase::UpdateWindowAggregates (uint8_t sFlowIdx, uint32_t cwnd)
+{
+  if (sFlowIdx >= m_attachedSubflows)
+    return;
+  UpdateWindowShare (sFlowIdx, cwnd);
+  double rate2 = subflows[sFlowIdx]->aggRate2;
+  if (rate2 >= m_coupledMaxRate2)
     {
-      if (subflows[i]->m_inFastRec)
-        totalCwnd += subflows[i]->ssthresh;
-      else
-        totalCwnd += subflows[i]->cwnd.Get ();
+      m_coupledMaxRate2 = rate2;
+      m_coupledMaxIdx = sFlowIdx;
     }
-  return totalCwnd;
+  else if (m_coupledMaxIdx == sFlowIdx)
+    RebuildWindowAggregates ();
+}
+
+void
+MpTcpSocketBase::UpdateWindowShare (uint8_t sFlowIdx, uint32_t cwnd)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  uint32_t window = sFlow->m_inFastRec ? sFlow->ssthresh : cwnd;
+  bool coupled = IsCoupledSubflow (sFlowIdx);
+  double rate = 0;
+  double rate2 = 0;
+  if (coupled)
+    {
+      double rtt = sFlow->rtt->GetCurrentEstimate ().GetMicroSeconds ();
+      if (rtt == 0)
+        rtt = 1;
+      rate = cwnd / rtt;
+      rate2 = cwnd / (rtt * rtt);
+    }
+  m_totalWindow += window - sFlow->aggWindow;
+  m_coupledWindow += (coupled ? window : 0) - (sFlow->aggCoupled ? sFlow->aggWindow : 0);
+  m_coupledRate += rate - sFlow->aggRate;
+  sFlow->aggWindow = window;
+  sFlow->aggCoupled = coupled;
+  sFlow->aggRate = rate;
+  sFlow->aggRate2 = rate2;
+}
+
+void
+MpTcpSocketBase::RebuildWindowAggregates ()
+{
+  double rate = 0;
+  double maxRate2 = 0;
+  m_coupledMaxIdx = -1;
+  for (uint32_t i = 0; i < m_attachedSubflows; i++)
+    {
+      if (subflows[i]->aggCoupled != IsCoupledSubflow (i))
+        UpdateWindowShare (i, subflows[i]->cwnd.Get ());
+      rate += subflows[i]->aggRate; // Also drops the rounding error of the running sum
+      if (m_coupledMaxIdx < 0 || subflows[i]->aggRate2 > maxRate2)
+        {
+          maxRate2 = subflows[i]->aggRate2;
+          m_coupledMaxIdx = i;
+        }
+    }
+  m_coupledRate = rate;
+  m_coupledMaxRate2 = maxRate2;
+}
+
+bool
+MpTcpSocketBase::IsCoupledSubflow (uint8_t sFlowIdx) const
+{
+  return true;
 }
 
 void
@@ -3361,45 +3575,43 @@ MpTcpSocketBase::ReadUnOrderedData ()
 {
   NS_LOG_FUNCTION (this);
   //NS_LOG_WARN("ReadUnOrderedData()-> Size: " << unOrdered.size());
-  list<DSNMapping *>::iterator current = unOrdered.begin ();
-  list<DSNMapping *>::iterator next = unOrdered.begin ();
 
   // I changed this method, now whenever a segment is readed it get dropped from that list
-  while (next != unOrdered.end ())
-    {
-      ++next;
-      DSNMapping *ptrDSN = *current;
-      uint32_t sFlowIdx = ptrDSN->subflowIndex;
-      Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-      if ((ptrDSN->dataSeqNumber <= nextRxSequence) /*&& (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)*/)
-        { /* Stored segment is in-order at connection level */
-          NS_ASSERT(ptrDSN->dataSeqNumber == nextRxSequence);
-
-          //uint32_t amount = recvingBuffer->Add(ptrDSN->packet, ptrDSN->dataLevelLength);
-          uint32_t amount = recvingBuffer.Add (ptrDSN->dataLevelLength);
-          if (amount == 0)
-            { // Receive buffer is full.
-              NS_FATAL_ERROR("In our model receive buffer never get full");
-              break;
-            }
-          NS_ASSERT(amount == ptrDSN->dataLevelLength);
-          nextRxSequence += amount;
-
-          if (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)
-            { /** Stored segment is also in-order at sub-flow level */
-              sFlow->RxSeqNumber += amount;
-              sFlow->highestAck = std::max (sFlow->highestAck, ptrDSN->acknowledgement - 1);
-              //SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
-              sFlow->AccumulativeAck = true; //TODO TEMP
-            }
-          else
-            NS_ASSERT(ptrDSN->subflowSeqNumber < sFlow->RxSeqNumber);
+  DSNMapping *ptrDSN;
+  while ((ptrDSN = unOrdered.Front ()) != 0 && ptrDSN->dataSeqNumber <= nextRxSequence)
+    { /* Stored segment is in-order at connection level */
+      Ptr<MpTcpSubFlow> sFlow = subflows[ptrDSN->subflowIndex];
+      NS_ASSERT(ptrDSN->dataSeqNumber == nextRxSequence);
+
+      uint32_t amount = (ptrDSN->packet != 0) ? recvingBuffer.ReadPacket (ptrDSN->packet, ptrDSN->dataLevelLength)
+                                              : recvingBuffer.Add (ptrDSN->dataLevelLength);
+      if (amount == 0)
+        { // Receive buffer is full.
+          NS_FATAL_ERROR("In our model receive buffer never get full");
+          break;
+        }
+      NS_ASSERT(amount == ptrDSN->dataLevelLength);
+      nextRxSequence += amount;
 
-          NotifyDataRecv ();
-          unOrdered.erase (current);
-          delete ptrDSN;
+      if (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)
+        { /** Stored segment is also in-order at sub-flow level */
+          sFlow->RxSeqNumber += amount;
+          sFlow->highestAck = std::max (sFlow->highestAck, ptrDSN->acknowledgement - 1);
+          //SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
+          sFlow->AccumulativeAck = true; //TODO TEMP
         }
-      else if (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)
+      else
+        NS_ASSERT(ptrDSN->subflowSeqNumber < sFlow->RxSeqNumber);
+
+      NotifyDataRecv ();
+      unOrdered.PopFront ();
+    }
+
+  // Remaining segments are out of order at connection level, but a sub-flow can still advance over them.
+  for (uint32_t sFlowIdx = 0; sFlowIdx < subflows.size (); sFlowIdx++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+      while ((ptrDSN = unOrdered.FindSubflowSegment (sFlowIdx, sFlow->RxSeqNumber)) != 0)
         { /* Stored segment is in-order only at sub-flow level! */
           NS_ASSERT((ptrDSN->dataSeqNumber > nextRxSequence));
           //NS_LOG_UNCOND("ReadUnOrderedData()-> sub-flow is in-order but connection is out of order " << (int)sFlow->routeId);
@@ -3410,7 +3622,6 @@ MpTcpSocketBase::ReadUnOrderedData ()
           sFlow->AccumulativeAck = true;  // TODO TEMP
           //SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
         }
-      current = next;
     }
 }
 
@@ -3439,28 +3650,33 @@ MpTcpSocketBase::DupAck (uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DUPACK.push_back (make_pair (Simulator::Now ().GetSeconds (), tmp));
+  Trace (sFlow, TRACE_DUPACK, tmp);
 #endif
 
   // Congestion control algorithms
-  if (sFlow->m_dupAckCount == 3 && !sFlow->m_inFastRec)
+  if (UseDupAckThresh () && (sFlow->m_dupAckCount == 3 || SackLossDetected (sFlowIdx)) && !sFlow->m_inFastRec)
     { // FastRetrasmsion
       NS_LOG_WARN (Simulator::Now().GetSeconds() <<" DupAck -> Subflow ("<< (int)sFlowIdx <<") 3rd duplicated ACK for segment ("<<ptrDSN->subflowSeqNumber<<")");
 
       if (m_dctcpFastReTxRecord)
         { // danger: m_dctcpFastReTxRecord should be deactivated in normal run
           uint32_t oldCwnd = sFlow->cwnd.Get();
-          RecordDctcpFastRetx(sFlowIdx, oldCwnd);
+          GetDctcpOps ()->RecordFastRetx (this, sFlowIdx, oldCwnd);
         }
 
       // Cut the window to the half
       ReduceCWND (sFlowIdx, ptrDSN);
 
 #ifdef PLOT
-      sFlow->_FReTx.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
+      Trace (sFlow, TRACE_FRETX, TimeScale);
 #endif
       FastReTxs++;
     }
+  else if (sFlow->m_inFastRec && m_sack)
+    { // SACK recovery, the dupack may have taken segments out of the pipe
+      FastRecoveries++;
+      SackRecoverySend (sFlowIdx);
+    }
   else if (sFlow->m_inFastRec)
     { // Fast Recovery
 // Increase cwnd for every additional DupACK (RFC2582, sec.3 bullet #3)
@@ -3468,8 +3684,8 @@ MpTcpSocketBase::DupAck (uint8_t sFlowIdx, DSNMapping* ptrDSN)
       sFlow->m_duplicatesSize += m_segmentSize;
 
 #ifdef PLOT
-      DupAcks.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd));
-      sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
+      Trace (TRACE_DUP_ACKS, sFlow->cwnd);
+      Trace (sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
 #endif
       NS_LOG_WARN ("DupAck-> FastRecovery. Increase cwnd by one MSS, from " << sFlow->cwnd.Get() <<" -> " << sFlow->cwnd << " AvailableWindow: " << AvailableWindow(sFlowIdx));
       FastRecoveries++;
@@ -3543,6 +3759,12 @@ MpTcpSocketBase::PrintCC (uint32_t cc)
   case 12:
     return "XCA";           //12
     break;
+  case 13:
+    return "OLIA";          //13
+    break;
+  case 14:
+    return "BALIA";         //14
+    break;
   default:
     exit (200);
     return "Unknown";
@@ -4947,31 +5169,15 @@ MpTcpSocketBase::GeneratePktCount ()
 /*
  * Segments are stored in this buffer based on mptcp connection sequence number.
  * So if a sub-flow's segment get delayed then other subflow's segments would be stored in-order here (subflow level).
- * This function returns false only when incoming packet is already stored before!
+ * This function returns false only when incoming packet is already stored before, toStore is then deleted!
  */
 bool
-MpTcpSocketBase::StoreUnOrderedData (DSNMapping *toStore)
+MpTcpSocketBase::StoreUnOrderedData (DSNMapping *toStore, Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this);
-  for (list<DSNMapping *>::iterator it = unOrdered.begin (); it != unOrdered.end (); ++it)
-    {
-      DSNMapping *stored = *it;
-      if (toStore->dataSeqNumber == stored->dataSeqNumber)
-        {
-          return false;
-        }
-      else if (toStore->dataSeqNumber < stored->dataSeqNumber)
-        {
-          // This assertion is to make sure un-ordered segments are stored in-order of subflow & connection level.
-          if (toStore->subflowIndex == stored->subflowIndex)
-            NS_ASSERT(toStore->subflowSeqNumber < stored->subflowSeqNumber);
-
-          unOrdered.insert (it, toStore);
-          return true;
-        }
-    }
-  unOrdered.insert (unOrdered.end (), toStore);
-  return true;
+  if (recvingBuffer.GetPayloadMode ())
+    toStore->packet = p; // Delivered to the receive buffer as it is once in order
+  return unOrdered.Insert (toStore);
 }
 
 /** Peer sent me a FIN. Remember its sequence in rx buffer. */
@@ -5091,20 +5297,7 @@ bool
 MpTcpSocketBase::FindPacketFromUnOrdered (uint8_t sFlowIdx)
 {
   NS_LOG_FUNCTION((int)sFlowIdx);
-  bool reValue = false;
-  list<DSNMapping *>::iterator current = unOrdered.begin ();
-  while (current != unOrdered.end ())
-    {
-      DSNMapping* ptrDSN = *current;
-      if (ptrDSN->subflowIndex == sFlowIdx)
-        {
-          reValue = true;
-          NS_LOG_LOGIC("(" << (int)sFlowIdx << ") FindPacketFromUnOrdered -> SeqNb" << ptrDSN->subflowSeqNumber << " pSize: " << ptrDSN->dataLevelLength);
-          break;
-        }
-      current++;
-    }
-  return reValue;
+  return unOrdered.HasSubflowSegment (sFlowIdx);
 }
 
 /** This function closes the endpoint completely. Called upon RST_TX action. */
@@ -5573,6 +5766,14 @@ MpTcpSocketBase::AvailableWindow (uint8_t sFlowIdx)
     }
 }
 
+uint32_t
+MpTcpSocketBase::UsableWindow (uint8_t sFlowIdx)
+{
+  if (subflows[sFlowIdx]->state != ESTABLISHED)
+    return 0;
+  return std::min (AvailableWindow (sFlowIdx), sendingBuffer.PendingData ());
+}
+
 uint32_t
 MpTcpSocketBase::GetTxAvailable ()
 {
@@ -5686,16 +5887,10 @@ MpTcpSocketBase::LookupSubflow (Ipv4Address src, uint32_t srcPort, Ipv4Address d
   Ptr<MpTcpSubFlow> sFlow = 0;
   uint8_t sFlowIdx = maxSubflows;
 
-  // Walk through the existing subflow container and try to find one with 4-tuple match!
-  for (uint32_t i = 0; i < subflows.size (); i++)
-    {
-      sFlow = subflows[i];
-      if (sFlow->sAddr == src && sFlow->dAddr == dst && sFlow->sPort == srcPort && sFlow->dPort == dstPort)
-        {
-          sFlowIdx = i;
-          return sFlowIdx;
-        }
-    }
+  // Find the subflow with 4-tuple match in the subflow index!
+  int idx = subflowIndex.Find (MpTcpSubflowTuple (src, srcPort, dst, dstPort));
+  if (idx >= 0)
+    return idx;
 
   // For now this should be happen only at server side
   NS_ASSERT(server);
@@ -5723,285 +5918,37 @@ MpTcpSocketBase::LookupSubflow (Ipv4Address src, uint32_t srcPort, Ipv4Address d
   if (sFlow->m_endPoint == 0)
     return -1;
   sFlow->m_endPoint->SetRxCallback (MakeCallback (&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase> (this)));
-  subflows.insert (subflows.end (), sFlow);
+  InsertSubflow (sFlow);
   NS_LOG_UNCOND(this << " LookupSubflow -> Subflow(" << (int) sFlowIdx <<") has created its (src,dst) = (" << sFlow->sAddr << ":" << sFlow->sPort << " , "<< sFlow->dAddr << ":" << sFlow->dPort<< ")" );
 
   return sFlowIdx;
 }
 
-uint32_t
-MpTcpSocketBase::compute_a_scaled ()
-{
-  if (AlgoCC < COUPLED_EPSILON)
-    exit (1);
-
-  uint32_t sum_denominator = 0;
-  uint64_t t = 0;
-  uint64_t cwndSum = 0;
-
-  for (uint32_t i = 0; i < subflows.size (); i++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[i];
-      Time time = sFlow->rtt->GetCurrentEstimate ();
-      uint32_t rtt = time.GetMicroSeconds () / 10;
-      if (rtt == 0)
-        rtt = 1;
-
-      uint32_t cwnd = sFlow->m_inFastRec ? sFlow->ssthresh : sFlow->cwnd.Get ();
-      uint32_t mss = sFlow->MSS;
-
-      t = max (t, (uint64_t) cwnd * mss * mss / rtt / rtt);
-      sum_denominator += cwnd * mss / rtt;
-      cwndSum += cwnd;
-    }
-  return (uint32_t) (A_SCALE * (uint64_t) cwndSum * t / sum_denominator / sum_denominator);
-}
-
-double
-MpTcpSocketBase::compute_alfa ()
-{
-  if (AlgoCC < COUPLED_EPSILON)
-    exit (300);
-
-  if (subflows.size () == 1)
-    {
-      return 1;
-    }
-  else
-    {
-      double maxt = 0, sum_denominator = 0;
-      for (uint32_t i = 0; i < subflows.size (); i++)
-        {
-          Ptr<MpTcpSubFlow> sFlow = subflows[i];
-          uint32_t cwnd = sFlow->m_inFastRec ? sFlow->ssthresh : sFlow->cwnd.Get ();
-          Time time = sFlow->rtt->GetCurrentEstimate ();
-          uint32_t rtt = time.GetMilliSeconds ();
-
-          if (rtt == 0)
-            rtt = 1;
-
-          double t = pow (cwnd, _e / 2) / rtt;
-          if (t > maxt)
-            maxt = t;
-          sum_denominator += ((double) cwnd / rtt);
-        }
-      return (double) compute_total_window () * pow (maxt, 1 / (1 - _e / 2)) / pow (sum_denominator, 1 / (1 - _e / 2));
-    }
-}
-
 void
-MpTcpSocketBase::window_changed ()
+MpTcpSocketBase::InsertSubflow (Ptr<MpTcpSubFlow> sFlow)
 {
-  switch (AlgoCC)
-    {
-  case COUPLED_EPSILON:
-    if (_e > 0 && _e < 2)
-      alpha = compute_alfa ();
-    return;
-  case COUPLED_INC:
-    a = compute_a_scaled ();
-    return;
-  default:
-    break;
-    }
+  NS_LOG_FUNCTION(this << sFlow);
+  // If the 4-tuple is already used, lookups keep returning the first subflow as the former linear search did
+  subflowIndex.Insert (MpTcpSubflowTuple (sFlow->sAddr, sFlow->sPort, sFlow->dAddr, sFlow->dPort), subflows.size ());
+  subflows.push_back (sFlow);
 }
 
 void
 MpTcpSocketBase::OpenCWND (uint8_t sFlowIdx, uint32_t ackedBytes)
 {
   NS_LOG_FUNCTION(this << (int) sFlowIdx << ackedBytes);
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-
-  double adder = 0;
-  uint32_t cwnd = sFlow->cwnd.Get ();
-  uint32_t ssthresh = sFlow->ssthresh;
-  uint32_t mss = sFlow->MSS;
-
-  // params used only for COUPLED_INC and COUPLED_EPS only
-  int tcp_inc = 0, tt = 0;
-  int tmp, total_cwnd, tmp2;
-  double tmp_float;
-
-  if (AlgoCC >= COUPLED_SCALABLE_TCP)
-    {
-      if (ackedBytes > mss)
-        ackedBytes = mss;
-      if (ackedBytes < 0)
-        {
-          exit (200);
-          return;
-        }
-      tcp_inc = (ackedBytes * mss) / cwnd;
-      tt = (ackedBytes * mss) % cwnd;
-      if (m_alphaPerAck)
-        {
-          a = compute_a_scaled (); // Per ACK for COUPLED_INC
-          alpha = compute_alfa (); // Per ACK for COUPLED_EPSILON
-        }
-    }
-
-  calculateTotalCWND ();
-  if (cwnd < ssthresh)
-    {
-      sFlow->cwnd += sFlow->MSS;
 #ifdef PLOT
-      sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
-      sFlow->CWNDtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd));
-      totalCWNDtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), totalCwnd));
-      sFlow->_ss.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  bool slowStart = sFlow->cwnd.Get () < sFlow->ssthresh;
 #endif
-      NS_LOG_WARN ("Congestion Control (Slow Start) increment by one segmentSize");
-    }
-  else
-    {
-      switch (AlgoCC)
-        {
-      case Fast_Uncoupled:
-        //calculateFastAlpha(sFlowIdx);
-        adder = ((1 - sFlow->dctcp_last_fraction) * sFlow->MSS * sFlow->MSS) / cwnd;
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        break;
-      case Fast_Increases:
-        adder = ((1 - sFlow->dctcp_last_fraction) * sFlow->MSS * sFlow->MSS) / totalCwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-        break;
-      case XCA:
-        adder = static_cast<double> (sFlow->MSS * sFlow->MSS) / totalCwnd;
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        break;
-      case RTT_Compensator:
-        calculateAlpha (); // Calculate alpha per drop or RTT...RFC 6356 (Section 4.1)
-        adder = std::min (alpha * sFlow->MSS * sFlow->MSS / totalCwnd, static_cast<double> (sFlow->MSS * sFlow->MSS) / cwnd);
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        NS_LOG_ERROR ("Congestion Control (RTT_Compensator): alpha "<<alpha<<" ackedBytes (" << ackedBytes << ") totalCwnd ("<< totalCwnd / sFlow->MSS<<" packets) -> increment is "<<adder << " cwnd: " << sFlow->cwnd);
-        break;
-      case Linked_Increases:
-        calculateAlpha ();
-        adder = alpha * sFlow->MSS * sFlow->MSS / totalCwnd;
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Linked_Increases): alpha "<<alpha<<" increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd );
-        break;
-      case Uncoupled_TCPs:
-        adder = static_cast<double> (sFlow->MSS * sFlow->MSS) / cwnd;
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        NS_LOG_WARN ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Uncoupled_TCPs) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-        break;
-      case UNCOUPLED:
-        sFlow->cwnd += tcp_inc;
-        break;
-      case Fully_Coupled:
-        adder = static_cast<double> (sFlow->MSS * sFlow->MSS) / totalCwnd;
-        adder = std::max (1.0, adder);
-        sFlow->cwnd += static_cast<double> (adder);
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Fully_Coupled) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-        break;
-      case COUPLED_INC:
-        total_cwnd = compute_total_window ();
-        tmp2 = (ackedBytes * mss * a) / total_cwnd;
-
-        tmp = tmp2 / A_SCALE;
-
-        if (tmp < 0)
-          {
-            printf ("Negative increase!");
-            tmp = 0;
-          }
-
-        if (rand () % A_SCALE < tmp2 % A_SCALE)
-          tmp++;
-
-        if (tmp > tcp_inc)    //capping
-          tmp = tcp_inc;
-
-        if ((cwnd + tmp) / mss != cwnd / mss)
-          a = compute_a_scaled ();
-
-        sFlow->cwnd = cwnd + tmp;
-        break;
-      case COUPLED_EPSILON: // RTT_Compensator
-        total_cwnd = compute_total_window ();
-        tmp_float = ((double) ackedBytes * mss * alpha * pow (alpha * cwnd, 1 - _e)) / pow (total_cwnd, 2 - _e);
-        tmp = (int) floor (tmp_float);
-
-        if (drand () < tmp_float - tmp)
-          tmp++;
-
-        if (tmp > tcp_inc)    //capping
-          tmp = tcp_inc;
-
-        if ((cwnd + tmp) / mss != cwnd / mss)
-          {
-            if (_e > 0 && _e < 2)
-              alpha = compute_alfa ();
-          }
-        sFlow->cwnd = cwnd + tmp;
-        break;
-      case COUPLED_SCALABLE_TCP:
-        sFlow->cwnd = cwnd + ackedBytes * 0.01;
-        break;
-      case COUPLED_FULLY:
-        total_cwnd = compute_total_window ();
-        tt = (int) (ackedBytes * mss * A);
-        tmp = tt / total_cwnd;
-        if (tmp > tcp_inc)
-          tmp = tcp_inc;
-        sFlow->cwnd = cwnd + tmp;
-        break;
-      default:
-        break;
-        }
+  calculateTotalCWND ();
+  GetCongestionOps ()->IncreaseWindow (this, sFlowIdx, ackedBytes);
 #ifdef PLOT
-      sFlow->ssthreshtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->ssthresh));
-      sFlow->CWNDtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), sFlow->cwnd));
-      totalCWNDtrack.push_back (make_pair (Simulator::Now ().GetSeconds (), totalCwnd));
-      sFlow->_ca.push_back (make_pair (Simulator::Now ().GetSeconds (), TimeScale));
+  Trace (sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
+  Trace (sFlow, TRACE_CWND, sFlow->cwnd);
+  Trace (TRACE_TOTAL_CWND, totalCwnd);
+  Trace (sFlow, slowStart ? TRACE_SS : TRACE_CA, TimeScale);
 #endif
-    }
-}
-
-void
-MpTcpSocketBase::calculateAlpha ()
-{
-  // this method is called whenever a congestion happen in order to regulate the agressivety of subflows
-  // alpha = cwnd_total * MAX(cwnd_i / rtt_i^2) / {SUM(cwnd_i / rtt_i))^2}   //RFC 6356 formula (2)
-
-  NS_LOG_FUNCTION_NOARGS ();
-  alpha = 0;
-  double maxi = 0;
-  double sumi = 0;
-
-  for (uint32_t i = 0; i < subflows.size (); i++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[i];
-      Time time = sFlow->rtt->GetCurrentEstimate ();
-      double rtt = time.GetMicroSeconds(); //double rtt = time.GetSeconds ();
-      if (rtt == 0)
-        rtt = 1;
-      double tmpi = sFlow->cwnd.Get () / (rtt * rtt);
-      if (maxi < tmpi)
-        maxi = tmpi;
-
-      sumi += sFlow->cwnd.Get () / rtt;
-    }
-  alpha = (totalCwnd * maxi) / (sumi * sumi);
-}
-
-void
-MpTcpSocketBase::calculateFastAlpha (uint8_t sFlowIdx)
-{
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  if (sFlow->dctcp_last_fraction == 1 || sFlow->curEcnState == true)
-    sFlow->fast_alpha = 0; // Do not increase cwnd when last/current window has received ECN signal
-  else if (sFlow->dctcp_last_fraction == 0 && sFlow->curEcnState == false)
-    sFlow->fast_alpha = 2; // Do increase cwnd by 2 MSS when last and current window are free from marked ACKs
-  else
-    sFlow->fast_alpha = 1; // Do increase by 1 MSS when some ACKs have been marked in the last window & but current window is clean
 }
 
 //void
@@ -6021,11 +5968,7 @@ MpTcpSocketBase::DestroySubflowMapDSN ()
   for (uint32_t i = 0; i < subflows.size (); i++)
     {
       Ptr<MpTcpSubFlow> sFlow = subflows[i];
-      for (std::list<DSNMapping *>::iterator i = sFlow->mapDSN.begin (); i != sFlow->mapDSN.end (); i++)
-        {
-          i = sFlow->mapDSN.erase (i);
-        }
-      sFlow->mapDSN.clear ();
+      sFlow->mapDSN.Clear ();
     }
 }
 
@@ -6033,11 +5976,7 @@ void
 MpTcpSocketBase::DestroyUnOrdered ()
 {
   NS_LOG_FUNCTION_NOARGS();
-  for (std::list<DSNMapping*>::iterator i = unOrdered.begin (); i != unOrdered.end (); i++)
-    {
-      i = unOrdered.erase (i);
-    }
-  unOrdered.clear ();
+  unOrdered.Clear ();
 }
 
 /** Kill this socket. This is a callback function configured to m_endpoint in
@@ -6096,43 +6035,150 @@ void
 MpTcpSocketBase::SetCCAlgo (string cc)
 {
   if (cc == "Uncoupled_TCPs")
-    AlgoCC = Uncoupled_TCPs;
+    SetCongestionCtrlAlgo (Uncoupled_TCPs);
   else if (cc == "Linked_Increases")
-    AlgoCC = Linked_Increases;
+    SetCongestionCtrlAlgo (Linked_Increases);
   else if (cc == "RTT_Compensator")
-    AlgoCC = RTT_Compensator;
+    SetCongestionCtrlAlgo (RTT_Compensator);
   else if (cc == "Fully_Coupled")
-    AlgoCC = Fully_Coupled;
+    SetCongestionCtrlAlgo (Fully_Coupled);
   else if (cc == "COUPLED_SCALABLE_TCP")
-    AlgoCC = COUPLED_SCALABLE_TCP;
+    SetCongestionCtrlAlgo (COUPLED_SCALABLE_TCP);
   else if (cc == "UNCOUPLED")
-    AlgoCC = UNCOUPLED;
+    SetCongestionCtrlAlgo (UNCOUPLED);
   else if (cc == "COUPLED_EPSILON")
-    AlgoCC = COUPLED_EPSILON;
+    SetCongestionCtrlAlgo (COUPLED_EPSILON);
   else if (cc == "COUPLED_INC")
-    AlgoCC = COUPLED_INC;
+    SetCongestionCtrlAlgo (COUPLED_INC);
   else if (cc == "COUPLED_FULLY")
-    AlgoCC = COUPLED_FULLY;
+    SetCongestionCtrlAlgo (COUPLED_FULLY);
   else if (cc == "XMP")
-    AlgoCC = XMP;
+    SetCongestionCtrlAlgo (XMP);
   else if (cc == "Fast_Uncoupled")
-    AlgoCC = Fast_Uncoupled;
+    SetCongestionCtrlAlgo (Fast_Uncoupled);
   else if (cc == "Fast_Increases")
-    AlgoCC = Fast_Increases;
+    SetCongestionCtrlAlgo (Fast_Increases);
   else if (cc == "XCA")
-    AlgoCC = XCA;
+    SetCongestionCtrlAlgo (XCA);
+  else if (cc == "OLIA")
+    SetCongestionCtrlAlgo (OLIA);
+  else if (cc == "BALIA")
+    SetCongestionCtrlAlgo (BALIA);
 }
 
 void
 MpTcpSocketBase::SetCongestionCtrlAlgo (CongestionCtrl_t ccalgo)
 {
   AlgoCC = ccalgo;
+  switch (AlgoCC)
+    {
+  case Uncoupled_TCPs:
+    m_congestionOps = CreateObject<MpTcpUncoupledReno> ();
+    break;
+  case Linked_Increases:
+    m_congestionOps = CreateObject<MpTcpLia> ();
+    break;
+  case RTT_Compensator:
+    m_congestionOps = CreateObject<MpTcpRttCompensator> ();
+    break;
+  case Fully_Coupled:
+    m_congestionOps = CreateObject<MpTcpFullyCoupled> ();
+    break;
+  case COUPLED_SCALABLE_TCP:
+    m_congestionOps = CreateObject<MpTcpCoupledScalable> ();
+    break;
+  case UNCOUPLED:
+    m_congestionOps = CreateObject<MpTcpUncoupledInc> ();
+    break;
+  case COUPLED_EPSILON:
+    m_congestionOps = CreateObject<MpTcpCoupledEpsilon> ();
+    break;
+  case COUPLED_INC:
+    m_congestionOps = CreateObject<MpTcpCoupledInc> ();
+    break;
+  case COUPLED_FULLY:
+    m_congestionOps = CreateObject<MpTcpCoupledFully> ();
+    break;
+  case XMP:
+    m_congestionOps = CreateObject<MpTcpXmp> ();
+    break;
+  case Fast_Uncoupled:
+    m_congestionOps = CreateObject<MpTcpFastUncoupled> ();
+    break;
+  case Fast_Increases:
+    m_congestionOps = CreateObject<MpTcpFastIncreases> ();
+    break;
+  case XCA:
+    m_congestionOps = CreateObject<MpTcpXca> ();
+    break;
+  case OLIA:
+    m_congestionOps = CreateObject<MpTcpOlia> ();
+    break;
+  case BALIA:
+    m_congestionOps = CreateObject<MpTcpBalia> ();
+    break;
+  default:
+    NS_FATAL_ERROR ("Unknown congestion control algorithm " << AlgoCC);
+    }
+}
+
+void
+MpTcpSocketBase::SetCongestionOps (Ptr<MpTcpCongestionOps> ops)
+{
+  m_congestionOps = ops;
+}
+
+Ptr<MpTcpCongestionOps>
+MpTcpSocketBase::GetCongestionOps ()
+{
+  if (m_congestionOps == 0)
+    SetCongestionCtrlAlgo (AlgoCC);
+  return m_congestionOps;
+}
+
+Ptr<MpTcpDctcp>
+MpTcpSocketBase::GetDctcpOps ()
+{
+  if (m_dctcpOps == 0)
+    m_dctcpOps = CreateObject<MpTcpDctcp> ();
+  return m_dctcpOps;
 }
 
 void
 MpTcpSocketBase::SetDataDistribAlgo (DataDistribAlgo_t ddalgo)
 {
   distribAlgo = ddalgo;
+  switch (distribAlgo)
+    {
+  case Round_Robin:
+    m_scheduler = CreateObject<MpTcpRoundRobinScheduler> ();
+    break;
+  case Lowest_RTT:
+    m_scheduler = CreateObject<MpTcpLowestRttScheduler> ();
+    break;
+  case Blest:
+    m_scheduler = CreateObject<MpTcpBlestScheduler> ();
+    break;
+  case Cwnd_Weighted:
+    m_scheduler = CreateObject<MpTcpCwndWeightedScheduler> ();
+    break;
+  default:
+    NS_FATAL_ERROR ("Unknown scheduling algorithm " << distribAlgo);
+    }
+}
+
+void
+MpTcpSocketBase::SetScheduler (Ptr<MpTcpScheduler> scheduler)
+{
+  m_scheduler = scheduler;
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSocketBase::GetScheduler ()
+{
+  if (m_scheduler == 0)
+    SetDataDistribAlgo (distribAlgo);
+  return m_scheduler;
 }
 
 void
@@ -6141,6 +6187,42 @@ MpTcpSocketBase::SetPathManager (PathManager_t pManagerMode)
   pathManager = pManagerMode;
 }
 
+void
+MpTcpSocketBase::SetPayloadMode (bool payload)
+{
+  sendingBuffer.SetPayloadMode (payload);
+  recvingBuffer.SetPayloadMode (payload);
+}
+
+bool
+MpTcpSocketBase::GetPayloadMode () const
+{
+  return sendingBuffer.GetPayloadMode ();
+}
+
+// Histograms are merged on every call, which costs a few hundred additions per subflow
+Time
+MpTcpSocketBase::GetRttPercentile (double p) const
+{
+  MpTcpRttStats stats;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    stats.Merge (subflows[i]->rttStats);
+  return stats.GetPercentile (p);
+}
+
+Time
+MpTcpSocketBase::GetMinRtt () const
+{
+  Time minRtt = Seconds (0);
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      const MpTcpRttStats &stats = subflows[i]->rttStats;
+      if (stats.GetSampleCount () > 0 && (minRtt.IsZero () || stats.GetMin () < minRtt))
+        minRtt = stats.GetMin ();
+    }
+  return minRtt;
+}
+
 void
 MpTcpSocketBase::SetFlowSize(uint32_t size)
 {
@@ -6211,7 +6293,85 @@ MpTcpSocketBase::getQueuePkt (Ipv4Address addr)
   PointerValue ptr;
   net0->GetAttribute ("TxQueue", ptr);
   Ptr<Queue> txQueue = ptr.Get<Queue> ();
-  TxQueue.push_back (make_pair (Simulator::Now ().GetSeconds (), txQueue->GetNPackets ()));
+  Trace (TRACE_TX_QUEUE, txQueue->GetNPackets ());
+}
+
+bool
+MpTcpSocketBase::IsPlotting ()
+{
+  if (!m_largePlotting && !m_shortPlotting)
+    return false;
+  return (m_largePlotting && (flowType.compare ("Large") == 0)) || (m_shortPlotting && (flowType.compare ("Short") == 0));
+}
+
+void
+MpTcpSocketBase::Trace (const Ptr<MpTcpSubFlow> &sFlow, MpTcpTrace_t series, double value)
+{
+  if (m_traceSink != 0)
+    {
+      MpTcpTraceRecord record;
+      record.time = Simulator::Now ().GetSeconds ();
+      record.value = value;
+      record.flowId = flowId;
+      record.series = series;
+      record.subflow = sFlow->routeId;
+      record.reserved = 0;
+      m_traceSink->Record (record);
+    }
+  else if (IsPlotting ())
+    sFlow->Store (series, Simulator::Now ().GetSeconds (), value);
+}
+
+void
+MpTcpSocketBase::Trace (MpTcpTrace_t series, double value)
+{
+  if (m_traceSink != 0)
+    {
+      MpTcpTraceRecord record;
+      record.time = Simulator::Now ().GetSeconds ();
+      record.value = value;
+      record.flowId = flowId;
+      record.series = series;
+      record.subflow = MpTcpTraceRecord::CONNECTION_LEVEL;
+      record.reserved = 0;
+      m_traceSink->Record (record);
+      return;
+    }
+  if (series != TRACE_RATE_CL && !IsPlotting ())
+    return; // Rate samples are only taken when rate plotting is on
+  pair<double, double> sample = make_pair (Simulator::Now ().GetSeconds (), value);
+  switch (series)
+    {
+  case TRACE_RATE_CL:
+    rateTracerCl.push_back (sample);
+    break;
+  case TRACE_TOTAL_CWND:
+    totalCWNDtrack.push_back (sample);
+    break;
+  case TRACE_RETX_CWND:
+    reTxTrack.push_back (sample);
+    break;
+  case TRACE_TIMEOUT_CWND:
+    timeOutTrack.push_back (sample);
+    break;
+  case TRACE_PARTIAL_ACK:
+    PartialAck.push_back (sample);
+    break;
+  case TRACE_FULL_ACK:
+    FullAck.push_back (sample);
+    break;
+  case TRACE_DUP_ACKS:
+    DupAcks.push_back (sample);
+    break;
+  case TRACE_PACKET_DROP:
+    PacketDrop.push_back (sample);
+    break;
+  case TRACE_TX_QUEUE:
+    TxQueue.push_back (sample);
+    break;
+  default:
+    NS_FATAL_ERROR ("MpTcpSocketBase::Trace: " << MpTcpTraceSink::GetSeriesName (series) << " is not a connection level series");
+    }
 }
 
 string
@@ -6350,7 +6510,9 @@ MpTcpSocketBase::GetTypeIdName ()
 void
 MpTcpSocketBase::GeneratePlots ()
 {
-  if ((m_largePlotting && (flowType.compare ("Large") == 0)) || (m_shortPlotting && (flowType.compare ("Short") == 0)))
+  if (m_traceSink != 0)
+    return; // Samples went to the sink, plots are generated from its records offline
+  if (IsPlotting ())
     {
       GenerateCwndTracer ();
       GenerateRTT ();
@@ -6457,101 +6619,6 @@ MpTcpSocketBase::GetPathBandwidth (uint8_t idxPath)
   return bandwidth.GetBitRate ();
 }
 
-void
-MpTcpSocketBase::SlowDownXMPLike (uint8_t sFlowIdx)
-{
-  assert(AlgoCC != XMP && m_DCTCP);
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-
-  double alpha = sFlow->dctcp_alpha;
-
-  if (sFlow->cwnd >= sFlow->ssthresh)
-    {
-      double tmp = sFlow->cwnd.Get () * (1 - alpha / 2);
-      sFlow->cwnd = std::max ((uint32_t) tmp, (m_cwndMin * sFlow->MSS));
-    }
-  if (sFlow->cwnd < sFlow->ssthresh)
-    sFlow->ssthresh = sFlow->cwnd.Get();
-
-  sFlow->dctcp_maxseq = sFlow->TxSeqNumber;
-}
-
-void
-MpTcpSocketBase::SlowDownEcnLike (uint8_t sFlowIdx)
-{
-  assert(!m_slowDownXmpLike);
-  assert(m_initGamma < m_backoffBeta);
-  assert(m_backoffBeta != 0 && m_initGamma != 0);
-  assert(AlgoCC != XMP && m_DCTCP);
-  SlowDownHits++;
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-
-  double tmp = sFlow->cwnd.Get () * (1 - m_initGamma / (float) m_backoffBeta);
-  if (tmp < 0) tmp = 0;
-  sFlow->cwnd = std::max ((uint32_t) tmp, (m_cwndMin * sFlow->MSS));
-  sFlow->ssthresh = std::max (sFlow->MSS, sFlow->cwnd.Get ());
-  sFlow->dctcp_maxseq = sFlow->TxSeqNumber;
-
-#ifdef PLOT_DCTCP
-  uint32_t pkt_tmp = ((sFlow->g_AckSeqNumber - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ECN_CWND_CUT_POINT.push_back (make_pair (Simulator::Now ().GetSeconds (), pkt_tmp));
-#endif
-}
-
-void
-MpTcpSocketBase::SlowDown (uint8_t sFlowIdx)
-{
-  assert(!m_slowDownXmpLike);
-//assert(!m_slowDownEcnLike); // Should be turn of for MMPTCP if 1st phase need dctcp and 2th phase ecn
-  assert(AlgoCC != XMP && m_DCTCP);
-  SlowDownHits++;
-
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-
-  double alpha = sFlow->dctcp_alpha;
-
-  if (m_dctcpAlphaPerAck)
-    {
-      alpha = sFlow->rtt->GetAlpha ();
-    }
-  //NS_ASSERT(alpha <= 1 && alpha >= 0);
-
-  double tmp = sFlow->cwnd.Get () * (1 - alpha / 2);
-  if (tmp < 0) tmp = 0;
-  sFlow->cwnd = std::max ((uint32_t) tmp, (m_cwndMin * sFlow->MSS));
-  sFlow->ssthresh = std::max (sFlow->MSS, sFlow->cwnd.Get ());
-  sFlow->dctcp_maxseq = sFlow->TxSeqNumber;
-
-  /*
-  if (sFlow->m_ssThreshLastChange + sFlow->rtt->GetCurrentEstimate() < Simulator::Now())
-    { // Prevent multiple cuts of ssthresh after timeouts or fast retransmissions
-      sFlow->m_ssThreshLastChange = Simulator::Now();
-      //sFlow->ssthresh = std::max (2 * sFlow->MSS, BytesInFlight (sFlowIdx) / 2);
-      sFlow->ssthresh = std::max (sFlow->MSS, (uint32_t) tmp);
-    }
-  */
-
-#ifdef PLOT_DCTCP
-  uint32_t pkt_tmp = ((sFlow->g_AckSeqNumber - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ECN_CWND_CUT_POINT.push_back (make_pair (Simulator::Now ().GetSeconds (), pkt_tmp));
-#endif
-}
-
-void
-MpTcpSocketBase::SlowDownFastReTx(uint8_t sFlowIdx, DSNMapping* ptrDSN, string sockName)
-{
-  NS_LOG_FUNCTION_NOARGS();
-  SlowDownHits++;
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  double tmpCwnd = sFlow->cwnd.Get() * (1 - sFlow->dctcp_alpha / 2);
-  sFlow->ssthresh = std::max(2 * sFlow->MSS, (uint32_t) tmpCwnd);
-  sFlow->cwnd = sFlow->ssthresh + 3 * sFlow->MSS;
-  DoRetransmit(sFlowIdx, ptrDSN);
-//sFlow->m_recover = SequenceNumber32(sFlow->maxSeqNb + 1);
-  sFlow->m_recover = SequenceNumber32(sFlow->m_highTxMark + 1);
-  sFlow->m_inFastRec = true;
-}
-
 void
 MpTcpSocketBase::SetDctcp (bool dctcp)
 {
@@ -6676,33 +6743,13 @@ MpTcpSocketBase::RateTracerCl ()
   //double sampledGoodput = (((nextTxSequence - lastNextTxSequence) * 8) / m_rateInterval);
   double sampledGoodput = (m_totalSentBytes * 8)/m_rateInterval;
   sampledGoodput = sampledGoodput/1000000;
-  rateTracerCl.push_back(make_pair(Simulator::Now().GetSeconds(), sampledGoodput));
+  Trace(TRACE_RATE_CL, sampledGoodput);
   //lastNextTxSequence = nextTxSequence;
   m_totalSentBytes = 0;
   if (flowCompletionTime)
     m_nextRateEvent = Simulator::Schedule (Seconds (m_rateInterval), &MpTcpSocketBase::RateTracerCl, this);
 }
 
-void
-MpTcpSocketBase::RecordDctcpFastRetx(uint8_t sFlowIdx, uint32_t oldCwnd)
-{
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  uint32_t newCwnd = sFlow->cwnd.Get();
-  double currentF;
-  double lastF = sFlow->dctcp_last_fraction;
-  double lastAlpha = sFlow->dctcp_alpha;
-
-  if (sFlow->dctcp_total > 0)
-    currentF = (double)sFlow->dctcp_marked / sFlow->dctcp_total;
-  else
-    currentF = 0.0;
-
-  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper>(outputFileNameDctcp, std::ios::out | std::ios::app);
-  ostream* os = stream->GetStream();
-  *os << flowId << "\t" << m_node->GetId() << "\t" << (int) sFlow->routeId << "\t" << Simulator::Now().GetSeconds() << "\t"
-      << currentF << "\t" << lastF << "\t" << lastAlpha << "\t" << oldCwnd << "\t" << newCwnd << endl;
-}
-
 void
 MpTcpSocketBase::SetCapacity (string capacity)
 {
@@ -11,6 +11,8 @@
 #include "ns3/tcp-socket-base.h"
 #include "ns3/gnuplot.h"
 #include "mp-tcp-subflow.h"
+#include "ns3/mp-tcp-scheduler.h"
+#include "ns3/mp-tcp-congestion-ops.h"
 #include "ns3/output-stream-wrapper.h"
 
 #define A 1
@@ -47,8 +49,10 @@ public: // public methods
   bool SendBufferedData();                    // This would called SendPendingData() - TcpTxBuffer API need to be used in future!
   //int FillBuffer(uint8_t* buf, uint32_t size);// Fill sending buffer with data - TcpTxBuffer API need to be used in future!
   int FillBuffer(uint32_t size);
+  int FillBuffer(Ptr<Packet> p);              // Queues p's data, in payload mode without copying it
   //uint32_t Recv(uint8_t* buf, uint32_t size); // Receive data from receiveing buffer - TcpRxBuffe API need to be used in future!
   uint32_t Recv(uint32_t size); // Receive data from receiveing buffer - TcpRxBuffe API need to be used in future!
+  Ptr<Packet> RecvPacket(uint32_t size); // At most size bytes as they arrived, see Payload attribute
 
   //void allocateSendingBuffer(uint32_t size);  // Can be removed now as SetSndBufSize() is implemented instead!
   //void allocateRecvingBuffer(uint32_t size);  // Can be removed now as SetRcvBufSize() is implemented instead!
@@ -71,8 +75,17 @@ public: // public methods
   // Setter for congestion Control and data distribution algorithm
   void SetCongestionCtrlAlgo(CongestionCtrl_t ccalgo);  // This would be used by attribute system for setting congestion control
   void SetCCAlgo(string ccAlgo);
-  void SetDataDistribAlgo(DataDistribAlgo_t ddalgo);    // Round Robin is only algorithms used.
+  void SetCongestionOps(Ptr<MpTcpCongestionOps> ops);   // Any other congestion control
+  Ptr<MpTcpCongestionOps> GetCongestionOps();
+  Ptr<MpTcpDctcp> GetDctcpOps();                        // Created on first use, only once DCTCP is enabled
+  void SetDataDistribAlgo(DataDistribAlgo_t ddalgo);    // Selects one of the built-in schedulers
+  void SetScheduler(Ptr<MpTcpScheduler> scheduler);     // Any other scheduler
+  Ptr<MpTcpScheduler> GetScheduler();
   void SetPathManager (PathManager_t);
+  void SetPayloadMode(bool payload);                    // Real bytes in the connection level buffers, before any data is queued
+  bool GetPayloadMode() const;
+  Time GetRttPercentile(double p) const;               // p in [0, 1], over the RTT samples of all subflows
+  Time GetMinRtt() const;                               // Smallest windowed min RTT among the subflows
   uint32_t GetTotalPktSent();
   string   GetSocketModel();
   void CheckIncast(uint8_t);
@@ -142,11 +155,15 @@ public: // public variables
   vector<pair<double, double> > DupAcks;
   vector<pair<double, double> > PacketDrop;
   vector<pair<double, double> > TxQueue;
+  Ptr<MpTcpTraceSink> m_traceSink; // Plotting samples go to the sink instead of the vectors when set
 
 
 protected: // protected methods
 
   friend class Tcp;
+  friend class MpTcpScheduler;
+  friend class MpTcpCongestionOps;
+  friend class MpTcpDctcp;
 
   // Implementing some inherited methods from ns3::TcpSocket. No need to comment them!
   virtual void SetSndBufSize (uint32_t size);
@@ -174,7 +191,10 @@ protected: // protected methods
   virtual bool SendPendingData(uint8_t sFlowId = -1);
   void SendEmptyPacket(uint8_t sFlowId, uint8_t flags);
   void SendRST(uint8_t sFlowIdx);
+  void SendDataAck(uint8_t sFlowIdx, uint32_t seq, bool quickAck); // ACK a received data segment, delayed up to DelayedAckCount segments
+  void SendDelayedAck(uint8_t sFlowIdx);
   virtual int SendDataPacket (uint8_t sFlowIdx, uint32_t pktSize, bool withAck);
+  uint32_t SendDataBurst(uint8_t sFlowIdx, uint32_t window); // Bytes sent, the window must come from UsableWindow()
   // Connection closing operations
   virtual int DoClose(uint8_t sFlowIdx);
   bool CloseMultipathConnection();      // Close MPTCP connection is possible
@@ -205,6 +225,7 @@ protected: // protected methods
   virtual uint32_t BytesInFlight(uint8_t sFlowIdx);  // Return total bytes in flight of a subflow
   uint16_t AdvertisedWindowSize();
   uint32_t AvailableWindow(uint8_t sFlowIdx);
+  virtual uint32_t UsableWindow(uint8_t sFlowIdx); // Window a scheduler may use now, 0 if sFlowIdx cannot send
 
   // Manage data Tx/Rx
   virtual Ptr<TcpSocketBase> Fork(void);
@@ -221,32 +242,51 @@ protected: // protected methods
   virtual void DoRetransmit (uint8_t sFlowIdx);
   virtual void DoRetransmit (uint8_t sFlowIdx, DSNMapping* ptrDSN);
   void SetReTxTimeout(uint8_t sFlowIdx);
+  void StartReTxTimer(uint8_t sFlowIdx);
+  uint8_t AddTimestamp(uint8_t sFlowIdx, TcpHeader& header); // Returns the option bytes it added
+  bool ReadTimestamp(const TcpHeader& header, uint64_t &tsval, uint64_t &tsecr) const;
   void ReTxTimeout(uint8_t sFlowIdx);
   virtual void Retransmit(uint8_t sFlowIdx);
   void LastAckTimeout(uint8_t sFlowIdx);
   void DiscardUpTo(uint8_t sFlowIdx, uint32_t ack);
 
   // Re-ordering buffer
-  bool StoreUnOrderedData(DSNMapping *ptr);
+  bool StoreUnOrderedData(DSNMapping *ptr, Ptr<Packet> p = 0);
   void ReadUnOrderedData();
   bool FindPacketFromUnOrdered(uint8_t sFlowIdx);
 
   // Congestion control
   virtual void OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes);
   void ReduceCWND(uint8_t sFlowIdx, DSNMapping* ptrDSN);
-  virtual void calculateAlpha();
+
+  // SACK loss recovery (RFC 6675)
+  void UpdateScoreboard(uint8_t sFlowIdx, const TcpHeader& mptcpHeader); // Record the SACK blocks of an ACK
+  bool SackLossDetected(uint8_t sFlowIdx);  // The segment at highestAck + 1 is lost per the scoreboard
+  void SackRecoverySend(uint8_t sFlowIdx);  // Retransmit holes then send new data while pipe allows it
+
+  // RACK / TLP loss recovery
+  void SegmentSent(uint8_t sFlowIdx, DSNMapping* ptrDSN); // After a data segment is sent, ptrDSN is the retransmitted one, 0 for new data
+  void RackUpdate(uint8_t sFlowIdx, const TcpHeader& mptcpHeader); // Record the most recently sent segment an ACK delivers
+  void RackDetectLoss(uint8_t sFlowIdx);
+  void ScheduleTlp(uint8_t sFlowIdx);
+  void TlpTimeout(uint8_t sFlowIdx);
+  bool UseDupAckThresh() const;             // RACK needs SACK to see segments delivered above a hole, else dupacks still count
   virtual void calculateTotalCWND();
-  void calculateFastAlpha(uint8_t sFlowIdx);
-  uint32_t compute_total_window();
-  uint32_t compute_a_scaled();
-  double compute_alfa();
-  void window_changed();
+  virtual bool IsCoupledSubflow(uint8_t sFlowIdx) const; // Whether the subflow counts in the coupled (total) window
+  void AttachSubflows();                           // Start maintaining the aggregates for subflows added since the last call
+  void DetachSubflows();
+  void UpdateWindowAggregates(uint8_t sFlowIdx);   // O(1) unless sFlowIdx held the largest cwnd / rtt^2 and it dropped
+  void UpdateWindowAggregates(uint8_t sFlowIdx, uint32_t cwnd);
+  void UpdateWindowShare(uint8_t sFlowIdx, uint32_t cwnd);
+  void RebuildWindowAggregates();                  // O(subflows), e.g. after IsCoupledSubflow() changed
+  static void CwndChanged(MpTcpSocketBase *socket, uint8_t sFlowIdx, uint32_t oldCwnd, uint32_t newCwnd);
 
   // Helper functions -> main operations
   uint8_t LookupByAddrs(Ipv4Address src, Ipv4Address dst); // Called by Forwardup() to find the right subflow for incoing packet
   virtual int LookupSubflow(Ipv4Address src, uint32_t sPort, Ipv4Address dst , uint32_t dPort); // LookupBy4-Tuple
+  void InsertSubflow(Ptr<MpTcpSubFlow> sFlow); // Append sFlow to subflows and index it by its 4-tuple
 
-  virtual uint8_t getSubflowToUse();  // Called by SendPendingData() to get a subflow based on round robin algorithm
+  int getSubflowToUse();              // Called by SendPendingData() to get a subflow with usable window from the scheduler, -1 if none
   bool IsThereRoute(Ipv4Address src, Ipv4Address dst);     // Called by InitiateSubflow & LookupByAddrs and Connect to check whether there is route between a pair of addresses.
   bool IsLocalAddress(Ipv4Address addr);
   bool IsRemoteAddress(Ipv4Address addr);
@@ -258,6 +298,9 @@ protected: // protected methods
   void PrintIpv4AddressFromIpv4Interface(Ptr<Ipv4Interface>, int32_t);
   std::string PrintCC(uint32_t cc);
   void getQueuePkt(Ipv4Address addr);
+  bool IsPlotting();                                                         // Plotting vectors are used by GeneratePlots()
+  void Trace(const Ptr<MpTcpSubFlow> &sFlow, MpTcpTrace_t series, double value); // Record a subflow level sample
+  void Trace(MpTcpTrace_t series, double value);                             // Record a connection level sample
 
 
   // Helper functions -> plotting
@@ -293,23 +336,14 @@ protected: // protected methods
   uint32_t GetRandom(uint32_t, uint32_t);
   double drand();
   uint32_t GetEstSubflows();
-  void SlowDown (uint8_t sFlowIdx); // DCTCP
-  void SlowDownXMPLike (uint8_t sFlowIdx); // DCTCP
-  void SlowDownEcnLike (uint8_t sFlowIdx); // DCTCP
-  void SlowDownFastReTx (uint8_t sFlowIdx, DSNMapping* ptrDSN, string sockName); // DCTCP
-  void CalculateDCTCPAlpha(uint8_t sFlowIdx, uint32_t); // Calculating fraction of Marked pkt and alpha once per rtt
-  void ExtractPacketTags(Ptr<Packet> p);
+  void ExtractEcn(Ptr<Packet> p, const Ipv4Header& header, TcpHeader& mptcpHeader); // Sets m_ceBit and m_eceBit
   void AddPacketTag (Ptr<Packet> p, PacketTag_t pt);
 //  virtual void AddEctTag(Ptr<Packet> p);
 //  virtual void AddContPktTag(Ptr<Packet> p);
   void AddEcmpTag(Ptr<Packet> p, uint8_t sFlowIdx);
   void GenerateDctcpAlpha();    //DCTCP Debugging
   void GenerateDctcpAlphaRtt(); //DCTCP Debugging
-  void RecordDctcpFastRetx(uint8_t, uint32_t);   //DCTCP Debugging
   bool ManualPacketDrop (uint8_t sFlowIdx, Ptr<Packet> p, uint32_t packetSize);
-  // XMP functions
-  void DoSubflowNewAck(uint8_t sFlowIdx, uint32_t);
-  void DoXMPEnterCWR(uint8_t sFlowIdx);
   string CutFileName(std::string::size_type &position);
   string CutFileNameOnly();
 
@@ -361,18 +395,36 @@ protected: // protected variables
 
   // MPTCP containers
   vector<Ptr<MpTcpSubFlow> > subflows;
+  MpTcpSubflowIndex subflowIndex; // 4-tuple -> position in subflows, maintained by InsertSubflow()
   vector<MpTcpAddressInfo *> localAddrs;
   vector<MpTcpAddressInfo *> remoteAddrs;
-  list<DSNMapping *> unOrdered;  // buffer that hold the out of sequence received packet
+  DSNReassemblyQueue unOrdered; // buffer that hold the out of sequence received packet
 
   // Congestion control
-  double alpha;
-  uint32_t a;
-  double _e;
-
   uint32_t totalCwnd;
+  // Running aggregates over the subflows, updated whenever a subflow's cwnd, RTT or fast recovery state changes
+  TracedValue<uint32_t> m_totalWindow;   // All subflows, ssthresh while in fast recovery
+  TracedValue<uint32_t> m_coupledWindow; // Same over the IsCoupledSubflow() subflows
+  TracedValue<double> m_coupledRate;     // SUM(cwnd_i / rtt_i) over the coupled subflows, rtt in us
+  TracedValue<double> m_coupledMaxRate2; // MAX(cwnd_i / rtt_i^2) over the coupled subflows
+  int m_coupledMaxIdx;                   // Subflow that holds m_coupledMaxRate2
+  uint32_t m_attachedSubflows;           // subflows[0 .. m_attachedSubflows) are part of the aggregates
   CongestionCtrl_t AlgoCC;       // Algorithm for Congestion Control
+  Ptr<MpTcpCongestionOps> m_congestionOps;
+  Ptr<MpTcpDctcp> m_dctcpOps;    // DCTCP state of the subflows, 0 until DCTCP is used
   DataDistribAlgo_t distribAlgo; // Algorithm for Data Distribution
+  Ptr<MpTcpScheduler> m_scheduler;
+  uint32_t m_delayedAckCount;       // In order segments per ACK on a subflow
+  Time m_delayedAckTimeout;         // Upper bound on how long an ACK is held back
+  bool m_sendBurst;                 // SendPendingData() sends a subflow's whole usable window at once
+  bool m_segmentOffload;            // Bursts are read from sendingBuffer as one packet, see SendDataBurst()
+  bool m_sack;                      // Subflows send SACK blocks and recover from loss with a scoreboard
+  LossRecovery_t m_lossRecovery;    // How subflows detect lost segments
+  bool m_timerWheel;                // Retransmission timers run on the node's MpTcpTimerWheel
+  Ptr<MpTcpTimerWheel> m_wheel;     // Set on first use
+  bool m_timestamps;                // Subflow segments carry timestamps, every ACK yields an RTT sample
+  Ptr<Packet> m_burstPacket;        // Burst being cut into segments, 0 outside SendDataBurst()
+  uint32_t m_burstOffset;           // Bytes of m_burstPacket already sent
   PathManager_t pathManager;        // Mechanism for subflow establishement
 
   // Window management variables
@@ -36,7 +36,6 @@ MpTcpSubFlow::MpTcpSubFlow() :
     dAddr(Ipv4Address::GetZero()),
     dPort(0),
     oif(0),
-    mapDSN(0),
     lastMeasuredRtt(Seconds(0.0))
 {
   connected = false;
@@ -60,6 +59,7 @@ MpTcpSubFlow::MpTcpSubFlow() :
   Time est = MilliSeconds(200);
   cnTimeout = est;
   initialSequnceNumber = 0;
+  traceFlowId = 0;
   m_retxThresh = 3;
   m_inFastRec = false;
   m_limitedTx = false;
@@ -70,38 +70,18 @@ MpTcpSubFlow::MpTcpSubFlow() :
   AccumulativeAck = false;
   m_limitedTxCount = 0;
   m_duplicatesSize = 0;
-  // ECN & DCTCP
-  m_ssThreshLastChange = Simulator::Now(); // means zero somehow...
-//  m_EcnState = NO_ECN;
-  m_EcnEchoSeq = 0;
-//  m_EcnTransition = false;
-  dctcp_last_fraction = 0;
-  dctcp_total = 0;
-  dctcp_marked = 0;
-  dctcp_alpha_update_seq = 0;
-  dctcp_maxseq = 0;
-  dctcp_alpha = 0.0;
-  fast_alpha = 0.0;
-  curEcnState = false;
-  g_AckSeqNumber = 0;
-  // XMP parameters
-  m_begSeq = 0;
-  m_baseRTT= Seconds(60.0);
-  m_minRTT = Seconds(60.0);
-  m_cnRTT  = 0;
-  m_sumRTT = 0;
-  m_rounds = 0;
-  m_gamma = 2;
-  m_weight = 1.0;
-  m_equilibrium = 0;
-  m_instantRate = 0;
-  m_minQueueDelay = 0;
-  m_bAvailable = false; // When established it becomes available
-  m_cwr = 1; //0; init to 1 to no need to assign to 1 at subflow setup.
-  m_refWin = 0;
-  m_incCum = 0.0;
-  m_nECE = 0;
-  m_cwrHighSeq = 0;
+  delAckCount = 0;
+  delAckCe = false;
+  sackRcvLast = 0;
+  sackRcvPrev = 0;
+  rackEndSeq = 0;
+  tlpProbed = false;
+  tsRecent = 0;
+  tsLastAckSent = 0;
+  aggWindow = 0;
+  aggCoupled = false;
+  aggRate = 0;
+  aggRate2 = 0;
   totalSentByte = 0;
 
 //  DATA.push_back (make_pair (Simulator::Now ().GetSeconds (), 0));
@@ -133,12 +113,7 @@ MpTcpSubFlow::~MpTcpSubFlow()
   maxSeqNb = 0;
   m_highTxMark = 0;
   highestAck = 0;
-  for (list<DSNMapping *>::iterator it = mapDSN.begin(); it != mapDSN.end(); ++it)
-    {
-      DSNMapping * ptrDSN = *it;
-      delete ptrDSN;
-    }
-  mapDSN.clear();
+  mapDSN.Clear();
 }
 
 bool
@@ -158,10 +133,10 @@ void
 MpTcpSubFlow::CwndTracer(uint32_t oldval, uint32_t newval)
 {
   //NS_LOG_UNCOND("Subflow "<< routeId <<": Moving cwnd from " << oldval << " to " << newval);
-  cwndTracer.push_back(make_pair(Simulator::Now().GetSeconds(), newval));
-  sstTracer.push_back(make_pair(Simulator::Now().GetSeconds(), ssthresh));
-  rttTracer.push_back(make_pair(Simulator::Now().GetSeconds(), rtt->GetCurrentEstimate().GetMicroSeconds()));
-  rtoTracer.push_back(make_pair(Simulator::Now().GetSeconds(), rtt->RetransmitTimeout().GetMilliSeconds()));
+  Trace(TRACE_CWND_TRACER, newval);
+  Trace(TRACE_SST_TRACER, ssthresh);
+  Trace(TRACE_RTT_TRACER, rtt->GetCurrentEstimate().GetMicroSeconds());
+  Trace(TRACE_RTO_TRACER, rtt->RetransmitTimeout().GetMilliSeconds());
 }
 
 void
@@ -171,7 +146,7 @@ MpTcpSubFlow::RateTracerSf(double &interval, bool &flowCompletionTime)
 //  sampledGoodput = sampledGoodput/1000000;
   double sampledGoodput = ((totalSentByte * 8) / interval);
   sampledGoodput = sampledGoodput/1000000;
-  rateTracerSf.push_back(make_pair(Simulator::Now().GetSeconds(), sampledGoodput));
+  Trace(TRACE_RATE_SF, sampledGoodput);
 //  lastTxSeqNumer = TxSeqNumber;
   totalSentByte = 0;
   if (flowCompletionTime)
@@ -179,11 +154,148 @@ MpTcpSubFlow::RateTracerSf(double &interval, bool &flowCompletionTime)
 }
 
 void
-MpTcpSubFlow::AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack/*,
-    Ptr<Packet> pkt*/)
+MpTcpSubFlow::Trace(MpTcpTrace_t series, double value)
+{
+  if (traceSink != 0)
+    {
+      MpTcpTraceRecord record;
+      record.time = Simulator::Now().GetSeconds();
+      record.value = value;
+      record.flowId = traceFlowId;
+      record.series = series;
+      record.subflow = routeId;
+      record.reserved = 0;
+      traceSink->Record(record);
+    }
+  else
+    Store(series, Simulator::Now().GetSeconds(), value);
+}
+
+void
+MpTcpSubFlow::Store(MpTcpTrace_t series, double time, double value)
+{
+  switch (series)
+    {
+  case TRACE_CWND_TRACER:
+    cwndTracer.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_SST_TRACER:
+    sstTracer.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_RTO_TRACER:
+    rtoTracer.push_back(make_pair(time, value));
+    break;
+  case TRACE_RTT_TRACER:
+    rttTracer.push_back(make_pair(time, value));
+    break;
+  case TRACE_RATE_SF:
+    rateTracerSf.push_back(make_pair(time, value));
+    break;
+  case TRACE_ECN_ECHO:
+    ECN_ECHO.push_back(make_pair(time, value));
+    break;
+  case TRACE_ECN_CWND_CUT_POINT:
+    ECN_CWND_CUT_POINT.push_back(make_pair(time, value));
+    break;
+  case TRACE_XMP_CWR1:
+    XMP_CWR1.push_back(make_pair(time, value));
+    break;
+  case TRACE_XMP_CWR2:
+    XMP_CWR2.push_back(make_pair(time, value));
+    break;
+  case TRACE_BEG:
+    BEG.push_back(make_pair(time, value));
+    break;
+  case TRACE_DCTCP_ALPHA:
+    DCTCP_ALPHA.push_back(make_pair(time, value));
+    break;
+  case TRACE_DCTCP_FRACTION:
+    DCTCP_FRACTION.push_back(make_pair(time, value));
+    break;
+  case TRACE_DCTCP_ALPHA_RTT:
+    DCTCP_ALPHA_RTT.push_back(make_pair(time, value));
+    break;
+  case TRACE_DCTCP_FRACTION_RTT:
+    DCTCP_FRACTION_RTT.push_back(make_pair(time, value));
+    break;
+  case TRACE_SSTHRESH:
+    ssthreshtrack.push_back(make_pair(time, value));
+    break;
+  case TRACE_CWND:
+    CWNDtrack.push_back(make_pair(time, value));
+    break;
+  case TRACE_DATA:
+    DATA.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_ACK:
+    ACK.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_DROP:
+    DROP.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_RETRANSMIT:
+    RETRANSMIT.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_DUPACK:
+    DUPACK.push_back(make_pair(time, (uint32_t) value));
+    break;
+  case TRACE_SS:
+    _ss.push_back(make_pair(time, value));
+    break;
+  case TRACE_CA:
+    _ca.push_back(make_pair(time, value));
+    break;
+  case TRACE_FR_FA:
+    _FR_FA.push_back(make_pair(time, value));
+    break;
+  case TRACE_FR_PA:
+    _FR_PA.push_back(make_pair(time, value));
+    break;
+  case TRACE_FRETX:
+    _FReTx.push_back(make_pair(time, value));
+    break;
+  case TRACE_TIMEOUT:
+    _TimeOut.push_back(make_pair(time, value));
+    break;
+  case TRACE_RTT:
+    _RTT.push_back(make_pair(time, value));
+    break;
+  case TRACE_AVG_RTT:
+    _AvgRTT.push_back(make_pair(time, value));
+    break;
+  case TRACE_RTO:
+    _RTO.push_back(make_pair(time, value));
+    break;
+  default:
+    NS_FATAL_ERROR("MpTcpSubFlow::Store: " << MpTcpTraceSink::GetSeriesName(series) << " is not a subflow level series");
+    }
+}
+
+void
+MpTcpSubFlow::AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack,
+    Ptr<Packet> pkt)
 {
   NS_LOG_FUNCTION_NOARGS();
-  mapDSN.push_back(new DSNMapping(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack/*, pkt*/));
+  DSNMapping *ptrDSN = new DSNMapping(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack);
+  if (pkt != 0)
+    { // Payload mode: keep the data for retransmissions, tags are added again on every send
+      ptrDSN->packet = pkt->Copy();
+      ptrDSN->packet->RemoveAllPacketTags();
+    }
+  mapDSN.push_back(ptrDSN);
+}
+
+bool
+MpTcpSubFlow::RetxPending() const
+{
+  return retxEvent.IsRunning() || rtoTimer.IsRunning();
+}
+
+void
+MpTcpSubFlow::CancelRetx()
+{
+  retxEvent.Cancel();
+  rtoTimer.Cancel();
 }
 
 void
@@ -200,16 +312,6 @@ DSNMapping *
 MpTcpSubFlow::GetunAckPkt()
 {
   NS_LOG_FUNCTION(this);
-  DSNMapping * ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = mapDSN.begin(); it != mapDSN.end(); ++it)
-    {
-      DSNMapping * ptr = *it;
-      if (ptr->subflowSeqNumber == highestAck + 1)
-        {
-          ptrDSN = ptr;
-          break;
-        }
-    }
-  return ptrDSN;
+  return mapDSN.Find(highestAck + 1);
 }
 }
@@ -24,6 +24,10 @@
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-end-point.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/mp-tcp-trace-sink.h"
+#include "ns3/mp-tcp-scoreboard.h"
+#include "ns3/mp-tcp-timer-wheel.h"
+#include "ns3/mp-tcp-rtt-stats.h"
 
 using namespace std;
 
@@ -38,13 +42,17 @@ public:
   MpTcpSubFlow();
   ~MpTcpSubFlow();
 
-  void AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack/*, Ptr<Packet> pkt*/);
+  void AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack, Ptr<Packet> pkt = 0);
   void StartTracing(string traced);
   void CwndTracer(uint32_t oldval, uint32_t newval);
   void SetFinSequence(const SequenceNumber32& s);
   bool Finished();
   DSNMapping *GetunAckPkt();
   void RateTracerSf(double &interval, bool &flowCompletionTime);
+  void Trace(MpTcpTrace_t series, double value);             // Record a sample of the series traced by the subflow itself
+  void Store(MpTcpTrace_t series, double time, double value); // Append a sample to the plotting vector of series
+  bool RetxPending() const;   // Either retransmission timer is running
+  void CancelRetx();          // Cancels both retransmission timers
 
   uint16_t routeId;           // Subflow's ID
   bool connected;             // Subflow's connection status
@@ -55,6 +63,7 @@ public:
   uint16_t dPort;             // Destination port
   uint32_t oif;               // interface related to the subflow's sAddr
   EventId retxEvent;          // Retransmission timer
+  MpTcpTimer rtoTimer;        // Retransmission timer of data segments on the node's timer wheel, see TimerWheel attribute
   EventId m_lastAckEvent;     // Timer for last ACK
   EventId m_timewaitEvent;    // Timer for closing connection at sender side
   EventId nextRateEvent;
@@ -74,8 +83,7 @@ public:
   bool m_limitedTx;           // perform limited transmit
   uint32_t m_dupAckCount;     // DupACK counter
   Ipv4EndPoint* m_endPoint;   // L4 stack object
-  list<DSNMapping *> mapDSN;  // List of all sent packets
-  multiset<double> measuredRTT;
+  DSNMappingQueue mapDSN;     // All sent but unacknowledged packets, ordered by subflow seqNb
   Ptr<RttMeanDeviation> rtt;  // RTT calculator
   Time lastMeasuredRtt;       // Last measured RTT, used for plotting
   uint32_t TxSeqNumber;       // Subflow's next expected sequence number to send
@@ -90,40 +98,36 @@ public:
   uint32_t initialSequnceNumber; // Plotting
   uint32_t  m_duplicatesSize; //The size of the inflation we do during fast recovery
   uint32_t  m_highTxMark;
-  // DCTCP
-  Time m_ssThreshLastChange;
-//  TracedValue<uint32_t> m_EcnState;         // Current ECN State, represented as combination of EcnState values
-  TracedValue<SequenceNumber32> m_EcnEchoSeq; // Sequence number of the last received ECN echo
-//  bool m_EcnTransition;
-  uint32_t dctcp_total;
-  uint32_t dctcp_marked;
-  uint32_t dctcp_alpha_update_seq;
-  uint32_t dctcp_maxseq;
-  double dctcp_alpha;
-  double fast_alpha;
-  bool curEcnState;
-  uint32_t g_AckSeqNumber;
-  double dctcp_last_fraction;
-  //XMP parameters
-  uint32_t m_begSeq;
-  Time     m_baseRTT; // min sample rtt observed
-  Time     m_minRTT; // min sample rtt during last RTT
-  uint32_t m_cnRTT;  // the number of sample rtts during last RTT
-  uint64_t m_sumRTT; // the sum of sample rtts during last RTT, us
-  uint64_t m_rounds;
-  double   m_gamma;  // threshold, when above it, bi-increase exits.
-  double   m_weight;
-  double   m_equilibrium;
-  double   m_instantRate;
-  uint32_t m_minQueueDelay; // us
-  bool     m_bAvailable;
-  uint32_t m_cwr;    // 0: disable, 1: normal, 2: cwr
-  uint32_t m_refWin; // used to determine a round
-  double   m_incCum;
-  uint32_t m_nECE;
-  SequenceNumber32 m_cwrHighSeq; // used to determine when to quit from cwr
+  // Delayed ACK, see MpTcpSocketBase::SendDataAck()
+  uint32_t delAckCount;       // In order segments received since the last ACK
+  bool delAckCe;              // CE state of those segments
+  EventId delAckEvent;        // Sends the delayed ACK when it expires
+  // SACK, see MpTcpSocketBase::SackRecoverySend()
+  MpTcpScoreboard scoreboard; // Sender: ranges SACKed by the peer, RFC 6675 scoreboard
+  MpTcpScoreboard sackRcv;    // Receiver: segments held above RxSeqNumber
+  uint32_t sackRcvLast;       // Receiver: most recent segment received out of order, its range is the first SACK block
+  uint32_t sackRcvPrev;       // Receiver: the one before it in another range, its range is the second block
+  // RACK / TLP, see MpTcpSocketBase::RackDetectLoss()
+  Time rackXmitTime;          // Transmission time of the most recently sent segment known delivered
+  uint32_t rackEndSeq;        // Its end, 0 until a segment is delivered
+  Time rackRtt;               // RTT sample of that segment
+  Time rackMinRtt;            // Smallest RACK RTT sample, sets the reordering window
+  EventId rackEvent;          // Reordering timer, checks again for lost segments once it expires
+  EventId tlpEvent;           // Tail loss probe timer
+  bool tlpProbed;             // A probe was sent and not acknowledged yet
+  // RTT samples and timestamps (RFC 7323), see MpTcpSocketBase::EstimateRtt()
+  MpTcpRttStats rttStats;     // Windowed min, smoothed RTT and histogram of the RTT samples
+  uint64_t tsRecent;          // Receiver: TSval to echo, 0 if the peer sends no timestamps
+  uint32_t tsLastAckSent;     // Receiver: RxSeqNumber of the last ACK sent
+  // Share in the connection aggregates, see MpTcpSocketBase::UpdateWindowAggregates()
+  uint32_t aggWindow;
+  bool aggCoupled;
+  double aggRate;
+  double aggRate2;
 
   //plotting
+  Ptr<MpTcpTraceSink> traceSink; // Samples go to the sink instead of the vectors below when set
+  uint32_t traceFlowId;
   vector<pair<double, uint32_t> > cwndTracer;
   vector<pair<double, uint32_t> > sstTracer;
   vector<pair<double, double> > rtoTracer;
@@ -0,0 +1,245 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/mp-tcp-timer-wheel.h"
+
+NS_LOG_COMPONENT_DEFINE("MpTcpTimerWheel");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(MpTcpTimerWheel);
+
+TypeId
+MpTcpTimerWheel::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpTimerWheel")
+      .SetParent<Object>()
+      .AddConstructor<MpTcpTimerWheel>()
+      .AddAttribute("Tick",
+                    "Granularity of the wheel, timers expire at the first tick after their deadline",
+                    TimeValue(MilliSeconds(1)),
+                    MakeTimeAccessor(&MpTcpTimerWheel::m_tick),
+                    MakeTimeChecker())
+      .AddAttribute("Slots",
+                    "Number of slots, timers further away than Slots ticks wait for later rounds",
+                    UintegerValue(512),
+                    MakeUintegerAccessor(&MpTcpTimerWheel::m_slotCount),
+                    MakeUintegerChecker<uint32_t>(1));
+  return tid;
+}
+
+MpTcpTimerWheel::MpTcpTimerWheel() :
+    m_slotCount(0), m_expiring(false), m_lastTick(0), m_pending(0), m_eventTick(0), m_events(0)
+{
+}
+
+MpTcpTimerWheel::~MpTcpTimerWheel()
+{
+}
+
+void
+MpTcpTimerWheel::NotifyConstructionCompleted(void)
+{
+  Object::NotifyConstructionCompleted();
+  NS_ASSERT(m_tick.IsStrictlyPositive());
+  m_slots.resize(m_slotCount);
+}
+
+void
+MpTcpTimerWheel::DoDispose(void)
+{
+  m_event.Cancel();
+  for (std::vector<Slot_t>::iterator slot = m_slots.begin(); slot != m_slots.end(); ++slot)
+    {
+      for (Slot_t::iterator it = slot->begin(); it != slot->end(); ++it)
+        (*it)->m_list = 0;
+      slot->clear();
+    }
+  for (Slot_t::iterator it = m_firing.begin(); it != m_firing.end(); ++it)
+    (*it)->m_list = 0;
+  m_firing.clear();
+  m_pending = 0;
+  Object::DoDispose();
+}
+
+Ptr<MpTcpTimerWheel>
+MpTcpTimerWheel::GetWheel(Ptr<Node> node)
+{
+  Ptr<MpTcpTimerWheel> wheel = node->GetObject<MpTcpTimerWheel>();
+  if (wheel == 0)
+    {
+      wheel = CreateObject<MpTcpTimerWheel>();
+      node->AggregateObject(wheel);
+    }
+  return wheel;
+}
+
+uint32_t
+MpTcpTimerWheel::GetPendingCount() const
+{
+  return m_pending;
+}
+
+uint64_t
+MpTcpTimerWheel::GetScheduledEvents() const
+{
+  return m_events;
+}
+
+uint64_t
+MpTcpTimerWheel::TickOf(Time t) const
+{
+  uint64_t tick = m_tick.GetTimeStep();
+  return (t.GetTimeStep() + tick - 1) / tick;
+}
+
+void
+MpTcpTimerWheel::Insert(MpTcpTimer *timer)
+{
+  uint64_t tick = std::max(TickOf(timer->m_deadline), m_lastTick + 1);
+  Slot_t *slot = &m_slots[tick % m_slotCount];
+  timer->m_tick = tick;
+  timer->m_list = slot;
+  timer->m_pos = slot->insert(slot->end(), timer);
+  m_pending++;
+  if (!m_expiring && (!m_event.IsRunning() || tick < m_eventTick))
+    Post(tick);
+}
+
+void
+MpTcpTimerWheel::Remove(MpTcpTimer *timer)
+{
+  NS_ASSERT(timer->m_list != 0);
+  timer->m_list->erase(timer->m_pos);
+  timer->m_list = 0;
+  m_pending--;
+  if (m_pending == 0 && !m_expiring)
+    m_event.Cancel();
+}
+
+void
+MpTcpTimerWheel::Post(uint64_t tick)
+{
+  m_event.Cancel();
+  m_eventTick = tick;
+  m_event = Simulator::Schedule(TimeStep(tick * m_tick.GetTimeStep()) - Simulator::Now(), &MpTcpTimerWheel::Expire, this, tick);
+  m_events++;
+}
+
+void
+MpTcpTimerWheel::Expire(uint64_t tick)
+{
+  NS_LOG_FUNCTION(this << tick << m_pending);
+  m_expiring = true;
+  m_lastTick = tick;
+  Slot_t &slot = m_slots[tick % m_slotCount];
+  Slot_t::iterator it = slot.begin();
+  while (it != slot.end())
+    {
+      MpTcpTimer *timer = *it++;
+      if (timer->m_tick != tick)
+        continue; // Later round
+      slot.erase(timer->m_pos);
+      if (TickOf(timer->m_deadline) > tick)
+        { // Re-armed while waiting, move it on (it lands behind it if it is in this slot again)
+          m_pending--;
+          Insert(timer);
+        }
+      else
+        {
+          timer->m_list = &m_firing;
+          timer->m_pos = m_firing.insert(m_firing.end(), timer);
+        }
+    }
+  // Callbacks may cancel or re-arm any timer, the ones still waiting to fire included
+  while (!m_firing.empty())
+    {
+      MpTcpTimer *timer = m_firing.front();
+      m_firing.pop_front();
+      timer->m_list = 0;
+      m_pending--;
+      timer->m_fn();
+    }
+  m_expiring = false;
+  if (m_pending == 0)
+    return;
+  // First occupied slot, it holds a timer of this round or the next one
+  for (uint64_t next = tick + 1;; next++)
+    {
+      if (!m_slots[next % m_slotCount].empty())
+        {
+          Post(next);
+          return;
+        }
+    }
+}
+
+MpTcpTimer::MpTcpTimer() :
+    m_tick(0), m_list(0)
+{
+}
+
+MpTcpTimer::~MpTcpTimer()
+{
+  Cancel();
+}
+
+void
+MpTcpTimer::SetFunction(Callback<void> fn)
+{
+  m_fn = fn;
+}
+
+bool
+MpTcpTimer::HasFunction() const
+{
+  return !m_fn.IsNull();
+}
+
+void
+MpTcpTimer::Schedule(Ptr<MpTcpTimerWheel> wheel, Time delay)
+{
+  NS_ASSERT(!m_fn.IsNull());
+  Time deadline = Simulator::Now() + delay;
+  if (m_list != 0 && m_list != &m_wheel->m_firing && wheel == m_wheel && wheel->TickOf(deadline) >= m_tick)
+    { // Lazy re-arm, the wheel moves it on when its slot expires
+      m_deadline = deadline;
+      return;
+    }
+  Cancel();
+  m_wheel = wheel;
+  m_deadline = deadline;
+  m_wheel->Insert(this);
+}
+
+void
+MpTcpTimer::Cancel()
+{
+  if (m_list != 0)
+    m_wheel->Remove(this);
+}
+
+bool
+MpTcpTimer::IsRunning() const
+{
+  return m_list != 0;
+}
+
+Time
+MpTcpTimer::GetDelayLeft() const
+{
+  if (m_list == 0)
+    return Seconds(0);
+  return m_deadline - Simulator::Now();
+}
+
+} //namespace ns3
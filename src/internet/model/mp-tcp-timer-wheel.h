@@ -0,0 +1,95 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_TIMER_WHEEL_H
+#define MP_TCP_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+#include <list>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+
+namespace ns3
+{
+
+class Node;
+class MpTcpTimer;
+
+/*
+ * Hashed timer wheel shared by the MPTCP sockets of a node, see GetWheel().
+ * Timers sit in slots of one tick and the wheel keeps a single simulator event, for the first
+ * occupied slot, instead of one event per timer. Re-arming a running timer to a later time, as
+ * every new ACK does with the RTO, only records the new deadline: the timer stays in its slot
+ * and is moved on when that slot expires. Deadlines are rounded up to the next tick.
+ */
+class MpTcpTimerWheel : public Object
+{
+public:
+  static TypeId GetTypeId(void);
+  MpTcpTimerWheel();
+  virtual ~MpTcpTimerWheel();
+  static Ptr<MpTcpTimerWheel> GetWheel(Ptr<Node> node); // Aggregated to the node on first use
+  uint32_t GetPendingCount() const;                     // Running timers
+  uint64_t GetScheduledEvents() const;                  // Simulator events posted so far
+
+protected:
+  virtual void NotifyConstructionCompleted(void);
+  virtual void DoDispose(void);
+
+private:
+  friend class MpTcpTimer;
+  typedef std::list<MpTcpTimer *> Slot_t;
+  uint64_t TickOf(Time t) const; // First tick at or after t
+  void Insert(MpTcpTimer *timer);
+  void Remove(MpTcpTimer *timer);
+  void Post(uint64_t tick);
+  void Expire(uint64_t tick);
+
+  Time m_tick;
+  uint32_t m_slotCount;
+  std::vector<Slot_t> m_slots;
+  Slot_t m_firing;       // Timers of the expiring slot, fired one at a time
+  bool m_expiring;       // In Expire(), which posts the next event once done
+  uint64_t m_lastTick;   // Last tick that expired
+  uint32_t m_pending;
+  EventId m_event;
+  uint64_t m_eventTick;  // Tick m_event expires at
+  uint64_t m_events;
+};
+
+/*
+ * A timer on a MpTcpTimerWheel, used like an EventId. Cancelled when destroyed.
+ */
+class MpTcpTimer
+{
+public:
+  MpTcpTimer();
+  ~MpTcpTimer();
+  void SetFunction(Callback<void> fn);
+  bool HasFunction() const;
+  void Schedule(Ptr<MpTcpTimerWheel> wheel, Time delay); // Re-arms a running timer
+  void Cancel();
+  bool IsRunning() const;
+  Time GetDelayLeft() const;
+
+private:
+  friend class MpTcpTimerWheel;
+  MpTcpTimer(const MpTcpTimer &);            // Not copyable, the wheel points to it
+  MpTcpTimer& operator=(const MpTcpTimer &);
+
+  Ptr<MpTcpTimerWheel> m_wheel;
+  Callback<void> m_fn;
+  Time m_deadline;
+  uint64_t m_tick;                           // Tick of the slot it sits in, may be before m_deadline
+  MpTcpTimerWheel::Slot_t *m_list;           // Slot (or firing list) holding it, 0 if not running
+  MpTcpTimerWheel::Slot_t::iterator m_pos;
+};
+
+} //namespace ns3
+#endif //MP_TCP_TIMER_WHEEL_H
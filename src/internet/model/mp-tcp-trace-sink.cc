@@ -0,0 +1,167 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#include <string.h>
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/mp-tcp-trace-sink.h"
+
+NS_LOG_COMPONENT_DEFINE("MpTcpTraceSink");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(MpTcpTraceSink);
+NS_OBJECT_ENSURE_REGISTERED(MpTcpFileTraceSink);
+
+const uint8_t MpTcpTraceRecord::CONNECTION_LEVEL;
+
+static const char* g_seriesNames[TRACE_SERIES_COUNT] =
+{
+  "CWND_TRACER", "SST_TRACER", "RTO_TRACER", "RTT_TRACER", "RATE_SF",
+  "ECN_ECHO", "ECN_CWND_CUT_POINT", "XMP_CWR1", "XMP_CWR2", "BEG",
+  "DCTCP_ALPHA", "DCTCP_FRACTION", "DCTCP_ALPHA_RTT", "DCTCP_FRACTION_RTT",
+  "SSTHRESH", "CWND", "DATA", "ACK", "DROP", "RETRANSMIT", "DUPACK",
+  "SS", "CA", "FR_FA", "FR_PA", "FRETX", "TIMEOUT", "RTT", "AVG_RTT", "RTO",
+  "RATE_CL", "TOTAL_CWND", "RETX_CWND", "TIMEOUT_CWND", "PARTIAL_ACK",
+  "FULL_ACK", "DUP_ACKS", "PACKET_DROP", "TX_QUEUE"
+};
+
+TypeId
+MpTcpTraceSink::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpTraceSink")
+      .SetParent<Object>();
+  return tid;
+}
+
+MpTcpTraceSink::~MpTcpTraceSink()
+{
+}
+
+const char*
+MpTcpTraceSink::GetSeriesName(MpTcpTrace_t series)
+{
+  if (series >= TRACE_SERIES_COUNT)
+    return "UNKNOWN";
+  return g_seriesNames[series];
+}
+
+const char MpTcpFileTraceSink::MAGIC[4] = { 'M', 'P', 'T', 'R' };
+const uint32_t MpTcpFileTraceSink::VERSION;
+
+TypeId
+MpTcpFileTraceSink::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MpTcpFileTraceSink")
+      .SetParent<MpTcpTraceSink>()
+      .AddConstructor<MpTcpFileTraceSink>()
+      .AddAttribute("FileName", "Trace file, opened (truncated) when the first record arrives",
+          StringValue("mptcp-trace.bin"),
+          MakeStringAccessor(&MpTcpFileTraceSink::m_fileName),
+          MakeStringChecker())
+      .AddAttribute("BufferSize", "Number of records buffered before they are written",
+          UintegerValue(4096),
+          MakeUintegerAccessor(&MpTcpFileTraceSink::m_bufferSize),
+          MakeUintegerChecker<uint32_t>(1));
+  return tid;
+}
+
+MpTcpFileTraceSink::MpTcpFileTraceSink() :
+    m_bufferSize(4096),
+    m_buffered(0),
+    m_records(0)
+{
+}
+
+MpTcpFileTraceSink::~MpTcpFileTraceSink()
+{
+  Flush();
+}
+
+void
+MpTcpFileTraceSink::DoDispose(void)
+{
+  Flush();
+  if (m_file.is_open())
+    m_file.close();
+  MpTcpTraceSink::DoDispose();
+}
+
+void
+MpTcpFileTraceSink::Open()
+{
+  m_file.open(m_fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS(m_file.is_open(), "MpTcpFileTraceSink: cannot open " << m_fileName);
+  uint32_t recordSize = sizeof(MpTcpTraceRecord);
+  m_file.write(MAGIC, sizeof(MAGIC));
+  m_file.write((const char*) &VERSION, sizeof(VERSION));
+  m_file.write((const char*) &recordSize, sizeof(recordSize));
+}
+
+void
+MpTcpFileTraceSink::Record(const MpTcpTraceRecord &record)
+{
+  if (m_buffer.size() != m_bufferSize)
+    { // BufferSize can be changed until the first record arrives
+      Flush();
+      m_buffer.resize(m_bufferSize);
+    }
+  m_buffer[m_buffered++] = record;
+  m_records++;
+  if (m_buffered == m_bufferSize)
+    Flush();
+}
+
+void
+MpTcpFileTraceSink::Flush()
+{
+  if (m_buffered == 0)
+    return;
+  if (!m_file.is_open())
+    Open();
+  m_file.write((const char*) &m_buffer[0], m_buffered * sizeof(MpTcpTraceRecord));
+  m_file.flush();
+  m_buffered = 0;
+}
+
+uint64_t
+MpTcpFileTraceSink::GetRecordCount() const
+{
+  return m_records;
+}
+
+MpTcpTraceReader::MpTcpTraceReader(const std::string &fileName) :
+    m_file(fileName.c_str(), std::ios::in | std::ios::binary),
+    m_valid(false)
+{
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t recordSize = 0;
+  m_file.read(magic, sizeof(magic));
+  m_file.read((char*) &version, sizeof(version));
+  m_file.read((char*) &recordSize, sizeof(recordSize));
+  m_valid = m_file.good() && memcmp(magic, MpTcpFileTraceSink::MAGIC, sizeof(magic)) == 0
+      && version == MpTcpFileTraceSink::VERSION && recordSize == sizeof(MpTcpTraceRecord);
+}
+
+bool
+MpTcpTraceReader::IsValid() const
+{
+  return m_valid;
+}
+
+bool
+MpTcpTraceReader::Read(MpTcpTraceRecord &record)
+{
+  if (!m_valid)
+    return false;
+  m_file.read((char*) &record, sizeof(record));
+  return m_file.gcount() == (std::streamsize) sizeof(record);
+}
+
+} //namespace ns3
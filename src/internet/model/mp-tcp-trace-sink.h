@@ -0,0 +1,96 @@
+/*
+ * MultiPath-TCP (MPTCP) implementation.
+ * Programmed by Morteza Kheirkhah from University of Sussex.
+ * Email: m.kheirkhah@sussex.ac.uk
+ */
+#ifndef MP_TCP_TRACE_SINK_H
+#define MP_TCP_TRACE_SINK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "ns3/object.h"
+#include "ns3/mp-tcp-typedefs.h"
+
+namespace ns3
+{
+
+/*
+ * One sample of a plotting series. Records are written to trace files as they are
+ * laid out in memory (host byte order), preceded by a small file header.
+ */
+struct MpTcpTraceRecord
+{
+  double time;        // Seconds
+  double value;
+  uint32_t flowId;    // MpTcpSocketBase::flowId
+  uint8_t series;     // MpTcpTrace_t
+  uint8_t subflow;    // Subflow routeId, CONNECTION_LEVEL for connection level series
+  uint16_t reserved;
+  static const uint8_t CONNECTION_LEVEL = 0xff;
+};
+
+/*
+ * Destination of the plotting series of an MpTcpSocketBase.
+ * When a socket has a sink its samples are handed to the sink instead of being kept in
+ * the plotting vectors of the socket and its subflows. A sink can be shared by sockets.
+ */
+class MpTcpTraceSink : public Object
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual ~MpTcpTraceSink();
+  virtual void Record(const MpTcpTraceRecord &record) = 0;
+  static const char* GetSeriesName(MpTcpTrace_t series);
+};
+
+/*
+ * Streams records to a binary file through a fixed size buffer, so memory use does not
+ * depend on the number of records. Use utils/mptcp-trace-plot to turn the file into the
+ * gnuplot files the sockets generate themselves.
+ */
+class MpTcpFileTraceSink : public MpTcpTraceSink
+{
+public:
+  static TypeId GetTypeId(void);
+  static const char MAGIC[4];
+  static const uint32_t VERSION = 1;
+
+  MpTcpFileTraceSink();
+  virtual ~MpTcpFileTraceSink();
+  virtual void Record(const MpTcpTraceRecord &record);
+  void Flush();                    // Write buffered records to the file
+  uint64_t GetRecordCount() const; // Records received so far
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  void Open();
+
+  std::string m_fileName;
+  uint32_t m_bufferSize;           // Records buffered before a write
+  std::ofstream m_file;
+  std::vector<MpTcpTraceRecord> m_buffer;
+  uint32_t m_buffered;
+  uint64_t m_records;
+};
+
+/*
+ * Sequential reader of the files written by MpTcpFileTraceSink.
+ */
+class MpTcpTraceReader
+{
+public:
+  MpTcpTraceReader(const std::string &fileName);
+  bool IsValid() const;                  // File exists and has a known header
+  bool Read(MpTcpTraceRecord &record);   // Next record, false at end of file
+
+private:
+  std::ifstream m_file;
+  bool m_valid;
+};
+
+} //namespace ns3
+#endif //MP_TCP_TRACE_SINK_H
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <string.h>
+#include <algorithm>
 #include "ns3/mp-tcp-typedefs.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -16,6 +18,7 @@ DSNMapping::DSNMapping()
   dataLevelLength = 0;
   subflowSeqNumber = 0;
   dupAckCount = 0;
+  retransmitted = false;
   //packet = 0;
 }
 
@@ -27,8 +30,8 @@ DSNMapping::DSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uin
   subflowSeqNumber = sflowSeqNum;
   acknowledgement = ack;
   dupAckCount = 0;
-  //packet = new uint8_t[dLvlLen];
-  //pkt->CopyData(packet, dLvlLen);
+  retransmitted = false;
+  xmitTime = Simulator::Now();
 }
 /*
  DSNMapping::DSNMapping (const DSNMapping &res)
@@ -54,33 +57,389 @@ DSNMapping::~DSNMapping()
   //packet = 0;
 }
 
+Ptr<Packet>
+DSNMapping::GetPayload() const
+{
+  if (packet != 0)
+    return packet->Copy();
+  return Create<Packet>(dataLevelLength);
+}
+
 bool
 DSNMapping::operator <(const DSNMapping& rhs) const
 {
   return this->dataSeqNumber < rhs.dataSeqNumber;
 }
 
-DataBuffer::DataBuffer()
+__thread void *DSNMapping::g_freeList = 0;
+vector<char *> DSNMapping::g_slabs;
+uint32_t DSNMapping::g_liveCount = 0;
+uint32_t DSNMapping::g_peakCount = 0;
+bool DSNMapping::g_destroyed = false;
+SpinLock DSNMapping::g_poolLock;
+struct DSNMapping::LocalStaticDestructor DSNMapping::g_localStaticDestructor;
+
+DSNMapping::LocalStaticDestructor::~LocalStaticDestructor()
 {
-  bufMaxSize = 0;
+  // Slabs can only be released once every mapping has been returned to the pool. Mappings
+  // still held by other static objects release them when the last of them is deleted
+  g_poolLock.Lock();
+  g_destroyed = true;
+  bool unused = g_liveCount == 0;
+  g_poolLock.Unlock();
+  if (unused)
+    FreeSlabs();
+}
+
+void
+DSNMapping::FreeSlabs()
+{
+  // Only called once no mapping is live, so no other thread touches the slabs
+  for (vector<char *>::iterator it = g_slabs.begin(); it != g_slabs.end(); ++it)
+    delete[] *it;
+  g_slabs.clear();
+  g_freeList = 0;
 }
 
-DataBuffer::DataBuffer(uint32_t size)
+void *
+DSNMapping::operator new(size_t size)
 {
-  bufMaxSize = size;
+  if (size != sizeof(DSNMapping))
+    return ::operator new(size);
+  char *slab = 0;
+  if (g_freeList == 0)
+    { // Carve a new slab into free slots, each free slot stores the next free slot
+      slab = new char[SLAB_SIZE * sizeof(DSNMapping)];
+      for (uint32_t i = 0; i < SLAB_SIZE; i++)
+        {
+          void *slot = slab + i * sizeof(DSNMapping);
+          *(void **) slot = g_freeList;
+          g_freeList = slot;
+        }
+    }
+  void *slot = g_freeList;
+  g_freeList = *(void **) slot;
+  g_poolLock.Lock();
+  if (slab != 0)
+    {
+      g_slabs.push_back(slab);
+      NS_LOG_LOGIC("DSNMapping pools grew to " << g_slabs.size() * SLAB_SIZE << " mappings");
+    }
+  g_liveCount++;
+  g_peakCount = std::max(g_peakCount, g_liveCount);
+  g_poolLock.Unlock();
+  return slot;
+}
+
+void
+DSNMapping::operator delete(void *ptr, size_t size)
+{
+  if (ptr == 0)
+    return;
+  if (size != sizeof(DSNMapping))
+    {
+      ::operator delete(ptr);
+      return;
+    }
+  *(void **) ptr = g_freeList;
+  g_freeList = ptr;
+  g_poolLock.Lock();
+  g_liveCount--;
+  bool last = g_destroyed && g_liveCount == 0;
+  g_poolLock.Unlock();
+  if (last)
+    FreeSlabs();
+}
+
+uint32_t
+DSNMapping::GetLiveCount()
+{
+  g_poolLock.Lock();
+  uint32_t live = g_liveCount;
+  g_poolLock.Unlock();
+  return live;
+}
+
+uint32_t
+DSNMapping::GetPeakCount()
+{
+  g_poolLock.Lock();
+  uint32_t peak = g_peakCount;
+  g_poolLock.Unlock();
+  return peak;
+}
+
+static bool
+StartsBefore(const DSNMapping *mapping, uint32_t seq)
+{
+  return mapping->subflowSeqNumber < seq;
+}
+
+static bool
+EndsBefore(const DSNMapping *mapping, uint32_t seq)
+{
+  return mapping->subflowSeqNumber + mapping->dataLevelLength < seq;
+}
+
+DSNMappingQueue::DSNMappingQueue()
+{
+}
+
+DSNMappingQueue::DSNMappingQueue(const DSNMappingQueue &queue)
+{
+  *this = queue;
+}
+
+DSNMappingQueue&
+DSNMappingQueue::operator=(const DSNMappingQueue &queue)
+{
+  if (this == &queue)
+    return *this;
+  Clear();
+  for (const_iterator it = queue.begin(); it != queue.end(); ++it)
+    mappings.push_back(new DSNMapping(**it));
+  return *this;
+}
+
+DSNMappingQueue::~DSNMappingQueue()
+{
+  Clear();
+}
+
+void
+DSNMappingQueue::push_back(DSNMapping *mapping)
+{
+  NS_ASSERT_MSG(mappings.empty() || mappings.back()->subflowSeqNumber < mapping->subflowSeqNumber,
+      "DSN mappings must be added in increasing subflow sequence number order");
+  mappings.push_back(mapping);
+}
+
+DSNMapping *
+DSNMappingQueue::Find(uint32_t subflowSeqNumber) const
+{
+  const_iterator it = lower_bound(mappings.begin(), mappings.end(), subflowSeqNumber, StartsBefore);
+  if (it != mappings.end() && (*it)->subflowSeqNumber == subflowSeqNumber)
+    return *it;
+  return 0;
+}
+
+DSNMapping *
+DSNMappingQueue::FindByEnd(uint32_t endSeqNumber) const
+{
+  const_iterator it = lower_bound(mappings.begin(), mappings.end(), endSeqNumber, EndsBefore);
+  if (it != mappings.end() && (*it)->subflowSeqNumber + (*it)->dataLevelLength == endSeqNumber)
+    return *it;
+  return 0;
+}
+
+uint32_t
+DSNMappingQueue::DiscardUpTo(uint32_t ack)
+{
+  uint32_t count = 0;
+  while (!mappings.empty() && mappings.front()->subflowSeqNumber + mappings.front()->dataLevelLength <= ack)
+    {
+      delete mappings.front();
+      mappings.pop_front();
+      count++;
+    }
+  return count;
+}
+
+void
+DSNMappingQueue::Clear()
+{
+  for (iterator it = mappings.begin(); it != mappings.end(); ++it)
+    delete *it;
+  mappings.clear();
+}
+
+DSNReassemblyQueue::DSNReassemblyQueue()
+{
+}
+
+DSNReassemblyQueue::DSNReassemblyQueue(const DSNReassemblyQueue &queue)
+{
+  *this = queue;
+}
+
+DSNReassemblyQueue&
+DSNReassemblyQueue::operator=(const DSNReassemblyQueue &queue)
+{
+  if (this == &queue)
+    return *this;
+  Clear();
+  for (DataSeqMap_t::const_iterator it = queue.byDataSeq.begin(); it != queue.byDataSeq.end(); ++it)
+    Insert(new DSNMapping(*it->second));
+  return *this;
+}
+
+DSNReassemblyQueue::~DSNReassemblyQueue()
+{
+  Clear();
+}
+
+bool
+DSNReassemblyQueue::Insert(DSNMapping *mapping)
+{
+  if (!byDataSeq.insert(make_pair(mapping->dataSeqNumber, mapping)).second)
+    {
+      delete mapping;
+      return false;
+    }
+  if (mapping->subflowIndex >= bySubflowSeq.size())
+    bySubflowSeq.resize(mapping->subflowIndex + 1);
+  SubflowSeqMap_t &subflowSegments = bySubflowSeq[mapping->subflowIndex];
+  // Segments of one subflow should be in-order at both subflow and connection level.
+  SubflowSeqMap_t::iterator next = subflowSegments.upper_bound(mapping->subflowSeqNumber);
+  NS_ASSERT(next == subflowSegments.end() || mapping->dataSeqNumber < next->second->dataSeqNumber);
+  subflowSegments[mapping->subflowSeqNumber] = mapping;
+  return true;
+}
+
+DSNMapping *
+DSNReassemblyQueue::Front() const
+{
+  if (byDataSeq.empty())
+    return 0;
+  return byDataSeq.begin()->second;
+}
+
+void
+DSNReassemblyQueue::PopFront()
+{
+  NS_ASSERT(!byDataSeq.empty());
+  DSNMapping *mapping = byDataSeq.begin()->second;
+  byDataSeq.erase(byDataSeq.begin());
+  SubflowSeqMap_t &subflowSegments = bySubflowSeq[mapping->subflowIndex];
+  SubflowSeqMap_t::iterator it = subflowSegments.find(mapping->subflowSeqNumber);
+  if (it != subflowSegments.end() && it->second == mapping)
+    subflowSegments.erase(it);
+  delete mapping;
+}
+
+DSNMapping *
+DSNReassemblyQueue::FindSubflowSegment(uint8_t sFlowIdx, uint32_t subflowSeqNumber) const
+{
+  if (sFlowIdx >= bySubflowSeq.size())
+    return 0;
+  SubflowSeqMap_t::const_iterator it = bySubflowSeq[sFlowIdx].find(subflowSeqNumber);
+  if (it == bySubflowSeq[sFlowIdx].end())
+    return 0;
+  return it->second;
+}
+
+bool
+DSNReassemblyQueue::HasSubflowSegment(uint8_t sFlowIdx) const
+{
+  return sFlowIdx < bySubflowSeq.size() && !bySubflowSeq[sFlowIdx].empty();
+}
+
+void
+DSNReassemblyQueue::Clear()
+{
+  for (DataSeqMap_t::iterator it = byDataSeq.begin(); it != byDataSeq.end(); ++it)
+    delete it->second;
+  byDataSeq.clear();
+  bySubflowSeq.clear();
+}
+
+DataBuffer::DataBuffer() :
+    bufMaxSize(0), bufSize(0), payloadMode(false), headOffset(0)
+{
+}
+
+DataBuffer::DataBuffer(uint32_t size) :
+    bufMaxSize(size), bufSize(0), payloadMode(false), headOffset(0)
+{
+}
+
+// Copies share the queued packets, their bytes are never modified in place
+DataBuffer::DataBuffer(const DataBuffer &res) :
+    bufMaxSize(res.bufMaxSize), bufSize(res.bufSize), payloadMode(res.payloadMode), chunks(res.chunks),
+    headOffset(res.headOffset)
+{
+}
+
+DataBuffer&
+DataBuffer::operator=(const DataBuffer &res)
+{
+  bufMaxSize = res.bufMaxSize;
+  bufSize = res.bufSize;
+  payloadMode = res.payloadMode;
+  chunks = res.chunks;
+  headOffset = res.headOffset;
+  return *this;
 }
 
 DataBuffer::~DataBuffer()
 {
+  chunks.clear();
   bufMaxSize = 0;
 }
+
+void
+DataBuffer::Write(Ptr<Packet> pkt, uint32_t size)
+{
+  bufSize += size;
+  if (!payloadMode || size == 0)
+    return;
+  if (pkt->GetSize() > size)
+    pkt = pkt->CreateFragment(0, size);
+  else if (pkt->GetSize() < size)
+    { // Short packet, pad with zeros
+      pkt = pkt->Copy();
+      pkt->AddPaddingAtEnd(size - pkt->GetSize());
+    }
+  chunks.push_back(pkt);
+}
+
+Ptr<Packet>
+DataBuffer::Read(uint32_t size, bool oneChunk)
+{
+  NS_ASSERT(size <= bufSize);
+  if (!payloadMode)
+    {
+      bufSize -= size;
+      return 0;
+    }
+  Ptr<Packet> pkt;
+  while (size > 0)
+    {
+      Ptr<Packet> chunk = chunks.front();
+      uint32_t len = std::min(size, chunk->GetSize() - headOffset);
+      // Both share the chunk's Buffer, only AddAtEnd across chunks copies bytes
+      Ptr<Packet> fragment = (headOffset == 0 && len == chunk->GetSize()) ? chunk->Copy() : chunk->CreateFragment(headOffset, len);
+      if (pkt == 0)
+        pkt = fragment;
+      else
+        pkt->AddAtEnd(fragment);
+      bufSize -= len;
+      headOffset += len;
+      size -= len;
+      if (headOffset == chunk->GetSize())
+        {
+          chunks.pop_front();
+          headOffset = 0;
+        }
+      if (oneChunk)
+        break;
+    }
+  return pkt;
+}
+
 uint32_t
 DataBuffer::Add(uint32_t size)
+{
+  return Add(0, size);
+}
+
+uint32_t
+DataBuffer::Add(const uint8_t* buf, uint32_t size)
 {
   // read data from buf and insert it into the DataBuffer instance
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t toWrite = std::min(size, (bufMaxSize - (uint32_t) buffer.size()));
-  if (buffer.empty() == true)
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  uint32_t toWrite = std::min(size, (bufMaxSize - bufSize));
+  if (bufSize == 0)
     {
       NS_LOG_INFO("DataBuffer::Add -> buffer is empty !");
     }
@@ -88,173 +447,133 @@ DataBuffer::Add(uint32_t size)
     {
       NS_LOG_INFO("DataBuffer::Add -> buffer was not empty !");
     }
-
-  uint32_t qty = 0;
-
-  while (qty < toWrite)
-    {
-      //buffer.push(buf[qty]);
-      buffer.push((uint8_t)qty);
-      qty++;
-    }NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< qty);NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - (uint32_t) buffer.size()) );
-  return qty;
+  if (payloadMode && toWrite > 0)
+    Write(buf ? Create<Packet>(buf, toWrite) : Create<Packet>(toWrite), toWrite);
+  else
+    Write(0, toWrite);
+  NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< toWrite);
+  NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - bufSize) );
+  return toWrite;
 }
 
-#ifdef OLD
 uint32_t
-DataBuffer::Add(uint8_t* buf, uint32_t size)
+DataBuffer::Add(Ptr<Packet> pkt)
 {
-  // read data from buf and insert it into the DataBuffer instance
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t toWrite = std::min(size, (bufMaxSize - (uint32_t) buffer.size()));
-    if (buffer.empty() == true)
-      {
-        NS_LOG_INFO("DataBuffer::Add -> buffer is empty !");
-      }
-    else
-      {
-        NS_LOG_INFO("DataBuffer::Add -> buffer was not empty !");
-      }
-
-  uint32_t qty = 0;
-
-  while (qty < toWrite)
-    {
-      //buffer.push(buf[qty]);
-      buffer.push((uint8_t)qty);
-      qty++;
-    }NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< qty);NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - (uint32_t) buffer.size()) );
-  return qty;
+  NS_LOG_FUNCTION (this << pkt->GetSize() << (int) (bufMaxSize - bufSize) );
+  uint32_t toWrite = std::min(pkt->GetSize(), (bufMaxSize - bufSize));
+  if (payloadMode && toWrite > 0)
+    { // Tags belong to the application's packet, not to the data stream
+      pkt = (toWrite < pkt->GetSize()) ? pkt->CreateFragment(0, toWrite) : pkt->Copy();
+      pkt->RemoveAllPacketTags();
+      pkt->RemoveAllByteTags();
+    }
+  Write(pkt, toWrite);
+  NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< toWrite);
+  return toWrite;
 }
-#endif
-
 
 uint32_t
 DataBuffer::Retrieve(uint32_t size)
 {
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
+  return Retrieve(0, size);
+}
+
+uint32_t
+DataBuffer::Retrieve(uint8_t* buf, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  uint32_t quantity = std::min(size, bufSize);
   if (quantity == 0)
     {
       NS_LOG_INFO("DataBuffer::Retrieve -> No data to read from buffer reception !");
       return 0;
     }
-
-  for (uint32_t i = 0; i < quantity; i++)
+  Ptr<Packet> pkt = Read(quantity, false);
+  if (buf)
     {
-      //buf[i] = buffer.front();
-      buffer.pop();
+      if (pkt != 0)
+        pkt->CopyData(buf, quantity);
+      else
+        memset(buf, 0, quantity);
     }
-
-  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return quantity;
 }
 
-
-//uint32_t
-//DataBuffer::Retrieve(uint8_t* buf, uint32_t size)
-//{
-//  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-//  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
-//  if (quantity == 0)
-//    {
-//      NS_LOG_INFO("DataBuffer::Retrieve -> No data to read from buffer reception !");
-//      return 0;
-//    }
-//
-//  for (uint32_t i = 0; i < quantity; i++)
-//    {
-//      buf[i] = buffer.front();
-//      buffer.pop();
-//    }
-//
-//  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
-//  return quantity;
-//}
+Ptr<Packet>
+DataBuffer::RetrievePacket(uint32_t size)
+{
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  uint32_t quantity = std::min(size, bufSize);
+  if (quantity == 0)
+    return 0;
+  Ptr<Packet> pkt = Read(quantity, true);
+  if (pkt == 0)
+    pkt = Create<Packet>(quantity);
+  return pkt;
+}
 
 Ptr<Packet>
 DataBuffer::CreatePacket(uint32_t size)
 {
-  NS_LOG_FUNCTION (this << (int) size << (int) ( bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
+  NS_LOG_FUNCTION (this << (int) size << (int) ( bufMaxSize - bufSize) );
+  uint32_t quantity = std::min(size, bufSize);
   if (quantity == 0)
     {
       NS_LOG_INFO("DataBuffer::CreatePacket -> No data ready for sending !");
       return 0;
     }
-  // Copy from front of Buffer to a new uint8_t array pointer
-  //uint8_t *ptrBuffer = new uint8_t[quantity];
-  for (uint32_t i = 0; i < quantity; i++)
-    {
-      //ptrBuffer[i] = buffer.front();
-      buffer.pop();
-    }
-  // Create packet from a data pointer and its size
-  //Ptr<Packet> pkt = new Packet(ptrBuffer, quantity);
-  //Ptr<Packet> pkt = Create<Packet>(ptrBuffer, quantity);
-  Ptr<Packet> pkt = Create<Packet>(quantity);
-  //delete[] ptrBuffer;
-  //ptrBuffer = 0; // MKS
-
-  NS_LOG_INFO("DataBuffer::CreatePacket -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  Ptr<Packet> pkt = Read(quantity, false);
+  if (pkt == 0)
+    pkt = Create<Packet>(quantity);
+  NS_LOG_INFO("DataBuffer::CreatePacket -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return pkt;
 }
 
 uint32_t
 DataBuffer::ReadPacket(Ptr<Packet> pkt, uint32_t dataLen)
 {
-  NS_LOG_FUNCTION (this << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-
-  uint32_t toWrite = std::min(dataLen, (bufMaxSize - (uint32_t) buffer.size()));
-
-  //uint8_t *ptrBuffer = new uint8_t[toWrite];
-  //pkt->CopyData(ptrBuffer, toWrite);
+  NS_LOG_FUNCTION (this << (int) (bufMaxSize - bufSize) );
 
-  for (uint32_t i = 0; i < toWrite; i++)
-    buffer.push(0);
-    //buffer.push(ptrBuffer[i]);
-
-  //delete[] ptrBuffer;
-  //ptrBuffer = 0; // MKS
+  uint32_t toWrite = std::min(dataLen, (bufMaxSize - bufSize));
+  Write(pkt, toWrite);
 
   NS_LOG_INFO("DataBuffer::ReadPacket -> data   readed == "<< toWrite );
-  NS_LOG_INFO("DataBuffer::ReadPacket -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::ReadPacket -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return toWrite;
 }
 
 uint32_t
 DataBuffer::PendingData()
 {
-  return ((uint32_t) buffer.size());
+  return bufSize;
 }
 
 bool
 DataBuffer::ClearBuffer()
 {
-  while (!buffer.empty())
-    {
-      buffer.pop();
-    }
-  NS_ASSERT(buffer.empty());
+  bufSize = 0;
+  chunks.clear();
+  headOffset = 0;
   return true;
 }
 
 uint32_t
 DataBuffer::FreeSpaceSize()
 {
-  return (bufMaxSize - (uint32_t) buffer.size());
+  return (bufMaxSize - bufSize);
 }
 
 bool
 DataBuffer::Empty()
 {
-  return buffer.empty(); // ( freeSpaceSize == bufMaxSize );
+  return (bufSize == 0);
 }
 
 bool
 DataBuffer::Full()
 {
-  return (bufMaxSize == (uint32_t) buffer.size()); //( freeSpaceSize == 0 );
+  return (bufMaxSize == bufSize);
 }
 
 void
@@ -263,6 +582,23 @@ DataBuffer::SetBufferSize(uint32_t size)
   bufMaxSize = size;
 }
 
+void
+DataBuffer::SetPayloadMode(bool payload)
+{
+  if (payload == payloadMode)
+    return;
+  NS_ASSERT_MSG(bufSize == 0, "DataBuffer::SetPayloadMode -> buffer is not empty");
+  payloadMode = payload;
+  chunks.clear();
+  headOffset = 0;
+}
+
+bool
+DataBuffer::GetPayloadMode() const
+{
+  return payloadMode;
+}
+
 MpTcpAddressInfo::MpTcpAddressInfo() :
     addrID(0), ipv4Addr(Ipv4Address::GetZero()), mask(Ipv4Mask::GetZero())
 {
@@ -274,4 +610,103 @@ MpTcpAddressInfo::~MpTcpAddressInfo()
   ipv4Addr = Ipv4Address::GetZero();
 }
 
+MpTcpSubflowTuple::MpTcpSubflowTuple() :
+    sPort(0), dPort(0)
+{
+}
+
+MpTcpSubflowTuple::MpTcpSubflowTuple(Ipv4Address src, uint16_t srcPort, Ipv4Address dst, uint16_t dstPort) :
+    sAddr(src), sPort(srcPort), dAddr(dst), dPort(dstPort)
+{
+}
+
+bool
+MpTcpSubflowTuple::operator==(const MpTcpSubflowTuple &rhs) const
+{
+  return sPort == rhs.sPort && dPort == rhs.dPort && sAddr == rhs.sAddr && dAddr == rhs.dAddr;
+}
+
+MpTcpSubflowIndex::MpTcpSubflowIndex() :
+    count(0), shift(32)
+{
+}
+
+uint32_t
+MpTcpSubflowIndex::Hash(const MpTcpSubflowTuple &tuple)
+{
+  // Subflows of a connection mostly differ by one port (NdiffPorts) or one address (FullMesh),
+  // so every field is mixed in; the top bits are the best mixed ones.
+  uint32_t h = tuple.sAddr.Get();
+  h = h * 2654435761U ^ tuple.dAddr.Get();
+  h = h * 2654435761U ^ ((uint32_t) tuple.sPort << 16 | tuple.dPort);
+  return h * 2654435761U;
+}
+
+uint32_t
+MpTcpSubflowIndex::Bucket(const MpTcpSubflowTuple &tuple) const
+{
+  return Hash(tuple) >> shift;
+}
+
+bool
+MpTcpSubflowIndex::Insert(const MpTcpSubflowTuple &tuple, uint8_t sFlowIdx)
+{
+  if (2 * (count + 1) > slots.size())
+    Grow();
+  uint32_t mask = slots.size() - 1;
+  for (uint32_t i = Bucket(tuple);; i = (i + 1) & mask)
+    {
+      if (!slots[i].used)
+        {
+          slots[i].tuple = tuple;
+          slots[i].sFlowIdx = sFlowIdx;
+          slots[i].used = true;
+          count++;
+          return true;
+        }
+      if (slots[i].tuple == tuple)
+        return false;
+    }
+}
+
+int
+MpTcpSubflowIndex::Find(const MpTcpSubflowTuple &tuple) const
+{
+  if (count == 0)
+    return -1;
+  uint32_t mask = slots.size() - 1;
+  for (uint32_t i = Bucket(tuple); slots[i].used; i = (i + 1) & mask)
+    {
+      if (slots[i].tuple == tuple)
+        return slots[i].sFlowIdx;
+    }
+  return -1;
+}
+
+void
+MpTcpSubflowIndex::Clear()
+{
+  slots.clear();
+  count = 0;
+  shift = 32;
+}
+
+void
+MpTcpSubflowIndex::Grow()
+{
+  vector<Slot> old;
+  old.swap(slots);
+  Slot empty;
+  empty.sFlowIdx = 0;
+  empty.used = false;
+  slots.resize(old.empty() ? 16 : 2 * old.size(), empty);
+  shift = old.empty() ? 28 : shift - 1;
+  count = 0;
+  for (uint32_t i = 0; i < old.size(); i++)
+    {
+      if (old[i].used)
+        Insert(old[i].tuple, old[i].sFlowIdx);
+    }
+}
+
 } // namespace ns3
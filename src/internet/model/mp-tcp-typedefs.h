@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <list>
 #include <set>
 #include <map>
@@ -14,6 +15,7 @@
 #include "ns3/sequence-number.h"
 #include "ns3/rtt-estimator.h"
 #include "ns3/event-id.h"
+#include "ns3/spin-lock.h"
 #include "ns3/packet.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-end-point.h"
@@ -46,12 +48,17 @@ typedef enum
   XMP,                    // 9
   Fast_Uncoupled,         // 10
   Fast_Increases,         // 11
-  XCA                     // 12
+  XCA,                    // 12
+  OLIA,                   // 13
+  BALIA                   // 14
 } CongestionCtrl_t;
 
 typedef enum
 {
-  Round_Robin
+  Round_Robin,     // 0
+  Lowest_RTT,      // 1
+  Blest,           // 2
+  Cwnd_Weighted    // 3
 } DataDistribAlgo_t;
 
 typedef enum
@@ -61,15 +68,65 @@ typedef enum
   NdiffPorts
 } PathManager_t;
 
+typedef enum
+{
+  DupAck_Recovery, // 0: fast retransmit after dupAckThresh duplicated ACKs (or SACKed segments)
+  Rack_Tlp         // 1: time based loss detection (RACK) with a tail loss probe timer (TLP)
+} LossRecovery_t;
+
 typedef enum
 {
   ECT_TAG,
-  CE_TAG,
-  ECE_TAG,
   CP_TAG,
   ECMP_TAG
 } PacketTag_t;
 
+typedef enum
+{
+  // Subflow level
+  TRACE_CWND_TRACER,        // cwndTracer
+  TRACE_SST_TRACER,         // sstTracer
+  TRACE_RTO_TRACER,         // rtoTracer
+  TRACE_RTT_TRACER,         // rttTracer
+  TRACE_RATE_SF,            // rateTracerSf
+  TRACE_ECN_ECHO,
+  TRACE_ECN_CWND_CUT_POINT,
+  TRACE_XMP_CWR1,
+  TRACE_XMP_CWR2,
+  TRACE_BEG,
+  TRACE_DCTCP_ALPHA,
+  TRACE_DCTCP_FRACTION,
+  TRACE_DCTCP_ALPHA_RTT,
+  TRACE_DCTCP_FRACTION_RTT,
+  TRACE_SSTHRESH,           // ssthreshtrack
+  TRACE_CWND,               // CWNDtrack
+  TRACE_DATA,
+  TRACE_ACK,
+  TRACE_DROP,
+  TRACE_RETRANSMIT,
+  TRACE_DUPACK,
+  TRACE_SS,
+  TRACE_CA,
+  TRACE_FR_FA,
+  TRACE_FR_PA,
+  TRACE_FRETX,
+  TRACE_TIMEOUT,
+  TRACE_RTT,
+  TRACE_AVG_RTT,
+  TRACE_RTO,
+  // Connection level
+  TRACE_RATE_CL,            // rateTracerCl
+  TRACE_TOTAL_CWND,         // totalCWNDtrack
+  TRACE_RETX_CWND,          // reTxTrack
+  TRACE_TIMEOUT_CWND,       // timeOutTrack
+  TRACE_PARTIAL_ACK,
+  TRACE_FULL_ACK,
+  TRACE_DUP_ACKS,
+  TRACE_PACKET_DROP,
+  TRACE_TX_QUEUE,
+  TRACE_SERIES_COUNT
+} MpTcpTrace_t;
+
 //typedef enum
 //{
 //  NoPR_Algo,
@@ -88,6 +145,13 @@ typedef enum
 //  INIT_SUBFLOWS
 //} MpActions_t;
 
+/*
+ * One mapping is allocated per sent segment and per out-of-order received segment, so
+ * mappings are carved out of slabs and recycled through a free list instead of going
+ * through malloc/free each time. Each thread has its own free list, shared by the sockets
+ * of the nodes it simulates, so the partitions of a multithreaded run never contend for it.
+ * The slabs and the live and peak counts are shared by every thread.
+ */
 class DSNMapping
 {
 public:
@@ -96,13 +160,104 @@ public:
   //DSNMapping (const DSNMapping &res);
   virtual ~DSNMapping();
   bool operator <(const DSNMapping& rhs) const;
+  static void* operator new(size_t size);
+  static void operator delete(void *ptr, size_t size);
+  static uint32_t GetLiveCount();  // Mappings currently allocated, by every thread
+  static uint32_t GetPeakCount();  // Highest number of mappings allocated at once, by every thread
   uint64_t dataSeqNumber;
   uint16_t dataLevelLength;
   uint32_t subflowSeqNumber;
   uint32_t acknowledgement;
   uint32_t dupAckCount;
   uint8_t subflowIndex;
+  bool retransmitted;
+  Time xmitTime;     // Last (re)transmission, used by RACK
+  Ptr<Packet> packet; // Payload mode: the data of the segment (shares its bytes), 0 otherwise
+  Ptr<Packet> GetPayload() const; // Data to (re)send or deliver, zero-filled when no payload is kept
   //uint8_t *packet;
+
+private:
+  static const uint32_t SLAB_SIZE = 256; // Mappings per slab
+  struct LocalStaticDestructor
+  {
+    ~LocalStaticDestructor();
+  };
+  static void FreeSlabs();
+  static __thread void *g_freeList;
+  // Guarded by g_poolLock
+  static vector<char *> g_slabs;   // Slabs of every thread
+  static uint32_t g_liveCount;
+  static uint32_t g_peakCount;
+  static bool g_destroyed;         // Slabs go as soon as the last live mapping does
+  static SpinLock g_poolLock;
+  static struct LocalStaticDestructor g_localStaticDestructor;
+};
+
+/*
+ * Subflow level store of sent but not yet acknowledged segments (mapDSN).
+ * Mappings are appended in increasing subflow sequence number order, so lookups by
+ * sequence number are binary searches and cumulative ACKs only pop the front.
+ * The queue owns its mappings and deletes them when they are discarded.
+ */
+class DSNMappingQueue
+{
+public:
+  typedef deque<DSNMapping *>::iterator iterator;
+  typedef deque<DSNMapping *>::const_iterator const_iterator;
+
+  DSNMappingQueue();
+  DSNMappingQueue(const DSNMappingQueue &queue);
+  DSNMappingQueue& operator=(const DSNMappingQueue &queue);
+  ~DSNMappingQueue();
+
+  iterator begin() { return mappings.begin(); }
+  iterator end() { return mappings.end(); }
+  const_iterator begin() const { return mappings.begin(); }
+  const_iterator end() const { return mappings.end(); }
+  uint32_t size() const { return mappings.size(); }
+  bool empty() const { return mappings.empty(); }
+  DSNMapping *front() const { return mappings.front(); }
+  DSNMapping *back() const { return mappings.back(); }
+  void push_back(DSNMapping *mapping);
+
+  DSNMapping *Find(uint32_t subflowSeqNumber) const;   // Segment starting at subflowSeqNumber
+  DSNMapping *FindByEnd(uint32_t endSeqNumber) const;  // Segment whose last byte is endSeqNumber - 1
+  uint32_t DiscardUpTo(uint32_t ack);                  // Delete segments fully covered by ack
+  void Clear();
+
+private:
+  deque<DSNMapping *> mappings;
+};
+
+/*
+ * Connection level reassembly queue of segments received out of order (unOrdered).
+ * Segments are keyed by data sequence number for in-order draining and duplicate
+ * detection, and also indexed per subflow by subflow sequence number so that a subflow
+ * can advance over stored segments without scanning the whole queue.
+ * The queue owns its mappings.
+ */
+class DSNReassemblyQueue
+{
+public:
+  DSNReassemblyQueue();
+  DSNReassemblyQueue(const DSNReassemblyQueue &queue);
+  DSNReassemblyQueue& operator=(const DSNReassemblyQueue &queue);
+  ~DSNReassemblyQueue();
+
+  uint32_t size() const { return byDataSeq.size(); }
+  bool empty() const { return byDataSeq.empty(); }
+  bool Insert(DSNMapping *mapping); // Deletes mapping and returns false if its data seqNb is already stored
+  DSNMapping *Front() const;        // Segment with the lowest data seqNb, 0 if empty
+  void PopFront();                  // Delete Front()
+  DSNMapping *FindSubflowSegment(uint8_t sFlowIdx, uint32_t subflowSeqNumber) const;
+  bool HasSubflowSegment(uint8_t sFlowIdx) const;
+  void Clear();
+
+private:
+  typedef map<uint64_t, DSNMapping *> DataSeqMap_t;
+  typedef map<uint32_t, DSNMapping *> SubflowSeqMap_t;
+  DataSeqMap_t byDataSeq;
+  vector<SubflowSeqMap_t> bySubflowSeq; // Indexed by subflowIndex
 };
 
 class MpTcpAddressInfo
@@ -115,18 +270,74 @@ public:
   Ipv4Mask mask;
 };
 
+/*
+ * 4-tuple of a subflow, key of the per-connection subflow index.
+ */
+class MpTcpSubflowTuple
+{
+public:
+  MpTcpSubflowTuple();
+  MpTcpSubflowTuple(Ipv4Address src, uint16_t srcPort, Ipv4Address dst, uint16_t dstPort);
+  bool operator==(const MpTcpSubflowTuple &rhs) const;
+  Ipv4Address sAddr;
+  uint16_t sPort;
+  Ipv4Address dAddr;
+  uint16_t dPort;
+};
+
+/*
+ * Flat open addressing hash index from subflow 4-tuple to subflow index, used to
+ * demultiplex incoming segments in O(1) whatever the number of subflows.
+ * Subflows are never removed from a connection, so entries are only inserted or cleared.
+ */
+class MpTcpSubflowIndex
+{
+public:
+  MpTcpSubflowIndex();
+  uint32_t size() const { return count; }
+  bool Insert(const MpTcpSubflowTuple &tuple, uint8_t sFlowIdx); // Returns false if tuple is already indexed
+  int Find(const MpTcpSubflowTuple &tuple) const;                 // Subflow index, -1 if tuple is unknown
+  void Clear();
+
+private:
+  struct Slot
+  {
+    MpTcpSubflowTuple tuple;
+    uint8_t sFlowIdx;
+    bool used;
+  };
+  static uint32_t Hash(const MpTcpSubflowTuple &tuple);
+  uint32_t Bucket(const MpTcpSubflowTuple &tuple) const; // Top log2(slots.size()) bits of Hash()
+  void Grow();
+
+  vector<Slot> slots; // Size is a power of two, kept at most half full
+  uint32_t count;
+  uint32_t shift;     // 32 - log2(slots.size())
+};
+
+/*
+ * Connection level send/receive buffer.
+ * By default only the amount of buffered data is tracked (payload is zero-filled when
+ * packets are created), so reserving and draining any amount of data costs O(1).
+ * When payload mode is enabled the data is kept as a list of packets whose reference counted
+ * Buffers hold the bytes. Packets are queued as they are and segments are cut out of them as
+ * fragments, so data is only copied where a segment spans two queued packets.
+ */
 class DataBuffer
 {
 public:
   DataBuffer();
   DataBuffer(uint32_t size);
+  DataBuffer(const DataBuffer &res);
+  DataBuffer& operator=(const DataBuffer &res);
   ~DataBuffer();
-  queue<uint8_t> buffer;
   uint32_t bufMaxSize;
-  //uint32_t Add(uint8_t* buf, uint32_t size);
+  uint32_t Add(const uint8_t* buf, uint32_t size);
   uint32_t Add(uint32_t size);
-  //uint32_t Retrieve(uint8_t* buf, uint32_t size);
+  uint32_t Add(Ptr<Packet> pkt);                // Payload mode queues pkt itself, returns the bytes accepted
+  uint32_t Retrieve(uint8_t* buf, uint32_t size);
   uint32_t Retrieve(uint32_t size);
+  Ptr<Packet> RetrievePacket(uint32_t size);    // At most size bytes, from a single queued packet in payload mode
   Ptr<Packet> CreatePacket(uint32_t size);
   uint32_t ReadPacket(Ptr<Packet> pkt, uint32_t dataLen);
   bool Empty();
@@ -135,6 +346,17 @@ public:
   uint32_t PendingData();
   uint32_t FreeSpaceSize();
   void SetBufferSize(uint32_t size);
+  void SetPayloadMode(bool payload); // Keep real bytes in the buffer, switching is only allowed while it is empty
+  bool GetPayloadMode() const;
+
+private:
+  void Write(Ptr<Packet> pkt, uint32_t size);     // Takes the first size bytes of pkt
+  Ptr<Packet> Read(uint32_t size, bool oneChunk); // 0 unless in payload mode
+
+  uint32_t bufSize;              // Amount of data currently held in buffer
+  bool payloadMode;
+  deque<Ptr<Packet> > chunks;    // Payload mode: queued data, front is the oldest
+  uint32_t headOffset;           // Bytes of chunks.front() already drained
 };
 
 } //namespace ns3
@@ -84,7 +84,7 @@ PacketScatterSocketBase::DoForwardUp(Ptr<Packet> p, Ipv4Header header, uint16_t
   p->RemoveHeader(mptcpHeader);
 
   //DCTCP
-  ExtractPacketTags(p);
+  ExtractEcn(p, header, mptcpHeader);
 
   m_localPort = mptcpHeader.GetDestinationPort();
 
@@ -233,7 +233,9 @@ PacketScatterSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, co
       sFlow->state = ESTABLISHED;
       sFlow->retxEvent.Cancel();
       sFlow->rtt->Init(mptcpHeader.GetAckNumber());
-      if ((m_largePlotting && (flowType.compare("Large") == 0)) || (m_shortPlotting && (flowType.compare("Short") == 0)))
+      sFlow->traceSink = m_traceSink;
+      sFlow->traceFlowId = flowId;
+      if (IsPlotting() || m_traceSink != 0)
         sFlow->StartTracing("cWindow");
       sFlow->initialSequnceNumber = (mptcpHeader.GetAckNumber().GetValue());
       NS_LOG_INFO("(" <<sFlow->routeId << ") InitialSeqNb of data packet should be --->>> " << sFlow->initialSequnceNumber << " Cwnd: " << sFlow->cwnd);
@@ -245,6 +247,7 @@ PacketScatterSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, co
       Time estimate;
       estimate = Seconds(1.5);
       sFlow->rtt->SetCurrentEstimate(estimate);
+      UpdateWindowAggregates(sFlowIdx);
 
       SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
 
@@ -309,15 +312,19 @@ PacketScatterSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const
 
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t ack = (mptcpHeader.GetAckNumber()).GetValue();
+  if (m_sack)
+    UpdateScoreboard(sFlowIdx, mptcpHeader);
+  if (m_lossRecovery == Rack_Tlp)
+    RackUpdate(sFlowIdx, mptcpHeader);
 
   if (m_DCTCP)
     {
-      CalculateDCTCPAlpha (sFlowIdx, ack);
+      GetDctcpOps ()->UpdateAlpha (this, sFlowIdx, ack);
     }
 
 #ifdef PLOT
   uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_ACK, tmp);
 #endif
 
   // Stop execution if TCPheader is not ACK at all.
@@ -328,39 +335,21 @@ PacketScatterSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const
   else if (ack <= sFlow->highestAck + 1)
     {
       NS_LOG_LOGIC ("This acknowlegment" << mptcpHeader.GetAckNumber () << "do not ack the latest data in subflow level");
-      list<DSNMapping *>::iterator current = sFlow->mapDSN.begin();
-      list<DSNMapping *>::iterator next = sFlow->mapDSN.begin();
-      while (current != sFlow->mapDSN.end())
-        {
-          ++next;
-          DSNMapping *ptrDSN = *current;
-          // All segments before ackSeqNum should be removed from the mapDSN list.
-          if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
-            { // Optional task ...
-              //next = sFlow->mapDSN.erase(current);
-              //delete ptrDSN;
-            }
-          // There is a sent segment with subflowSN equal to ack but the ack is smaller than already receveid acked!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack < sFlow->highestAck + 1))
-            { // Case 1: Old ACK, ignored.
-              NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
-              NS_ASSERT(3!=3);
-              break;
-            }
-          // There is a sent segment with requested SequenceNumber and ack is for first unacked byte!!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack == sFlow->highestAck + 1))
-            { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
-              if (ack < sFlow->TxSeqNumber)
-                {
-                  //NS_LOG_ERROR(Simulator::Now().GetSeconds()<< " [" << m_node->GetId()<< "] Duplicated ack received for SeqgNb: " << ack << " DUPACKs: " << sFlow->m_dupAckCount + 1);
-                  DupAck(sFlowIdx, ptrDSN);
-                  break;
-                }
-              // otherwise, the ACK is precisely equal to the nextTxSequence
-              NS_ASSERT(ack <= sFlow->TxSeqNumber);
-              break;
+      // Only the segment starting at ack matters, all segments before it are already acked.
+      DSNMapping *ptrDSN = sFlow->mapDSN.Find(ack);
+      if (ptrDSN != 0 && ack < sFlow->highestAck + 1)
+        { // Case 1: Old ACK, ignored.
+          NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
+          NS_ASSERT(3 != 3);
+        }
+      else if (ptrDSN != 0 && ack == sFlow->highestAck + 1)
+        { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
+          if (ack < sFlow->TxSeqNumber)
+            {
+              DupAck(sFlowIdx, ptrDSN);
             }
-          current = next;
+          // otherwise, the ACK is precisely equal to the nextTxSequence
+          NS_ASSERT(ack <= sFlow->TxSeqNumber);
         }
     }
   else if (ack > sFlow->highestAck + 1)
@@ -369,6 +358,8 @@ PacketScatterSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const
       NewAckNewReno(sFlowIdx, mptcpHeader, 0);
       sFlow->m_dupAckCount = 0;
     }
+  if (m_lossRecovery == Rack_Tlp)
+    RackDetectLoss(sFlowIdx);
   // If there is any data piggybacked, store it into m_rxBuffer
   if (packet->GetSize() > 0)
     {
@@ -414,7 +405,7 @@ bool
 PacketScatterSocketBase::IsPktScattered(const TcpHeader &mptcpHeader)
 {
   NS_LOG_FUNCTION(this << mptcpHeader);
-  vector<TcpOptions*> mp_options = mptcpHeader.GetOptions();
+  const TcpOptionList &mp_options = mptcpHeader.GetOptions ();
   TcpOptions *opt;
   for (uint32_t j = 0; j < mp_options.size(); j++)
     {
@@ -439,9 +430,9 @@ PacketScatterSocketBase::SendPendingData(uint8_t sFlowIdx)
   NS_LOG_FUNCTION(this);
   // DCTCP: If we have received ECN echo in some of the received ACKs, slow down the congestion window
   if (m_DCTCP && sFlowIdx < maxSubflows && m_eceBit > 0 && subflows[sFlowIdx]->state == ESTABLISHED
-      && subflows[sFlowIdx]->dctcp_maxseq < (subflows[sFlowIdx]->highestAck + 1))
+      && GetDctcpOps ()->SlowDownDue (this, sFlowIdx))
     {
-      SlowDown (sFlowIdx);
+      m_dctcpOps->SlowDown (this, sFlowIdx);
     }
 
   if (sendingBuffer.Empty() && sFlowIdx < maxSubflows)
@@ -482,13 +473,13 @@ PacketScatterSocketBase::SendPendingData(uint8_t sFlowIdx)
       bool loop = true;
       while (!sendingBuffer.Empty() && loop)
         {
-          uint8_t sFlowIdx = 0;
-          uint32_t window = std::min(AvailableWindow(sFlowIdx), sendingBuffer.PendingData());
-          if (window == 0)
+          int sFlowIdx = getSubflowToUse(); // Only subflow 0 exists in packet scatter mode
+          if (sFlowIdx < 0)
             {
               loop = false;
               break;
             }
+          uint32_t window = UsableWindow(sFlowIdx);
           sFlow = subflows[sFlowIdx];
           NS_LOG_INFO("["<< (int)sFlowIdx << "] Window("<< AvailableWindow(sFlowIdx) << ") DataInBuffer("<< sendingBuffer.PendingData()<< ")");
           if (sFlow->state == ESTABLISHED)
@@ -530,21 +521,14 @@ PacketScatterSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool wi
 
   if (sFlow->maxSeqNb > sFlow->TxSeqNumber - 1)
     {
-      uint32_t IterNumber = 0;
-      for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin(); (it != sFlow->mapDSN.end() && guard == false); ++it)
-        { // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
-          IterNumber++;
-          DSNMapping * ptr = *it;
-          if (ptr->subflowSeqNumber == sFlow->TxSeqNumber)
-            {
-              ptrDSN = ptr;
-              //p = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-              p = Create<Packet>(ptrDSN->dataLevelLength);
-              packetSize = ptrDSN->dataLevelLength;
-              guard = true;
-              NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize << " IterNumInMapDSN: " << IterNumber <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
-              break;
-            }
+      // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
+      ptrDSN = sFlow->mapDSN.Find(sFlow->TxSeqNumber);
+      if (ptrDSN != 0)
+        {
+          p = ptrDSN->GetPayload();
+          packetSize = ptrDSN->dataLevelLength;
+          guard = true;
+          NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
         }
       if (p == 0)
         {
@@ -597,7 +581,7 @@ PacketScatterSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool wi
   header.SetWindowSize(AdvertisedWindowSize());
   if (!guard)
     { // If packet is made from sendingBuffer, then we got to add the packet and its info to subflow's mapDSN.
-      sFlow->AddDSNMapping(sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber/*, p->Copy()*/);
+      sFlow->AddDSNMapping(sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber, sendingBuffer.GetPayloadMode() ? p : 0);
     }
 
   if (!guard)
@@ -622,7 +606,7 @@ PacketScatterSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool wi
 
   uint8_t hlen = 5;   // 5 --> 32-bit words = 20 Bytes == TcpHeader Size with out any option
   //uint8_t olen = 15;  // 15 because packet size is 2 bytes in size. 1 + 8 + 2+ 4 = 15
-  uint8_t olen = 20;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4; // (4 - (15 % 4)) 4 => 1
   olen = (olen + plen) / 4;    // (15 + 1) / 4 = 4
@@ -647,12 +631,13 @@ PacketScatterSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool wi
 
 #ifdef PLOT
   uint32_t tmp = (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DATA.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_DATA, tmp);
 #endif
 
   NS_LOG_LOGIC(Simulator::Now().GetSeconds() << " ["<< m_node->GetId()<< "] SendDataPacket->  " << header <<" dSize: " << packetSize<< " sFlow: " << sFlow->routeId);
 
   // Do some updates.....
+  SegmentSent(sFlowIdx, guard ? ptrDSN : 0);
   sFlow->rtt->SentSeq(SequenceNumber32(sFlow->TxSeqNumber), packetSize); // Notify the RTT of a data packet sent
   sFlow->TxSeqNumber += packetSize; // Update subflow's nextSeqNum to send.
   sFlow->maxSeqNb = std::max(sFlow->maxSeqNb, sFlow->TxSeqNumber - 1);
@@ -680,7 +665,14 @@ Ptr<TcpSocketBase>
 PacketScatterSocketBase::Fork(void)
 {
   NS_LOG_FUNCTION_NOARGS();
-  return CopyObject<PacketScatterSocketBase>(this);
+  Ptr<PacketScatterSocketBase> newSock = CopyObject<PacketScatterSocketBase>(this);
+  newSock->m_scheduler = 0; // Schedulers keep per connection state
+  if (m_scheduler != 0)
+    newSock->SetScheduler(m_scheduler->Copy());
+  newSock->m_congestionOps = 0; // So do congestion ops
+  if (m_congestionOps != 0)
+    newSock->SetCongestionOps(m_congestionOps->Copy());
+  return newSock;
 }
 
 void
@@ -717,7 +709,7 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx)
   NS_ASSERT(ptrDSN->subflowSeqNumber == sFlow->highestAck +1);
 
   // we retransmit only one lost pkt
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload();
   TcpHeader header;
 
   if (m_shortFlowTCP && flowType.compare("Short") == 0)
@@ -737,7 +729,7 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx)
   header.AddOptDSN(OPT_DSN, ptrDSN->dataSeqNumber, ptrDSN->dataLevelLength, ptrDSN->subflowSeqNumber, remoteToken, 1);
 
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -753,14 +745,15 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx)
 
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_RETRANSMIT, tmp);
   if (!sFlow->m_inFastRec)
     {
-      timeOutTrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
+      Trace(TRACE_TIMEOUT_CWND, sFlow->cwnd);
     }
 #endif
 
   // Update Rtt
+  SegmentSent(sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq(SequenceNumber32(ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -780,7 +773,7 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   SetReTxTimeout(sFlowIdx); // reset RTO
 
   // we retransmit only one lost pkt
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->GetPayload();
   if (pkt == 0)
     NS_ASSERT(3!=3);
 
@@ -806,7 +799,7 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
   NS_LOG_WARN (Simulator::Now().GetSeconds() <<" RetransmitSegment -> "<< " localToken "<< localToken<<" Subflow "<<(int) sFlowIdx<<" DataSeq "<< ptrDSN->dataSeqNumber <<" SubflowSeq " << ptrDSN->subflowSeqNumber <<" dataLength " << ptrDSN->dataLevelLength << " packet size " << pkt->GetSize() << " 3DupACK");
   uint8_t hlen = 5;
-  uint8_t olen = 20; //uint8_t olen = 15;
+  uint8_t olen = 20 + AddTimestamp(sFlowIdx, header);
   uint8_t plen = 0;
   plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -821,10 +814,11 @@ PacketScatterSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   //Plotting
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_RETRANSMIT, tmp);
 #endif
 
   // Notify RTT
+  SegmentSent(sFlowIdx, ptrDSN);
   sFlow->rtt->SentSeq(SequenceNumber32(ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
 
   // In case of RTO, advance m_nextTxSequence
@@ -846,7 +840,7 @@ PacketScatterSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
 #ifdef PLOT
   uint32_t tmp = (((ptrDSN->subflowSeqNumber) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DUPACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
+  Trace(sFlow, TRACE_DUPACK, tmp);
 #endif
 
   // PS: Tuning DupAckThresh dynamically based on flight packets
@@ -857,7 +851,8 @@ PacketScatterSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
     }
 
   // congestion control algorithms
-  if (sFlow->m_dupAckCount == sFlow->m_retxThresh && !sFlow->m_inFastRec)
+  if (UseDupAckThresh() && (sFlow->m_dupAckCount == sFlow->m_retxThresh || SackLossDetected(sFlowIdx))
+      && !sFlow->m_inFastRec)
     { // FastRetrasmsion
       NS_LOG_WARN (Simulator::Now().GetSeconds() <<" DupAck -> subflow ("<< (int)sFlowIdx <<") 3rd duplicated ACK for segment ("<<ptrDSN->subflowSeqNumber<<")");
 
@@ -865,17 +860,22 @@ PacketScatterSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
       ReduceCWND(sFlowIdx, ptrDSN);
 
 #ifdef PLOT
-      sFlow->_FReTx.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
+      Trace(sFlow, TRACE_FRETX, TimeScale);
 #endif
       FastReTxs++;
     }
+  else if (sFlow->m_inFastRec && m_sack)
+    { // SACK recovery, the dupack may have taken segments out of the pipe
+      FastRecoveries++;
+      SackRecoverySend(sFlowIdx);
+    }
   else if (sFlow->m_inFastRec)
     { // Fast Recovery
       sFlow->cwnd += segmentSize;
 
 #ifdef PLOT
-      DupAcks.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
+      Trace(TRACE_DUP_ACKS, sFlow->cwnd);
+      Trace(sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
 #endif
       NS_LOG_WARN ("DupAck-> FastRecovery. Increase cwnd by one MSS, from " << sFlow->cwnd.Get() <<" -> " << sFlow->cwnd << " AvailableWindow: " << AvailableWindow(sFlowIdx));
       FastRecoveries++;
@@ -918,10 +918,10 @@ PacketScatterSocketBase::OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes)
     { // Slow Start phase
       sFlow->cwnd += sFlow->MSS;
 #ifdef PLOT
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-      sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-      sFlow->_ss.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
+      Trace(sFlow, TRACE_SSTHRESH, sFlow->ssthresh);
+      Trace(sFlow, TRACE_CWND, sFlow->cwnd);
+      Trace(TRACE_TOTAL_CWND, totalCwnd);
+      Trace(sFlow, TRACE_SS, TimeScale);
 #endif
     }
   else
@@ -943,6 +943,7 @@ PacketScatterSocketBase::Retransmit(uint8_t sFlowIdx)
   sFlow->m_inFastRec = false;
   sFlow->ssthresh = std::max(2 * sFlow->MSS, BytesInFlight(sFlowIdx) / 2);
   sFlow->cwnd = sFlow->MSS;
+  UpdateWindowAggregates(sFlowIdx);
   sFlow->TxSeqNumber = sFlow->highestAck + 1; // m_nextTxSequence = m_txBuffer.HeadSequence(); // Restart from highest Ack
 
   if (m_isRTObackoff == false)
@@ -950,7 +951,7 @@ PacketScatterSocketBase::Retransmit(uint8_t sFlowIdx)
 
   DoRetransmit(sFlowIdx);  // Retransmit the packet
 #ifdef PLOT
-      sFlow->_TimeOut.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
+      Trace(sFlow, TRACE_TIMEOUT, TimeScale);
 #endif
   TimeOuts++;
 }
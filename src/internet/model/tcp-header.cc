@@ -35,7 +35,7 @@ NS_OBJECT_ENSURE_REGISTERED(TcpHeader);
 
 TcpHeader::TcpHeader() :
     m_sourcePort(0), m_destinationPort(0), m_sequenceNumber(0), m_ackNumber(0), m_length(5), m_flags(0), m_windowSize(0xffff), m_urgentPointer(
-        0), m_calcChecksum(false), m_goodChecksum(true), m_option(0), oLen(0), pLen(0), original(true)
+        0), m_calcChecksum(false), m_goodChecksum(true), m_option(), oLen(0), pLen(0)
 {
 }
 
@@ -537,7 +537,7 @@ TcpHeader::Deserialize(Buffer::Iterator start)
   SetSequenceNumber(SequenceNumber32(i.ReadNtohU32()));
   SetAckNumber(SequenceNumber32(i.ReadNtohU32()));
   uint16_t field = i.ReadNtohU16();
-  SetFlags(field & 0x3F);
+  SetFlags(field & 0xFF);
   hlen = (field >> 12);
   SetLength(hlen);
   SetWindowSize(i.ReadNtohU16());
@@ -555,54 +555,62 @@ TcpHeader::Deserialize(Buffer::Iterator start)
     }
 
   // handle options field
+  m_option.Clear();
   while (!i.IsEnd() && hlen > 0)
     {
-      TcpOptions *opt;
       TcpOption_t kind = (TcpOption_t) i.ReadU8(); //TcpOption_t kind = UintToTcpOption(i.ReadU8());
       if (kind == OPT_MPC)
         {
-          opt = new OptMultipathCapable(kind, i.ReadNtohU32());
+          m_option.Add(OptMultipathCapable(kind, i.ReadNtohU32()));
           plen = (plen + 5) % 4;
           hlen -= 5;
         }
       else if (kind == OPT_JOIN)
         {
-          opt = new OptJoinConnection(kind, i.ReadNtohU32(), i.ReadU8());
+          uint32_t token = i.ReadNtohU32();
+          m_option.Add(OptJoinConnection(kind, token, i.ReadU8()));
           plen = (plen + 6) % 4;
           hlen -= 6;
         }
       else if (kind == OPT_ADDR)
         {
-          opt = new OptAddAddress(kind, i.ReadU8(), Ipv4Address(i.ReadNtohU32()));
+          uint8_t addrID = i.ReadU8();
+          m_option.Add(OptAddAddress(kind, addrID, Ipv4Address(i.ReadNtohU32())));
           plen = (plen + 6) % 4;
           hlen -= 6;
         }
       else if (kind == OPT_REMADR)
         {
-          opt = new OptRemoveAddress(kind, i.ReadU8());
+          m_option.Add(OptRemoveAddress(kind, i.ReadU8()));
           plen = (plen + 2) % 4;
           hlen -= 2;
         }
       else if (kind == OPT_DSN)
         {
-          opt = new OptDataSeqMapping(kind, i.ReadU64(), i.ReadNtohU16(), i.ReadNtohU32(), i.ReadNtohU32(), i.ReadU8());
+          // Fields are read one by one, evaluation order of function arguments is unspecified
+          uint64_t dataSeqNumber = i.ReadU64();
+          uint16_t dataLevelLength = i.ReadNtohU16();
+          uint32_t subflowSeqNumber = i.ReadNtohU32();
+          uint32_t receiverToken = i.ReadNtohU32();
+          m_option.Add(OptDataSeqMapping(kind, dataSeqNumber, dataLevelLength, subflowSeqNumber, receiverToken, i.ReadU8()));
           plen = (plen + 20) % 4; // plen = (plen + 15) % 4;
           hlen -= 20; //hlen -= 15;
         }
       else if (kind == OPT_TT)
         {
-          opt = new OptTimesTamp(kind, i.ReadU64(), i.ReadU64());
+          uint64_t tsval = i.ReadU64();
+          m_option.Add(OptTimesTamp(kind, tsval, i.ReadU64()));
           plen = (plen + 17) % 4;
           hlen -= 17;
         }
       else if (kind == OPT_DSACK)
         {
-          OptDSACK *dsak = new OptDSACK(kind);
+          OptDSACK dsak(kind);
           uint64_t fstLeft = i.ReadU64(), fstRight = i.ReadU64();
           uint64_t sndLeft = i.ReadU64(), sndRight = i.ReadU64();
-          dsak->AddfstBlock(fstLeft, fstRight);
-          dsak->AddBlock(sndLeft, sndRight);
-          opt = dsak;
+          dsak.AddfstBlock(fstLeft, fstRight);
+          dsak.AddBlock(sndLeft, sndRight);
+          m_option.Add(dsak);
           plen = (plen + 33) % 4;
           hlen -= 33;
         }
@@ -612,9 +620,6 @@ TcpHeader::Deserialize(Buffer::Iterator start)
           hlen = 0;
           break;
         }
-
-      m_option.insert(m_option.end(), opt);
-
     }
   //i.Next(plen);
   NS_LOG_INFO("TcpHeader::Deserialize leaving this method plen" << plen);
@@ -629,14 +634,14 @@ TcpHeader::SetOptionsLength(uint8_t length)
   oLen = length;
 }
 
-vector<TcpOptions*>
+const TcpOptionList&
 TcpHeader::GetOptions(void) const
 {
   return m_option;
 }
 
 void
-TcpHeader::SetOptions(vector<TcpOptions*> opt)
+TcpHeader::SetOptions(const TcpOptionList &opt)
 {
   m_option = opt;
 }
@@ -741,7 +746,9 @@ TcpHeader::UintToTcpOption(uint8_t kind) const
 }
 
 
-TcpHeader::TcpHeader(const TcpHeader &res)
+TcpHeader::TcpHeader(const TcpHeader &res) :
+    Header(res), m_urgentPointer(res.m_urgentPointer), m_source(res.m_source), m_destination(res.m_destination), m_protocol(
+        res.m_protocol), m_calcChecksum(res.m_calcChecksum), m_goodChecksum(res.m_goodChecksum)
 {
   //NS_LOG_FUNCTION_NOARGS();
   SetSourcePort(res.GetSourcePort());
@@ -754,8 +761,7 @@ TcpHeader::TcpHeader(const TcpHeader &res)
   SetLength(res.GetLength());
   SetOptionsLength(res.GetOptionsLength());
   SetPaddingLength(res.GetPaddingLength());
-  SetOptions(res.GetOptions());
-  original = false;
+  SetOptions(res.GetOptions()); // Options are held inline, this copies them without allocating
 }
 /*
  TcpHeader
@@ -778,37 +784,8 @@ TcpHeader::TcpHeader(const TcpHeader &res)
  */
 TcpHeader::~TcpHeader()
 {
-  if (original == false)
-    return;
   //NS_LOG_FUNCTION_NOARGS();
-  for (uint32_t i = 0; i < m_option.size(); i++)
-    {
-      if (m_option[i] != 0)
-        switch (m_option[i]->optName)
-          {
-        case OPT_MPC:
-          delete (OptMultipathCapable*) m_option[i];
-          break;
-        case OPT_JOIN:
-          delete (OptJoinConnection*) m_option[i];
-          break;
-        case OPT_ADDR:
-          delete (OptAddAddress*) m_option[i];
-          break;
-        case OPT_REMADR:
-          delete (OptRemoveAddress*) m_option[i];
-          break;
-        case OPT_DSN:
-          delete (OptDataSeqMapping*) m_option[i];
-          break;
-        case OPT_TT:
-          delete (OptTimesTamp*) m_option[i];
-          break;
-        default:
-          break;
-          }
-    }
-  m_option.clear();
+  m_option.Clear();
   oLen = 0;
 }
 
@@ -818,9 +795,7 @@ TcpHeader::AddOptMPC(TcpOption_t optName, uint32_t TxToken)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_MPC)
     {
-      OptMultipathCapable* opt = new OptMultipathCapable(optName, TxToken);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptMultipathCapable(optName, TxToken));
 
       return true;
     }
@@ -833,9 +808,7 @@ TcpHeader::AddOptJOIN(TcpOption_t optName, uint32_t RxToken, uint8_t addrID)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_JOIN)
     {
-      OptJoinConnection* opt = new OptJoinConnection(optName, RxToken, addrID);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptJoinConnection(optName, RxToken, addrID));
       return true;
     }
   return false;
@@ -847,9 +820,7 @@ TcpHeader::AddOptADDR(TcpOption_t optName, uint8_t addrID, Ipv4Address addr)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_ADDR)
     {
-      OptAddAddress* opt = new OptAddAddress(optName, addrID, addr);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptAddAddress(optName, addrID, addr));
       return true;
     }
   return false;
@@ -861,9 +832,7 @@ TcpHeader::AddOptREMADR(TcpOption_t optName, uint8_t addrID)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_REMADR)
     {
-      OptRemoveAddress* opt = new OptRemoveAddress(optName, addrID);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptRemoveAddress(optName, addrID));
       return true;
     }
   return false;
@@ -875,9 +844,7 @@ TcpHeader::AddOptDSN(TcpOption_t optName, uint64_t dSeqNum, uint16_t dLevelLengt
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_DSN)
     {
-      OptDataSeqMapping* opt = new OptDataSeqMapping(optName, dSeqNum, dLevelLength, sfSeqNum, rToken, pS);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptDataSeqMapping(optName, dSeqNum, dLevelLength, sfSeqNum, rToken, pS));
       return true;
     }
   else
@@ -891,21 +858,19 @@ TcpHeader::AddOptTT(TcpOption_t optName, uint64_t tsval, uint64_t tsecr)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_TT)
     {
-      OptTimesTamp* opt = new OptTimesTamp(optName, tsval, tsecr);
-
-      m_option.insert(m_option.end(), opt);
+      m_option.Add(OptTimesTamp(optName, tsval, tsecr));
       return true;
     }
   return false;
 }
 
 bool
-TcpHeader::AddOptDSACK(TcpOption_t optName, OptDSACK *ptrDSAK)
+TcpHeader::AddOptDSACK(TcpOption_t optName, const OptDSACK &opt)
 {
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_DSACK)
     {
-      m_option.insert(m_option.end(), ptrDSAK);
+      m_option.Add(opt);
       return true;
     }
   return false;
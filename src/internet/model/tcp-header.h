@@ -60,15 +60,15 @@ public:
   bool AddOptDSN(TcpOption_t optName, uint64_t dSeqNum, uint16_t dLevelLength, uint32_t sfSeqNum , uint32_t rToken = 0, uint8_t pS = 0); // Data Sequence Mapping Option
   bool AddOptREMADR(TcpOption_t optName, uint8_t addrID);   // Remove address Option
   bool AddOptTT(TcpOption_t optName, uint64_t tsval, uint64_t tsecr); // TCP TimesTamp Option
-  bool AddOptDSACK(TcpOption_t optName, OptDSACK *opt); // DSACK Option
+  bool AddOptDSACK(TcpOption_t optName, const OptDSACK &opt); // DSACK Option, opt is copied
   void SetOptionsLength(uint8_t length);
   void SetPaddingLength(uint8_t length);
   uint8_t GetOptionsLength() const;
   uint8_t GetPaddingLength() const;
   uint8_t TcpOptionToUint(TcpOption_t opt) const;
   TcpOption_t UintToTcpOption(uint8_t kind) const;
-  vector<TcpOptions*> GetOptions(void) const;
-  void SetOptions(vector<TcpOptions*> opt);
+  const TcpOptionList& GetOptions(void) const;
+  void SetOptions(const TcpOptionList &opt);
   //--------------------------------------------
   /**
    * \brief Enable checksum calculation for TCP
@@ -269,10 +269,9 @@ private:
   bool m_goodChecksum;    //!< Flag to indicate that checksum is correct
 
   // MPTCP related variables------------
-  vector<TcpOptions*> m_option;
+  TcpOptionList m_option; // Held inline, parsing and copying a header never allocates
   uint8_t oLen;
   uint8_t pLen;
-  bool original;
   //------------------------------------
 };
 
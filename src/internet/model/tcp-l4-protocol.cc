@@ -358,7 +358,7 @@ TcpL4Protocol::Receive(Ptr<Packet> packet, Ipv4Header const &ipHeader, Ptr<Ipv4I
   //
   // MPTCP related modification----------------------------
   // Extract MPTCP options if there is any
-  vector<TcpOptions*> options = tcpHeader.GetOptions();
+  const TcpOptionList &options = tcpHeader.GetOptions ();
   uint8_t flags = tcpHeader.GetFlags();
   bool hasSyn = flags & TcpHeader::SYN;
   TcpOptions *opt;
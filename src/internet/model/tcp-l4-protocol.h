@@ -32,6 +32,7 @@
 #include "ns3/object-factory.h"
 #include "ip-l4-protocol.h"
 #include "ns3/net-device.h"
+#include "ns3/sgi-hashmap.h"
 
 
 namespace ns3 {
@@ -64,7 +65,7 @@ public:
    */
   static TypeId GetTypeId (void);
   static const uint8_t PROT_NUMBER; //!< protocol number (0x6)
-  typedef std::map<uint32_t, Ipv4EndPoint*> TokenMaps; // MPTCP related modification
+  typedef sgi::hash_map<uint32_t, Ipv4EndPoint*> TokenMaps; // MPTCP related modification, hashed as it is looked up per received segment
 
   TcpL4Protocol ();
   virtual ~TcpL4Protocol ();
@@ -268,7 +269,7 @@ private:
   TcpL4Protocol &operator = (const TcpL4Protocol &);
 
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
-  std::map<uint32_t, Ipv4EndPoint* > m_TokenMap;   //!< list of Token
+  TokenMaps m_TokenMap;                            //!< list of Token
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 };
@@ -1,6 +1,8 @@
 #include <stdint.h>
 #include <iostream>
+#include <new>
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "tcp-options.h"
 
 NS_LOG_COMPONENT_DEFINE ("TcpOptions");
@@ -21,6 +23,12 @@ TcpOptions::~TcpOptions(void)
   optName = OPT_NONE;
 }
 
+TcpOptions*
+TcpOptions::CopyTo(void *storage) const
+{
+  return new (storage) TcpOptions(*this);
+}
+
 OptMultipathCapable::OptMultipathCapable(TcpOption_t oName, uint32_t TxToken)
 {
   NS_LOG_FUNCTION(this << oName << TxToken);
@@ -37,6 +45,12 @@ OptMultipathCapable::~OptMultipathCapable()
   senderToken = 0;
 }
 
+TcpOptions*
+OptMultipathCapable::CopyTo(void *storage) const
+{
+  return new (storage) OptMultipathCapable(*this);
+}
+
 OptJoinConnection::OptJoinConnection(TcpOption_t oName, uint32_t RxToken, uint8_t aID)
 {
   NS_LOG_FUNCTION(this << oName << RxToken << aID);
@@ -55,6 +69,12 @@ OptJoinConnection::~OptJoinConnection()
   addrID = 0;
 }
 
+TcpOptions*
+OptJoinConnection::CopyTo(void *storage) const
+{
+  return new (storage) OptJoinConnection(*this);
+}
+
 OptAddAddress::OptAddAddress(TcpOption_t oName, uint8_t aID, Ipv4Address address)
 {
   NS_LOG_FUNCTION(this << oName << aID << address);
@@ -73,6 +93,12 @@ OptAddAddress::~OptAddAddress()
   addr = Ipv4Address::GetZero();
 }
 
+TcpOptions*
+OptAddAddress::CopyTo(void *storage) const
+{
+  return new (storage) OptAddAddress(*this);
+}
+
 OptRemoveAddress::OptRemoveAddress(TcpOption_t oName, uint8_t aID)
 {
   NS_LOG_FUNCTION(this << oName << aID);
@@ -89,6 +115,12 @@ OptRemoveAddress::~OptRemoveAddress()
   addrID = 0;
 }
 
+TcpOptions*
+OptRemoveAddress::CopyTo(void *storage) const
+{
+  return new (storage) OptRemoveAddress(*this);
+}
+
 OptDataSeqMapping::OptDataSeqMapping(TcpOption_t oName, uint64_t dSeqNum, uint16_t dLevelLength, uint32_t sfSeqNum, uint32_t rToken, uint8_t pS)
 {
   NS_LOG_FUNCTION(this << oName << dSeqNum << dLevelLength << sfSeqNum << rToken << pS);
@@ -113,6 +145,12 @@ OptDataSeqMapping::~OptDataSeqMapping()
   pScatter = 0;
 }
 
+TcpOptions*
+OptDataSeqMapping::CopyTo(void *storage) const
+{
+  return new (storage) OptDataSeqMapping(*this);
+}
+
 OptTimesTamp::OptTimesTamp(TcpOption_t oName, uint64_t tsval, uint64_t tsecr)
 {
   NS_LOG_FUNCTION(this << oName << tsval << tsecr);
@@ -130,31 +168,103 @@ OptTimesTamp::~OptTimesTamp()
   TSecr = 0;
 }
 
+TcpOptions*
+OptTimesTamp::CopyTo(void *storage) const
+{
+  return new (storage) OptTimesTamp(*this);
+}
+
 OptDSACK::OptDSACK(TcpOption_t oName) :
-    blocks(0)
+    nEdges(0)
 {
   optName = oName;
+  Length = 33;
+  for (uint32_t i = 0; i < 2 * MAX_BLOCKS; i++)
+    blocks[i] = 0;
 }
 
 void
 OptDSACK::AddBlock(uint64_t leftEdge, uint64_t rightEdge)
 {
-  blocks.insert(blocks.end(), leftEdge);
-  blocks.insert(blocks.end(), rightEdge);
+  NS_ASSERT(nEdges < 2 * MAX_BLOCKS);
+  blocks[nEdges++] = leftEdge;
+  blocks[nEdges++] = rightEdge;
 }
 
 void
 OptDSACK::AddfstBlock(uint64_t leftEdge, uint64_t rightEdge)
 {
-  // We first insert the right edge in the beginning then the left edge to keep the order
-  blocks.insert(blocks.begin(), rightEdge);
-  blocks.insert(blocks.begin(), leftEdge);
+  NS_ASSERT(nEdges < 2 * MAX_BLOCKS);
+  // Shift the existing blocks to keep the order
+  for (uint32_t i = nEdges; i > 0; i--)
+    blocks[i + 1] = blocks[i - 1];
+  blocks[0] = leftEdge;
+  blocks[1] = rightEdge;
+  nEdges += 2;
 }
 
 OptDSACK::~OptDSACK()
 {
   NS_LOG_FUNCTION_NOARGS();
-  blocks.clear();
+  nEdges = 0;
+}
+
+TcpOptions*
+OptDSACK::CopyTo(void *storage) const
+{
+  return new (storage) OptDSACK(*this);
+}
+
+TcpOptionList::TcpOptionList() :
+    count(0)
+{
+}
+
+TcpOptionList::TcpOptionList(const TcpOptionList &list) :
+    count(0)
+{
+  for (uint32_t i = 0; i < list.count; i++)
+    Add(*list[i]);
+}
+
+TcpOptionList&
+TcpOptionList::operator=(const TcpOptionList &list)
+{
+  if (this != &list)
+    {
+      Clear();
+      for (uint32_t i = 0; i < list.count; i++)
+        Add(*list[i]);
+    }
+  return *this;
+}
+
+TcpOptionList::~TcpOptionList()
+{
+  Clear();
+}
+
+TcpOptions*
+TcpOptionList::operator[](uint32_t i) const
+{
+  NS_ASSERT(i < count);
+  return options[i];
+}
+
+void
+TcpOptionList::Add(const TcpOptions &opt)
+{
+  NS_ASSERT_MSG(count < MAX_OPTIONS, "Too many options in TCP header");
+  options[count] = opt.CopyTo(&slots[count]);
+  count++;
+}
+
+void
+TcpOptionList::Clear()
+{
+  for (uint32_t i = 0; i < count; i++)
+    options[i]->~TcpOptions();
+  count = 0;
 }
 
 }
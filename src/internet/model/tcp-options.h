@@ -29,6 +29,8 @@ public:
   TcpOptions();
   virtual
   ~TcpOptions();
+  virtual TcpOptions*
+  CopyTo(void *storage) const; // Copy construct this option in storage, see TcpOptionList
 
   TcpOption_t optName;
   uint8_t Length;
@@ -39,6 +41,8 @@ class OptMultipathCapable : public TcpOptions
 public:
   virtual
   ~OptMultipathCapable();
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
   uint32_t senderToken;
   OptMultipathCapable(TcpOption_t oName, uint32_t TxToken);
 };
@@ -48,6 +52,8 @@ class OptJoinConnection : public TcpOptions
 public:
   virtual
   ~OptJoinConnection();
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
   uint32_t receiverToken;
   uint8_t addrID;
   OptJoinConnection(TcpOption_t oName, uint32_t RxToken, uint8_t aID);
@@ -58,6 +64,8 @@ class OptAddAddress : public TcpOptions
 public:
   virtual
   ~OptAddAddress();
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
   uint8_t addrID;
   Ipv4Address addr;
   OptAddAddress(TcpOption_t oName, uint8_t aID, Ipv4Address address);
@@ -68,6 +76,8 @@ class OptRemoveAddress : public TcpOptions
 public:
   virtual
   ~OptRemoveAddress();
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
   uint8_t addrID;
   OptRemoveAddress(TcpOption_t oName, uint8_t aID);
 };
@@ -77,6 +87,8 @@ class OptDataSeqMapping : public TcpOptions
 public:
   virtual
   ~OptDataSeqMapping();
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
   uint64_t dataSeqNumber;
   uint16_t dataLevelLength;
   uint32_t subflowSeqNumber;
@@ -90,8 +102,10 @@ class OptTimesTamp : public TcpOptions
 public:
   virtual
   ~OptTimesTamp();
-  uint64_t TSval;     // TS Value      in milliseconds
-  uint64_t TSecr;     // TS Echo Reply in milliseconds
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
+  uint64_t TSval;     // TS Value, a simulator time step for MPTCP subflows
+  uint64_t TSecr;     // TS Echo Reply
 
   OptTimesTamp(TcpOption_t oName, uint64_t tsval, uint64_t tsecr);
 };
@@ -101,8 +115,11 @@ class OptDSACK : public TcpOptions
 public:
   virtual
   ~OptDSACK();
-  std::vector<uint64_t> blocks;     // a vector of 4-bytes fields, representing the DSACK block's edge
-  // the size of the vector is a multiple of 2 (a block has to limits, upper and lower) representing the length of the table
+  virtual TcpOptions*
+  CopyTo(void *storage) const;
+  static const uint32_t MAX_BLOCKS = 2;
+  uint64_t blocks[2 * MAX_BLOCKS]; // Edges of the DSACK blocks, a block has two limits (lower and upper)
+  uint32_t nEdges;                 // Number of valid entries in blocks, a multiple of 2
   OptDSACK(TcpOption_t oName);
   void
   AddBlock(uint64_t leftEdge, uint64_t rightEdge);
@@ -110,5 +127,45 @@ public:
   AddfstBlock(uint64_t leftEdge, uint64_t rightEdge);
 };
 
+/*
+ * Options of one TcpHeader.
+ * Options are copy constructed in fixed size slots held inline, so that parsing,
+ * adding and copying the options of a header never allocate memory. The TCP option
+ * space (40 bytes) holds at most 20 options, the smallest being 2 bytes long.
+ */
+class TcpOptionList
+{
+public:
+  static const uint32_t MAX_OPTIONS = 20;
+
+  TcpOptionList();
+  TcpOptionList(const TcpOptionList &list);
+  TcpOptionList& operator=(const TcpOptionList &list);
+  ~TcpOptionList();
+
+  uint32_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  TcpOptions *operator[](uint32_t i) const;
+  void Add(const TcpOptions &opt); // Append a copy of opt
+
+  void Clear();
+
+private:
+  union Slot
+  {
+    char mpc[sizeof(OptMultipathCapable)];
+    char join[sizeof(OptJoinConnection)];
+    char addr[sizeof(OptAddAddress)];
+    char remAddr[sizeof(OptRemoveAddress)];
+    char dsn[sizeof(OptDataSeqMapping)];
+    char tt[sizeof(OptTimesTamp)];
+    char dsack[sizeof(OptDSACK)];
+    uint64_t align;
+  };
+  Slot slots[MAX_OPTIONS];
+  TcpOptions *options[MAX_OPTIONS]; // options[i] lives in slots[i]
+  uint32_t count;
+};
+
 }
 #endif /* TCP_OPTIONS */
@@ -24,9 +24,26 @@
 
 #include "ns3/test.h"
 #include "ns3/global-route-manager-impl.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
 #include "ns3/candidate-queue.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node-list.h"
+#include "ns3/node-container.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <sstream>
 
 using namespace ns3;
 
@@ -213,6 +230,287 @@ GlobalRouteManagerImplTestCase::DoRun (void)
   // does not crash
 }
 
+class GlobalRouteManagerLsdbTestCase : public TestCase
+{
+public:
+  GlobalRouteManagerLsdbTestCase();
+  virtual void DoRun (void);
+};
+
+GlobalRouteManagerLsdbTestCase::GlobalRouteManagerLsdbTestCase()
+  : TestCase ("Look up LSAs by link state ID and by transit link data")
+{
+}
+void
+GlobalRouteManagerLsdbTestCase::DoRun (void)
+{
+  // Two routers attached to the transit network 10.1.1.0/24 whose
+  // designated router is 10.1.1.1
+  GlobalRoutingLSA* lsa0 = new GlobalRoutingLSA ();
+  lsa0->SetLSType (GlobalRoutingLSA::RouterLSA);
+  lsa0->SetLinkStateId ("0.0.0.1");
+  lsa0->SetAdvertisingRouter ("0.0.0.1");
+  lsa0->AddLinkRecord (new GlobalRoutingLinkRecord (
+                         GlobalRoutingLinkRecord::TransitNetwork,
+                         "10.1.1.1", // designated router
+                         "10.1.1.1", // local address
+                         1));
+
+  GlobalRoutingLSA* lsa1 = new GlobalRoutingLSA ();
+  lsa1->SetLSType (GlobalRoutingLSA::RouterLSA);
+  lsa1->SetLinkStateId ("0.0.0.2");
+  lsa1->SetAdvertisingRouter ("0.0.0.2");
+  lsa1->AddLinkRecord (new GlobalRoutingLinkRecord (
+                         GlobalRoutingLinkRecord::StubNetwork,
+                         "10.1.2.0",
+                         "255.255.255.0",
+                         1));
+
+  GlobalRouteManagerLSDB* lsdb = new GlobalRouteManagerLSDB ();
+  lsdb->Insert (lsa0->GetLinkStateId (), lsa0);
+  lsdb->Insert (lsa1->GetLinkStateId (), lsa1);
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSA ("0.0.0.1"), lsa0, "Wrong LSA for router 0.0.0.1");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSA ("0.0.0.2"), lsa1, "Wrong LSA for router 0.0.0.2");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSA ("0.0.0.3"), (GlobalRoutingLSA*) 0, "Unknown router should have no LSA");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSAByLinkData ("10.1.1.1"), lsa0, "Wrong LSA for transit link data");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSAByLinkData ("10.1.2.0"), (GlobalRoutingLSA*) 0, "Stub links must not be found by link data");
+
+  // Inserting after a lookup must make the new link data visible
+  GlobalRoutingLSA* lsa2 = new GlobalRoutingLSA ();
+  lsa2->SetLSType (GlobalRoutingLSA::RouterLSA);
+  lsa2->SetLinkStateId ("0.0.0.3");
+  lsa2->SetAdvertisingRouter ("0.0.0.3");
+  lsa2->AddLinkRecord (new GlobalRoutingLinkRecord (
+                         GlobalRoutingLinkRecord::TransitNetwork,
+                         "10.1.1.1",
+                         "10.1.1.3",
+                         1));
+  lsdb->Insert (lsa2->GetLinkStateId (), lsa2);
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSA ("0.0.0.3"), lsa2, "Wrong LSA for router 0.0.0.3");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSAByLinkData ("10.1.1.3"), lsa2, "Link data inserted after a lookup not found");
+  NS_TEST_ASSERT_MSG_EQ (lsdb->GetLSAByLinkData ("10.1.1.1"), lsa0, "Wrong LSA for transit link data");
+
+  delete lsdb;
+}
+
+// The global routing takes the link of two of these for a point-to-point link
+class PointToPointTestNetDevice : public SimpleNetDevice
+{
+public:
+  virtual bool IsPointToPoint (void) const
+  {
+    return true;
+  }
+};
+
+class GlobalRouteManagerRecomputeTestCase : public TestCase
+{
+public:
+  GlobalRouteManagerRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Link two nodes
+   * \returns the interfaces of the link on both nodes
+   */
+  std::pair<uint32_t, uint32_t> Link (Ptr<Node> a, Ptr<Node> b, uint16_t metric);
+  // Take the link between m_routers i and j down or up
+  void SetLink (uint32_t i, uint32_t j, bool up);
+  void SetMetric (uint32_t i, uint32_t j, uint16_t metric);
+  /**
+   * Recompute the routes, check them against routes calculated from scratch
+   * \returns the number of SPF trees calculated again
+   */
+  uint32_t Recompute (void);
+  // Every route of every node
+  std::string GetRoutes (void) const;
+  static void SetThreads (uint32_t threads);
+  static void SetIncremental (bool incremental);
+  static uint32_t GetNCalculated (void);
+
+  NodeContainer m_routers;
+  NodeContainer m_hosts;
+  Ipv4AddressHelper m_addresses;
+  std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t> > m_links;
+};
+
+GlobalRouteManagerRecomputeTestCase::GlobalRouteManagerRecomputeTestCase ()
+  : TestCase ("Parallel and incremental SPF calculations install the same routes as a serial one")
+{
+}
+
+std::pair<uint32_t, uint32_t>
+GlobalRouteManagerRecomputeTestCase::Link (Ptr<Node> a, Ptr<Node> b, uint16_t metric)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  Ptr<Node> nodes[] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<PointToPointTestNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes[i]->AddDevice (device);
+      devices.Add (device);
+    }
+  m_addresses.Assign (devices);
+  m_addresses.NewNetwork ();
+  std::pair<uint32_t, uint32_t> interfaces (a->GetObject<Ipv4> ()->GetInterfaceForDevice (devices.Get (0)),
+                                            b->GetObject<Ipv4> ()->GetInterfaceForDevice (devices.Get (1)));
+  a->GetObject<Ipv4> ()->SetMetric (interfaces.first, metric);
+  b->GetObject<Ipv4> ()->SetMetric (interfaces.second, metric);
+  return interfaces;
+}
+
+void
+GlobalRouteManagerRecomputeTestCase::SetLink (uint32_t i, uint32_t j, bool up)
+{
+  std::pair<uint32_t, uint32_t> interfaces = m_links[std::make_pair (i, j)];
+  Ptr<Ipv4> a = m_routers.Get (i)->GetObject<Ipv4> ();
+  Ptr<Ipv4> b = m_routers.Get (j)->GetObject<Ipv4> ();
+  if (up)
+    {
+      a->SetUp (interfaces.first);
+      b->SetUp (interfaces.second);
+    }
+  else
+    {
+      a->SetDown (interfaces.first);
+      b->SetDown (interfaces.second);
+    }
+}
+
+void
+GlobalRouteManagerRecomputeTestCase::SetMetric (uint32_t i, uint32_t j, uint16_t metric)
+{
+  std::pair<uint32_t, uint32_t> interfaces = m_links[std::make_pair (i, j)];
+  m_routers.Get (i)->GetObject<Ipv4> ()->SetMetric (interfaces.first, metric);
+  m_routers.Get (j)->GetObject<Ipv4> ()->SetMetric (interfaces.second, metric);
+}
+
+uint32_t
+GlobalRouteManagerRecomputeTestCase::Recompute (void)
+{
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string incremental = GetRoutes ();
+  uint32_t calculated = GetNCalculated ();
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (incremental, GetRoutes (), "Same routes as calculated from scratch");
+  return calculated;
+}
+
+std::string
+GlobalRouteManagerRecomputeTestCase::GetRoutes (void) const
+{
+  std::ostringstream routes;
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = NodeList::GetNode (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      routes << "node " << i << std::endl;
+      for (uint32_t j = 0; j < gr->GetNRoutes (); j++)
+        {
+          routes << *gr->GetRoute (j) << std::endl;
+        }
+    }
+  return routes.str ();
+}
+
+void
+GlobalRouteManagerRecomputeTestCase::SetThreads (uint32_t threads)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+}
+
+void
+GlobalRouteManagerRecomputeTestCase::SetIncremental (bool incremental)
+{
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (incremental));
+}
+
+uint32_t
+GlobalRouteManagerRecomputeTestCase::GetNCalculated (void)
+{
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->DebugGetNCalculated ();
+}
+
+void
+GlobalRouteManagerRecomputeTestCase::DoRun (void)
+{
+  // 4 x 4 grid of routers, with many equal cost paths, a costly link between
+  // two opposite corners and a host on each of these corners
+  const uint32_t side = 4;
+  m_routers.Create (side * side);
+  m_hosts.Create (2);
+  InternetStackHelper internet;
+  internet.Install (m_routers);
+  internet.Install (m_hosts);
+  m_addresses.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < side * side; i++)
+    {
+      if (i % side + 1 < side)
+        m_links[std::make_pair (i, i + 1)] = Link (m_routers.Get (i), m_routers.Get (i + 1), 1);
+      if (i + side < side * side)
+        m_links[std::make_pair (i, i + side)] = Link (m_routers.Get (i), m_routers.Get (i + side), 1);
+    }
+  const uint32_t last = side * side - 1;
+  m_links[std::make_pair (0, last)] = Link (m_routers.Get (0), m_routers.Get (last), 10);
+  Link (m_hosts.Get (0), m_routers.Get (0), 1);
+  Link (m_hosts.Get (1), m_routers.Get (last), 1);
+  const uint32_t nodes = side * side + 2;
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string serial = GetRoutes ();
+  NS_TEST_ASSERT_MSG_EQ (GetNCalculated (), nodes, "Every node calculated");
+
+  SetThreads (4);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), serial, "Same routes on 4 threads");
+  NS_TEST_ASSERT_MSG_EQ (GetNCalculated (), nodes, "Every node calculated");
+
+  // The first computation keeps the trees, the next ones only calculate the affected ones
+  SetIncremental (true);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), serial, "Same routes with the trees kept");
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), serial, "Nothing changed");
+  NS_TEST_ASSERT_MSG_EQ (GetNCalculated (), m_hosts.GetN (), "Only the stub hosts calculated");
+
+  // A link no shortest path takes only changes the stub hosts, which are always calculated
+  const uint32_t hosts = m_hosts.GetN ();
+  SetLink (0, last, false);
+  NS_TEST_ASSERT_MSG_EQ (Recompute (), hosts, "Unused link down");
+  SetLink (0, last, true);
+  NS_TEST_ASSERT_MSG_EQ (Recompute (), hosts, "Unused link up");
+  // As long as no shortest path gets longer than through it
+  SetMetric (0, last, 7);
+  NS_TEST_ASSERT_MSG_EQ (Recompute (), hosts, "Unused link cheaper");
+  SetMetric (0, last, 6);
+  uint32_t calculated = Recompute ();
+  NS_TEST_ASSERT_MSG_GT (calculated, hosts, "Equal cost path through the link");
+  NS_TEST_ASSERT_MSG_LT (calculated, nodes, "Only for the routers near its ends");
+  SetMetric (0, last, 10);
+  Recompute ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), serial, "Back to the first routes");
+
+  // Links in the middle of the grid and next to a host
+  std::pair<uint32_t, uint32_t> changes[] = { std::make_pair (5, 6), std::make_pair (0, 1) };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      SetLink (changes[i].first, changes[i].second, false);
+      Recompute ();
+      SetLink (changes[i].first, changes[i].second, true);
+      Recompute ();
+      NS_TEST_ASSERT_MSG_EQ (GetRoutes (), serial, "Back to the first routes");
+    }
+
+  SetThreads (1);
+  SetIncremental (false);
+  Simulator::Destroy ();
+}
 
 static class GlobalRouteManagerImplTestSuite : public TestSuite
 {
@@ -221,5 +519,7 @@ public:
     : TestSuite ("global-route-manager-impl", UNIT)
   {
     AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+    AddTestCase (new GlobalRouteManagerLsdbTestCase (), TestCase::QUICK);
+    AddTestCase (new GlobalRouteManagerRecomputeTestCase (), TestCase::QUICK);
   }
 } g_globalRoutingManagerImplTestSuite;
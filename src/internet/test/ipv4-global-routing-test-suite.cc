@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+
+using namespace ns3;
+
+class Ipv4GlobalRoutingEcmpHashTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingEcmpHashTestCase (Ipv4GlobalRouting::EcmpHashFunction hashFunction);
+
+private:
+  virtual void DoRun (void);
+  Ptr<Ipv4GlobalRouting> CreateRouting (uint32_t seed);
+  Ptr<Packet> CreateSegment (uint16_t srcPort, uint16_t dstPort);
+  Ipv4GlobalRouting::EcmpHashFunction m_hashFunction;
+};
+
+Ipv4GlobalRoutingEcmpHashTestCase::Ipv4GlobalRoutingEcmpHashTestCase (Ipv4GlobalRouting::EcmpHashFunction hashFunction)
+  : TestCase (hashFunction == Ipv4GlobalRouting::ECMP_HASH_FNV1A ? "FlowEcmpRouting 5-tuple hash, Fnv1a" : "FlowEcmpRouting 5-tuple hash, Murmur3"),
+    m_hashFunction (hashFunction)
+{
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingEcmpHashTestCase::CreateRouting (uint32_t seed)
+{
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetAttribute ("EcmpHashSeed", UintegerValue (seed));
+  routing->SetAttribute ("EcmpHashFunction", EnumValue (m_hashFunction));
+  return routing;
+}
+
+Ptr<Packet>
+Ipv4GlobalRoutingEcmpHashTestCase::CreateSegment (uint16_t srcPort, uint16_t dstPort)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (srcPort);
+  tcpHeader.SetDestinationPort (dstPort);
+  p->AddHeader (tcpHeader);
+  return p;
+}
+
+void
+Ipv4GlobalRoutingEcmpHashTestCase::DoRun (void)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.1"));
+  header.SetDestination (Ipv4Address ("10.2.1.1"));
+  header.SetProtocol (6);
+
+  Ptr<Ipv4GlobalRouting> routing = CreateRouting (1);
+  uint64_t hash = routing->GetTupleValue (header, CreateSegment (49153, 5000));
+  NS_TEST_ASSERT_MSG_EQ (routing->GetTupleValue (header, CreateSegment (49153, 5000)), hash, "Segments of a flow should hash alike");
+  NS_TEST_ASSERT_MSG_NE (routing->GetTupleValue (header, CreateSegment (49154, 5000)), hash, "Source port should be hashed");
+  NS_TEST_ASSERT_MSG_NE (routing->GetTupleValue (header, CreateSegment (5000, 49153)), hash, "Port order should be hashed");
+  NS_TEST_ASSERT_MSG_NE (CreateRouting (2)->GetTupleValue (header, CreateSegment (49153, 5000)), hash, "Seed should be hashed");
+
+  // UDP datagrams are hashed on their ports as well
+  Ptr<Packet> datagram = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (49153);
+  udpHeader.SetDestinationPort (5000);
+  datagram->AddHeader (udpHeader);
+  header.SetProtocol (17);
+  uint64_t udpHash = routing->GetTupleValue (header, datagram);
+  NS_TEST_ASSERT_MSG_NE (udpHash, hash, "Protocol should be hashed");
+  NS_TEST_ASSERT_MSG_NE (routing->GetTupleValue (header, 0), udpHash, "Route requests without payload should hash with zero ports");
+  header.SetProtocol (6);
+
+  // NdiffPorts subflows only differ by their source port, they should spread over
+  // the routes, and two switches with distinct seeds should split them independently.
+  const uint32_t flows = 4000;
+  const uint32_t routes = 4;
+  Ptr<Ipv4GlobalRouting> next = CreateRouting (2);
+  uint32_t count[routes] = { 0 };
+  uint32_t sameRoute = 0;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      Ptr<Packet> p = CreateSegment (49153 + i, 5000);
+      uint32_t route = routing->GetTupleValue (header, p) % routes;
+      count[route]++;
+      if (next->GetTupleValue (header, p) % routes == route)
+        {
+          sameRoute++;
+        }
+    }
+  for (uint32_t j = 0; j < routes; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (count[j], flows / routes, flows / routes / 10, "Flows should be balanced over ECMP routes");
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (sameRoute, flows / routes, flows / routes / 10, "Seeds should decorrelate path selection across hops");
+}
+
+class Ipv4GlobalRoutingFibTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFibTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ipv4Address Lookup (Ipv4Address dest, uint16_t srcPort = 49153, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4GlobalRouting> m_routing;
+};
+
+Ipv4GlobalRoutingFibTestCase::Ipv4GlobalRoutingFibTestCase ()
+  : TestCase ("FIB longest prefix match, host routes, ECMP groups and updates")
+{
+}
+
+// Gateway of the route selected for dest, 0.0.0.0 when there is no route
+Ipv4Address
+Ipv4GlobalRoutingFibTestCase::Lookup (Ipv4Address dest, uint16_t srcPort, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("192.168.1.1"));
+  header.SetDestination (dest);
+  header.SetProtocol (6);
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (srcPort);
+  tcpHeader.SetDestinationPort (5000);
+  p->AddHeader (tcpHeader);
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (p, header, oif, err);
+  return route == 0 ? Ipv4Address::GetZero () : route->GetGateway ();
+}
+
+void
+Ipv4GlobalRoutingFibTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<ArpL3Protocol> ());
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  m_routing = CreateObject<Ipv4GlobalRouting> ();
+  ipv4->SetRoutingProtocol (m_routing);
+  node->AggregateObject (ipv4);
+  std::vector<Ptr<SimpleNetDevice> > devices;
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = ipv4->AddInterface (device);
+      std::ostringstream addr;
+      addr << "192.168." << i << ".1";
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (addr.str ().c_str ()), Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (interface);
+      devices.push_back (device);
+    }
+
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), Ipv4Address ("192.168.1.2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.2.2"), 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.2.3"), 2);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), Ipv4Address ("192.168.3.2"), 3);
+  m_routing->AddASExternalRouteTo (Ipv4Address ("172.16.0.0"), Ipv4Mask ("255.240.0.0"), Ipv4Address ("192.168.1.3"), 1);
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.1.2"), "Only the /8 matches");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.1.9.9"), Ipv4Address ("192.168.2.2"), "Longest prefix wins, first route of the group without ECMP");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.3.2"), "Host route wins over network routes");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("172.16.5.5"), Ipv4Address ("192.168.1.3"), "External route is used when nothing else matches");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("11.0.0.1"), Ipv4Address::GetZero (), "No route");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.1.9.9", 49153, devices[0]), Ipv4Address ("192.168.1.2"),
+                         "Shorter prefix is used when the longest one has no route on oif");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.1.2.3", 49153, devices[1]), Ipv4Address ("192.168.2.2"),
+                         "Network route is used when host routes are not on oif");
+
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address ("10.1.9.9"));
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (0, header, 0, err);
+  NS_TEST_ASSERT_MSG_EQ (route->GetSource (), Ipv4Address ("192.168.2.1"), "Source address of the output interface");
+  NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), devices[1], "Output device of the route");
+  NS_TEST_ASSERT_MSG_EQ ((m_routing->RouteOutput (0, header, 0, err) == route), true, "Routes are reused across lookups");
+
+  m_routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  m_routing->SetAttribute ("EcmpHashSeed", UintegerValue (1));
+  uint32_t first = 0;
+  for (uint16_t port = 49153; port < 49153 + 100; port++)
+    {
+      Ipv4Address gateway = Lookup ("10.1.9.9", port);
+      NS_TEST_ASSERT_MSG_EQ ((gateway == Ipv4Address ("192.168.2.2") || gateway == Ipv4Address ("192.168.2.3")), true, "Flows stay in the ECMP group");
+      first += (gateway == Ipv4Address ("192.168.2.2"));
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (first, 50, 20, "Flows should use both routes of the ECMP group");
+  m_routing->SetAttribute ("FlowEcmpRouting", BooleanValue (false));
+
+  // Host routes are listed first, so route 0 is the host route
+  m_routing->RemoveRoute (0);
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.2.2"), "FIB should follow route removal");
+  m_routing->AddNetworkRouteTo (Ipv4Address ("11.0.0.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("192.168.3.3"), 3);
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("11.0.0.1"), Ipv4Address ("192.168.3.3"), "FIB should follow route addition");
+  m_routing->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), Ipv4Address ("192.168.3.4"), 3);
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("12.0.0.1"), Ipv4Address ("192.168.3.4"), "Default route");
+  NS_TEST_ASSERT_MSG_EQ (Lookup ("172.16.5.5"), Ipv4Address ("192.168.3.4"), "Default network route is preferred over external routes");
+
+  node->Dispose ();
+  m_routing = 0;
+}
+
+static class Ipv4GlobalRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4GlobalRoutingTestSuite ()
+    : TestSuite ("ipv4-global-routing", UNIT)
+  {
+    AddTestCase (new Ipv4GlobalRoutingEcmpHashTestCase (Ipv4GlobalRouting::ECMP_HASH_MURMUR3), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpHashTestCase (Ipv4GlobalRouting::ECMP_HASH_FNV1A), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFibTestCase, TestCase::QUICK);
+  }
+} g_ipv4GlobalRoutingTestSuite;
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-options.h"
+#include "mp-tcp-test-network.h"
+#include <vector>
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = 1000;
+
+class MpTcpBurstTestCase : public TestCase
+{
+public:
+  MpTcpBurstTestCase ();
+
+private:
+  // A client data segment as the channel saw it, sequence numbers relative to the first one
+  struct Mapping
+  {
+    uint32_t seq;
+    uint32_t size;
+    uint64_t dataSeq;
+    uint16_t dataLength;
+  };
+
+  virtual void DoRun (void);
+  void TestSameSegments (void);
+  void TestOffloadPayload (void);
+
+  /**
+   * Send m_bytes of patterned data over a single subflow
+   * \param sendBurst SendBurst of the client
+   * \param offload SegmentOffload of the client
+   * \param received filled with the bytes the server read, in payload mode
+   * \returns the client data segments, retransmissions included
+   */
+  std::vector<Mapping> Run (bool sendBurst, bool offload, std::vector<uint8_t> &received);
+  static void Send (Ptr<MpTcpSocketBase> socket, Ptr<Packet> data);
+  static uint8_t Byte (uint32_t offset);
+
+  uint32_t m_bytes;
+};
+
+MpTcpBurstTestCase::MpTcpBurstTestCase ()
+  : TestCase ("MPTCP bursts send the same segments as the per-segment path"),
+    m_bytes (20 * SEGMENT_SIZE + SEGMENT_SIZE / 2)
+{
+}
+
+uint8_t
+MpTcpBurstTestCase::Byte (uint32_t offset)
+{
+  return offset % 251;
+}
+
+void
+MpTcpBurstTestCase::Send (Ptr<MpTcpSocketBase> socket, Ptr<Packet> data)
+{
+  socket->FillBuffer (data);
+  socket->SendBufferedData ();
+}
+
+std::vector<MpTcpBurstTestCase::Mapping>
+MpTcpBurstTestCase::Run (bool sendBurst, bool offload, std::vector<uint8_t> &received)
+{
+  MpTcpTestNetwork net (MilliSeconds (1));
+  Ptr<MpTcpSocketBase> sockets[] = { net.GetClient (), net.GetListener () };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      sockets[i]->SetAttribute ("MaxSubflows", UintegerValue (1));
+      sockets[i]->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+      sockets[i]->SetAttribute ("Payload", BooleanValue (true));
+    }
+  net.GetClient ()->SetAttribute ("SendBurst", BooleanValue (sendBurst));
+  net.GetClient ()->SetAttribute ("SegmentOffload", BooleanValue (offload));
+  std::vector<uint8_t> data (m_bytes);
+  for (uint32_t i = 0; i < m_bytes; i++)
+    data[i] = Byte (i);
+  net.Connect ();
+  Simulator::Schedule (Seconds (1), &MpTcpBurstTestCase::Send, net.GetClient (), Create<Packet> (&data[0], m_bytes));
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  received.clear ();
+  Ptr<Packet> p;
+  while (net.GetServer () != 0 && (p = net.GetServer ()->RecvPacket (m_bytes)) != 0)
+    {
+      uint32_t offset = received.size ();
+      received.resize (offset + p->GetSize ());
+      p->CopyData (&received[offset], p->GetSize ());
+    }
+  std::vector<Mapping> mappings;
+  const std::vector<MpTcpTestChannel::Segment> &segs = net.GetChannel ()->GetSegments ();
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (!segs[i].fromClient || segs[i].size == 0)
+        continue;
+      Mapping m;
+      m.seq = segs[i].header.GetSequenceNumber ().GetValue ();
+      m.size = segs[i].size;
+      m.dataSeq = 0;
+      m.dataLength = 0;
+      const TcpOptionList &options = segs[i].header.GetOptions ();
+      for (uint32_t j = 0; j < options.size (); j++)
+        {
+          if (options[j]->optName != OPT_DSN)
+            continue;
+          const OptDataSeqMapping *dsn = (const OptDataSeqMapping *) options[j];
+          m.dataSeq = dsn->dataSeqNumber;
+          m.dataLength = dsn->dataLevelLength;
+        }
+      mappings.push_back (m);
+    }
+  for (uint32_t i = mappings.size (); i-- > 0; )
+    { // Initial sequence numbers differ from run to run
+      mappings[i].seq -= mappings[0].seq;
+      mappings[i].dataSeq -= mappings[0].dataSeq;
+    }
+  Simulator::Destroy ();
+  return mappings;
+}
+
+void
+MpTcpBurstTestCase::TestSameSegments (void)
+{
+  std::vector<uint8_t> received;
+  std::vector<Mapping> single = Run (false, false, received);
+  NS_TEST_ASSERT_MSG_EQ (single.size (), 21, "Whole segments and a short last one");
+  NS_TEST_ASSERT_MSG_EQ (single.back ().size, SEGMENT_SIZE / 2, "Short last segment");
+  for (uint32_t offload = 0; offload < 2; offload++)
+    {
+      std::vector<Mapping> burst = Run (true, offload == 1, received);
+      NS_TEST_ASSERT_MSG_EQ (burst.size (), single.size (), "Same number of segments");
+      for (uint32_t i = 0; i < single.size () && i < burst.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (burst[i].seq, single[i].seq, "Same subflow sequence number");
+          NS_TEST_ASSERT_MSG_EQ (burst[i].size, single[i].size, "Same segment size");
+          NS_TEST_ASSERT_MSG_EQ (burst[i].dataSeq, single[i].dataSeq, "Same data sequence number");
+          NS_TEST_ASSERT_MSG_EQ (burst[i].dataLength, single[i].dataLength, "Same data level length");
+        }
+    }
+}
+
+void
+MpTcpBurstTestCase::TestOffloadPayload (void)
+{
+  // The fragments cut out of each burst must cover it exactly: any gap or overlap shifts the bytes
+  // after it away from the data sequence numbers they are sent under
+  std::vector<uint8_t> received;
+  std::vector<Mapping> burst = Run (true, true, received);
+  NS_TEST_ASSERT_MSG_EQ ((burst.size () > 0), true, "Data sent");
+  uint64_t nextDataSeq = burst[0].dataSeq;
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < burst.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (burst[i].dataSeq, nextDataSeq, "Segments follow each other without a gap");
+      NS_TEST_ASSERT_MSG_EQ (burst[i].dataLength, burst[i].size, "Mapping covers the segment");
+      nextDataSeq += burst[i].dataLength;
+      total += burst[i].size;
+    }
+  NS_TEST_ASSERT_MSG_EQ (total, m_bytes, "The sending buffer is used up, nothing left in a burst");
+  NS_TEST_ASSERT_MSG_EQ (received.size (), m_bytes, "Everything received");
+  uint32_t wrong = 0;
+  for (uint32_t i = 0; i < received.size (); i++)
+    {
+      if (received[i] != Byte (i))
+        wrong++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (wrong, 0, "Every byte received at its place");
+}
+
+void
+MpTcpBurstTestCase::DoRun (void)
+{
+  TestSameSegments ();
+  TestOffloadPayload ();
+}
+
+static class MpTcpBurstTestSuite : public TestSuite
+{
+public:
+  MpTcpBurstTestSuite ()
+    : TestSuite ("mp-tcp-burst", UNIT)
+  {
+    AddTestCase (new MpTcpBurstTestCase, TestCase::QUICK);
+  }
+} g_mpTcpBurstTestSuite;
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/mp-tcp-socket-base.h"
+#include "ns3/mp-tcp-congestion-ops.h"
+#include "mp-tcp-test-socket.h"
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = MpTcpTestSocket::SEGMENT_SIZE;
+
+class CongestionTestSocket : public MpTcpTestSocket
+{
+public:
+  // cwnd and ssthresh are in segments, the whole window is in flight
+  Ptr<MpTcpSubFlow> AddSubflow (uint32_t cwnd, uint32_t ssthresh, uint32_t rttMs)
+  {
+    Ptr<MpTcpSubFlow> sFlow = MpTcpTestSocket::AddSubflow (cwnd, cwnd, rttMs);
+    sFlow->ssthresh = ssthresh * SEGMENT_SIZE;
+    return sFlow;
+  }
+  void Ack (uint8_t sFlowIdx)
+  {
+    OpenCWND (sFlowIdx, SEGMENT_SIZE);
+  }
+  uint32_t GetSsThresh (uint8_t sFlowIdx, uint32_t flightSize)
+  {
+    calculateTotalCWND ();
+    return GetCongestionOps ()->GetSsThresh (this, sFlowIdx, flightSize);
+  }
+  void EcnEcho (uint8_t sFlowIdx)
+  {
+    GetCongestionOps ()->EcnEcho (this, sFlowIdx);
+  }
+  uint32_t GetCoupledWindow ()
+  {
+    calculateTotalCWND ();
+    return m_coupledWindow;
+  }
+  double GetCoupledRate ()
+  {
+    return m_coupledRate;
+  }
+  double GetCoupledMaxRate2 ()
+  {
+    return m_coupledMaxRate2;
+  }
+  // ACK of the segment ending at ack, echoing CE or not
+  void DctcpAck (uint8_t sFlowIdx, uint32_t ack, bool ece)
+  {
+    m_eceBit = ece ? 1 : 0;
+    GetDctcpOps ()->UpdateAlpha (this, sFlowIdx, ack);
+    subflows[sFlowIdx]->highestAck = ack - 1;
+  }
+  void DctcpEcnEcho (uint8_t sFlowIdx)
+  {
+    if (GetDctcpOps ()->SlowDownDue (this, sFlowIdx))
+      GetDctcpOps ()->SlowDown (this, sFlowIdx);
+  }
+  bool HasDctcp ()
+  {
+    return m_dctcpOps != 0;
+  }
+};
+
+class MpTcpCongestionOpsTestCase : public TestCase
+{
+public:
+  MpTcpCongestionOpsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TestSelection (void);
+  void TestUncoupled (void);
+  void TestLia (void);
+  void TestAggregates (void);
+  void TestFullyCoupled (void);
+  void TestXmp (void);
+  void TestOlia (void);
+  void TestBalia (void);
+  void TestDctcp (void);
+};
+
+MpTcpCongestionOpsTestCase::MpTcpCongestionOpsTestCase ()
+  : TestCase ("MPTCP congestion ops grow and cut subflow windows per algorithm")
+{
+}
+
+void
+MpTcpCongestionOpsTestCase::TestSelection (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCongestionOps ()->GetInstanceTypeId (), MpTcpLia::GetTypeId (), "Default congestion control");
+  socket->SetAttribute ("CongestionControl", EnumValue (OLIA));
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCongestionOps ()->GetInstanceTypeId (), MpTcpOlia::GetTypeId (), "Congestion control from attribute");
+  socket->SetCCAlgo ("XMP");
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCongestionOps ()->GetInstanceTypeId (), MpTcpXmp::GetTypeId (), "Congestion control by name");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestUncoupled (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("CongestionControl", EnumValue (Uncoupled_TCPs));
+  Ptr<MpTcpSubFlow> slowStart = socket->AddSubflow (2, 64, 10);
+  Ptr<MpTcpSubFlow> avoidance = socket->AddSubflow (10, 5, 10);
+  socket->Ack (0);
+  socket->Ack (1);
+  NS_TEST_ASSERT_MSG_EQ (slowStart->cwnd.Get (), 3 * SEGMENT_SIZE, "One segment per ACK in slow start");
+  NS_TEST_ASSERT_MSG_EQ (avoidance->cwnd.Get (), 10100, "MSS * MSS / cwnd in congestion avoidance");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestLia (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  Ptr<MpTcpSubFlow> sFlow = socket->AddSubflow (10, 5, 10);
+  socket->AddSubflow (10, 5, 10);
+  // alpha = 20000 * (10000 / rtt^2) / (20000 / rtt)^2 = 0.5
+  socket->Ack (0);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->cwnd.Get (), 10025, "alpha * MSS * MSS / total cwnd");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestAggregates (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  Ptr<MpTcpSubFlow> small = socket->AddSubflow (10, 5, 10);
+  socket->AddSubflow (30, 5, 20);
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCoupledWindow (), 40000, "Sum of subflow windows");
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetCoupledRate (), 2.5, 1e-9, "10000 / 10000us + 30000 / 20000us");
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetCoupledMaxRate2 (), 1e-4, 1e-12, "10000 / 10000us^2");
+  // The subflow holding the maximum shrinks, the maximum moves to the other one
+  small->cwnd = 2 * SEGMENT_SIZE;
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCoupledWindow (), 32000, "Updated on cwnd change");
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetCoupledRate (), 1.7, 1e-9, "2000 / 10000us + 30000 / 20000us");
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetCoupledMaxRate2 (), 7.5e-5, 1e-12, "30000 / 20000us^2");
+  // A new RTT sample moves the maximum back
+  small->rtt->SetCurrentEstimate (MilliSeconds (4));
+  socket->Ack (0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetCoupledMaxRate2 (), small->cwnd.Get () / 16e6, 1e-12, "cwnd / 4000us^2");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestFullyCoupled (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("CongestionControl", EnumValue (Fully_Coupled));
+  socket->AddSubflow (10, 5, 10);
+  socket->AddSubflow (30, 5, 10);
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSsThresh (0, 10000), 2 * SEGMENT_SIZE, "Never below two segments");
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSsThresh (1, 30000), 10000, "cwnd - total cwnd / 2");
+  socket->SetAttribute ("CongestionControl", EnumValue (XCA));
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSsThresh (1, 30000), 15000, "XCA halves flight size");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestXmp (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("CongestionControl", EnumValue (XMP));
+  Ptr<MpTcpSubFlow> sFlow = socket->AddSubflow (20, 10, 10);
+  socket->EcnEcho (0);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->cwnd.Get (), 15 * SEGMENT_SIZE, "cwnd cut by 1 / beta");
+  socket->EcnEcho (0);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->cwnd.Get (), 15 * SEGMENT_SIZE, "At most one cut per round");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestOlia (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("CongestionControl", EnumValue (OLIA));
+  Ptr<MpTcpSubFlow> large = socket->AddSubflow (30, 5, 10);
+  Ptr<MpTcpSubFlow> small = socket->AddSubflow (10, 5, 10);
+  // The small subflow is the best path (most bytes since the last loss), alpha = 1/2
+  socket->Ack (1);
+  NS_TEST_ASSERT_MSG_EQ (small->cwnd.Get (), 10056, "1e6 * 10000 / 40000^2 + 0.5 * 1e6 / 10000");
+  // Both are best paths now, window moves away from the largest one, alpha = -1/2
+  socket->Ack (0);
+  NS_TEST_ASSERT_MSG_EQ (large->cwnd.Get (), 30002, "1e6 * 30000 / 40056^2 - 0.5 * 1e6 / 30000");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestBalia (void)
+{
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("CongestionControl", EnumValue (BALIA));
+  socket->AddSubflow (30, 5, 10);
+  socket->AddSubflow (10, 5, 10);
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSsThresh (0, 30000), 15000, "Fastest subflow halves its window");
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSsThresh (1, 10000), 2500, "Slower subflows back off by up to 3/4");
+}
+
+void
+MpTcpCongestionOpsTestCase::TestDctcp (void)
+{
+  Ptr<CongestionTestSocket> plain = CreateObject<CongestionTestSocket> ();
+  plain->AddSubflow (10, 5, 10);
+  plain->Ack (0);
+  NS_TEST_ASSERT_MSG_EQ (plain->HasDctcp (), false, "No DCTCP state unless DCTCP is enabled");
+
+  Ptr<CongestionTestSocket> socket = CreateObject<CongestionTestSocket> ();
+  socket->SetAttribute ("DCTCP", BooleanValue (true));
+  Ptr<MpTcpSubFlow> sFlow = socket->AddSubflow (20, 10, 10);
+  // The first ACK closes an empty window, the next one ends when 21000 is acknowledged
+  socket->DctcpAck (0, 2000, true);
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetDctcpOps ()->GetAlpha (0), 1.0 / 16, 1e-9, "alpha = g * fraction");
+  for (uint32_t ack = 3000; ack <= 21000; ack += SEGMENT_SIZE)
+    socket->DctcpAck (0, ack, ack % 2000 == 0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetDctcpOps ()->GetAlpha (0), 1.0 / 16, 1e-9, "alpha kept within the window");
+  socket->DctcpAck (0, 22000, true);
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetDctcpOps ()->GetMarkedFraction (0), 0.5, 1e-9, "10 of 20 segments marked");
+  NS_TEST_ASSERT_MSG_EQ_TOL (socket->GetDctcpOps ()->GetAlpha (0), 23.0 / 256, 1e-9, "(1 - g) * alpha + g * fraction");
+  // One cut per window of data
+  sFlow->TxSeqNumber = 40000;
+  socket->DctcpEcnEcho (0);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->cwnd.Get (), 19101, "cwnd * (1 - alpha / 2)");
+  NS_TEST_ASSERT_MSG_EQ (sFlow->ssthresh, 19101, "ssthresh follows cwnd");
+  socket->DctcpEcnEcho (0);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->cwnd.Get (), 19101, "No other cut before 40000 is acknowledged");
+}
+
+void
+MpTcpCongestionOpsTestCase::DoRun (void)
+{
+  TestSelection ();
+  TestUncoupled ();
+  TestLia ();
+  TestAggregates ();
+  TestFullyCoupled ();
+  TestXmp ();
+  TestOlia ();
+  TestBalia ();
+  TestDctcp ();
+}
+
+static class MpTcpCongestionOpsTestSuite : public TestSuite
+{
+public:
+  MpTcpCongestionOpsTestSuite ()
+    : TestSuite ("mp-tcp-congestion-ops", UNIT)
+  {
+    AddTestCase (new MpTcpCongestionOpsTestCase, TestCase::QUICK);
+  }
+} g_mpTcpCongestionOpsTestSuite;
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "mp-tcp-test-network.h"
+#include <map>
+#include <set>
+
+using namespace ns3;
+
+typedef std::vector<MpTcpTestChannel::Segment> Segments;
+
+static const uint32_t SEGMENT_SIZE = 1000;
+
+class MpTcpDelayedAckTestCase : public TestCase
+{
+public:
+  MpTcpDelayedAckTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TestCount (void);
+  void TestTimer (void);
+  void TestReordering (void);
+  void TestCeChange (void);
+
+  /**
+   * Send a single subflow bulk transfer from the client to the server
+   * \param delAckCount DelayedAckCount of both sockets
+   * \param segments data segments to send, 1 s after the connection started
+   * \param drop client data segment to drop, -1 for none
+   * \param markCe client data segment to CE mark, -1 for none
+   * \returns the segments seen by the channel
+   */
+  Segments Run (uint32_t delAckCount, uint32_t segments, int32_t drop, int32_t markCe);
+  static void Send (Ptr<MpTcpSocketBase> socket, uint32_t bytes);
+  static bool IsDataAck (const MpTcpTestChannel::Segment &s);
+  // Time each client data segment reaches the server, by sequence number, last transmission wins
+  std::map<uint32_t, Time> Arrivals (const Segments &segs) const;
+
+  Time m_delay;
+  Time m_timeout;
+};
+
+MpTcpDelayedAckTestCase::MpTcpDelayedAckTestCase ()
+  : TestCase ("MPTCP subflows delay ACKs up to DelayedAckCount segments or DelayedAckTimeout"),
+    m_delay (MilliSeconds (1)),
+    m_timeout (MilliSeconds (40))
+{
+}
+
+void
+MpTcpDelayedAckTestCase::Send (Ptr<MpTcpSocketBase> socket, uint32_t bytes)
+{
+  socket->FillBuffer (bytes);
+  socket->SendBufferedData ();
+}
+
+Segments
+MpTcpDelayedAckTestCase::Run (uint32_t delAckCount, uint32_t segments, int32_t drop, int32_t markCe)
+{
+  MpTcpTestNetwork net (m_delay);
+  Ptr<MpTcpSocketBase> sockets[] = { net.GetClient (), net.GetListener () };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      sockets[i]->SetAttribute ("MaxSubflows", UintegerValue (1));
+      sockets[i]->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+      sockets[i]->SetAttribute ("DelayedAckCount", UintegerValue (delAckCount));
+      sockets[i]->SetAttribute ("DelayedAckTimeout", TimeValue (m_timeout));
+    }
+  if (drop >= 0)
+    net.GetChannel ()->Drop (drop);
+  if (markCe >= 0)
+    net.GetChannel ()->MarkCe (markCe);
+  net.Connect ();
+  Simulator::Schedule (Seconds (1), &MpTcpDelayedAckTestCase::Send, net.GetClient (), segments * SEGMENT_SIZE);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Segments segs = net.GetChannel ()->GetSegments ();
+  Simulator::Destroy ();
+  return segs;
+}
+
+bool
+MpTcpDelayedAckTestCase::IsDataAck (const MpTcpTestChannel::Segment &s)
+{
+  return !s.fromClient && s.size == 0 && (s.header.GetFlags () & TcpHeader::ACK) && s.time >= Seconds (1);
+}
+
+std::map<uint32_t, Time>
+MpTcpDelayedAckTestCase::Arrivals (const Segments &segs) const
+{
+  std::map<uint32_t, Time> arrivals;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (segs[i].fromClient && segs[i].size > 0 && !segs[i].dropped)
+        arrivals[segs[i].header.GetSequenceNumber ().GetValue ()] = segs[i].time + m_delay;
+    }
+  return arrivals;
+}
+
+void
+MpTcpDelayedAckTestCase::TestCount (void)
+{
+  // Every ACK covers DelayedAckCount segments and leaves with the last of them, or fewer when the timer expires
+  const uint32_t count = 3;
+  Segments segs = Run (count, 30, -1, -1);
+  std::map<uint32_t, Time> arrivals = Arrivals (segs);
+  uint32_t prevAck = arrivals.begin ()->first;
+  uint32_t full = 0, timed = 0;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (!IsDataAck (segs[i]))
+        continue;
+      uint32_t ack = segs[i].header.GetAckNumber ().GetValue ();
+      NS_TEST_ASSERT_MSG_EQ ((ack > prevAck), true, "No duplicate ACK without losses");
+      NS_TEST_ASSERT_MSG_EQ (arrivals.count (ack - SEGMENT_SIZE), 1, "ACK is on a segment boundary");
+      Time last = arrivals[ack - SEGMENT_SIZE];
+      if (ack - prevAck == count * SEGMENT_SIZE)
+        {
+          NS_TEST_ASSERT_MSG_EQ (segs[i].time, last, "ACK sent when the last segment it covers arrives");
+          full++;
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_LT (ack - prevAck, count * SEGMENT_SIZE, "ACK covers at most DelayedAckCount segments");
+          NS_TEST_ASSERT_MSG_EQ (segs[i].time, last + m_timeout, "ACK of fewer segments sent by the timer");
+          timed++;
+        }
+      prevAck = ack;
+    }
+  NS_TEST_ASSERT_MSG_EQ (prevAck, arrivals.begin ()->first + 30 * SEGMENT_SIZE, "All data acknowledged");
+  NS_TEST_ASSERT_MSG_GT (full, timed, "Most ACKs cover DelayedAckCount segments");
+}
+
+void
+MpTcpDelayedAckTestCase::TestTimer (void)
+{
+  Segments segs = Run (2, 1, -1, -1);
+  std::map<uint32_t, Time> arrivals = Arrivals (segs);
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 1, "A single data segment");
+  uint32_t acks = 0;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (!IsDataAck (segs[i]))
+        continue;
+      NS_TEST_ASSERT_MSG_EQ (segs[i].header.GetAckNumber ().GetValue (), arrivals.begin ()->first + SEGMENT_SIZE,
+                             "Segment acknowledged");
+      NS_TEST_ASSERT_MSG_EQ (segs[i].time, arrivals.begin ()->second + m_timeout, "ACK sent when the timer expires");
+      acks++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (acks, 1, "A single ACK");
+}
+
+void
+MpTcpDelayedAckTestCase::TestReordering (void)
+{
+  // Segments above the hole and the retransmission filling it are acknowledged as they arrive
+  const int32_t lost = 12;
+  Segments segs = Run (2, 30, lost, -1);
+  uint32_t hole = 0;
+  Time filled;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (segs[i].dropped)
+        hole = segs[i].header.GetSequenceNumber ().GetValue ();
+      else if (hole != 0 && segs[i].fromClient && segs[i].header.GetSequenceNumber ().GetValue () == hole)
+        filled = segs[i].time + m_delay;
+    }
+  NS_TEST_ASSERT_MSG_NE (hole, 0, "Segment dropped");
+  NS_TEST_ASSERT_MSG_NE (filled, Time (0), "Segment retransmitted");
+  std::multiset<Time> above, dupAcks;
+  Time recovered;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      Time arrival = segs[i].time + m_delay;
+      if (segs[i].fromClient && segs[i].size > 0 && !segs[i].dropped
+          && segs[i].header.GetSequenceNumber ().GetValue () > hole && arrival < filled)
+        above.insert (arrival);
+      if (IsDataAck (segs[i]) && segs[i].header.GetAckNumber ().GetValue () == hole && segs[i].time < filled)
+        dupAcks.insert (segs[i].time);
+      if (IsDataAck (segs[i]) && segs[i].header.GetAckNumber ().GetValue () > hole && recovered.IsZero ())
+        recovered = segs[i].time;
+    }
+  NS_TEST_ASSERT_MSG_EQ (recovered, filled, "Retransmission acknowledged at once");
+  NS_TEST_ASSERT_MSG_GT (above.size (), 1, "Segments received above the hole");
+  NS_TEST_ASSERT_MSG_EQ (dupAcks.size (), above.size (), "Each segment above the hole is acknowledged");
+  NS_TEST_ASSERT_MSG_EQ ((dupAcks == above), true, "Each one as it arrives");
+}
+
+void
+MpTcpDelayedAckTestCase::TestCeChange (void)
+{
+  // DCTCP: no ACK covers both CE and not CE segments, its ECE is the CE state of what it covers.
+  // The 7th segment arrives while the 6th is held back, a flush is due right then
+  const int32_t marked = 6;
+  Segments segs = Run (2, 30, -1, marked);
+  std::map<uint32_t, bool> ce;
+  uint32_t ceSeq = 0;
+  Time ceArrival;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (segs[i].fromClient && segs[i].size > 0)
+        ce[segs[i].header.GetSequenceNumber ().GetValue ()] = segs[i].ce;
+      if (segs[i].ce)
+        {
+          ceSeq = segs[i].header.GetSequenceNumber ().GetValue ();
+          ceArrival = segs[i].time + m_delay;
+        }
+    }
+  NS_TEST_ASSERT_MSG_NE (ceSeq, 0, "Segment marked");
+  uint32_t prevAck = ce.begin ()->first;
+  bool flushed = false;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (!IsDataAck (segs[i]))
+        continue;
+      uint32_t ack = segs[i].header.GetAckNumber ().GetValue ();
+      bool ece = (segs[i].header.GetFlags () & TcpHeader::ECE) != 0;
+      for (uint32_t seq = prevAck; seq < ack; seq += SEGMENT_SIZE)
+        NS_TEST_ASSERT_MSG_EQ (ce[seq], ece, "ECE matches the CE state of every segment covered");
+      if (ack == ceSeq)
+        {
+          NS_TEST_ASSERT_MSG_EQ (segs[i].time, ceArrival, "Held segment flushed when the CE state changes");
+          flushed = true;
+        }
+      prevAck = ack;
+    }
+  NS_TEST_ASSERT_MSG_EQ (flushed, true, "Segment before the marked one acknowledged on its own");
+}
+
+void
+MpTcpDelayedAckTestCase::DoRun (void)
+{
+  TestCount ();
+  TestTimer ();
+  TestReordering ();
+  TestCeChange ();
+}
+
+static class MpTcpDelayedAckTestSuite : public TestSuite
+{
+public:
+  MpTcpDelayedAckTestSuite ()
+    : TestSuite ("mp-tcp-delayed-ack", UNIT)
+  {
+    AddTestCase (new MpTcpDelayedAckTestCase, TestCase::QUICK);
+  }
+} g_mpTcpDelayedAckTestSuite;
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/packet.h"
+#include "mp-tcp-test-network.h"
+#include <vector>
+#include <set>
+#include <utility>
+
+using namespace ns3;
+
+typedef std::vector<MpTcpTestChannel::Segment> Segments;
+
+static const uint32_t SEGMENT_SIZE = 1000;
+
+class MpTcpPayloadTestCase : public TestCase
+{
+public:
+  MpTcpPayloadTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send m_bytes of patterned data over two subflows in payload mode
+   * \param drops client data segments to drop
+   * \param received filled with the bytes the server read
+   * \returns the segments seen by the channel
+   */
+  Segments Run (const std::vector<uint32_t> &drops, std::vector<uint8_t> &received);
+  static void Send (Ptr<MpTcpSocketBase> socket, Ptr<Packet> data, uint32_t offset, uint32_t size);
+  static uint8_t Byte (uint32_t offset);
+  // Adler-32 of data
+  static uint32_t Checksum (const std::vector<uint8_t> &data);
+
+  std::vector<uint8_t> m_data;
+};
+
+MpTcpPayloadTestCase::MpTcpPayloadTestCase ()
+  : TestCase ("MPTCP payload reaches the peer intact over two lossy subflows"),
+    m_data (100 * SEGMENT_SIZE + 300)
+{
+  for (uint32_t i = 0; i < m_data.size (); i++)
+    m_data[i] = Byte (i);
+}
+
+uint8_t
+MpTcpPayloadTestCase::Byte (uint32_t offset)
+{
+  return (offset * 7 + offset / 251) % 256;
+}
+
+uint32_t
+MpTcpPayloadTestCase::Checksum (const std::vector<uint8_t> &data)
+{
+  uint32_t a = 1, b = 0;
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      a = (a + data[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+  return (b << 16) | a;
+}
+
+void
+MpTcpPayloadTestCase::Send (Ptr<MpTcpSocketBase> socket, Ptr<Packet> data, uint32_t offset, uint32_t size)
+{
+  socket->FillBuffer (data->CreateFragment (offset, size));
+  socket->SendBufferedData ();
+}
+
+Segments
+MpTcpPayloadTestCase::Run (const std::vector<uint32_t> &drops, std::vector<uint8_t> &received)
+{
+  MpTcpTestNetwork net (MilliSeconds (1));
+  Ptr<MpTcpSocketBase> sockets[] = { net.GetClient (), net.GetListener () };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      sockets[i]->SetAttribute ("MaxSubflows", UintegerValue (2));
+      sockets[i]->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+      sockets[i]->SetAttribute ("Payload", BooleanValue (true));
+    }
+  for (uint32_t i = 0; i < drops.size (); i++)
+    net.GetChannel ()->Drop (drops[i]);
+  net.Connect ();
+  // Application writes of odd sizes, so segments span two of them
+  Ptr<Packet> data = Create<Packet> (&m_data[0], m_data.size ());
+  const uint32_t write = 3 * SEGMENT_SIZE + 77;
+  for (uint32_t offset = 0; offset < m_data.size (); offset += write)
+    {
+      uint32_t size = std::min (write, (uint32_t) m_data.size () - offset);
+      Simulator::Schedule (Seconds (1) + MilliSeconds (offset / write), &MpTcpPayloadTestCase::Send,
+                           net.GetClient (), data, offset, size);
+    }
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+
+  received.clear ();
+  Ptr<Packet> p;
+  while (net.GetServer () != 0 && (p = net.GetServer ()->RecvPacket (m_data.size ())) != 0)
+    {
+      uint32_t offset = received.size ();
+      received.resize (offset + p->GetSize ());
+      p->CopyData (&received[offset], p->GetSize ());
+    }
+  Segments segs = net.GetChannel ()->GetSegments ();
+  Simulator::Destroy ();
+  return segs;
+}
+
+void
+MpTcpPayloadTestCase::DoRun (void)
+{
+  // Losses early and late in the transfer, back to back ones included, on both subflows
+  std::vector<uint32_t> drops;
+  drops.push_back (6);
+  drops.push_back (7);
+  drops.push_back (20);
+  drops.push_back (41);
+  drops.push_back (42);
+  drops.push_back (43);
+  drops.push_back (70);
+  std::vector<uint8_t> received;
+  Segments segs = Run (drops, received);
+
+  std::set<uint16_t> ports, lossPorts;
+  std::set<std::pair<uint16_t, uint32_t> > lost, everLost;
+  uint32_t retransmitted = 0;
+  for (uint32_t i = 0; i < segs.size (); i++)
+    {
+      if (!segs[i].fromClient || segs[i].size == 0)
+        continue;
+      std::pair<uint16_t, uint32_t> id (segs[i].header.GetSourcePort (), segs[i].header.GetSequenceNumber ().GetValue ());
+      ports.insert (id.first);
+      if (segs[i].dropped)
+        {
+          lost.insert (id);
+          everLost.insert (id);
+          lossPorts.insert (id.first);
+        }
+      else if (lost.erase (id) > 0)
+        retransmitted++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (ports.size (), 2, "Data sent on two subflows");
+  NS_TEST_ASSERT_MSG_EQ (lossPorts.size (), 2, "Losses on both subflows");
+  NS_TEST_ASSERT_MSG_EQ (lost.size (), 0, "Every dropped segment retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (retransmitted, everLost.size (), "Each lost segment delivered once repaired");
+
+  NS_TEST_ASSERT_MSG_EQ (received.size (), m_data.size (), "Everything received");
+  NS_TEST_ASSERT_MSG_EQ (Checksum (received), Checksum (m_data), "Same checksum at both ends");
+  uint32_t wrong = 0;
+  for (uint32_t i = 0; i < received.size () && i < m_data.size (); i++)
+    {
+      if (received[i] != m_data[i])
+        wrong++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (wrong, 0, "Every byte received at its place");
+}
+
+static class MpTcpPayloadTestSuite : public TestSuite
+{
+public:
+  MpTcpPayloadTestSuite ()
+    : TestSuite ("mp-tcp-payload", UNIT)
+  {
+    AddTestCase (new MpTcpPayloadTestCase, TestCase::QUICK);
+  }
+} g_mpTcpPayloadTestSuite;
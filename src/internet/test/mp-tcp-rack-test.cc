@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-options.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "mp-tcp-test-socket.h"
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = MpTcpTestSocket::SEGMENT_SIZE;
+
+// Sends nothing, records the segments it would send instead
+class RackTestSocket : public MpTcpTestSocket
+{
+public:
+  struct Sent
+  {
+    Time time;
+    uint32_t seq;
+    bool retransmission;
+  };
+
+  Ptr<MpTcpSubFlow> AddSubflow (uint32_t rttMs)
+  {
+    Ptr<MpTcpSubFlow> sFlow = MpTcpTestSocket::AddSubflow (20, 0, rttMs);
+    sFlow->maxSeqNb = sFlow->TxSeqNumber - 1;
+    return sFlow;
+  }
+  // New segment after the last one
+  void Send (uint8_t sFlowIdx)
+  {
+    Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+    sFlow->mapDSN.push_back (new DSNMapping (sFlowIdx, sFlow->TxSeqNumber, SEGMENT_SIZE, sFlow->TxSeqNumber, 0));
+    m_sent.push_back (MakeSent (sFlow->TxSeqNumber, false));
+    sFlow->TxSeqNumber += SEGMENT_SIZE;
+    sFlow->maxSeqNb = sFlow->TxSeqNumber - 1;
+    sFlow->m_highTxMark = sFlow->maxSeqNb;
+    SegmentSent (sFlowIdx, 0);
+  }
+  // ACK up to ack, SACKing [left, right) unless right is 0. Same steps as ReceivedAck()
+  void Ack (uint8_t sFlowIdx, uint32_t ack, uint32_t left, uint32_t right)
+  {
+    Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+    TcpHeader header;
+    header.SetAckNumber (SequenceNumber32 (ack));
+    if (right > 0)
+      {
+        OptDSACK sack (OPT_DSACK);
+        sack.AddBlock (left, right);
+        header.AddOptDSACK (OPT_DSACK, sack);
+      }
+    UpdateScoreboard (sFlowIdx, header);
+    RackUpdate (sFlowIdx, header);
+    if (ack > sFlow->highestAck + 1)
+      {
+        sFlow->mapDSN.DiscardUpTo (ack);
+        sFlow->highestAck = ack - 1;
+      }
+    RackDetectLoss (sFlowIdx);
+  }
+  void SetPeerWindow (uint32_t bytes)
+  {
+    remoteRecvWnd = bytes;
+  }
+  const std::vector<Sent>& GetSent (void) const
+  {
+    return m_sent;
+  }
+  Time GetRto (uint8_t sFlowIdx) const
+  {
+    return subflows[sFlowIdx]->rtt->RetransmitTimeout ();
+  }
+  bool InFastRecovery (uint8_t sFlowIdx) const
+  {
+    return subflows[sFlowIdx]->m_inFastRec;
+  }
+
+protected:
+  virtual void DoRetransmit (uint8_t sFlowIdx, DSNMapping* ptrDSN)
+  {
+    m_sent.push_back (MakeSent (ptrDSN->subflowSeqNumber, true));
+    SegmentSent (sFlowIdx, ptrDSN);
+  }
+  virtual int SendDataPacket (uint8_t sFlowIdx, uint32_t pktSize, bool withAck)
+  {
+    Send (sFlowIdx);
+    return pktSize;
+  }
+
+private:
+  static Sent MakeSent (uint32_t seq, bool retransmission)
+  {
+    Sent s;
+    s.time = Simulator::Now ();
+    s.seq = seq;
+    s.retransmission = retransmission;
+    return s;
+  }
+  std::vector<Sent> m_sent;
+};
+
+class MpTcpRackTestCase : public TestCase
+{
+public:
+  MpTcpRackTestCase ();
+
+private:
+  virtual void DoRun (void);
+  // RACK-TLP socket with one subflow and nothing in flight
+  static Ptr<RackTestSocket> CreateSocket (uint32_t rttMs);
+  void TestReordering (void);
+  void TestLoss (void);
+  void TestProbeNewData (void);
+  void TestProbeLast (void);
+  void TestProbeRto (void);
+};
+
+MpTcpRackTestCase::MpTcpRackTestCase ()
+  : TestCase ("MPTCP RACK marks segments lost by send time and TLP probes the tail")
+{
+}
+
+Ptr<RackTestSocket>
+MpTcpRackTestCase::CreateSocket (uint32_t rttMs)
+{
+  Ptr<RackTestSocket> socket = CreateObject<RackTestSocket> ();
+  socket->SetAttribute ("Sack", BooleanValue (true));
+  socket->SetAttribute ("LossRecovery", EnumValue (Rack_Tlp));
+  socket->AddSubflow (rttMs);
+  return socket;
+}
+
+void
+MpTcpRackTestCase::TestReordering (void)
+{
+  // Second segment sent 1 ms after the first and SACKed after 10 ms, the first one gets
+  // RACK.rtt + min RTT / 4 = 12.5 ms to show up before it is lost
+  Ptr<RackTestSocket> socket = CreateSocket (1000);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (1), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (11), &RackTestSocket::Ack, socket, 0, 1000, 2000, 3000);
+  Simulator::Stop (MilliSeconds (12));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (socket->GetSent ().size (), 2, "Reordered segment not marked lost");
+  NS_TEST_ASSERT_MSG_EQ (socket->InFastRecovery (0), false, "No recovery yet");
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  const std::vector<RackTestSocket::Sent> &sent = socket->GetSent ();
+  NS_TEST_ASSERT_MSG_EQ ((sent.size () > 2), true, "Lost once the reordering timer fires");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].retransmission, true, "Retransmission");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].seq, 1000, "Of the first segment");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].time, MicroSeconds (12500), "When the reordering window is over");
+  NS_TEST_ASSERT_MSG_EQ (socket->InFastRecovery (0), true, "Recovery entered");
+  Simulator::Destroy ();
+}
+
+void
+MpTcpRackTestCase::TestLoss (void)
+{
+  // Second segment sent 5 ms after the first and SACKed after 10 ms, the first one is
+  // 2.5 ms past RACK.rtt + min RTT / 4 already
+  Ptr<RackTestSocket> socket = CreateSocket (1000);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (5), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (15), &RackTestSocket::Ack, socket, 0, 1000, 2000, 3000);
+  Simulator::Stop (MilliSeconds (15) + NanoSeconds (1));
+  Simulator::Run ();
+  const std::vector<RackTestSocket::Sent> &sent = socket->GetSent ();
+  NS_TEST_ASSERT_MSG_EQ ((sent.size () > 2), true, "Older segment lost");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].seq, 1000, "First segment retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].time, MilliSeconds (15), "On the ACK SACKing the later one");
+  for (uint32_t i = 3; i < sent.size (); i++)
+    NS_TEST_ASSERT_MSG_NE (sent[i].seq, 2000, "SACKed segment not retransmitted");
+  Simulator::Destroy ();
+}
+
+void
+MpTcpRackTestCase::TestProbeNewData (void)
+{
+  // No ACK within 2 * SRTT, the window allows new data
+  Ptr<RackTestSocket> socket = CreateSocket (10);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  const std::vector<RackTestSocket::Sent> &sent = socket->GetSent ();
+  NS_TEST_ASSERT_MSG_EQ (sent.size (), 3, "A single probe");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].retransmission, false, "Probe carries new data");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].seq, 3000, "Right after the last segment");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].time, MilliSeconds (20), "After 2 * SRTT");
+  Simulator::Destroy ();
+}
+
+void
+MpTcpRackTestCase::TestProbeLast (void)
+{
+  // The peer's window is full, the last segment is sent again instead
+  Ptr<RackTestSocket> socket = CreateSocket (10);
+  socket->SetPeerWindow (2 * SEGMENT_SIZE);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  const std::vector<RackTestSocket::Sent> &sent = socket->GetSent ();
+  NS_TEST_ASSERT_MSG_EQ (sent.size (), 3, "A single probe");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].retransmission, true, "Probe retransmits");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].seq, 2000, "The last segment");
+  NS_TEST_ASSERT_MSG_EQ (sent[2].time, MilliSeconds (20), "After 2 * SRTT");
+  Simulator::Destroy ();
+}
+
+void
+MpTcpRackTestCase::TestProbeRto (void)
+{
+  // 2 * SRTT is longer than the RTO, the probe goes out when the RTO would expire
+  Ptr<RackTestSocket> socket = CreateSocket (800);
+  Time rto = socket->GetRto (0);
+  NS_TEST_ASSERT_MSG_LT (rto, MilliSeconds (1600), "RTO below 2 * SRTT");
+  Simulator::Schedule (MilliSeconds (0), &RackTestSocket::Send, socket, 0);
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  const std::vector<RackTestSocket::Sent> &sent = socket->GetSent ();
+  NS_TEST_ASSERT_MSG_EQ (sent.size (), 2, "A single probe");
+  NS_TEST_ASSERT_MSG_EQ (sent[1].time, rto, "Never later than the RTO");
+  Simulator::Destroy ();
+}
+
+void
+MpTcpRackTestCase::DoRun (void)
+{
+  TestReordering ();
+  TestLoss ();
+  TestProbeNewData ();
+  TestProbeLast ();
+  TestProbeRto ();
+}
+
+static class MpTcpRackTestSuite : public TestSuite
+{
+public:
+  MpTcpRackTestSuite ()
+    : TestSuite ("mp-tcp-rack", UNIT)
+  {
+    AddTestCase (new MpTcpRackTestCase, TestCase::QUICK);
+  }
+} g_mpTcpRackTestSuite;
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/mp-tcp-rtt-stats.h"
+
+using namespace ns3;
+
+class MpTcpRttStatsTestCase : public TestCase
+{
+public:
+  MpTcpRttStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TestBuckets (void);
+  void TestSmoothed (void);
+  void TestMinFilter (void);
+  void TestPercentile (void);
+};
+
+MpTcpRttStatsTestCase::MpTcpRttStatsTestCase ()
+  : TestCase ("MPTCP RTT stats keep a windowed min, a smoothed RTT and percentiles in constant memory")
+{
+}
+
+void
+MpTcpRttStatsTestCase::TestBuckets (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (1023), 0, "Below 1024ns");
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (1024), 1, "First octave");
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (1279), 1, "Still the first quarter");
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (1280), 2, "Second quarter");
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (2048), 5, "Second octave");
+  NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (Seconds (1000).GetNanoSeconds ()), MpTcpRttStats::BUCKETS - 1, "Clamped");
+  for (uint32_t b = 1; b < MpTcpRttStats::BUCKETS; b++)
+    NS_TEST_ASSERT_MSG_EQ (MpTcpRttStats::BucketOf (MpTcpRttStats::BucketLow (b)), b, "Lowest value of each bucket");
+}
+
+void
+MpTcpRttStatsTestCase::TestSmoothed (void)
+{
+  MpTcpRttStats stats;
+  NS_TEST_ASSERT_MSG_EQ (stats.GetSmoothed (), Seconds (0), "No sample yet");
+  stats.AddSample (MilliSeconds (100), Seconds (1));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetSmoothed (), MilliSeconds (100), "First sample");
+  NS_TEST_ASSERT_MSG_EQ (stats.GetVariation (), MilliSeconds (50), "Half the first sample");
+  stats.AddSample (MilliSeconds (200), Seconds (2));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetSmoothed (), MicroSeconds (112500), "7/8 old + 1/8 new");
+  NS_TEST_ASSERT_MSG_EQ (stats.GetVariation (), MicroSeconds (62500), "3/4 old + 1/4 deviation");
+  NS_TEST_ASSERT_MSG_EQ (stats.GetLatest (), MilliSeconds (200), "Latest sample");
+  stats.AddSample (Seconds (0), Seconds (3));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetSampleCount (), 2, "Zero samples are ignored");
+}
+
+void
+MpTcpRttStatsTestCase::TestMinFilter (void)
+{
+  MpTcpRttStats stats;
+  stats.SetMinWindow (Seconds (1));
+  stats.AddSample (MilliSeconds (10), MilliSeconds (0));
+  stats.AddSample (MilliSeconds (50), MilliSeconds (500));
+  stats.AddSample (MilliSeconds (30), MilliSeconds (800));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetMin (), MilliSeconds (10), "Minimum of the window");
+  stats.AddSample (MilliSeconds (40), MilliSeconds (1200));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetMin (), MilliSeconds (30), "Oldest minimum expired, the best later candidate takes over");
+  stats.AddSample (MilliSeconds (20), MilliSeconds (1300));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetMin (), MilliSeconds (20), "New minimum");
+  stats.AddSample (MilliSeconds (60), MilliSeconds (3000));
+  NS_TEST_ASSERT_MSG_EQ (stats.GetMin (), MilliSeconds (60), "All candidates expired");
+}
+
+void
+MpTcpRttStatsTestCase::TestPercentile (void)
+{
+  MpTcpRttStats stats, other;
+  NS_TEST_ASSERT_MSG_EQ (stats.GetPercentile (0.5), Seconds (0), "No sample yet");
+  for (uint32_t i = 0; i < 90; i++)
+    stats.AddSample (MilliSeconds (10), MilliSeconds (i));
+  for (uint32_t i = 0; i < 10; i++)
+    other.AddSample (MilliSeconds (100), MilliSeconds (i));
+  stats.Merge (other);
+  NS_TEST_ASSERT_MSG_EQ (stats.GetSampleCount (), 100, "Merged counts");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats.GetPercentile (0.5), MilliSeconds (10), MicroSeconds (1250), "Median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats.GetPercentile (0.9), MilliSeconds (10), MicroSeconds (1250), "Rank 90 is the last 10ms sample");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats.GetPercentile (0.95), MilliSeconds (100), MilliSeconds (12.5), "Tail");
+  NS_TEST_ASSERT_MSG_EQ (stats.GetPercentile (0), stats.GetPercentile (0.01), "Smallest sample");
+  NS_TEST_ASSERT_MSG_EQ (stats.GetMin (), MilliSeconds (10), "Merging leaves the min filter alone");
+}
+
+void
+MpTcpRttStatsTestCase::DoRun (void)
+{
+  TestBuckets ();
+  TestSmoothed ();
+  TestMinFilter ();
+  TestPercentile ();
+}
+
+static class MpTcpRttStatsTestSuite : public TestSuite
+{
+public:
+  MpTcpRttStatsTestSuite ()
+    : TestSuite ("mp-tcp-rtt-stats", UNIT)
+  {
+    AddTestCase (new MpTcpRttStatsTestCase, TestCase::QUICK);
+  }
+} g_mpTcpRttStatsTestSuite;
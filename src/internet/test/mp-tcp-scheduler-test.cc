@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/enum.h"
+#include "ns3/mp-tcp-socket-base.h"
+#include "ns3/mp-tcp-scheduler.h"
+#include "mp-tcp-test-socket.h"
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = MpTcpTestSocket::SEGMENT_SIZE;
+
+class SchedulerTestSocket : public MpTcpTestSocket
+{
+public:
+  void SetPeerWindow (uint32_t bytes)
+  {
+    remoteRecvWnd = bytes;
+  }
+  int Pick ()
+  {
+    return getSubflowToUse ();
+  }
+};
+
+class MpTcpSchedulerTestCase : public TestCase
+{
+public:
+  MpTcpSchedulerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TestRoundRobin (void);
+  void TestLowestRtt (void);
+  void TestBlest (void);
+  void TestCwndWeighted (void);
+};
+
+MpTcpSchedulerTestCase::MpTcpSchedulerTestCase ()
+  : TestCase ("MPTCP schedulers only pick subflows that can send")
+{
+}
+
+void
+MpTcpSchedulerTestCase::TestRoundRobin (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateObject<SchedulerTestSocket> ();
+  NS_TEST_ASSERT_MSG_EQ (socket->GetScheduler ()->GetInstanceTypeId (), MpTcpRoundRobinScheduler::GetTypeId (), "Default scheduler");
+  socket->AddSubflow (10, 0, 10);
+  socket->AddSubflow (10, 10, 10);  // No window left
+  socket->AddSubflow (10, 0, 10);
+  socket->AddSubflow (10, 0, 10)->state = SYN_SENT;
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 0, "Round robin");
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 2, "Subflow without window is skipped");
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 0, "Subflow not established is skipped");
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 2, "Round robin");
+}
+
+void
+MpTcpSchedulerTestCase::TestLowestRtt (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateObject<SchedulerTestSocket> ();
+  socket->SetAttribute ("SchedulingAlgorithm", EnumValue (Lowest_RTT));
+  NS_TEST_ASSERT_MSG_EQ (socket->GetScheduler ()->GetInstanceTypeId (), MpTcpLowestRttScheduler::GetTypeId (), "Scheduler from attribute");
+  socket->AddSubflow (10, 0, 30);
+  Ptr<MpTcpSubFlow> fast = socket->AddSubflow (10, 0, 10);
+  socket->AddSubflow (10, 0, 20);
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 1, "Lowest RTT");
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 1, "Lowest RTT again while it has window");
+  fast->TxSeqNumber = 1000 + 10 * SEGMENT_SIZE;
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 2, "Next lowest RTT with window");
+}
+
+void
+MpTcpSchedulerTestCase::TestBlest (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateObject<SchedulerTestSocket> ();
+  socket->SetAttribute ("SchedulingAlgorithm", EnumValue (Blest));
+  Ptr<MpTcpSubFlow> fast = socket->AddSubflow (10, 10, 10); // No window left
+  socket->AddSubflow (10, 2, 40);
+  // The fast subflow sends MSS * (10 + (4 - 1) / 2) * 4 = 46000 bytes during one slow RTT
+  socket->SetPeerWindow (40000);  // 40000 - 12000 in flight - 3000 for the slow subflow < 46000
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), -1, "Wait for the fast subflow rather than block it");
+  socket->SetPeerWindow (100000);
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 1, "Enough send window to use the slow subflow");
+  fast->TxSeqNumber = 1000;
+  NS_TEST_ASSERT_MSG_EQ (socket->Pick (), 0, "Fast subflow is used whenever it can send");
+}
+
+void
+MpTcpSchedulerTestCase::TestCwndWeighted (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateObject<SchedulerTestSocket> ();
+  socket->SetAttribute ("SchedulingAlgorithm", EnumValue (Cwnd_Weighted));
+  socket->AddSubflow (30, 0, 10);
+  socket->AddSubflow (10, 0, 10);
+  socket->AddSubflow (10, 10, 10); // No window left
+  uint32_t picks[3] = { 0, 0, 0 };
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      int sFlowIdx = socket->Pick ();
+      NS_TEST_ASSERT_MSG_EQ ((sFlowIdx >= 0 && sFlowIdx < 3), true, "A subflow with window is picked");
+      picks[sFlowIdx]++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (picks[0], 30, "Share proportional to cwnd");
+  NS_TEST_ASSERT_MSG_EQ (picks[1], 10, "Share proportional to cwnd");
+  NS_TEST_ASSERT_MSG_EQ (picks[2], 0, "Subflow without window is never picked");
+}
+
+void
+MpTcpSchedulerTestCase::DoRun (void)
+{
+  TestRoundRobin ();
+  TestLowestRtt ();
+  TestBlest ();
+  TestCwndWeighted ();
+}
+
+static class MpTcpSchedulerTestSuite : public TestSuite
+{
+public:
+  MpTcpSchedulerTestSuite ()
+    : TestSuite ("mp-tcp-scheduler", UNIT)
+  {
+    AddTestCase (new MpTcpSchedulerTestCase, TestCase::QUICK);
+  }
+} g_mpTcpSchedulerTestSuite;
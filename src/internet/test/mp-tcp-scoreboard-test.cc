@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/mp-tcp-scoreboard.h"
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = 1000;
+
+class MpTcpScoreboardTestCase : public TestCase
+{
+public:
+  MpTcpScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void TestRanges (void);
+  void TestDiscard (void);
+  void TestLoss (void);
+  void TestPipe (void);
+};
+
+MpTcpScoreboardTestCase::MpTcpScoreboardTestCase ()
+  : TestCase ("MPTCP SACK scoreboard merges ranges and estimates loss and pipe")
+{
+}
+
+void
+MpTcpScoreboardTestCase::TestRanges (void)
+{
+  MpTcpScoreboard sb;
+  NS_TEST_ASSERT_MSG_EQ (sb.Add (3000, 4000), 1000, "New range");
+  NS_TEST_ASSERT_MSG_EQ (sb.Add (6000, 7000), 1000, "Second range");
+  NS_TEST_ASSERT_MSG_EQ (sb.Add (3500, 4000), 0, "Already covered");
+  NS_TEST_ASSERT_MSG_EQ (sb.Add (4000, 5000), 1000, "Touching ranges are merged");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetRangeCount (), 2, "[3000, 5000) and [6000, 7000)");
+  NS_TEST_ASSERT_MSG_EQ (sb.Add (2000, 8000), 3000, "Fills the gaps around and between the ranges");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetRangeCount (), 1, "Everything merged");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetCoveredBytes (), 6000, "[2000, 8000)");
+  uint32_t left = 0, right = 0;
+  NS_TEST_ASSERT_MSG_EQ (sb.GetRange (7999, left, right), true, "Last byte is covered");
+  NS_TEST_ASSERT_MSG_EQ (left, 2000, "Left edge");
+  NS_TEST_ASSERT_MSG_EQ (right, 8000, "Right edge");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetRange (8000, left, right), false, "Right edge is excluded");
+  NS_TEST_ASSERT_MSG_EQ (sb.NextHole (1000), 1000, "Not covered");
+  NS_TEST_ASSERT_MSG_EQ (sb.NextHole (2500), 8000, "Skips the range");
+}
+
+void
+MpTcpScoreboardTestCase::TestDiscard (void)
+{
+  MpTcpScoreboard sb;
+  sb.Add (2000, 3000);
+  sb.Add (4000, 6000);
+  sb.DiscardBelow (5000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetRangeCount (), 1, "First range dropped");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetCoveredBytes (), 1000, "Second range cut at the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetHighRxt (), 5000, "Nothing below the ACK is left to retransmit");
+  sb.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (sb.GetCoveredBytes (), 0, "Cleared");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetHighRxt (), 0, "Cleared");
+}
+
+void
+MpTcpScoreboardTestCase::TestLoss (void)
+{
+  // Segments from 1000, the first one is lost
+  MpTcpScoreboard sb;
+  sb.Add (2000, 4000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetLossFrontier (3, SEGMENT_SIZE), 0, "Two segments SACKed above, not lost yet");
+  sb.Add (4000, 5000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetLossFrontier (3, SEGMENT_SIZE), 2000, "Three segments SACKed above");
+  // Three discontiguous ranges make the holes between them lost too
+  sb.Clear ();
+  sb.Add (2000, 2500);
+  sb.Add (3000, 3500);
+  sb.Add (4000, 4500);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetLossFrontier (3, SEGMENT_SIZE), 2000, "Three ranges above");
+}
+
+void
+MpTcpScoreboardTestCase::TestPipe (void)
+{
+  // 10 segments in flight from 1000, the 1st and 4th are lost, all others SACKed
+  MpTcpScoreboard sb;
+  sb.Add (2000, 4000);
+  sb.Add (5000, 11000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetLossFrontier (3, SEGMENT_SIZE), 5000, "Holes below the last three segments are lost");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetPipe (1000, 11000, 3, SEGMENT_SIZE), 0, "Lost and SACKed segments leave the pipe");
+  sb.SetHighRxt (2000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetPipe (1000, 11000, 3, SEGMENT_SIZE), SEGMENT_SIZE, "First hole retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (sb.NextHole (sb.GetHighRxt ()), 4000, "Next hole to retransmit");
+  sb.SetHighRxt (5000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetPipe (1000, 11000, 3, SEGMENT_SIZE), 2 * SEGMENT_SIZE, "Both holes retransmitted");
+  // The cumulative ACK moves past the first hole
+  sb.DiscardBelow (4000);
+  NS_TEST_ASSERT_MSG_EQ (sb.GetPipe (4000, 11000, 3, SEGMENT_SIZE), SEGMENT_SIZE, "Second retransmission still in flight");
+  NS_TEST_ASSERT_MSG_EQ (sb.GetPipe (4000, 12000, 3, SEGMENT_SIZE), 2 * SEGMENT_SIZE, "New data counts in full");
+}
+
+void
+MpTcpScoreboardTestCase::DoRun (void)
+{
+  TestRanges ();
+  TestDiscard ();
+  TestLoss ();
+  TestPipe ();
+}
+
+static class MpTcpScoreboardTestSuite : public TestSuite
+{
+public:
+  MpTcpScoreboardTestSuite ()
+    : TestSuite ("mp-tcp-scoreboard", UNIT)
+  {
+    AddTestCase (new MpTcpScoreboardTestCase, TestCase::QUICK);
+  }
+} g_mpTcpScoreboardTestSuite;
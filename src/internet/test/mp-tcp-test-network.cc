@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mp-tcp-test-network.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("MpTcpTestNetwork");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MpTcpTestChannel)
+  ;
+
+TypeId
+MpTcpTestChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpTestChannel")
+    .SetParent<SimpleChannel> ()
+    .AddConstructor<MpTcpTestChannel> ()
+  ;
+  return tid;
+}
+
+MpTcpTestChannel::MpTcpTestChannel ()
+  : m_dataSegments (0)
+{
+}
+
+void
+MpTcpTestChannel::Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
+                        Ptr<SimpleNetDevice> sender)
+{
+  NS_LOG_FUNCTION (p << protocol << to << from << sender);
+  Ptr<Packet> copy = p->Copy ();
+  Ipv4Header ipHeader;
+  copy->RemoveHeader (ipHeader);
+  if (ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER)
+    {
+      Segment s;
+      s.time = Simulator::Now ();
+      s.fromClient = (sender == m_devices[0]);
+      copy->RemoveHeader (s.header);
+      s.size = copy->GetSize ();
+      s.dropped = false;
+      s.ce = false;
+      if (s.fromClient && s.size > 0)
+        {
+          s.dropped = m_drop.count (m_dataSegments) > 0;
+          s.ce = m_markCe.count (m_dataSegments) > 0;
+          m_dataSegments++;
+        }
+      m_segments.push_back (s);
+      if (s.dropped)
+        {
+          return;
+        }
+      if (s.ce)
+        {
+          p = p->Copy ();
+          p->RemoveHeader (ipHeader);
+          ipHeader.SetEcn (Ipv4Header::ECN_CE);
+          p->AddHeader (ipHeader);
+        }
+    }
+  for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
+    {
+      Ptr<SimpleNetDevice> tmp = *i;
+      if (tmp == sender)
+        {
+          continue;
+        }
+      Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
+                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+    }
+}
+
+void
+MpTcpTestChannel::Add (Ptr<SimpleNetDevice> device)
+{
+  m_devices.push_back (device);
+  SimpleChannel::Add (device);
+}
+
+void
+MpTcpTestChannel::SetDelay (Time delay)
+{
+  m_delay = delay;
+}
+
+void
+MpTcpTestChannel::Drop (uint32_t dataSegment)
+{
+  m_drop.insert (dataSegment);
+}
+
+void
+MpTcpTestChannel::MarkCe (uint32_t dataSegment)
+{
+  m_markCe.insert (dataSegment);
+}
+
+const std::vector<MpTcpTestChannel::Segment>&
+MpTcpTestChannel::GetSegments (void) const
+{
+  return m_segments;
+}
+
+const uint16_t MpTcpTestNetwork::PORT;
+
+MpTcpTestNetwork::MpTcpTestNetwork (Time delay)
+{
+  m_nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+
+  m_channel = CreateObject<MpTcpTestChannel> ();
+  m_channel->SetDelay (delay);
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (m_channel);
+      m_nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  m_serverAddress = interfaces.GetAddress (1);
+
+  m_client = DynamicCast<MpTcpSocketBase> (
+      m_nodes.Get (0)->GetObject<TcpL4Protocol> ()->CreateSocket (MpTcpSocketBase::GetTypeId ()));
+  m_listener = DynamicCast<MpTcpSocketBase> (
+      m_nodes.Get (1)->GetObject<TcpL4Protocol> ()->CreateSocket (MpTcpSocketBase::GetTypeId ()));
+}
+
+Ptr<MpTcpSocketBase>
+MpTcpTestNetwork::GetClient (void) const
+{
+  return m_client;
+}
+
+Ptr<MpTcpSocketBase>
+MpTcpTestNetwork::GetListener (void) const
+{
+  return m_listener;
+}
+
+Ptr<MpTcpSocketBase>
+MpTcpTestNetwork::GetServer (void) const
+{
+  return m_server;
+}
+
+Ptr<MpTcpTestChannel>
+MpTcpTestNetwork::GetChannel (void) const
+{
+  return m_channel;
+}
+
+void
+MpTcpTestNetwork::Connect (void)
+{
+  m_listener->Bind (InetSocketAddress (Ipv4Address::GetAny (), PORT));
+  m_listener->Listen ();
+  m_listener->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                                 MakeCallback (&MpTcpTestNetwork::Accept, this));
+  m_client->Bind ();
+  m_client->Connect (InetSocketAddress (m_serverAddress, PORT));
+}
+
+void
+MpTcpTestNetwork::Accept (Ptr<Socket> socket, const Address &from)
+{
+  m_server = DynamicCast<MpTcpSocketBase> (socket);
+}
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef MP_TCP_TEST_NETWORK_H
+#define MP_TCP_TEST_NETWORK_H
+
+#include "ns3/simple-channel.h"
+#include "ns3/node-container.h"
+#include "ns3/tcp-header.h"
+#include "ns3/nstime.h"
+#include "ns3/mp-tcp-socket-base.h"
+#include <vector>
+#include <set>
+
+namespace ns3 {
+
+class SimpleNetDevice;
+
+/**
+ * \brief Channel of fixed delay between two SimpleNetDevices, which records
+ * the TCP segments crossing it. Used for testing
+ *
+ * The first device added is the client's. The data segments it sends,
+ * counted from 0 and retransmissions included, can be dropped or CE marked
+ * on their way.
+ */
+class MpTcpTestChannel : public SimpleChannel
+{
+public:
+  struct Segment
+  {
+    Time time;         //!< When the segment entered the channel
+    bool fromClient;
+    TcpHeader header;
+    uint32_t size;     //!< Payload bytes
+    bool dropped;
+    bool ce;           //!< CE marked by the channel
+  };
+
+  static TypeId GetTypeId (void);
+  MpTcpTestChannel ();
+
+  virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
+                     Ptr<SimpleNetDevice> sender);
+  virtual void Add (Ptr<SimpleNetDevice> device);
+
+  void SetDelay (Time delay);
+  void Drop (uint32_t dataSegment);
+  void MarkCe (uint32_t dataSegment);
+  const std::vector<Segment>& GetSegments (void) const;
+
+private:
+  std::vector<Ptr<SimpleNetDevice> > m_devices;
+  Time m_delay;
+  std::set<uint32_t> m_drop;
+  std::set<uint32_t> m_markCe;
+  uint32_t m_dataSegments; //!< Data segments sent by the client so far
+  std::vector<Segment> m_segments;
+};
+
+/**
+ * \brief An MPTCP client and an MPTCP server on two nodes joined by an
+ * MpTcpTestChannel. Used for testing
+ *
+ * Both sockets exist once the network is built, so a test can set their
+ * attributes before Connect(). The server's are copied to the socket it
+ * accepts the connection with.
+ */
+class MpTcpTestNetwork
+{
+public:
+  static const uint16_t PORT = 5000;
+
+  MpTcpTestNetwork (Time delay);
+
+  Ptr<MpTcpSocketBase> GetClient (void) const;
+  Ptr<MpTcpSocketBase> GetListener (void) const;
+  Ptr<MpTcpSocketBase> GetServer (void) const; //!< Accepted socket, 0 before the connection is set up
+  Ptr<MpTcpTestChannel> GetChannel (void) const;
+
+  void Connect (void);
+
+private:
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  NodeContainer m_nodes;
+  Ptr<MpTcpTestChannel> m_channel;
+  Ptr<MpTcpSocketBase> m_client;
+  Ptr<MpTcpSocketBase> m_listener;
+  Ptr<MpTcpSocketBase> m_server;
+  Ipv4Address m_serverAddress;
+};
+
+} // namespace ns3
+
+#endif /* MP_TCP_TEST_NETWORK_H */
@@ -1,7 +1,5 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 /*
- * Copyright (c) 2008 INRIA
- *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License version 2 as
  * published by the Free Software Foundation;
@@ -15,33 +13,36 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
- * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
-#ifndef CE_TAG_H
-#define CE_TAG_H
 
-#include "ns3/tag.h"
+#include "mp-tcp-test-socket.h"
 
 namespace ns3 {
 
-class CeTag : public Tag
-{
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer buf) const;
-  virtual void Deserialize (TagBuffer buf);
-  virtual void Print (std::ostream &os) const;
+const uint32_t MpTcpTestSocket::SEGMENT_SIZE;
 
-  CeTag ();
-  void SetCe (uint8_t ce);
-  uint8_t GetCe (void) const;
+MpTcpTestSocket::MpTcpTestSocket ()
+{
+  remoteRecvWnd = 1 << 20;
+  m_rwndScale = 1;
+  sendingBuffer.SetBufferSize (1 << 20);
+  sendingBuffer.Add (1 << 19);
+}
 
-private:
-  uint8_t m_ce;
-};
+Ptr<MpTcpSubFlow>
+MpTcpTestSocket::AddSubflow (uint32_t cwnd, uint32_t inFlight, uint32_t rttMs)
+{
+  Ptr<MpTcpSubFlow> sFlow = CreateObject<MpTcpSubFlow> ();
+  sFlow->routeId = subflows.size ();
+  sFlow->state = ESTABLISHED;
+  sFlow->MSS = SEGMENT_SIZE;
+  sFlow->cwnd = cwnd * SEGMENT_SIZE;
+  sFlow->highestAck = 999;
+  sFlow->TxSeqNumber = 1000 + inFlight * SEGMENT_SIZE;
+  sFlow->m_highTxMark = sFlow->TxSeqNumber - 1;
+  sFlow->rtt->SetCurrentEstimate (MilliSeconds (rttMs));
+  subflows.push_back (sFlow);
+  return sFlow;
+}
 
 } // namespace ns3
-
-#endif /* CE_TAG_H */
@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef MP_TCP_TEST_SOCKET_H
+#define MP_TCP_TEST_SOCKET_H
+
+#include "ns3/mp-tcp-socket-base.h"
+
+namespace ns3 {
+
+/**
+ * \brief Socket whose subflows are set up by hand, without any network
+ * underneath. Used for testing
+ *
+ * The peer advertises a large window and half of a large sending buffer
+ * is filled. The test suites derive from it to reach the protected
+ * members they check.
+ */
+class MpTcpTestSocket : public MpTcpSocketBase
+{
+public:
+  static const uint32_t SEGMENT_SIZE = 1000;
+
+  MpTcpTestSocket ();
+
+  /**
+   * \brief Add an established subflow whose first data byte is 1000
+   * \param cwnd congestion window, in segments
+   * \param inFlight segments sent and not acknowledged yet
+   * \param rttMs smoothed round trip time, in milliseconds
+   * \returns the subflow
+   */
+  Ptr<MpTcpSubFlow> AddSubflow (uint32_t cwnd, uint32_t inFlight, uint32_t rttMs);
+};
+
+} // namespace ns3
+
+#endif /* MP_TCP_TEST_SOCKET_H */
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/mp-tcp-timer-wheel.h"
+
+using namespace ns3;
+
+class MpTcpTimerWheelTestCase : public TestCase
+{
+public:
+  MpTcpTimerWheelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Fired (uint32_t timer);
+  void Rearm (uint32_t timer, Time delay);
+  void Cancel (uint32_t timer);
+
+  Ptr<MpTcpTimerWheel> m_wheel;
+  MpTcpTimer m_timers[5];
+  Time m_fired[5];
+};
+
+MpTcpTimerWheelTestCase::MpTcpTimerWheelTestCase ()
+  : TestCase ("MPTCP timer wheel expires, re-arms and cancels timers with one event per occupied tick")
+{
+}
+
+void
+MpTcpTimerWheelTestCase::Fired (uint32_t timer)
+{
+  m_fired[timer] = Simulator::Now ();
+  if (timer == 4 && Simulator::Now () < MilliSeconds (30))
+    m_timers[4].Schedule (m_wheel, MilliSeconds (10)); // Periodic
+}
+
+void
+MpTcpTimerWheelTestCase::Rearm (uint32_t timer, Time delay)
+{
+  m_timers[timer].Schedule (m_wheel, delay);
+}
+
+void
+MpTcpTimerWheelTestCase::Cancel (uint32_t timer)
+{
+  m_timers[timer].Cancel ();
+}
+
+void
+MpTcpTimerWheelTestCase::DoRun (void)
+{
+  m_wheel = CreateObjectWithAttributes<MpTcpTimerWheel> ("Tick", TimeValue (MilliSeconds (1)), "Slots", UintegerValue (8));
+  for (uint32_t i = 0; i < 5; i++)
+    m_timers[i].SetFunction (MakeCallback (&MpTcpTimerWheelTestCase::Fired, this).Bind (i));
+
+  // Deadlines are rounded up to the tick
+  m_timers[0].Schedule (m_wheel, MicroSeconds (2500));
+  // Restarted every 2ms like an RTO on new ACKs, fires 10ms after the last restart
+  m_timers[1].Schedule (m_wheel, MilliSeconds (10));
+  for (uint32_t i = 1; i <= 4; i++)
+    Simulator::Schedule (MilliSeconds (2 * i), &MpTcpTimerWheelTestCase::Rearm, this, 1, MilliSeconds (10));
+  // Further away than one turn of the wheel, then moved to an earlier time
+  m_timers[2].Schedule (m_wheel, MilliSeconds (20));
+  Simulator::Schedule (MilliSeconds (3), &MpTcpTimerWheelTestCase::Rearm, this, 2, MilliSeconds (4));
+  // Cancelled before it expires
+  m_timers[3].Schedule (m_wheel, MilliSeconds (6));
+  Simulator::Schedule (MilliSeconds (5), &MpTcpTimerWheelTestCase::Cancel, this, 3);
+  m_timers[4].Schedule (m_wheel, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetPendingCount (), 5, "All timers running");
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_fired[0], MilliSeconds (3), "Rounded up to the next tick");
+  NS_TEST_ASSERT_MSG_EQ (m_fired[1], MilliSeconds (18), "Last restart plus 10ms");
+  NS_TEST_ASSERT_MSG_EQ (m_fired[2], MilliSeconds (7), "Moved to an earlier deadline");
+  NS_TEST_ASSERT_MSG_EQ (m_fired[3], Seconds (0), "Cancelled timer never fires");
+  NS_TEST_ASSERT_MSG_EQ (m_fired[4], MilliSeconds (30), "Re-armed from its own callback");
+  NS_TEST_ASSERT_MSG_EQ (m_timers[4].IsRunning (), false, "Stopped re-arming");
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetPendingCount (), 0, "No timer left");
+  // Wake ups at 3, 4, 6, 7, 10, 12, 18, 20, 22 and 30. Those at 4, 6, 12 and 22 find nothing due,
+  // their slot held a later round or a timer that was moved or cancelled since
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetScheduledEvents (), 10, "One event per occupied slot, not per restart");
+
+  m_wheel->Dispose ();
+  m_wheel = 0;
+  Simulator::Destroy ();
+}
+
+static class MpTcpTimerWheelTestSuite : public TestSuite
+{
+public:
+  MpTcpTimerWheelTestSuite ()
+    : TestSuite ("mp-tcp-timer-wheel", UNIT)
+  {
+    AddTestCase (new MpTcpTimerWheelTestCase, TestCase::QUICK);
+  }
+} g_mpTcpTimerWheelTestSuite;
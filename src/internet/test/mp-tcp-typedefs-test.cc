@@ -0,0 +1,491 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "ns3/mp-tcp-subflow.h"
+#include "ns3/mp-tcp-trace-sink.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+using namespace ns3;
+
+class DataBufferTestCase : public TestCase
+{
+public:
+  DataBufferTestCase (bool payload);
+
+private:
+  virtual void DoRun (void);
+  bool m_payload;
+};
+
+DataBufferTestCase::DataBufferTestCase (bool payload)
+  : TestCase (payload ? "DataBuffer with real payload" : "DataBuffer with virtual payload"),
+    m_payload (payload)
+{
+}
+
+void
+DataBufferTestCase::DoRun (void)
+{
+  DataBuffer buffer (20000);
+  buffer.SetPayloadMode (m_payload);
+  NS_TEST_ASSERT_MSG_EQ (buffer.Empty (), true, "New buffer should be empty");
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (15000), 15000, "Add should reserve all requested bytes");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (15000), 5000, "Add should be limited by the free space");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Full (), true, "Buffer should be full");
+
+  Ptr<Packet> p = buffer.CreatePacket (1400);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1400, "Packet should carry one segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.PendingData (), 18600, "Segment should be drained from buffer");
+  NS_TEST_ASSERT_MSG_EQ (buffer.FreeSpaceSize (), 1400, "Drained segment should be free again");
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.Retrieve (100000), 18600, "Retrieve should be limited by pending data");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Empty (), true, "Buffer should be empty after retrieving everything");
+  NS_TEST_ASSERT_MSG_EQ ((buffer.CreatePacket (1400) == 0), true, "No packet can be made from an empty buffer");
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.ReadPacket (p, p->GetSize ()), 1400, "Segment should be stored");
+  NS_TEST_ASSERT_MSG_EQ (buffer.PendingData (), 1400, "Stored segment should be pending");
+  buffer.ClearBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (buffer.Empty (), true, "Buffer should be empty after clearing");
+}
+
+class DataBufferPayloadTestCase : public TestCase
+{
+public:
+  DataBufferPayloadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DataBufferPayloadTestCase::DataBufferPayloadTestCase ()
+  : TestCase ("DataBuffer keeps byte stream across chunk boundaries")
+{
+}
+
+void
+DataBufferPayloadTestCase::DoRun (void)
+{
+  const uint32_t size = 30000; // spans several chunks
+  uint8_t *data = new uint8_t[size];
+  uint8_t *out = new uint8_t[size];
+  for (uint32_t i = 0; i < size; i++)
+    data[i] = (uint8_t)(i * 7 + i / 256);
+
+  DataBuffer tx (size);
+  tx.SetPayloadMode (true);
+  DataBuffer rx (size);
+  rx.SetPayloadMode (true);
+
+  // Fill and drain in uneven pieces so reads and writes cross chunk boundaries
+  uint32_t written = 0;
+  while (written < size)
+    {
+      written += tx.Add (data + written, std::min (size - written, (uint32_t) 3333));
+      Ptr<Packet> p;
+      while ((p = tx.CreatePacket (1000)) != 0)
+        rx.ReadPacket (p, p->GetSize ());
+    }
+  DataBuffer copy = rx;
+  NS_TEST_ASSERT_MSG_EQ (rx.Retrieve (out, size), size, "All bytes should reach the receive buffer");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (data, out, size), 0, "Byte stream should be preserved");
+
+  memset (out, 0, size);
+  NS_TEST_ASSERT_MSG_EQ (copy.Retrieve (out, size), size, "Copied buffer should hold all bytes");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (data, out, size), 0, "Copied buffer should hold the same bytes");
+
+  delete[] data;
+  delete[] out;
+}
+
+class DataBufferZeroCopyTestCase : public TestCase
+{
+public:
+  DataBufferZeroCopyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DataBufferZeroCopyTestCase::DataBufferZeroCopyTestCase ()
+  : TestCase ("Payload checksum survives segmenting, retransmission and reordering")
+{
+}
+
+static uint32_t
+Adler32 (const uint8_t *data, uint32_t size)
+{
+  uint32_t a = 1, b = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      a = (a + data[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+  return (b << 16) | a;
+}
+
+void
+DataBufferZeroCopyTestCase::DoRun (void)
+{
+  const uint32_t size = 20000;
+  uint8_t *data = new uint8_t[size];
+  uint8_t *out = new uint8_t[size];
+  for (uint32_t i = 0; i < size; i++)
+    data[i] = (uint8_t)(i * 13 + i / 251);
+
+  DataBuffer tx (size);
+  tx.SetPayloadMode (true);
+  DataBuffer rx (size);
+  rx.SetPayloadMode (true);
+
+  // The application writes packets of uneven sizes, so some segments straddle two of them
+  uint32_t written = 0;
+  for (uint32_t n = 700; written < size; n += 1100)
+    {
+      Ptr<Packet> app = Create<Packet> (data + written, std::min (n, size - written));
+      NS_TEST_ASSERT_MSG_EQ (tx.Add (app), app->GetSize (), "Application packet should be queued");
+      written += app->GetSize ();
+    }
+
+  // Segments keep their data in the subflow mapping, as SendDataPacket() does
+  vector<DSNMapping *> sent;
+  uint64_t dataSeq = 0;
+  Ptr<Packet> p;
+  while ((p = tx.CreatePacket (1000)) != 0)
+    {
+      DSNMapping *ptrDSN = new DSNMapping (0, dataSeq, p->GetSize (), dataSeq, 0);
+      ptrDSN->packet = p;
+      dataSeq += p->GetSize ();
+      sent.push_back (ptrDSN);
+    }
+  NS_TEST_ASSERT_MSG_EQ (dataSeq, size, "Whole stream should be segmented");
+
+  // Odd segments arrive first and wait in the reassembly queue, even ones are lost and their
+  // retransmissions, made from the mappings, arrive afterwards
+  DSNReassemblyQueue unOrdered;
+  uint64_t nextRxSequence = 0;
+  for (uint32_t i = 1; i < sent.size (); i += 2)
+    {
+      DSNMapping *ptrDSN = new DSNMapping (0, sent[i]->dataSeqNumber, sent[i]->dataLevelLength, sent[i]->subflowSeqNumber, 0);
+      ptrDSN->packet = sent[i]->GetPayload ();
+      unOrdered.Insert (ptrDSN);
+    }
+  for (uint32_t i = 0; i < sent.size (); i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sent[i]->dataSeqNumber, nextRxSequence, "Retransmission should fill the hole");
+      nextRxSequence += rx.ReadPacket (sent[i]->GetPayload (), sent[i]->dataLevelLength);
+      DSNMapping *ptrDSN;
+      while ((ptrDSN = unOrdered.Front ()) != 0 && ptrDSN->dataSeqNumber == nextRxSequence)
+        {
+          nextRxSequence += rx.ReadPacket (ptrDSN->packet, ptrDSN->dataLevelLength);
+          unOrdered.PopFront ();
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.empty (), true, "Every stored segment should be delivered");
+  NS_TEST_ASSERT_MSG_EQ (rx.PendingData (), size, "Whole stream should be in the receive buffer");
+
+  // The application gets the received segments back as they are
+  uint32_t read = 0;
+  while ((p = rx.RetrievePacket (1500)) != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((p->GetSize () <= 1000), true, "A retrieved packet never spans two segments");
+      read += p->CopyData (out + read, p->GetSize ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (read, size, "Whole stream should be retrieved");
+  NS_TEST_ASSERT_MSG_EQ (Adler32 (out, size), Adler32 (data, size), "Checksum should match end to end");
+
+  for (uint32_t i = 0; i < sent.size (); i++)
+    delete sent[i];
+  delete[] data;
+  delete[] out;
+}
+
+class DSNMappingQueueTestCase : public TestCase
+{
+public:
+  DSNMappingQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DSNMappingQueueTestCase::DSNMappingQueueTestCase ()
+  : TestCase ("DSNMappingQueue lookups and cumulative discard")
+{
+}
+
+void
+DSNMappingQueueTestCase::DoRun (void)
+{
+  DSNMappingQueue mapDSN;
+  for (uint32_t i = 0; i < 100; i++)
+    mapDSN.push_back (new DSNMapping (0, 5000 + i * 1000, 1000, 1 + i * 1000, 0));
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.size (), 100, "All mappings should be stored");
+
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.Find (42001)->dataSeqNumber, 47000, "Lookup by subflow seqNb");
+  NS_TEST_ASSERT_MSG_EQ ((mapDSN.Find (42002) == 0), true, "No segment starts inside another one");
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.FindByEnd (42001)->subflowSeqNumber, 41001, "Lookup by segment end");
+  NS_TEST_ASSERT_MSG_EQ ((mapDSN.FindByEnd (100002) == 0), true, "No segment ends past the last one");
+
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.DiscardUpTo (10500), 10, "Partially acked segment should be kept");
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.front ()->subflowSeqNumber, 10001, "Front should be first unacked segment");
+  NS_TEST_ASSERT_MSG_EQ ((mapDSN.Find (5001) == 0), true, "Discarded segment should be gone");
+
+  DSNMappingQueue copy = mapDSN;
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.DiscardUpTo (100001), 90, "Cumulative ack should discard all segments");
+  NS_TEST_ASSERT_MSG_EQ (mapDSN.empty (), true, "Queue should be empty");
+  NS_TEST_ASSERT_MSG_EQ (copy.size (), 90, "Copy should own its own mappings");
+  NS_TEST_ASSERT_MSG_EQ (copy.Find (99001)->dataSeqNumber, 104000, "Copy should keep mapping contents");
+  copy.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (copy.size (), 0, "Clear should drop all mappings");
+}
+
+class DSNMappingPoolTestCase : public TestCase
+{
+public:
+  DSNMappingPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+  static void Allocate (std::vector<DSNMapping *> *mappings);
+  static void Free (std::vector<DSNMapping *> *mappings);
+};
+
+DSNMappingPoolTestCase::DSNMappingPoolTestCase ()
+  : TestCase ("DSNMapping pool counts live and peak mappings")
+{
+}
+
+void
+DSNMappingPoolTestCase::DoRun (void)
+{
+  uint32_t live = DSNMapping::GetLiveCount ();
+  {
+    DSNMappingQueue mapDSN;
+    for (uint32_t i = 0; i < 1000; i++) // spans several slabs
+      mapDSN.push_back (new DSNMapping (0, i * 1000, 1000, i * 1000, 0));
+    NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live + 1000, "Every mapping should be counted");
+    NS_TEST_ASSERT_MSG_EQ ((DSNMapping::GetPeakCount () >= live + 1000), true, "Peak should cover live mappings");
+    mapDSN.DiscardUpTo (500000);
+    NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live + 500, "Discarded mappings should be released");
+    DSNMapping *reused = new DSNMapping (1, 7, 8, 9, 10);
+    NS_TEST_ASSERT_MSG_EQ (reused->subflowSeqNumber, 9, "Recycled slot should be constructed");
+    delete reused;
+  }
+  NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live, "Queue should release its mappings when destroyed");
+#ifdef HAVE_PTHREAD_H
+  // Mappings freed by another thread than the one which allocated them, both ways
+  std::vector<DSNMapping *> mappings;
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&DSNMappingPoolTestCase::Allocate, &mappings));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live + 1000, "Mappings of other threads should be counted");
+  Free (&mappings);
+  NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live, "Mappings freed by this thread should be counted");
+  Allocate (&mappings);
+  thread = Create<SystemThread> (MakeBoundCallback (&DSNMappingPoolTestCase::Free, &mappings));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_ASSERT_MSG_EQ (DSNMapping::GetLiveCount (), live, "Mappings freed by other threads should be counted");
+#endif
+}
+
+void
+DSNMappingPoolTestCase::Allocate (std::vector<DSNMapping *> *mappings)
+{
+  for (uint32_t i = 0; i < 1000; i++)
+    mappings->push_back (new DSNMapping (0, i * 1000, 1000, i * 1000, 0));
+}
+
+void
+DSNMappingPoolTestCase::Free (std::vector<DSNMapping *> *mappings)
+{
+  for (uint32_t i = 0; i < mappings->size (); i++)
+    delete (*mappings)[i];
+  mappings->clear ();
+}
+
+class DSNReassemblyQueueTestCase : public TestCase
+{
+public:
+  DSNReassemblyQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DSNReassemblyQueueTestCase::DSNReassemblyQueueTestCase ()
+  : TestCase ("DSNReassemblyQueue ordering, duplicates and subflow lookups")
+{
+}
+
+void
+DSNReassemblyQueueTestCase::DoRun (void)
+{
+  DSNReassemblyQueue unOrdered;
+  // Two subflows, data segments of 1000 bytes interleaved at connection level
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Insert (new DSNMapping (1, 5000, 1000, 200, 0)), true, "Insert");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Insert (new DSNMapping (0, 2000, 1000, 100, 0)), true, "Insert");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Insert (new DSNMapping (0, 4000, 1000, 1100, 0)), true, "Insert");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Insert (new DSNMapping (1, 5000, 1000, 2200, 0)), false, "Duplicate data seqNb should be rejected");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Insert (new DSNMapping (1, 2000, 1000, 2200, 0)), false, "Duplicate data seqNb should be rejected");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.size (), 3, "Rejected segments should not be stored");
+
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Front ()->dataSeqNumber, 2000, "Front should be the lowest data seqNb");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.FindSubflowSegment (0, 1100)->dataSeqNumber, 4000, "Lookup by subflow seqNb");
+  NS_TEST_ASSERT_MSG_EQ ((unOrdered.FindSubflowSegment (1, 100) == 0), true, "Lookup should be per subflow");
+  NS_TEST_ASSERT_MSG_EQ ((unOrdered.FindSubflowSegment (7, 100) == 0), true, "Unknown subflow has no segments");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.HasSubflowSegment (1), true, "Subflow 1 has a stored segment");
+
+  DSNReassemblyQueue copy = unOrdered;
+  unOrdered.PopFront ();
+  unOrdered.PopFront ();
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.Front ()->dataSeqNumber, 5000, "Segments should drain in data seqNb order");
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.HasSubflowSegment (0), false, "Drained segments should leave the subflow index");
+  unOrdered.PopFront ();
+  NS_TEST_ASSERT_MSG_EQ (unOrdered.empty (), true, "Queue should be empty");
+  NS_TEST_ASSERT_MSG_EQ ((unOrdered.Front () == 0), true, "Empty queue has no front");
+
+  NS_TEST_ASSERT_MSG_EQ (copy.size (), 3, "Copy should own its own segments");
+  NS_TEST_ASSERT_MSG_EQ (copy.FindSubflowSegment (1, 200)->dataSeqNumber, 5000, "Copy should keep the subflow index");
+}
+
+class SubflowIndexTestCase : public TestCase
+{
+public:
+  SubflowIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SubflowIndexTestCase::SubflowIndexTestCase ()
+  : TestCase ("Subflow index keyed by 4-tuple")
+{
+}
+
+void
+SubflowIndexTestCase::DoRun (void)
+{
+  Ipv4Address src ("10.1.1.1");
+  Ipv4Address dst ("10.2.1.1");
+  MpTcpSubflowIndex subflowIndex;
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (src, 49153, dst, 5000)), -1, "Empty index");
+  // NdiffPorts subflows only differ by their source port, enough of them to grow the table
+  for (uint8_t i = 0; i < 32; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (subflowIndex.Insert (MpTcpSubflowTuple (src, 49153 + i, dst, 5000), i), true, "Insert");
+    }
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Insert (MpTcpSubflowTuple (src, 49153, dst, 5000), 40), false, "4-tuple already indexed");
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.size (), 32, "Tuples differing by one port should be distinct keys");
+  for (uint8_t i = 0; i < 32; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (src, 49153 + i, dst, 5000)), i, "Lookup should return the subflow index");
+    }
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (dst, 49153, src, 5000)), -1, "Swapped addresses are another 4-tuple");
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (src, 5000, dst, 49153)), -1, "Swapped ports are another 4-tuple");
+  subflowIndex.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (src, 49153, dst, 5000)), -1, "Cleared index");
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Insert (MpTcpSubflowTuple (src, 49154, dst, 5000), 1), true, "Insert after clear");
+  NS_TEST_ASSERT_MSG_EQ (subflowIndex.Find (MpTcpSubflowTuple (src, 49154, dst, 5000)), 1, "Lookup after clear");
+}
+
+class TraceSinkTestCase : public TestCase
+{
+public:
+  TraceSinkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TraceSinkTestCase::TraceSinkTestCase ()
+  : TestCase ("Plotting samples streamed to a file trace sink")
+{
+}
+
+void
+TraceSinkTestCase::DoRun (void)
+{
+  // Without a sink samples are kept in the plotting vectors
+  Ptr<MpTcpSubFlow> sFlow = CreateObject<MpTcpSubFlow> ();
+  sFlow->routeId = 2;
+  sFlow->Trace (TRACE_DATA, 1400);
+  sFlow->Trace (TRACE_RTT, 12.5);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->DATA.size (), 1, "Sample should be stored in DATA");
+  NS_TEST_ASSERT_MSG_EQ (sFlow->DATA[0].second, 1400, "Stored value");
+  NS_TEST_ASSERT_MSG_EQ (sFlow->_RTT.size (), 1, "Sample should be stored in _RTT");
+
+  // With a sink nothing is kept in memory beyond the sink buffer
+  std::string fileName = CreateTempDirFilename ("mptcp-trace.bin");
+  Ptr<MpTcpFileTraceSink> sink = CreateObject<MpTcpFileTraceSink> ();
+  sink->SetAttribute ("FileName", StringValue (fileName));
+  sink->SetAttribute ("BufferSize", UintegerValue (3));
+  sFlow->traceSink = sink;
+  sFlow->traceFlowId = 7;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      sFlow->Trace (TRACE_DATA, 1400 * i);
+    }
+  sFlow->Trace (TRACE_DCTCP_ALPHA, 0.0625);
+  NS_TEST_ASSERT_MSG_EQ (sFlow->DATA.size (), 1, "Samples should go to the sink only");
+  NS_TEST_ASSERT_MSG_EQ (sink->GetRecordCount (), 11, "Records received by the sink");
+  sink->Dispose ();
+
+  MpTcpTraceReader reader (fileName);
+  NS_TEST_ASSERT_MSG_EQ (reader.IsValid (), true, "Trace file header");
+  MpTcpTraceRecord record;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.flowId, 7, "Flow id");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.subflow, 2, "Subflow id");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.series, TRACE_DATA, "Series");
+      NS_TEST_ASSERT_MSG_EQ (record.value, 1400 * i, "Value");
+    }
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Last record");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.series, TRACE_DCTCP_ALPHA, "Series");
+  NS_TEST_ASSERT_MSG_EQ (record.value, 0.0625, "Value");
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), false, "End of file");
+  NS_TEST_ASSERT_MSG_EQ (std::string (MpTcpTraceSink::GetSeriesName (TRACE_TX_QUEUE)), "TX_QUEUE", "Series name");
+}
+
+static class MpTcpTypeDefsTestSuite : public TestSuite
+{
+public:
+  MpTcpTypeDefsTestSuite ()
+    : TestSuite ("mp-tcp-typedefs", UNIT)
+  {
+    AddTestCase (new DataBufferTestCase (false), TestCase::QUICK);
+    AddTestCase (new DataBufferTestCase (true), TestCase::QUICK);
+    AddTestCase (new DataBufferPayloadTestCase, TestCase::QUICK);
+    AddTestCase (new DataBufferZeroCopyTestCase, TestCase::QUICK);
+    AddTestCase (new DSNMappingQueueTestCase, TestCase::QUICK);
+    AddTestCase (new DSNMappingPoolTestCase, TestCase::QUICK);
+    AddTestCase (new DSNReassemblyQueueTestCase, TestCase::QUICK);
+    AddTestCase (new SubflowIndexTestCase, TestCase::QUICK);
+    AddTestCase (new TraceSinkTestCase, TestCase::QUICK);
+  }
+} g_mpTcpTypeDefsTestSuite;
@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cstring>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+
+using namespace ns3;
+
+// Headers as written on the wire by the MPTCP sockets, captured before options
+// were stored inline in TcpHeader.
+static const uint8_t g_mpcBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0x70, 0x02, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x11, 0x22, 0x33,
+  0x44, 0xff, 0xff, 0xff
+};
+static const uint8_t g_joinBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0x70, 0x02, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x1f, 0xaa, 0xbb, 0xcc,
+  0xdd, 0x03, 0xff, 0xff
+};
+static const uint8_t g_addrBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0x80, 0x10, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x20, 0x01, 0x0a, 0x01,
+  0x01, 0x01, 0x20, 0x02, 0x0a, 0x02, 0x01, 0x01
+};
+static const uint8_t g_dsnBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0xa0, 0x10, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x22, 0x08, 0x07, 0x06,
+  0x05, 0x04, 0x03, 0x02, 0x01, 0x05, 0x78, 0x00, 0x00, 0x30, 0x39, 0x55,
+  0x66, 0x77, 0x88, 0x01
+};
+static const uint8_t g_remAddrTtBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0xa0, 0x10, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x21, 0x04, 0x08, 0x15,
+  0xcd, 0x5b, 0x07, 0x00, 0x00, 0x00, 0x00, 0xb1, 0x68, 0xde, 0x3a, 0x00,
+  0x00, 0x00, 0x00, 0xff
+};
+static const uint8_t g_dsackBytes[] = {
+  0xc0, 0x01, 0x13, 0x89, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x07, 0xd0,
+  0xe0, 0x10, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x05, 0x64, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x2c, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x01, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff
+};
+
+// Fill the fixed fields and the lengths the way MpTcpSocketBase does
+static void
+FinishHeader (TcpHeader &header, uint8_t flags, uint8_t olen)
+{
+  uint8_t plen = (4 - (olen % 4)) % 4;
+  header.SetSourcePort (49153);
+  header.SetDestinationPort (5001);
+  header.SetSequenceNumber (SequenceNumber32 (1000));
+  header.SetAckNumber (SequenceNumber32 (2000));
+  header.SetWindowSize (65535);
+  header.SetFlags (flags);
+  header.SetLength (5 + (olen + plen) / 4);
+  header.SetOptionsLength ((olen + plen) / 4);
+  header.SetPaddingLength (plen);
+}
+
+class TcpHeaderWireTestCase : public TestCase
+{
+public:
+  TcpHeaderWireTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckBytes (const TcpHeader &header, const uint8_t *bytes, uint32_t size, std::string name);
+  TcpHeader Parse (const uint8_t *bytes, uint32_t size);
+};
+
+TcpHeaderWireTestCase::TcpHeaderWireTestCase ()
+  : TestCase ("MPTCP options keep their wire format")
+{
+}
+
+void
+TcpHeaderWireTestCase::CheckBytes (const TcpHeader &header, const uint8_t *bytes, uint32_t size, std::string name)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), size, name << ": wrong serialized size");
+  uint8_t buf[64];
+  p->CopyData (buf, sizeof buf);
+  NS_TEST_ASSERT_MSG_EQ (std::memcmp (buf, bytes, size), 0, name << ": serialized bytes differ");
+}
+
+TcpHeader
+TcpHeaderWireTestCase::Parse (const uint8_t *bytes, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (bytes, size);
+  TcpHeader header;
+  p->RemoveHeader (header);
+  return header;
+}
+
+void
+TcpHeaderWireTestCase::DoRun (void)
+{
+  TcpHeader mpc;
+  mpc.AddOptMPC (OPT_MPC, 0x11223344);
+  FinishHeader (mpc, TcpHeader::SYN, 5);
+  CheckBytes (mpc, g_mpcBytes, sizeof g_mpcBytes, "MP_CAPABLE");
+  TcpHeader h = Parse (g_mpcBytes, sizeof g_mpcBytes);
+  NS_TEST_ASSERT_MSG_EQ (h.GetOptions ().size (), 1, "MP_CAPABLE should be parsed");
+  NS_TEST_ASSERT_MSG_EQ (((OptMultipathCapable *) h.GetOptions ()[0])->senderToken, 0x11223344, "Wrong token");
+  h.SetPaddingLength (3);
+  CheckBytes (h, g_mpcBytes, sizeof g_mpcBytes, "Parsed MP_CAPABLE");
+
+  TcpHeader join;
+  join.AddOptJOIN (OPT_JOIN, 0xaabbccdd, 3);
+  FinishHeader (join, TcpHeader::SYN, 6);
+  CheckBytes (join, g_joinBytes, sizeof g_joinBytes, "MP_JOIN");
+  h = Parse (g_joinBytes, sizeof g_joinBytes);
+  OptJoinConnection *optJoin = (OptJoinConnection *) h.GetOptions ()[0];
+  NS_TEST_ASSERT_MSG_EQ (optJoin->receiverToken, 0xaabbccdd, "Wrong token");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) optJoin->addrID, 3, "Wrong address ID");
+
+  TcpHeader addr;
+  addr.AddOptADDR (OPT_ADDR, 1, Ipv4Address ("10.1.1.1"));
+  addr.AddOptADDR (OPT_ADDR, 2, Ipv4Address ("10.2.1.1"));
+  FinishHeader (addr, TcpHeader::ACK, 12);
+  CheckBytes (addr, g_addrBytes, sizeof g_addrBytes, "ADD_ADDR");
+  h = Parse (g_addrBytes, sizeof g_addrBytes);
+  NS_TEST_ASSERT_MSG_EQ (h.GetOptions ().size (), 2, "Both addresses should be parsed");
+  NS_TEST_ASSERT_MSG_EQ (((OptAddAddress *) h.GetOptions ()[1])->addr, Ipv4Address ("10.2.1.1"), "Wrong address");
+  CheckBytes (h, g_addrBytes, sizeof g_addrBytes, "Parsed ADD_ADDR");
+
+  TcpHeader dsn;
+  dsn.AddOptDSN (OPT_DSN, 0x0102030405060708ULL, 1400, 12345, 0x55667788, 1);
+  FinishHeader (dsn, TcpHeader::ACK, 20);
+  CheckBytes (dsn, g_dsnBytes, sizeof g_dsnBytes, "DSN");
+  h = Parse (g_dsnBytes, sizeof g_dsnBytes);
+  OptDataSeqMapping *optDSN = (OptDataSeqMapping *) h.GetOptions ()[0];
+  NS_TEST_ASSERT_MSG_EQ (optDSN->dataSeqNumber, 0x0102030405060708ULL, "Wrong data sequence number");
+  NS_TEST_ASSERT_MSG_EQ (optDSN->dataLevelLength, 1400, "Wrong data level length");
+  NS_TEST_ASSERT_MSG_EQ (optDSN->subflowSeqNumber, 12345, "Wrong subflow sequence number");
+  NS_TEST_ASSERT_MSG_EQ (optDSN->receiverToken, 0x55667788, "Wrong token");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) optDSN->pScatter, 1, "Wrong packet scatter flag");
+  CheckBytes (h, g_dsnBytes, sizeof g_dsnBytes, "Parsed DSN");
+
+  TcpHeader remAddrTt;
+  remAddrTt.AddOptREMADR (OPT_REMADR, 4);
+  remAddrTt.AddOptTT (OPT_TT, 123456789ULL, 987654321ULL);
+  FinishHeader (remAddrTt, TcpHeader::ACK, 19);
+  CheckBytes (remAddrTt, g_remAddrTtBytes, sizeof g_remAddrTtBytes, "REMOVE_ADDR and timestamp");
+  h = Parse (g_remAddrTtBytes, sizeof g_remAddrTtBytes);
+  NS_TEST_ASSERT_MSG_EQ (h.GetOptions ().size (), 2, "Both options should be parsed");
+  NS_TEST_ASSERT_MSG_EQ (((OptTimesTamp *) h.GetOptions ()[1])->TSecr, 987654321ULL, "Wrong timestamp echo");
+
+  OptDSACK blocks (OPT_DSACK);
+  blocks.AddBlock (300, 400);
+  blocks.AddfstBlock (100, 200);
+  TcpHeader dsack;
+  dsack.AddOptDSACK (OPT_DSACK, blocks);
+  FinishHeader (dsack, TcpHeader::ACK, 33);
+  CheckBytes (dsack, g_dsackBytes, sizeof g_dsackBytes, "DSACK");
+  h = Parse (g_dsackBytes, sizeof g_dsackBytes);
+  OptDSACK *optDSACK = (OptDSACK *) h.GetOptions ()[0];
+  NS_TEST_ASSERT_MSG_EQ (optDSACK->blocks[0], 100, "Wrong first block");
+  NS_TEST_ASSERT_MSG_EQ (optDSACK->blocks[3], 400, "Wrong second block");
+}
+
+class TcpHeaderCopyTestCase : public TestCase
+{
+public:
+  TcpHeaderCopyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHeaderCopyTestCase::TcpHeaderCopyTestCase ()
+  : TestCase ("Copies of a TcpHeader own their options")
+{
+}
+
+void
+TcpHeaderCopyTestCase::DoRun (void)
+{
+  TcpHeader *original = new TcpHeader;
+  original->AddOptDSN (OPT_DSN, 5000, 1400, 1, 0, 0);
+  TcpHeader copy (*original);
+  TcpHeader assigned;
+  assigned.AddOptMPC (OPT_MPC, 7);
+  assigned = *original;
+  delete original;
+  NS_TEST_ASSERT_MSG_EQ (copy.GetOptions ().size (), 1, "Copy should keep the options");
+  NS_TEST_ASSERT_MSG_EQ (((OptDataSeqMapping *) copy.GetOptions ()[0])->dataSeqNumber, 5000, "Copy outlives the original");
+  NS_TEST_ASSERT_MSG_EQ (assigned.GetOptions ().size (), 1, "Assignment should replace the options");
+  NS_TEST_ASSERT_MSG_EQ (assigned.GetOptions ()[0]->optName, OPT_DSN, "Assignment should replace the options");
+
+  copy.AddOptTT (OPT_TT, 1, 2);
+  NS_TEST_ASSERT_MSG_EQ (assigned.GetOptions ().size (), 1, "Copies should not share options");
+
+  // Deserializing into a used header replaces its options
+  Ptr<Packet> p = Create<Packet> (g_mpcBytes, sizeof g_mpcBytes);
+  p->PeekHeader (copy);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetOptions ().size (), 1, "Deserialize should replace the options");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetOptions ()[0]->optName, OPT_MPC, "Deserialize should replace the options");
+}
+
+static class TcpHeaderTestSuite : public TestSuite
+{
+public:
+  TcpHeaderTestSuite ()
+    : TestSuite ("tcp-header", UNIT)
+  {
+    AddTestCase (new TcpHeaderWireTestCase, TestCase::QUICK);
+    AddTestCase (new TcpHeaderCopyTestCase, TestCase::QUICK);
+  }
+} g_tcpHeaderTestSuite;
@@ -70,6 +70,13 @@ public:
    * \return true if parallel communication is enabled
    */
   static bool IsEnabled ();
+  /**
+   * \param systemId system identification
+   * \return true if the nodes of this system are simulated by this process
+   *
+   * With MPI only the nodes of this rank are, with threads all of them.
+   */
+  static bool IsLocal (uint32_t systemId);
   /**
    * \param pargc number of command line arguments
    * \param pargv command line arguments
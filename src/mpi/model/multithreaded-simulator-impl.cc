@@ -0,0 +1,843 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "mpi-interface.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <sched.h>
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl)
+  ;
+
+namespace {
+
+const uint64_t MAX_TS = 0x7fffffffffffffffLL;
+
+/* Lower *value to ts, unless it is already lower. */
+void
+LowerTo (volatile uint64_t *value, uint64_t ts)
+{
+  uint64_t old = *value;
+  while (ts < old)
+    {
+      uint64_t seen = __sync_val_compare_and_swap (value, old, ts);
+      if (seen == old)
+        {
+          break;
+        }
+      old = seen;
+    }
+}
+
+} // anonymous namespace
+
+/*
+ * An event scheduled by a partition for a node of another one. The
+ * messages of a mailbox form a list pushed with compare-and-swap, which
+ * the owner of the mailbox takes whole.
+ */
+struct MultithreadedSimulatorImpl::Message
+{
+  Message *next;
+  uint64_t ts;
+  uint32_t context;
+  uint32_t source;      //!< system id of the sender
+  uint64_t seq;         //!< rank of the message among those of the sender
+  EventImpl *event;
+
+  bool operator < (const Message &o) const
+  {
+    if (ts != o.ts)
+      {
+        return ts < o.ts;
+      }
+    if (source != o.source)
+      {
+        return source < o.source;
+      }
+    return seq < o.seq;
+  }
+};
+
+struct MultithreadedSimulatorImpl::Partition
+{
+  Partition (MultithreadedSimulatorImpl *impl, uint32_t id)
+    : impl (impl),
+      id (id),
+      uid (4),
+      currentUid (0),
+      currentTs (0),
+      currentContext (0xffffffff),
+      stopTs (MAX_TS),
+      windowEnd (0),
+      nextTs (MAX_TS),
+      seq (0),
+      inbox (0)
+  {
+  }
+  void Run (void)
+  {
+    impl->RunPartition (this);
+  }
+
+  MultithreadedSimulatorImpl *impl;
+  uint32_t id;
+  Ptr<Scheduler> events;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  uint32_t uid;
+  uint32_t currentUid;
+  uint64_t currentTs;
+  uint32_t currentContext;
+  uint64_t stopTs;          //!< Stop time as seen by this partition
+  uint64_t windowEnd;       //!< events of the current window are before this time
+  uint64_t nextTs;          //!< time of the next event, published at the barrier
+  uint64_t seq;             //!< messages sent
+  Message * volatile inbox;
+  Ptr<SystemThread> thread;
+};
+
+/*
+ * Barrier for the threads of the partitions. Windows can be very short,
+ * so the waiters spin before they give their processor away.
+ */
+class MultithreadedSimulatorImpl::Barrier
+{
+public:
+  Barrier (uint32_t n)
+    : m_n (n),
+      m_count (0),
+      m_generation (0)
+  {
+  }
+  void Wait (void)
+  {
+    uint32_t generation = m_generation;
+    if (__sync_add_and_fetch (&m_count, 1) == m_n)
+      {
+        m_count = 0;
+        __sync_fetch_and_add (&m_generation, 1);
+        return;
+      }
+    for (uint32_t spins = 0; m_generation == generation; spins++)
+      {
+        if (spins >= SPINS)
+          {
+            sched_yield ();
+          }
+      }
+    __sync_synchronize ();
+  }
+private:
+  static const uint32_t SPINS = 4096;
+  const uint32_t m_n;
+  volatile uint32_t m_count;
+  volatile uint32_t m_generation;
+};
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_global (new Partition (this, 0)),
+    m_running (false),
+    m_lookAhead (MAX_TS),
+    m_stopTs (MAX_TS),
+    m_barrier (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      delete m_partitions[i];
+    }
+  delete m_global;
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Partition *> all (m_partitions);
+  all.push_back (m_global);
+  for (uint32_t i = 0; i < all.size (); i++)
+    {
+      Partition *partition = all[i];
+      for (Message *message = partition->inbox; message != 0; )
+        {
+          Message *next = message->next;
+          message->event->Unref ();
+          delete message;
+          message = next;
+        }
+      partition->inbox = 0;
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->events = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // The destroy events dispose of the nodes, whose events may be cancelled
+  // on the way: their partitions must be known without asking them.
+  MapNodes ();
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+
+  if (MpiInterface::IsEnabled ())
+    {
+      MpiInterface::Destroy ();
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  return g_current != 0 ? g_current : m_global;
+}
+
+void
+MultithreadedSimulatorImpl::MapNodes (void)
+{
+  m_nodePartition.clear ();
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      m_nodePartition.push_back ((*node)->GetSystemId ());
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context)
+{
+  if (context == 0xffffffff)
+    {
+      return m_global;
+    }
+  uint32_t systemId;
+  if (context < m_nodePartition.size ())
+    {
+      systemId = m_nodePartition[context];
+    }
+  else
+    {
+      // A node created since the last run, maybe by a global event.
+      if (m_running && GetCurrent () != m_global)
+        {
+          NS_FATAL_ERROR ("Node " << context << " was created by partition " << GetCurrent ()->id << " during the run");
+        }
+      systemId = NodeList::GetNode (context)->GetSystemId ();
+    }
+  while (systemId >= m_partitions.size ())
+    {
+      if (m_running)
+        {
+          NS_FATAL_ERROR ("No thread runs system id " << systemId << ", created during the run");
+        }
+      Partition *partition = new Partition (this, m_partitions.size ());
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      m_partitions.push_back (partition);
+    }
+  return m_partitions[systemId];
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+
+  m_schedulerFactory = schedulerFactory;
+  std::vector<Partition *> all (m_partitions);
+  all.push_back (m_global);
+  for (uint32_t i = 0; i < all.size (); i++)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (all[i]->events != 0)
+        {
+          while (!all[i]->events->IsEmpty ())
+            {
+              scheduler->Insert (all[i]->events->RemoveNext ());
+            }
+        }
+      all[i]->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, uint32_t uid, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = uid;
+  partition->events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::Post (Partition *from, Partition *to, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  if (to != m_global && ts < from->windowEnd)
+    {
+      NS_FATAL_ERROR ("Partition " << from->id << " scheduled an event for node " << context <<
+                      " of partition " << to->id << " closer than the lookahead of " << TimeStep (m_lookAhead));
+    }
+  Message *message = new Message;
+  message->ts = ts;
+  message->context = context;
+  message->source = from->id;
+  message->seq = from->seq++;
+  message->event = event;
+  do
+    {
+      message->next = to->inbox;
+    }
+  while (!__sync_bool_compare_and_swap (&to->inbox, message->next, message));
+}
+
+void
+MultithreadedSimulatorImpl::Drain (Partition *partition, uint64_t floor)
+{
+  Message *list = __sync_lock_test_and_set (&partition->inbox, (Message *) 0);
+  if (list == 0)
+    {
+      return;
+    }
+  std::vector<Message> messages;
+  while (list != 0)
+    {
+      Message *next = list->next;
+      messages.push_back (*list);
+      delete list;
+      list = next;
+    }
+  // Arrival order depends on the threads, this order does not.
+  std::sort (messages.begin (), messages.end ());
+  for (std::vector<Message>::const_iterator i = messages.begin (); i != messages.end (); ++i)
+    {
+      Insert (partition, std::max (i->ts, floor), i->context, partition->uid++, i->event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Rehome (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Partition *> all (m_partitions);
+  all.push_back (m_global);
+  std::vector<Scheduler::Event> moved;
+  for (uint32_t i = 0; i < all.size (); i++)
+    {
+      Ptr<Scheduler> kept = m_schedulerFactory.Create<Scheduler> ();
+      while (!all[i]->events->IsEmpty ())
+        {
+          Scheduler::Event ev = all[i]->events->RemoveNext ();
+          if (GetPartition (ev.key.m_context) == all[i])
+            {
+              kept->Insert (ev);
+            }
+          else
+            {
+              moved.push_back (ev);
+            }
+        }
+      all[i]->events = kept;
+    }
+  // Every uid was drawn from the global counter, so moving keeps them unique.
+  for (uint32_t i = 0; i < moved.size (); i++)
+    {
+      GetPartition (moved[i].key.m_context)->events->Insert (moved[i]);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_lookAhead = MAX_TS;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      uint32_t systemId = (*node)->GetSystemId ();
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<Channel> channel = (*node)->GetDevice (i)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              uint32_t remote = channel->GetDevice (j)->GetNode ()->GetSystemId ();
+              if (remote == systemId)
+                {
+                  continue;
+                }
+              if (channel->GetInstanceTypeId ().GetName () != "ns3::PointToPointRemoteChannel")
+                {
+                  NS_FATAL_ERROR ("A " << channel->GetInstanceTypeId ().GetName () << " joins partitions " <<
+                                  systemId << " and " << remote << ", only point-to-point links can; " <<
+                                  "enable the MpiInterface before installing them");
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              if (!delay.Get ().IsStrictlyPositive ())
+                {
+                  NS_FATAL_ERROR ("Partitions " << systemId << " and " << remote << " are joined by a link without delay");
+                }
+              m_lookAhead = std::min (m_lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << TimeStep (m_lookAhead));
+}
+
+uint64_t
+MultithreadedSimulatorImpl::NextTs (const Partition *partition) const
+{
+  if (partition->events->IsEmpty ())
+    {
+      return MAX_TS;
+    }
+  return partition->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *partition)
+{
+  NS_LOG_FUNCTION (this << partition->id);
+
+  g_current = partition;
+  while (true)
+    {
+      Drain (partition, 0);
+      partition->nextTs = NextTs (partition);
+      if (partition->id == 0)
+        {
+          // Global events scheduled by the partitions during the window run
+          // once it is over, no sooner than the last event of the window.
+          uint64_t floor = 0;
+          for (uint32_t i = 0; i < m_partitions.size (); i++)
+            {
+              floor = std::max (floor, m_partitions[i]->currentTs);
+            }
+          Drain (m_global, floor);
+          m_global->nextTs = NextTs (m_global);
+        }
+      // Nobody runs events between the two barriers, so all the threads
+      // read the same Stop time and take the same decisions.
+      partition->stopTs = m_stopTs;
+      m_barrier->Wait ();
+
+      uint64_t next = m_global->nextTs;
+      for (uint32_t i = 0; i < m_partitions.size (); i++)
+        {
+          next = std::min (next, m_partitions[i]->nextTs);
+        }
+      if (next == MAX_TS || next > partition->stopTs)
+        {
+          break;
+        }
+      if (next == m_global->nextTs)
+        {
+          // Global events run alone, on the thread of partition 0.
+          partition->windowEnd = next;
+          if (partition->id == 0)
+            {
+              g_current = m_global;
+              m_global->stopTs = partition->stopTs;
+              while (NextTs (m_global) == next && next <= m_global->stopTs)
+                {
+                  ProcessOneEvent (m_global);
+                }
+              g_current = partition;
+            }
+        }
+      else
+        {
+          uint64_t end = m_lookAhead < MAX_TS - next ? next + m_lookAhead : MAX_TS;
+          end = std::min (end, m_global->nextTs);
+          partition->windowEnd = end;
+          if (partition->id == 0)
+            {
+              NS_LOG_LOGIC ("window " << TimeStep (next) << " to " << TimeStep (end));
+            }
+          while (!partition->events->IsEmpty ())
+            {
+              uint64_t ts = partition->events->PeekNext ().key.m_ts;
+              if (ts >= end || ts > partition->stopTs)
+                {
+                  break;
+                }
+              ProcessOneEvent (partition);
+            }
+        }
+      m_barrier->Wait ();
+    }
+  g_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT_MSG (!m_running, "Run () called during the run");
+  MapNodes ();
+  for (uint32_t i = 0; i < m_nodePartition.size (); i++)
+    {
+      GetPartition (i);
+    }
+  if (m_partitions.empty ())
+    {
+      m_partitions.push_back (new Partition (this, 0));
+      m_partitions[0]->events = m_schedulerFactory.Create<Scheduler> ();
+    }
+  Rehome ();
+  CalculateLookAhead ();
+
+  m_running = true;
+  m_barrier = new Barrier (m_partitions.size ());
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      Partition *partition = m_partitions[i];
+      partition->uid = m_global->uid;
+      partition->windowEnd = 0;
+      partition->seq = 0;
+      if (i != 0)
+        {
+          partition->thread = Create<SystemThread> (MakeCallback (&Partition::Run, partition));
+          partition->thread->Start ();
+        }
+    }
+  RunPartition (m_partitions[0]);
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      m_partitions[i]->thread->Join ();
+      m_partitions[i]->thread = 0;
+    }
+  delete m_barrier;
+  m_barrier = 0;
+  m_running = false;
+
+  // Out of Run (), the time is the one of the last event of any partition,
+  // or the Stop time, as if it were an event.
+  if (m_stopTs != MAX_TS)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, static_cast<uint64_t> (m_stopTs));
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      Partition *partition = m_partitions[i];
+      m_global->uid = std::max (m_global->uid, partition->uid);
+      m_global->currentTs = std::max (m_global->currentTs, partition->currentTs);
+      partition->stopTs = MAX_TS;
+    }
+  m_global->stopTs = MAX_TS;
+  m_stopTs = MAX_TS;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      if (!m_partitions[i]->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events->IsEmpty ();
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Partition *current = GetCurrent ();
+  current->stopTs = std::min (current->stopTs, current->currentTs);
+  LowerTo (&m_stopTs, current->currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+
+  Partition *current = GetCurrent ();
+  uint64_t ts = current->currentTs + time.GetTimeStep ();
+  current->stopTs = std::min (current->stopTs, ts);
+  LowerTo (&m_stopTs, ts);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+
+  Partition *current = GetCurrent ();
+  Time tAbsolute = time + TimeStep (current->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  uint64_t ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  uint32_t uid = m_running ? current->uid++ : m_global->uid++;
+  Insert (current, ts, current->currentContext, uid, event);
+  return EventId (event, ts, current->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+
+  Partition *current = GetCurrent ();
+  Partition *target = GetPartition (context);
+  uint64_t ts = current->currentTs + time.GetTimeStep ();
+  if (target == current || current == m_global)
+    {
+      // Out of the windows, only one thread runs
+      uint32_t uid = m_running ? target->uid++ : m_global->uid++;
+      Insert (target, ts, context, uid, event);
+    }
+  else
+    {
+      Post (current, target, ts, context, event);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  Partition *current = GetCurrent ();
+  uint32_t uid = m_running ? current->uid++ : m_global->uid++;
+  Insert (current, current->currentTs, current->currentContext, uid, event);
+  return EventId (event, current->currentTs, current->currentContext, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *current = GetCurrent ();
+  Partition *target = GetPartition (id.GetContext ());
+  if (target != current && current != m_global)
+    {
+      NS_FATAL_ERROR ("Partition " << current->id << " can't remove an event of partition " << target->id);
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  target->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *partition = const_cast<MultithreadedSimulatorImpl *> (this)->GetPartition (ev.GetContext ());
+  if (ev.PeekEventImpl () == 0
+      || ev.GetTs () < partition->currentTs
+      || (ev.GetTs () == partition->currentTs
+          && ev.GetUid () <= partition->currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return GetCurrent ()->id;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->currentContext;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+} // namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator running the partitions of one process on threads
+ *
+ * The nodes are partitioned by their system id, like the MPI ranks of the
+ * DistributedSimulatorImpl, but all the partitions live in this process:
+ * partition 0 runs on the thread which calls Simulator::Run, each other
+ * partition on a thread of its own. No MPI installation is needed.
+ *
+ * The partitions advance in conservative time windows. At the start of a
+ * window every partition publishes the time of its next event; all of them
+ * then run their events up to the smallest of these times plus the
+ * lookahead, the smallest delay of the point-to-point links between two
+ * partitions, and wait for each other at a barrier. An event which a
+ * partition schedules on a node of another partition goes to the lock-free
+ * mailbox of that partition and enters its queue at the next window, which
+ * is in time since such an event is at least one lookahead away. The
+ * mailboxes are sorted before they are emptied, so a run gives the same
+ * results whatever the interleaving of the threads.
+ *
+ * Events which do not belong to a node (context 0xffffffff), like the
+ * events scheduled from main () with Simulator::Schedule, may touch any
+ * node: they run on the thread of partition 0 between two windows, while
+ * all the partitions wait.
+ *
+ * Links between partitions must be PointToPointRemoteChannels: enable the
+ * MpiInterface before installing the devices, which then sends the packets
+ * through the ParallelCommunicationInterface instead of sharing them
+ * between threads. Objects of one partition must not be used from another:
+ * their reference counts are not atomic.
+ *
+ * A Stop takes effect at once in the partition which calls it, and at
+ * the end of the current window, at most one lookahead later, in the
+ * others.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \return the number of partitions, one more than the largest system id
+   * of the nodes
+   */
+  uint32_t GetPartitionCount (void) const;
+  /**
+   * \return the lookahead of the last run, infinite if no link joins two
+   * partitions
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  struct Message;
+  struct Partition;
+  class Barrier;
+
+  virtual void DoDispose (void);
+
+  /* Return the partition of the calling thread, the global one out of Run (). */
+  Partition *GetCurrent (void) const;
+  /* Record the system id of every node. */
+  void MapNodes (void);
+  /* Return the partition which runs the events of a context. */
+  Partition *GetPartition (uint32_t context);
+  void Insert (Partition *partition, uint64_t ts, uint32_t context, uint32_t uid, EventImpl *event);
+  void Post (Partition *from, Partition *to, uint64_t ts, uint32_t context, EventImpl *event);
+  /* Move the messages of a mailbox to the queue of its partition, no sooner than floor. */
+  void Drain (Partition *partition, uint64_t floor);
+  /* Move the events scheduled before Run () to the partition of their node. */
+  void Rehome (void);
+  void CalculateLookAhead (void);
+  /* Body of the thread of one partition. */
+  void RunPartition (Partition *partition);
+  void ProcessOneEvent (Partition *partition);
+  uint64_t NextTs (const Partition *partition) const;
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  mutable SystemMutex m_destroyMutex;
+  ObjectFactory m_schedulerFactory;
+  Partition *m_global;                     //!< events of no node, and the time out of Run ()
+  std::vector<Partition *> m_partitions;   //!< indexed by system id
+  std::vector<uint32_t> m_nodePartition;   //!< system id of each node at the last MapNodes ()
+  bool m_running;
+  uint64_t m_lookAhead;
+  volatile uint64_t m_stopTs;              //!< no event after this time runs
+  Barrier *m_barrier;
+
+  static __thread Partition *g_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-memory-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryInterface");
+
+namespace ns3 {
+
+SharedMemoryInterface::SharedMemoryInterface ()
+  : m_enabled (false)
+{
+}
+
+void
+SharedMemoryInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+SharedMemoryInterface::GetSystemId ()
+{
+  return Simulator::GetSystemId ();
+}
+
+uint32_t
+SharedMemoryInterface::GetSize ()
+{
+  uint32_t size = 1;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      size = std::max (size, (*node)->GetSystemId () + 1);
+    }
+  return size;
+}
+
+bool
+SharedMemoryInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+bool
+SharedMemoryInterface::IsLocal (uint32_t systemId)
+{
+  return true;
+}
+
+void
+SharedMemoryInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = true;
+}
+
+void
+SharedMemoryInterface::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = false;
+}
+
+void
+SharedMemoryInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
+
+  // Copies of a packet share buffers whose reference counts are not
+  // atomic, so the destination gets a packet of its own.
+  uint32_t serializedSize = p->GetSerializedSize ();
+  std::vector<uint8_t> buffer (serializedSize);
+  p->Serialize (&buffer[0], serializedSize);
+  Ptr<Packet> copy = Create<Packet> (&buffer[0], serializedSize, true);
+  Simulator::ScheduleWithContext (node, rxTime - Simulator::Now (), &SharedMemoryInterface::Receive, copy, node, dev);
+}
+
+void
+SharedMemoryInterface::Receive (Ptr<Packet> p, uint32_t node, uint32_t dev)
+{
+  Ptr<MpiReceiver> receiver = NodeList::GetNode (node)->GetDevice (dev)->GetObject<MpiReceiver> ();
+  NS_ASSERT_MSG (receiver != 0, "Device " << dev << " of node " << node << " has no MpiReceiver");
+  receiver->Receive (p);
+}
+
+} // namespace ns3
@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_INTERFACE_H
+#define NS3_SHARED_MEMORY_INTERFACE_H
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Interface between the partitions of a MultithreadedSimulatorImpl
+ *
+ * All the systems are threads of this process, so every system is local
+ * and only links between two of them are remote. A packet sent on such a
+ * link is serialized and rebuilt by the sender, then the copy, which
+ * shares nothing with the original, is scheduled on the destination node
+ * through the mailbox of its partition.
+ */
+class SharedMemoryInterface : public ParallelCommunicationInterface
+{
+public:
+  SharedMemoryInterface ();
+
+  virtual void Destroy ();
+  /**
+   * \return the system id of the partition of the caller
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return the number of partitions, one more than the largest system id
+   * of the nodes created so far
+   */
+  virtual uint32_t GetSize ();
+  virtual bool IsEnabled ();
+  virtual bool IsLocal (uint32_t systemId);
+  virtual void Enable (int* pargc, char*** pargv);
+  virtual void Disable ();
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+
+private:
+  /* Hand the copy of a packet to the MpiReceiver of its device. */
+  static void Receive (Ptr<Packet> p, uint32_t node, uint32_t dev);
+
+  bool m_enabled;
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_INTERFACE_H */
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/node.h"
+#include "ns3/system-thread.h"
+#include "ns3/multithreaded-simulator-impl.h"
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t NODES = 6;
+const uint32_t PARTITIONS = 3;
+
+struct Record
+{
+  Time now;
+  uint32_t context;
+  uint32_t systemId;
+  SystemThread::ThreadId thread;
+};
+
+} // anonymous namespace
+
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void NodeEvent (uint32_t node);
+  void Cancelled (void);
+  void GlobalEvent (void);
+  void LateGlobalEvent (Time scheduled);
+  void AskGlobal (void);
+
+  uint32_t m_nodes[NODES];
+  std::vector<Record> m_records[NODES];
+  EventId m_cancelled;
+  bool m_cancelledRun;
+  // Events of each node before the global event, seen by the global event
+  uint32_t m_seen[NODES];
+  uint32_t m_expected[NODES];
+  uint32_t m_globalContext;
+  bool m_lateRun;
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase ()
+  : TestCase ("Partitions run their nodes on their own threads, global events run alone"),
+    m_cancelledRun (false),
+    m_globalContext (0),
+    m_lateRun (false)
+{
+}
+
+void
+MultithreadedSimulatorTestCase::NodeEvent (uint32_t node)
+{
+  Record record;
+  record.now = Simulator::Now ();
+  record.context = Simulator::GetContext ();
+  record.systemId = Simulator::GetSystemId ();
+  record.thread = SystemThread::Self ();
+  m_records[node].push_back (record);
+  if (m_records[node].size () % 2 == 1)
+    {
+      // Scheduled without context: on the same node, hence partition
+      Simulator::Schedule (MilliSeconds (250), &MultithreadedSimulatorTestCase::NodeEvent, this, node);
+    }
+  if (node == 4 && m_records[node].size () == 1)
+    {
+      m_cancelled = Simulator::Schedule (MilliSeconds (500), &MultithreadedSimulatorTestCase::Cancelled, this);
+    }
+  if (node == 4 && m_records[node].size () == 2)
+    {
+      Simulator::Cancel (m_cancelled);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Cancelled (void)
+{
+  m_cancelledRun = true;
+}
+
+void
+MultithreadedSimulatorTestCase::GlobalEvent (void)
+{
+  m_globalContext = Simulator::GetContext ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      m_seen[i] = m_records[i].size ();
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::AskGlobal (void)
+{
+  Simulator::ScheduleWithContext (0xffffffff, Seconds (0), &MultithreadedSimulatorTestCase::LateGlobalEvent, this, Simulator::Now ());
+}
+
+void
+MultithreadedSimulatorTestCase::LateGlobalEvent (Time scheduled)
+{
+  m_lateRun = Simulator::Now () >= scheduled && Simulator::GetContext () == 0xffffffff;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> (i % PARTITIONS);
+      m_nodes[i] = node->GetId ();
+      // Node i gets events at i/10 s and 1 + i/10 s, each of which schedules
+      // another one 250ms later.
+      Simulator::ScheduleWithContext (node->GetId (), MilliSeconds (100 * i), &MultithreadedSimulatorTestCase::NodeEvent, this, i);
+      Simulator::ScheduleWithContext (node->GetId (), MilliSeconds (1000 + 100 * i), &MultithreadedSimulatorTestCase::NodeEvent, this, i);
+      m_expected[i] = i < 5 ? (i < 3 ? 2 : 1) : 0;
+    }
+  Simulator::Schedule (MilliSeconds (500), &MultithreadedSimulatorTestCase::GlobalEvent, this);
+  Simulator::ScheduleWithContext (m_nodes[5], Seconds (2), &MultithreadedSimulatorTestCase::AskGlobal, this);
+  Simulator::Stop (Seconds (10));
+
+  Simulator::Run ();
+
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Wrong simulator");
+  NS_TEST_ASSERT_MSG_EQ (impl->GetPartitionCount (), PARTITIONS, "One partition per system id");
+  NS_TEST_ASSERT_MSG_EQ (impl->GetLookAhead (), impl->GetMaximumSimulationTime (), "No link between the partitions");
+
+  SystemThread::ThreadId threads[PARTITIONS];
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_records[i].size (), 4, "Every event of node " << i << " should run");
+      for (uint32_t j = 0; j < m_records[i].size (); j++)
+        {
+          const Record &record = m_records[i][j];
+          Time expected = MilliSeconds (100 * i + 1000 * (j / 2) + 250 * (j % 2));
+          NS_TEST_EXPECT_MSG_EQ (record.now, expected, "Time of event " << j << " of node " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.context, m_nodes[i], "Context of node " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.systemId, i % PARTITIONS, "System id of node " << i);
+          if (i < PARTITIONS && j == 0)
+            {
+              threads[i] = record.thread;
+            }
+          NS_TEST_EXPECT_MSG_EQ (pthread_equal (record.thread, threads[i % PARTITIONS]) != 0, true, "A partition has one thread");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (SystemThread::Equals (threads[0]), true, "Partition 0 runs on the thread of Run ()");
+  NS_TEST_ASSERT_MSG_EQ (pthread_equal (threads[0], threads[1]) || pthread_equal (threads[0], threads[2])
+                         || pthread_equal (threads[1], threads[2]), false, "Each partition has its own thread");
+  NS_TEST_ASSERT_MSG_EQ (m_cancelledRun, false, "A cancelled event does not run");
+  NS_TEST_ASSERT_MSG_EQ (m_globalContext, 0xffffffff, "Global events have no context");
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_seen[i], m_expected[i], "The global event sees every partition at its time for node " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_lateRun, true, "A partition can schedule a global event");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (10), "Time of the Stop out of Run ()");
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Tick (uint32_t node);
+
+  uint32_t m_ticks[PARTITIONS];
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase ()
+  : TestCase ("A stop ends every partition")
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Tick (uint32_t node)
+{
+  m_ticks[node]++;
+  if (node == 1 && Simulator::Now () == Seconds (5))
+    {
+      Simulator::Stop ();
+    }
+  Simulator::Schedule (Seconds (1), &MultithreadedSimulatorStopTestCase::Tick, this, node);
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+
+  for (uint32_t i = 0; i < PARTITIONS; i++)
+    {
+      m_ticks[i] = 0;
+      Ptr<Node> node = CreateObject<Node> (i);
+      Simulator::ScheduleWithContext (node->GetId (), Seconds (0), &MultithreadedSimulatorStopTestCase::Tick, this, i);
+    }
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  // Without lookahead, the other partitions do not hear of the stop until
+  // the end of the window: they only honour the first one.
+  NS_TEST_ASSERT_MSG_EQ (m_ticks[1], 6, "Stop () ends its partition at once");
+  NS_TEST_ASSERT_MSG_EQ (m_ticks[0], 21, "Stop (time) ends every partition");
+  NS_TEST_ASSERT_MSG_EQ (m_ticks[2], 21, "Stop (time) ends every partition");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (20), "Time of the Stop out of Run ()");
+
+  // Stop times are used up by the run, which can go on
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  // Partition 1 was left behind at 5s, it catches up
+  NS_TEST_ASSERT_MSG_EQ (m_ticks[0], 26, "A second run goes on from the first");
+  NS_TEST_ASSERT_MSG_EQ (m_ticks[1], 26, "A second run goes on from the first");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (25), "Time of the Stop out of Run ()");
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+static class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorStopTestCase, TestCase::QUICK);
+  }
+} g_multithreadedSimulatorTestSuite;
@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/spin-lock.h"
 #include <vector>
 #include <cstring>
 
@@ -44,6 +45,8 @@ public:
   ~ByteTagListDataFreeList ();
 } g_freeList;
 static uint32_t g_maxSize = 0;
+// The threads of a parallel simulation share the free list
+static SpinLock g_freeListLock;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -274,6 +277,11 @@ void
 ByteTagList::AddAtEnd (int32_t adjustment, int32_t appendOffset)
 {
   NS_LOG_FUNCTION (this << adjustment << appendOffset);
+  if (m_data == 0)
+    {
+      // no tags to move
+      return;
+    }
   if (adjustment == 0 && !IsDirtyAtEnd (appendOffset))
     {
       return;
@@ -308,6 +316,11 @@ void
 ByteTagList::AddAtStart (int32_t adjustment, int32_t prependOffset)
 {
   NS_LOG_FUNCTION (this << adjustment << prependOffset);
+  if (m_data == 0)
+    {
+      // no tags to move
+      return;
+    }
   if (adjustment == 0 && !IsDirtyAtStart (prependOffset))
     {
       return;
@@ -344,6 +357,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  g_freeListLock.Lock ();
   while (!g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
@@ -351,6 +365,7 @@ ByteTagList::Allocate (uint32_t size)
       NS_ASSERT (data != 0);
       if (data->size >= size)
         {
+          g_freeListLock.Unlock ();
           data->count = 1;
           data->dirty = 0;
           return data;
@@ -358,7 +373,9 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  uint32_t maxSize = g_maxSize;
+  g_freeListLock.Unlock ();
+  uint8_t *buffer = new uint8_t [std::max (size, maxSize) + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
@@ -374,19 +391,22 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  g_maxSize = std::max (g_maxSize, data->size);
   data->count--;
   if (data->count == 0)
     {
+      g_freeListLock.Lock ();
+      g_maxSize = std::max (g_maxSize, data->size);
       if (g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
+          g_freeListLock.Unlock ();
           uint8_t *buffer = (uint8_t *)data;
           delete [] buffer;
         }
       else
         {
           g_freeList.push_back (data);
+          g_freeListLock.Unlock ();
         }
     }
 }
@@ -48,7 +48,9 @@ public:
   Ptr<Node> GetNode (uint32_t n);
   uint32_t GetNNodes (void);
 
-  static Ptr<NodeListPriv> Get (void);
+  // A plain pointer: the threads of a parallel run look nodes up at once,
+  // and the reference count of a Ptr is not atomic.
+  static NodeListPriv *Get (void);
 
 private:
   virtual void DoDispose (void);
@@ -73,11 +75,11 @@ NodeListPriv::GetTypeId (void)
   return tid;
 }
 
-Ptr<NodeListPriv> 
+NodeListPriv *
 NodeListPriv::Get (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return *DoGet ();
+  return PeekPointer (*DoGet ());
 }
 Ptr<NodeListPriv> *
 NodeListPriv::DoGet (void)
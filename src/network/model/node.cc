@@ -175,6 +175,7 @@ Node::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_deviceAdditionListeners.clear ();
   m_handlers.clear ();
+  m_ecnMarkers.clear ();
   for (std::vector<Ptr<NetDevice> >::iterator i = m_devices.begin ();
        i != m_devices.end (); i++)
     {
@@ -345,6 +346,25 @@ Node::UnregisterDeviceAdditionListener (DeviceAdditionListener listener)
          }
     }
 }
+
+void
+Node::RegisterEcnMarker (EcnMarker marker, uint16_t protocolType)
+{
+  NS_LOG_FUNCTION (this << &marker << protocolType);
+  m_ecnMarkers[protocolType] = marker;
+}
+
+bool
+Node::MarkEcn (Ptr<Packet> packet, uint16_t protocolType)
+{
+  NS_LOG_FUNCTION (this << packet << protocolType);
+  std::map<uint16_t, EcnMarker>::iterator it = m_ecnMarkers.find (protocolType);
+  if (it == m_ecnMarkers.end ())
+    {
+      return false;
+    }
+  return it->second (packet);
+}
  
 void 
 Node::NotifyDeviceAdded (Ptr<NetDevice> device)
@@ -199,6 +199,25 @@ public:
    */
   void UnregisterDeviceAdditionListener (DeviceAdditionListener listener);
 
+  /**
+   * A callback which marks a packet that starts with its protocol's header
+   * Congestion Experienced. It returns false if the packet is not ECN capable.
+   */
+  typedef Callback<bool, Ptr<Packet> > EcnMarker;
+  /**
+   * \param marker the marker to register
+   * \param protocolType the EtherType of the protocol whose header it rewrites
+   */
+  void RegisterEcnMarker (EcnMarker marker, uint16_t protocolType);
+  /**
+   * \param packet packet stripped of its link layer header
+   * \param protocolType the EtherType of the packet
+   * \returns true if the packet is ECN capable and now marked CE
+   *
+   * Used by devices on behalf of their queues, see Queue::SetMarkCallback ()
+   */
+  bool MarkEcn (Ptr<Packet> packet, uint16_t protocolType);
+
 
 
   /**
@@ -240,6 +259,7 @@ private:
   std::vector<Ptr<Application> > m_applications;
   ProtocolHandlerList m_handlers;
   DeviceAdditionListenerList m_deviceAdditionListeners;
+  std::map<uint16_t, EcnMarker> m_ecnMarkers; // EtherType -> marker
 
 public: // Morteza
   uint32_t m_locked;
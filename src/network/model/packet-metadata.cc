@@ -22,6 +22,7 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/spin-lock.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -33,10 +34,13 @@ namespace ns3 {
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_lean = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+// The threads of a parallel simulation share the free list
+static SpinLock g_freeListLock;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -59,6 +63,11 @@ PacketMetadata::Enable (void)
                  "after sending any packets.  One way to fix this problem is "
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
+  if (IsLean ())
+    {
+      NS_FATAL_ERROR ("Error: attempting to enable the packet metadata "
+                      "subsystem while packets are lean.");
+    }
   m_enable = true;
 }
 
@@ -70,6 +79,18 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableLean (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_enable)
+    {
+      NS_FATAL_ERROR ("Error: attempting to make packets lean "
+                      "while the packet metadata subsystem is enabled.");
+    }
+  m_lean = true;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +154,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -582,6 +607,7 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+  g_freeListLock.Lock ();
   NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
   if (size > m_maxSize)
     {
@@ -593,15 +619,18 @@ PacketMetadata::Create (uint32_t size)
       m_freeList.pop_back ();
       if (data->m_size >= size) 
         {
+          g_freeListLock.Unlock ();
           NS_LOG_LOGIC ("create found size="<<data->m_size);
           data->m_count = 1;
           return data;
         }
-      PacketMetadata::Deallocate (data);
       NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
+      PacketMetadata::Deallocate (data);
     }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  uint32_t maxSize = m_maxSize;
+  g_freeListLock.Unlock ();
+  NS_LOG_LOGIC ("create alloc size="<<maxSize);
+  return PacketMetadata::Allocate (maxSize);
 }
 
 void
@@ -613,16 +642,19 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
       PacketMetadata::Deallocate (data);
       return;
     } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
+  g_freeListLock.Lock ();
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   if (m_freeList.size () > 1000 ||
       data->m_size < m_maxSize) 
     {
+      g_freeListLock.Unlock ();
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
       m_freeList.push_back (data);
+      g_freeListLock.Unlock ();
     }
 }
 
@@ -1345,8 +1377,11 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
                     ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
                     ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
                     extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
-      uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
-      UpdateTail (tmp);
+      if (m_data != 0)
+        {
+          uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
+          UpdateTail (tmp);
+        }
     }
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
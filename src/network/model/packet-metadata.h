@@ -127,6 +127,18 @@ private:
 
   static void Enable (void);
   static void EnableChecking (void);
+  /**
+   * Stop keeping metadata: the packets created from now on do not
+   * allocate any, and Packet skips the bookkeeping of their headers,
+   * trailers and fragments altogether. Metadata cannot be enabled
+   * afterwards.
+   */
+  static void EnableLean (void);
+  /**
+   * \returns true if packets are created without metadata, always the
+   * case when ns-3 is configured with --enable-lean-packets
+   */
+  static inline bool IsLean (void);
 
   inline PacketMetadata (uint64_t uid, uint32_t size);
   inline PacketMetadata (PacketMetadata const &o);
@@ -338,6 +350,7 @@ public:
   static DataFreeList m_freeList;
   static bool m_enable;
   static bool m_enableChecking;
+  static bool m_lean;
 
   // set to true when adding metadata to a packet is skipped because
   // m_enable is false; used to detect enabling of metadata in the
@@ -363,13 +376,27 @@ public:
 
 namespace ns3 {
 
+bool
+PacketMetadata::IsLean (void)
+{
+#ifdef NS3_LEAN_PACKETS
+  return true;
+#else
+  return m_lean;
+#endif
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (IsLean () ? 0 : PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
+  if (m_data == 0)
+    {
+      return;
+    }
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
@@ -383,9 +410,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -393,15 +422,19 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -411,7 +444,10 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
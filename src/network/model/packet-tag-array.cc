@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+\file   packet-tag-array.cc
+\brief  Implements a fixed array of Packet tags, stored inline.
+*/
+
+#include "packet-tag-array.h"
+#include "tag-buffer.h"
+#include "tag.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("PacketTagArray")
+  ;
+
+namespace ns3 {
+
+uint32_t
+PacketTagArray::Find (TypeId tid) const
+{
+  uint32_t i = 0;
+  while (i < m_n && m_tags[i].tid != tid)
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+PacketTagArray::Add (const Tag &tag) const
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  // ensure this id was not yet added
+  NS_ASSERT (Find (tag.GetInstanceTypeId ()) == m_n);
+  if (m_n == MAX_TAGS)
+    {
+      NS_FATAL_ERROR ("Cannot add a tag of type " << tag.GetInstanceTypeId () <<
+                      ": a lean packet holds at most " << MAX_TAGS << " tags");
+    }
+  PacketTagArray *self = const_cast<PacketTagArray *> (this);
+  struct PacketTagList::TagData *data = &self->m_tags[m_n];
+  data->tid = tag.GetInstanceTypeId ();
+  NS_ASSERT (tag.GetSerializedSize () <= PacketTagList::TagData::MAX_SIZE);
+  tag.Serialize (TagBuffer (data->data, data->data + tag.GetSerializedSize ()));
+  self->m_n++;
+}
+
+bool
+PacketTagArray::Remove (Tag &tag)
+{
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t i = Find (tid);
+  if (i == m_n)
+    {
+      return false;
+    }
+  tag.Deserialize (TagBuffer (m_tags[i].data,
+                              m_tags[i].data + PacketTagList::TagData::MAX_SIZE));
+  m_n--;
+  for (; i < m_n; i++)
+    {
+      m_tags[i] = m_tags[i + 1];
+    }
+  return true;
+}
+
+bool
+PacketTagArray::Replace (Tag &tag)
+{
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t i = Find (tid);
+  if (i == m_n)
+    {
+      Add (tag);
+      return false;
+    }
+  tag.Serialize (TagBuffer (m_tags[i].data,
+                            m_tags[i].data + tag.GetSerializedSize ()));
+  return true;
+}
+
+bool
+PacketTagArray::Peek (Tag &tag) const
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  uint32_t i = Find (tag.GetInstanceTypeId ());
+  if (i == m_n)
+    {
+      return false;
+    }
+  struct PacketTagList::TagData *data = const_cast<struct PacketTagList::TagData *> (&m_tags[i]);
+  tag.Deserialize (TagBuffer (data->data, data->data + PacketTagList::TagData::MAX_SIZE));
+  return true;
+}
+
+const struct PacketTagList::TagData *
+PacketTagArray::Head (void) const
+{
+  if (m_n == 0)
+    {
+      return 0;
+    }
+  // link the tags from the most recent one, as a PacketTagList does
+  PacketTagArray *self = const_cast<PacketTagArray *> (this);
+  self->m_tags[0].next = 0;
+  for (uint8_t i = 1; i < m_n; i++)
+    {
+      self->m_tags[i].next = &self->m_tags[i - 1];
+    }
+  return &m_tags[m_n - 1];
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_TAG_ARRAY_H
+#define PACKET_TAG_ARRAY_H
+
+/**
+\file   packet-tag-array.h
+\brief  Defines a fixed array of Packet tags, stored inline.
+*/
+
+#include <stdint.h>
+#include "packet-tag-list.h"
+
+namespace ns3 {
+
+class Tag;
+
+/**
+ * \ingroup packet
+ *
+ * \brief Array of the packet tags stored in a packet.
+ *
+ * This class has the interface of PacketTagList, and replaces it in
+ * the packets of ns-3 configured with --enable-lean-packets.
+ *
+ * \internal
+ *
+ * The tags are serialized in an array of TagData held by the packet
+ * itself, in the order they were added. Packets rarely carry more
+ * than a couple of tags, so a copy moves the few slots in use instead
+ * of sharing heap-allocated nodes, and adding or removing a tag
+ * allocates nothing. The array holds at most MAX_TAGS tags: adding
+ * one more is a fatal error.
+ *
+ * The \c next pointers of the TagData link the tags from the most
+ * recent one on, like those of a PacketTagList, but they are only
+ * set by #Head, for the PacketTagIterator; \c count is unused.
+ */
+class PacketTagArray
+{
+public:
+  enum PacketTagArray_e
+  {
+    MAX_TAGS = 8              /**< Number of tags a packet can hold */
+  };
+
+  /**
+   * Create a new, empty PacketTagArray.
+   */
+  inline PacketTagArray ();
+  /**
+   * Copy constructor
+   *
+   * \param [in] o The PacketTagArray to copy.
+   */
+  inline PacketTagArray (PacketTagArray const &o);
+  /**
+   * Assignment
+   *
+   * \param [in] o The PacketTagArray to copy.
+   */
+  inline PacketTagArray &operator = (PacketTagArray const &o);
+
+  /**
+   * Add a tag after the others.
+   *
+   * \param [in] tag The tag to add
+   */
+  void Add (Tag const&tag) const;
+  /**
+   * Remove tag from the array.
+   *
+   * \param [in,out] tag The tag type to remove.  If found,
+   *          \pname{tag} is set to the value of the tag found.
+   * \returns True if \pname{tag} is found, false otherwise.
+   */
+  bool Remove (Tag &tag);
+  /**
+   * Replace the value of a tag.
+   *
+   * \param [in] tag The tag type to replace.
+   * \returns True if \pname{tag} is found, false otherwise.
+   *        If \pname{tag} wasn't found, Add is performed instead.
+   */
+  bool Replace (Tag &tag);
+  /**
+   * Find a tag and return its value.
+   *
+   * \param [in,out] tag The tag type to find.  If found,
+   *          \pname{tag} is set to the value of the tag found.
+   * \returns True if \pname{tag} is found, false otherwise.
+   */
+  bool Peek (Tag &tag) const;
+  /**
+   * Remove all tags.
+   */
+  inline void RemoveAll (void);
+  /**
+   * \returns pointer to the most recent tag, linked to the older ones
+   */
+  const struct PacketTagList::TagData *Head (void) const;
+
+private:
+  /**
+   * \param [in] tid The type of the tag to find.
+   * \returns The index of the tag of type \pname{tid}, or m_n.
+   */
+  uint32_t Find (TypeId tid) const;
+
+  struct PacketTagList::TagData m_tags[MAX_TAGS];
+  uint8_t m_n;                /**< Number of tags in #m_tags */
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of inline methods for performance
+ ****************************************************/
+
+namespace ns3 {
+
+PacketTagArray::PacketTagArray ()
+  : m_n (0)
+{
+}
+
+PacketTagArray::PacketTagArray (PacketTagArray const &o)
+  : m_n (o.m_n)
+{
+  for (uint8_t i = 0; i < m_n; i++)
+    {
+      m_tags[i] = o.m_tags[i];
+    }
+}
+
+PacketTagArray &
+PacketTagArray::operator = (PacketTagArray const &o)
+{
+  if (this == &o)
+    {
+      return *this;
+    }
+  m_n = o.m_n;
+  for (uint8_t i = 0; i < m_n; i++)
+    {
+      m_tags[i] = o.m_tags[i];
+    }
+  return *this;
+}
+
+void
+PacketTagArray::RemoveAll (void)
+{
+  m_n = 0;
+}
+
+} // namespace ns3
+
+#endif /* PACKET_TAG_ARRAY_H */
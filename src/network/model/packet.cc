@@ -28,6 +28,7 @@ NS_LOG_COMPONENT_DEFINE ("Packet");
 
 namespace ns3 {
 
+// Incremented atomically: the threads of a parallel simulation create packets at once
 uint32_t Packet::m_globalUid = 0;
 
 TypeId 
@@ -137,10 +138,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | __sync_fetch_and_add (&m_globalUid, 1), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -179,10 +179,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | __sync_fetch_and_add (&m_globalUid, 1), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -205,17 +204,16 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | __sync_fetch_and_add (&m_globalUid, 1), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
-                const PacketTagList &packetTagList, const PacketMetadata &metadata)
+                const PacketTags &packetTagList, const PacketMetadata &metadata)
   : m_buffer (buffer),
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
@@ -231,7 +229,8 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   Buffer buffer = m_buffer.CreateFragment (start, length);
   NS_ASSERT (m_buffer.GetSize () >= start + length);
   uint32_t end = m_buffer.GetSize () - (start + length);
-  PacketMetadata metadata = m_metadata.CreateFragment (start, end);
+  PacketMetadata metadata = PacketMetadata::IsLean () ?
+    m_metadata : m_metadata.CreateFragment (start, end);
   // again, call the constructor directly rather than
   // through Create because it is private.
   return Ptr<Packet> (new Packet (buffer, m_byteTagList, m_packetTagList, metadata), false);
@@ -262,7 +261,10 @@ Packet::AddHeader (const Header &header)
                                 m_buffer.GetCurrentStartOffset () + size);
     }
   header.Serialize (m_buffer.Begin ());
-  m_metadata.AddHeader (header, size);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.AddHeader (header, size);
+    }
 }
 uint32_t
 Packet::RemoveHeader (Header &header)
@@ -270,7 +272,10 @@ Packet::RemoveHeader (Header &header)
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.RemoveHeader (header, deserialized);
+    }
   return deserialized;
 }
 uint32_t
@@ -294,7 +299,10 @@ Packet::AddTrailer (const Trailer &trailer)
     }
   Buffer::Iterator end = m_buffer.End ();
   trailer.Serialize (end);
-  m_metadata.AddTrailer (trailer, size);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.AddTrailer (trailer, size);
+    }
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
@@ -302,7 +310,10 @@ Packet::RemoveTrailer (Trailer &trailer)
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
-  m_metadata.RemoveTrailer (trailer, deserialized);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.RemoveTrailer (trailer, deserialized);
+    }
   return deserialized;
 }
 uint32_t
@@ -327,7 +338,10 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   copy.AddAtStart (m_buffer.GetCurrentEndOffset () - bEnd,
                    appendPrependOffset);
   m_byteTagList.Add (copy);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -340,21 +354,30 @@ Packet::AddPaddingAtEnd (uint32_t size)
       m_byteTagList.AddAtEnd (m_buffer.GetCurrentEndOffset () - orgEnd,
                               m_buffer.GetCurrentEndOffset () - size);
     }
-  m_metadata.AddPaddingAtEnd (size);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.AddPaddingAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtEnd (size);
-  m_metadata.RemoveAtEnd (size);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.RemoveAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtStart (size);
-  m_metadata.RemoveAtStart (size);
+  if (!PacketMetadata::IsLean ())
+    {
+      m_metadata.RemoveAtStart (size);
+    }
 }
 
 void 
@@ -562,6 +585,13 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableLeanMode (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableLean ();
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
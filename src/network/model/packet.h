@@ -28,6 +28,7 @@
 #include "tag.h"
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
+#include "packet-tag-array.h"
 #include "nix-vector.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
@@ -437,6 +438,17 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * Packets keep no metadata by default, but they still allocate it and
+   * record their headers, trailers and fragments in case it is enabled.
+   * Invoke this method during the simulation setup to skip this
+   * bookkeeping altogether in the packets created afterwards: copies
+   * are cheaper, but EnablePrinting and EnableChecking are no longer
+   * allowed. Configuring ns-3 with --enable-lean-packets builds every
+   * packet this way, and also keeps the packet tags in a small inline
+   * array instead of a shared list.
+   */
+  static void EnableLeanMode (void);
 
   /**
    * \returns number of bytes required for packet
@@ -579,14 +591,20 @@ public:
   Ptr<NixVector> GetNixVector (void) const; 
 
 private:
+#ifdef NS3_LEAN_PACKETS
+  typedef PacketTagArray PacketTags;
+#else
+  typedef PacketTagList PacketTags;
+#endif
+
   Packet (const Buffer &buffer, const ByteTagList &byteTagList, 
-          const PacketTagList &packetTagList, const PacketMetadata &metadata);
+          const PacketTags &packetTagList, const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
   Buffer m_buffer;
   ByteTagList m_byteTagList;
-  PacketTagList m_packetTagList;
+  PacketTags m_packetTagList;
   PacketMetadata m_metadata;
 
   /* Please see comments above about nix-vector */
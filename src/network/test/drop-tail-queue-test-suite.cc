@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 
 using namespace ns3;
 
@@ -77,6 +78,52 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((p == 0), true, "There are really no packets in there");
 }
 
+class DropTailQueueMarkingTestCase : public TestCase
+{
+public:
+  DropTailQueueMarkingTestCase ();
+  virtual void DoRun (void);
+private:
+  bool Mark (Ptr<Packet> p);
+  uint32_t m_marked;
+};
+
+DropTailQueueMarkingTestCase::DropTailQueueMarkingTestCase ()
+  : TestCase ("Drop tail queue marks ECN capable packets above the marking threshold and drops the others")
+{
+}
+
+// Stands for the device, packets of 100 bytes are the ECN capable ones
+bool
+DropTailQueueMarkingTestCase::Mark (Ptr<Packet> p)
+{
+  if (p->GetSize () != 100)
+    {
+      return false;
+    }
+  m_marked++;
+  return true;
+}
+
+void
+DropTailQueueMarkingTestCase::DoRun (void)
+{
+  m_marked = 0;
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (10));
+  queue->SetAttribute ("Marking", BooleanValue (true));
+  queue->SetAttribute ("MarkingTh", UintegerValue (2));
+  // Set by the device, marking without it is a fatal error
+  queue->SetMarkCallback (MakeCallback (&DropTailQueueMarkingTestCase::Mark, this));
+
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (50)), true, "Below the threshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (100)), true, "Below the threshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (100)), true, "ECN capable, marked");
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (50)), false, "Not ECN capable, dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_marked, 1, "Marked once");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "Two below the threshold and the marked one");
+}
+
 static class DropTailQueueTestSuite : public TestSuite
 {
 public:
@@ -84,5 +131,6 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueMarkingTestCase (), TestCase::QUICK);
   }
 } g_dropTailQueueTestSuite;
@@ -835,4 +835,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
 }
 
+// lean packets have no metadata to test
+#ifndef NS3_LEAN_PACKETS
 PacketMetadataTestSuite g_packetMetadataTest;
+#endif
@@ -19,6 +19,7 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-tag-array.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -673,6 +674,7 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (5);
     ReplaceCheck (6);
     ReplaceCheck (7);
+#   undef ReplaceCheck
   }
   
   { // Timing
@@ -716,6 +718,150 @@ PacketTagListTest::DoRun (void)
     
 }
 
+//--------------------------------------
+class PacketTagArrayTest : public TestCase
+{
+public:
+  PacketTagArrayTest ();
+  virtual ~PacketTagArrayTest ();
+private:
+  void DoRun (void);
+  void CheckRef (const PacketTagArray & ref,
+                 ATestTagBase & t,
+                 const char * msg,
+                 bool miss = false);
+  void CheckRefList (const PacketTagArray & ref,
+                     const char * msg,
+                     int miss = 0);
+};
+
+PacketTagArrayTest::PacketTagArrayTest ()
+  : TestCase ("PacketTagArrayTest: ")
+{
+}
+
+PacketTagArrayTest::~PacketTagArrayTest ()
+{
+}
+
+void
+PacketTagArrayTest::CheckRef (const PacketTagArray & ref,
+                              ATestTagBase & t,
+                              const char * msg,
+                              bool miss)
+{
+  int expect = t.GetData ();
+  bool found = ref.Peek (t);
+  NS_TEST_EXPECT_MSG_EQ (found, !miss,
+                         msg << ": ref contains "
+                         << t.GetTypeId ().GetName ());
+  if (found) {
+    NS_TEST_EXPECT_MSG_EQ (t.GetData (), expect,
+                           msg << ": ref " << t.GetTypeId ().GetName ()
+                           << " = " << expect);
+    NS_TEST_EXPECT_MSG_EQ (t.m_error, false,
+                           msg << ": ref " << t.GetTypeId ().GetName ()
+                           << " intact");
+  }
+}
+
+void
+PacketTagArrayTest::CheckRefList (const PacketTagArray & pta,
+                                  const char * msg,
+                                  int miss /* = 0 */)
+{
+  MAKE_TEST_TAGS ;
+  CheckRef (pta, t1, msg, miss == 1);
+  CheckRef (pta, t2, msg, miss == 2);
+  CheckRef (pta, t3, msg, miss == 3);
+  CheckRef (pta, t4, msg, miss == 4);
+  CheckRef (pta, t5, msg, miss == 5);
+  CheckRef (pta, t6, msg, miss == 6);
+  CheckRef (pta, t7, msg, miss == 7);
+}
+
+void
+PacketTagArrayTest::DoRun (void)
+{
+  MAKE_TEST_TAGS ;
+
+  PacketTagArray ref;
+  NS_TEST_EXPECT_MSG_EQ ((ref.Head () == 0), true, "empty array");
+  ref.Add (t1);
+  ref.Add (t2);
+  ref.Add (t3);
+  ref.Add (t4);
+  ref.Add (t5);
+  ref.Add (t6);
+  ref.Add (t7);
+  CheckRefList (ref, "added");
+
+  { // Peek
+    ATestTag<10> t10;
+    NS_TEST_EXPECT_MSG_EQ (ref.Peek (t10), false, "missing tag");
+  }
+
+  { // Copy ctor, assignment
+    PacketTagArray pta (ref);
+    CheckRefList (pta, "copy ctor copy");
+    PacketTagArray ptb;
+    ptb = ref;
+    CheckRefList (ptb, "assignment copy");
+  }
+
+  { // Removal
+#   define RemoveCheck(n)                               \
+    { PacketTagArray p ## n = ref;			\
+      NS_TEST_EXPECT_MSG_EQ (p ## n .Remove ( t ## n ), true, "remove " #n); \
+      NS_TEST_EXPECT_MSG_EQ (p ## n .Remove ( t ## n ), false, "remove " #n " again"); \
+      CheckRefList (ref,     "remove " #n " orig");	\
+      CheckRefList (p ## n, "remove " #n " copy", n);   \
+    }
+    RemoveCheck (1);
+    RemoveCheck (4);
+    RemoveCheck (7);
+#   undef RemoveCheck
+  }
+
+  { // Replace
+#   define ReplaceCheck(n)					\
+    t ## n .m_data = 2;						\
+    { PacketTagArray p ## n = ref;				\
+      NS_TEST_EXPECT_MSG_EQ (p ## n .Replace ( t ## n ), true, "replace " #n); \
+      CheckRef     (p ## n, t ## n, "replace " #n " copy");	\
+      t ## n .m_data = 1;					\
+      CheckRefList (ref,     "replace " #n " orig");		\
+    }
+    ReplaceCheck (1);
+    ReplaceCheck (7);
+#   undef ReplaceCheck
+    PacketTagArray pta;
+    NS_TEST_EXPECT_MSG_EQ (pta.Replace (t3), false, "replace missing");
+    CheckRef (pta, t3, "replace missing adds");
+  }
+
+  { // Iteration from the most recent tag, as with a PacketTagList
+    PacketTagArray pta = ref;
+    pta.Remove (t5);
+    ATestTag<8> t8 (1);
+    pta.Add (t8);
+    TypeId expected[7] = { t8.GetTypeId (), t7.GetTypeId (), t6.GetTypeId (),
+                           t4.GetTypeId (), t3.GetTypeId (), t2.GetTypeId (),
+                           t1.GetTypeId () };
+    int n = 0;
+    for (const struct PacketTagList::TagData *cur = pta.Head (); cur != 0; cur = cur->next)
+      {
+        NS_TEST_ASSERT_MSG_LT (n, 7, "too many tags");
+        NS_TEST_EXPECT_MSG_EQ (cur->tid, expected[n], "tag " << n);
+        n++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 7, "tags iterated");
+    pta.RemoveAll ();
+    NS_TEST_EXPECT_MSG_EQ ((pta.Head () == 0), true, "all removed");
+    CheckRefList (ref, "orig after RemoveAll");
+  }
+}
+
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -728,6 +874,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagArrayTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -20,9 +20,7 @@
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "drop-tail-queue.h"
-#include "ns3/ce-tag.h" //Morteza
 #include "ns3/control-tag.h" //Morteza
-#include "ns3/ect-tag.h" //Morteza
 
 
 NS_LOG_COMPONENT_DEFINE ("DropTailQueue");
@@ -102,8 +100,6 @@ DropTailQueue::DoEnqueue (Ptr<Packet> p)
 
   ControlTag controlTag;
   bool isControlPkt = p->PeekPacketTag(controlTag);
-  EctTag ectTag;
-  bool isEct = p->PeekPacketTag(ectTag);
 
   if (m_mode == QUEUE_MODE_PACKETS && (m_packets.size () >= m_maxPackets) && !isControlPkt)
     {
@@ -129,19 +125,13 @@ DropTailQueue::DoEnqueue (Ptr<Packet> p)
 
       if (queueSize >= m_markingTh)
         { // We do not mark control packets && packet should be ECN capable (ECT)
-          if (isEct)
+          if (isControlPkt)
             {
-              CeTag ceTag;
-              bool exist = p->PeekPacketTag (ceTag);
-              if (!exist && !isControlPkt)
-                {
-                  ceTag.SetCe (1);
-                  p->AddPacketTag (ceTag);
-                }
+              // Do not drop control packets, when marking threshold has been reached!
             }
-          else if (!isEct && isControlPkt)
+          else if (Mark (p))
             {
-              // Do not drop control packets, when marking threshold has been reached!
+              // CE is set in the IP header
             }
           else
             {
@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "ns3/trace-source-accessor.h"
 #include "queue.h"
@@ -200,4 +201,23 @@ Queue::Drop (Ptr<Packet> p)
   m_traceDrop (p);
 }
 
+void
+Queue::SetMarkCallback (MarkCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_mark = cb;
+}
+
+bool
+Queue::Mark (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  if (m_mark.IsNull ())
+    {
+      NS_FATAL_ERROR ("Queue::Mark(): no mark callback is set; the device owning "
+                      "this queue cannot mark packets, so do not enable marking on it");
+    }
+  return m_mark (p);
+}
+
 } // namespace ns3
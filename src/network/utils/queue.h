@@ -29,6 +29,7 @@
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/callback.h"
 
 namespace ns3 {
 
@@ -115,6 +116,18 @@ public:
    */
   void ResetStatistics (void);
 
+  /**
+   * Marks a packet Congestion Experienced in its network header. Returns false if
+   * the packet is not ECN capable.
+   */
+  typedef Callback<bool, Ptr<Packet> > MarkCallback;
+  /**
+   * \param cb callback used by Mark ()
+   * Set by the device that owns the queue, which knows how its frames are laid out.
+   * The point-to-point and CSMA devices set it.
+   */
+  void SetMarkCallback (MarkCallback cb);
+
   /**
    * \brief Enumeration of the modes supported in the class.
    *
@@ -162,6 +175,15 @@ protected:
    *  This method is called by subclasses to notify parent (this class) of packet drops.
    */
   void Drop (Ptr<Packet> packet);
+  /**
+   *  \brief Mark a packet Congestion Experienced
+   *  \param packet packet in the queue's frame format
+   *  \return false if the packet is not ECN capable
+   *  This method is called by subclasses that mark rather than drop packets.
+   *  It is a fatal error if the device owning the queue set no mark callback:
+   *  marking queues must not silently drop the packets they cannot mark.
+   */
+  bool Mark (Ptr<Packet> packet);
 
 private:
   TracedCallback<Ptr<const Packet> > m_traceEnqueue;
@@ -174,6 +196,7 @@ private:
   uint32_t m_nTotalReceivedPackets;
   uint32_t m_nTotalDroppedBytes;
   uint32_t m_nTotalDroppedPackets;
+  MarkCallback m_mark;
 };
 
 } // namespace ns3
@@ -65,8 +65,6 @@
 #include "ns3/random-variable-stream.h"
 #include "red-queue.h"
 #include "ns3/flow-id-tag.h"
-#include "ns3/ce-tag.h"
-#include "ns3/ect-tag.h"
 #include "ns3/control-tag.h"
 
 NS_LOG_COMPONENT_DEFINE ("RedQueue");
@@ -321,21 +319,11 @@ RedQueue::DoEnqueue (Ptr<Packet> p)
       m_stats.qLimDrop++;
     }
 
-  // Extract ECT bit
-  EctTag ectTag;
-  bool isEct =  p->PeekPacketTag(ectTag);
 	// Try to mark ECN bits first
   if (dropType == DTYPE_UNFORCED_SOFT || dropType == DTYPE_UNFORCED_HARD)
     {
-      if (m_useCurrent && isEct) // This means running red with DCTCP
+      if (m_useCurrent && !isControlPkt && Mark (p)) // This means running red with DCTCP
         {
-          CeTag ceTag;
-          bool exist = p->PeekPacketTag (ceTag);
-          if (!exist && !isControlPkt)
-            {
-              ceTag.SetCe (1);
-              p->AddPacketTag (ceTag);
-            }
           m_stats.marked++;
           dropType = DTYPE_NONE; // We marked ECN bits! Packet shouldn't be dropped
         }
@@ -30,6 +30,7 @@
 #include "ns3/names.h"
 #include "ns3/mpi-interface.h"
 #include "ns3/mpi-receiver.h"
+#include "ns3/nstime.h"
 
 #include "ns3/trace-helper.h"
 #include "point-to-point-helper.h"
@@ -236,43 +237,84 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   b->AddDevice (devB);
   Ptr<Queue> queueB = m_queueFactory.Create<Queue> ();
   devB->SetQueue (queueB);
-  // If MPI is enabled, we need to see if both nodes have the same system id 
-  // (rank), and the rank is the same as this instance.  If both are true, 
-  //use a normal p2p channel, otherwise use a remote channel
-  bool useNormalChannel = true;
-  Ptr<PointToPointChannel> channel = 0;
+  Ptr<PointToPointChannel> channel = CreateChannel (devA, devB, NeedsRemoteChannel (a, b));
+  devA->Attach (channel);
+  devB->Attach (channel);
+  container.Add (devA);
+  container.Add (devB);
+
+  return container;
+}
 
+bool
+PointToPointHelper::NeedsRemoteChannel (Ptr<Node> a, Ptr<Node> b) const
+{
+  // If MPI is enabled, we need to see if both nodes have the same system id 
+  // (rank), and the rank is simulated by this instance (with threads, every
+  // rank is).  If both are true, use a normal p2p channel, otherwise use a
+  // remote channel
   if (MpiInterface::IsEnabled ())
     {
       uint32_t n1SystemId = a->GetSystemId ();
       uint32_t n2SystemId = b->GetSystemId ();
-      uint32_t currSystemId = MpiInterface::GetSystemId ();
-      if (n1SystemId != currSystemId || n2SystemId != currSystemId) 
+      if (n1SystemId != n2SystemId || !MpiInterface::IsLocal (n1SystemId))
         {
-          useNormalChannel = false;
+          return true;
         }
     }
-  if (useNormalChannel)
+  return false;
+}
+
+Ptr<PointToPointChannel>
+PointToPointHelper::CreateChannel (Ptr<PointToPointNetDevice> devA, Ptr<PointToPointNetDevice> devB, bool remote)
+{
+  if (!remote)
     {
-      channel = m_channelFactory.Create<PointToPointChannel> ();
+      return m_channelFactory.Create<PointToPointChannel> ();
     }
-  else
+  Ptr<PointToPointNetDevice> devs[2] = { devA, devB };
+  for (uint32_t i = 0; i < 2; ++i)
     {
-      channel = m_remoteChannelFactory.Create<PointToPointRemoteChannel> ();
-      Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
-      Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
-      mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devA));
-      mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devB));
-      devA->AggregateObject (mpiRecA);
-      devB->AggregateObject (mpiRecB);
+      if (devs[i]->GetObject<MpiReceiver> () == 0)
+        {
+          Ptr<MpiReceiver> mpiRec = CreateObject<MpiReceiver> ();
+          mpiRec->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devs[i]));
+          devs[i]->AggregateObject (mpiRec);
+        }
     }
+  return m_remoteChannelFactory.Create<PointToPointRemoteChannel> ();
+}
 
-  devA->Attach (channel);
-  devB->Attach (channel);
-  container.Add (devA);
-  container.Add (devB);
-
-  return container;
+void
+PointToPointHelper::UpdateChannels (NodeContainer c)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+        {
+          Ptr<PointToPointNetDevice> devA = (*i)->GetDevice (j)->GetObject<PointToPointNetDevice> ();
+          if (devA == 0 || devA->GetChannel () == 0 || devA->GetChannel ()->GetNDevices () != 2)
+            {
+              continue;
+            }
+          Ptr<PointToPointChannel> old = DynamicCast<PointToPointChannel> (devA->GetChannel ());
+          Ptr<PointToPointNetDevice> devB = old->GetPointToPointDevice (old->GetPointToPointDevice (0) == devA ? 1 : 0);
+          bool remote = NeedsRemoteChannel (devA->GetNode (), devB->GetNode ());
+          if ((DynamicCast<PointToPointRemoteChannel> (old) != 0) == remote)
+            {
+              // Already the right kind, or the link was seen from devB
+              continue;
+            }
+          NS_LOG_LOGIC ((remote ? "cutting" : "joining") << " the link between nodes " <<
+                        devA->GetNode ()->GetId () << " and " << devB->GetNode ()->GetId ());
+          TimeValue delay;
+          old->GetAttribute ("Delay", delay);
+          Ptr<PointToPointChannel> channel = CreateChannel (devA, devB, remote);
+          channel->SetAttribute ("Delay", delay);
+          devA->Attach (channel);
+          devB->Attach (channel);
+        }
+    }
 }
 
 NetDeviceContainer 
@@ -34,6 +34,8 @@ namespace ns3 {
 class Queue;
 class NetDevice;
 class Node;
+class PointToPointNetDevice;
+class PointToPointChannel;
 
 /**
  * \brief Build a set of PointToPointNetDevice objects
@@ -146,7 +148,35 @@ public:
    */
   NetDeviceContainer Install (std::string aNode, std::string bNode);
 
+  /**
+   * \param c a set of nodes
+   *
+   * Give every point-to-point link of these nodes the channel which
+   * Install would create for the current system ids of its two ends:
+   * for distributed simulations, this turns the links cut by a
+   * TopologyPartitioner into remote point-to-point channels, and those
+   * which are no longer cut back into plain ones. The new channel keeps
+   * the delay of the old one. Call it after the system ids are assigned
+   * and before the simulation starts.
+   */
+  void UpdateChannels (NodeContainer c);
+
 private:
+  /**
+   * \returns true if MPI is enabled and the nodes are not both simulated by
+   * this instance with the same system id, so that a link between them
+   * needs a ns3::PointToPointRemoteChannel
+   */
+  bool NeedsRemoteChannel (Ptr<Node> a, Ptr<Node> b) const;
+
+  /**
+   * \brief Create the channel for a link between two devices
+   *
+   * A remote channel also gives the devices an MpiReceiver. The devices
+   * are not attached.
+   */
+  Ptr<PointToPointChannel> CreateChannel (Ptr<PointToPointNetDevice> devA, Ptr<PointToPointNetDevice> devB, bool remote);
+
   /**
    * \brief Enable pcap output the indicated net device.
    *
@@ -0,0 +1,748 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-partitioner.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+
+NS_LOG_COMPONENT_DEFINE ("TopologyPartitioner");
+
+namespace ns3 {
+
+const uint32_t TopologyPartitioner::NONE;
+
+namespace {
+
+/* Gains closer to 0 than this are rounding errors. */
+const double EPSILON = 1e-9;
+/* Vertices below which a graph is not coarsened further. */
+const uint32_t COARSEST = 16;
+/* Bisections of the coarsest graph to choose from. */
+const uint32_t TRIALS = 8;
+/* Fiduccia-Mattheyses passes at most on each level. */
+const uint32_t PASSES = 8;
+
+uint32_t
+Find (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+} // anonymous namespace
+
+TopologyPartitioner::TopologyPartitioner ()
+  : m_imbalance (0.05)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TopologyPartitioner::Add (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  if (m_index.find (node->GetId ()) != m_index.end ())
+    {
+      return;
+    }
+  m_index[node->GetId ()] = m_nodes.size ();
+  m_nodes.push_back (node);
+  m_nodeWeights.push_back (1);
+}
+
+void
+TopologyPartitioner::Add (NodeContainer c)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Add (*i);
+    }
+}
+
+void
+TopologyPartitioner::SetNodeWeight (Ptr<Node> node, double weight)
+{
+  NS_LOG_FUNCTION (this << node << weight);
+  std::map<uint32_t, uint32_t>::const_iterator i = m_index.find (node->GetId ());
+  NS_ASSERT_MSG (i != m_index.end (), "Node " << node->GetId () << " was not added");
+  m_nodeWeights[i->second] = weight;
+}
+
+void
+TopologyPartitioner::SetLinkWeightCallback (LinkWeightCallback cb)
+{
+  m_linkWeight = cb;
+}
+
+void
+TopologyPartitioner::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  m_imbalance = imbalance;
+}
+
+void
+TopologyPartitioner::BuildGraph (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = m_nodes.size ();
+  std::vector<uint32_t> parent (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      parent[i] = i;
+    }
+  m_links.clear ();
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Node> node = m_nodes[i];
+      for (uint32_t d = 0; d < node->GetNDevices (); ++d)
+        {
+          Ptr<Channel> channel = node->GetDevice (d)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          bool cuttable = false;
+          if (DynamicCast<PointToPointChannel> (channel) != 0 && channel->GetNDevices () == 2)
+            {
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              cuttable = delay.Get ().IsStrictlyPositive ();
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<Node> other = channel->GetDevice (k)->GetNode ();
+              std::map<uint32_t, uint32_t>::const_iterator j = m_index.find (other->GetId ());
+              if (other == node || j == m_index.end ())
+                {
+                  continue;
+                }
+              if (!cuttable)
+                {
+                  parent[Find (parent, i)] = Find (parent, j->second);
+                }
+              else if (i < j->second)
+                {
+                  // Each link is seen from both ends, it is kept once
+                  Link link;
+                  link.a = i;
+                  link.b = j->second;
+                  link.weight = m_linkWeight.IsNull () ? 1 : m_linkWeight (node, other);
+                  m_links.push_back (link);
+                }
+            }
+        }
+    }
+
+  // The vertices follow the order of their first node
+  m_vertices.clear ();
+  m_vertexOf.assign (nNodes, NONE);
+  std::vector<uint32_t> vertexOfRoot (nNodes, NONE);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      uint32_t root = Find (parent, i);
+      if (vertexOfRoot[root] == NONE)
+        {
+          vertexOfRoot[root] = m_vertices.size ();
+          m_vertices.push_back (Vertex ());
+          m_vertices.back ().load = 0;
+          m_vertices.back ().degree = 0;
+        }
+      m_vertexOf[i] = vertexOfRoot[root];
+      m_vertices[m_vertexOf[i]].load += m_nodeWeights[i];
+    }
+  for (std::vector<Link>::const_iterator link = m_links.begin (); link != m_links.end (); ++link)
+    {
+      uint32_t a = m_vertexOf[link->a];
+      uint32_t b = m_vertexOf[link->b];
+      m_vertices[a].load += link->weight / 2;
+      m_vertices[b].load += link->weight / 2;
+      if (a != b)
+        {
+          m_vertices[a].links[b] += link->weight;
+          m_vertices[a].degree += link->weight;
+          m_vertices[b].links[a] += link->weight;
+          m_vertices[b].degree += link->weight;
+        }
+    }
+  NS_LOG_LOGIC (nNodes << " nodes, " << m_vertices.size () << " vertices, " << m_links.size () << " links");
+}
+
+bool
+TopologyPartitioner::Coarsen (const Graph &fine, double maxLoad, Graph &coarse, std::vector<uint32_t> &coarseOf)
+{
+  NS_LOG_FUNCTION (fine.size () << maxLoad);
+  uint32_t nVertices = fine.size ();
+  std::vector<double> heaviest (nVertices, 0);
+  for (uint32_t v = 0; v < nVertices; ++v)
+    {
+      const std::map<uint32_t, double> &links = fine[v].links;
+      for (std::map<uint32_t, double>::const_iterator j = links.begin (); j != links.end (); ++j)
+        {
+          heaviest[v] = std::max (heaviest[v], j->second);
+        }
+    }
+  // The heaviest links first, then those between the lightest vertices, so
+  // that tightly knit groups merge, and end hosts merge with their switch
+  // before the switches merge with each other. A link which is not the
+  // heaviest of both its ends, like that between a switch and a core switch
+  // of a fat tree, would merge vertices of different groups: such links
+  // are only followed if the graph does not shrink otherwise.
+  std::vector<uint32_t> mate (nVertices, NONE);
+  uint32_t nMerged = 0;
+  for (uint32_t pass = 0; pass < 2 && nMerged < nVertices / 10; ++pass)
+    {
+      std::vector<std::pair<std::pair<double, double>, std::pair<uint32_t, uint32_t> > > order;
+      for (uint32_t v = 0; v < nVertices; ++v)
+        {
+          const std::map<uint32_t, double> &links = fine[v].links;
+          for (std::map<uint32_t, double>::const_iterator j = links.begin (); j != links.end (); ++j)
+            {
+              uint32_t u = j->first;
+              if (v < u && fine[v].load + fine[u].load <= maxLoad
+                  && (pass == 1 || j->second > std::max (heaviest[v], heaviest[u]) - EPSILON))
+                {
+                  order.push_back (std::make_pair (std::make_pair (-j->second, fine[v].load + fine[u].load),
+                                                   std::make_pair (v, u)));
+                }
+            }
+        }
+      std::sort (order.begin (), order.end ());
+      for (uint32_t i = 0; i < order.size (); ++i)
+        {
+          uint32_t v = order[i].second.first;
+          uint32_t u = order[i].second.second;
+          if (mate[v] == NONE && mate[u] == NONE)
+            {
+              mate[v] = u;
+              mate[u] = v;
+              nMerged++;
+            }
+        }
+    }
+  for (uint32_t v = 0; v < nVertices; ++v)
+    {
+      if (mate[v] == NONE)
+        {
+          mate[v] = v;
+        }
+    }
+
+  // The coarse vertices follow the order of their first fine vertex
+  coarse.clear ();
+  coarseOf.assign (nVertices, NONE);
+  for (uint32_t v = 0; v < nVertices; ++v)
+    {
+      if (coarseOf[v] == NONE)
+        {
+          coarseOf[v] = coarseOf[mate[v]] = coarse.size ();
+          coarse.push_back (Vertex ());
+          coarse.back ().load = 0;
+          coarse.back ().degree = 0;
+        }
+      coarse[coarseOf[v]].load += fine[v].load;
+    }
+  for (uint32_t v = 0; v < nVertices; ++v)
+    {
+      Vertex &vertex = coarse[coarseOf[v]];
+      const std::map<uint32_t, double> &links = fine[v].links;
+      for (std::map<uint32_t, double>::const_iterator j = links.begin (); j != links.end (); ++j)
+        {
+          uint32_t u = coarseOf[j->first];
+          if (u != coarseOf[v])
+            {
+              vertex.links[u] += j->second;
+              vertex.degree += j->second;
+            }
+        }
+    }
+  NS_LOG_LOGIC (nVertices << " vertices coarsened to " << coarse.size ());
+  return coarse.size () < nVertices - nVertices / 10;
+}
+
+bool
+TopologyPartitioner::Quality::IsBetterThan (const Quality &other) const
+{
+  if (overload < other.overload - EPSILON || overload > other.overload + EPSILON)
+    {
+      return overload < other.overload;
+    }
+  if (cut < other.cut - EPSILON || cut > other.cut + EPSILON)
+    {
+      return cut < other.cut;
+    }
+  return balance < other.balance - EPSILON;
+}
+
+TopologyPartitioner::Quality
+TopologyPartitioner::Measure (const Graph &graph, const double maxLoads[2], const std::vector<uint32_t> &side)
+{
+  double loads[2] = { 0, 0 };
+  Quality quality;
+  quality.cut = 0;
+  for (uint32_t v = 0; v < graph.size (); ++v)
+    {
+      loads[side[v]] += graph[v].load;
+      const std::map<uint32_t, double> &links = graph[v].links;
+      for (std::map<uint32_t, double>::const_iterator i = links.begin (); i != links.end (); ++i)
+        {
+          if (side[i->first] != side[v])
+            {
+              quality.cut += i->second / 2;
+            }
+        }
+    }
+  quality.balance = std::max (loads[0] / maxLoads[0], loads[1] / maxLoads[1]);
+  quality.overload = std::max (quality.balance, 1.0);
+  return quality;
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Seeds (const Graph &graph)
+{
+  uint32_t nVertices = graph.size ();
+  // The vertex farthest from vertex 0; vertices out of its reach are the
+  // farthest.
+  std::vector<uint32_t> distances (nVertices, NONE);
+  std::deque<uint32_t> queue (1, 0);
+  distances[0] = 0;
+  uint32_t farthest = 0;
+  while (!queue.empty ())
+    {
+      uint32_t v = queue.front ();
+      queue.pop_front ();
+      farthest = v;
+      const std::map<uint32_t, double> &links = graph[v].links;
+      for (std::map<uint32_t, double>::const_iterator i = links.begin (); i != links.end (); ++i)
+        {
+          if (distances[i->first] == NONE)
+            {
+              distances[i->first] = distances[v] + 1;
+              queue.push_back (i->first);
+            }
+        }
+    }
+  for (uint32_t v = 0; v < nVertices; ++v)
+    {
+      if (distances[v] == NONE)
+        {
+          farthest = v;
+          break;
+        }
+    }
+  // Then vertices spread over the graph
+  std::vector<uint32_t> seeds (1, farthest);
+  for (uint32_t i = 0; i < std::min (TRIALS, nVertices); ++i)
+    {
+      uint32_t v = i * nVertices / std::min (TRIALS, nVertices);
+      if (v != farthest)
+        {
+          seeds.push_back (v);
+        }
+    }
+  return seeds;
+}
+
+void
+TopologyPartitioner::Grow (const Graph &graph, double target, uint32_t seed, std::vector<uint32_t> &side)
+{
+  NS_LOG_FUNCTION (graph.size () << target << seed);
+  uint32_t nVertices = graph.size ();
+  side.assign (nVertices, 1);
+
+  // Vertices next to side 0, with the weight of their links to it
+  std::map<uint32_t, double> frontier;
+  double load = 0;
+  uint32_t left = nVertices;
+  uint32_t next = seed;
+  while (true)
+    {
+      side[next] = 0;
+      load += graph[next].load;
+      left--;
+      frontier.erase (next);
+      const std::map<uint32_t, double> &links = graph[next].links;
+      for (std::map<uint32_t, double>::const_iterator i = links.begin (); i != links.end (); ++i)
+        {
+          if (side[i->first] == 1)
+            {
+              frontier[i->first] += i->second;
+            }
+        }
+      if (left == 0 || load >= target)
+        {
+          break;
+        }
+      // The vertex whose move reduces the cut the most, or increases it the
+      // least, else any vertex of side 1
+      next = NONE;
+      double best = 0;
+      for (std::map<uint32_t, double>::const_iterator i = frontier.begin (); i != frontier.end (); ++i)
+        {
+          double gain = 2 * i->second - graph[i->first].degree;
+          if (next == NONE || gain > best + EPSILON)
+            {
+              next = i->first;
+              best = gain;
+            }
+        }
+      for (uint32_t v = 0; next == NONE; ++v)
+        {
+          if (side[v] == 1)
+            {
+              next = v;
+            }
+        }
+      // Stop short of the target if reaching it overshoots it more
+      if (load + graph[next].load - target > target - load)
+        {
+          break;
+        }
+    }
+}
+
+bool
+TopologyPartitioner::Improve (const Graph &graph, const double maxLoads[2], std::vector<uint32_t> &side)
+{
+  NS_LOG_FUNCTION (graph.size () << maxLoads[0] << maxLoads[1]);
+  double loads[2] = { 0, 0 };
+  double cut = 0;
+  // Gain of moving each vertex to the other side, in queues of each side
+  // from the best move
+  std::vector<double> gains (graph.size (), 0);
+  std::set<std::pair<double, uint32_t> > queues[2];
+  // On the way, a side may carry one vertex more than it should, so that
+  // vertices can be swapped when the sides are balanced
+  double slack = 0;
+  for (uint32_t v = 0; v < graph.size (); ++v)
+    {
+      loads[side[v]] += graph[v].load;
+      slack = std::max (slack, graph[v].load);
+      const std::map<uint32_t, double> &links = graph[v].links;
+      for (std::map<uint32_t, double>::const_iterator i = links.begin (); i != links.end (); ++i)
+        {
+          gains[v] += side[i->first] == side[v] ? -i->second : i->second;
+          if (side[i->first] != side[v])
+            {
+              cut += i->second / 2;
+            }
+        }
+      queues[side[v]].insert (std::make_pair (-gains[v], v));
+    }
+
+  Quality best = Measure (graph, maxLoads, side);
+  std::vector<uint32_t> moves;
+  uint32_t bestMoves = 0;
+  while (true)
+    {
+      // The best move within the slack, out of the overloaded side if any
+      uint32_t next = NONE;
+      for (uint32_t from = 0; from < 2; ++from)
+        {
+          uint32_t to = 1 - from;
+          if (loads[to] > maxLoads[to] && loads[from] <= maxLoads[from])
+            {
+              continue;
+            }
+          for (std::set<std::pair<double, uint32_t> >::const_iterator i = queues[from].begin (); i != queues[from].end (); ++i)
+            {
+              if (loads[to] + graph[i->second].load <= maxLoads[to] + slack)
+                {
+                  if (next == NONE || gains[i->second] > gains[next] + EPSILON)
+                    {
+                      next = i->second;
+                    }
+                  break;
+                }
+            }
+        }
+      if (next == NONE)
+        {
+          break;
+        }
+      uint32_t from = side[next];
+      uint32_t to = 1 - from;
+      queues[from].erase (std::make_pair (-gains[next], next));
+      side[next] = to;
+      loads[from] -= graph[next].load;
+      loads[to] += graph[next].load;
+      cut -= gains[next];
+      moves.push_back (next);
+      const std::map<uint32_t, double> &links = graph[next].links;
+      for (std::map<uint32_t, double>::const_iterator i = links.begin (); i != links.end (); ++i)
+        {
+          uint32_t u = i->first;
+          if (queues[side[u]].erase (std::make_pair (-gains[u], u)) == 0)
+            {
+              // Already moved
+              continue;
+            }
+          gains[u] += side[u] == from ? 2 * i->second : -2 * i->second;
+          queues[side[u]].insert (std::make_pair (-gains[u], u));
+        }
+
+      Quality quality;
+      quality.cut = cut;
+      quality.balance = std::max (loads[0] / maxLoads[0], loads[1] / maxLoads[1]);
+      quality.overload = std::max (quality.balance, 1.0);
+      if (quality.IsBetterThan (best))
+        {
+          best = quality;
+          bestMoves = moves.size ();
+        }
+    }
+
+  // Undo the moves after the best bisection
+  for (uint32_t i = bestMoves; i < moves.size (); ++i)
+    {
+      side[moves[i]] = 1 - side[moves[i]];
+    }
+  NS_LOG_LOGIC ("kept " << bestMoves << " moves of " << moves.size () << ", cut " << best.cut);
+  return bestMoves != 0;
+}
+
+void
+TopologyPartitioner::Bisect (const Graph &graph, double target, double imbalance, std::vector<uint32_t> &side)
+{
+  NS_LOG_FUNCTION (graph.size () << target << imbalance);
+  double total = 0;
+  for (uint32_t v = 0; v < graph.size (); ++v)
+    {
+      total += graph[v].load;
+    }
+  double maxLoads[2] = { (1 + imbalance) * target, (1 + imbalance) * (total - target) };
+
+  // Coarsen down to a few vertices, none heavier than a fraction of a side
+  std::vector<Graph> graphs (1, graph);
+  std::vector<std::vector<uint32_t> > coarseOf;
+  while (graphs.back ().size () > COARSEST)
+    {
+      Graph coarse;
+      std::vector<uint32_t> map;
+      if (!Coarsen (graphs.back (), std::min (target, total - target) / 4, coarse, map))
+        {
+          break;
+        }
+      graphs.push_back (coarse);
+      coarseOf.push_back (map);
+    }
+
+  // Bisections of the coarsest graph, even overloaded ones, may end up
+  // best once refined: keep the best of those grown from several seeds
+  std::vector<uint32_t> seeds = Seeds (graphs.back ());
+  Quality best;
+  for (std::vector<uint32_t>::const_iterator seed = seeds.begin (); seed != seeds.end (); ++seed)
+    {
+      std::vector<uint32_t> trial;
+      Grow (graphs.back (), target, *seed, trial);
+      for (uint32_t level = graphs.size () - 1; ; --level)
+        {
+          for (uint32_t pass = 0; pass < PASSES && Improve (graphs[level], maxLoads, trial); ++pass)
+            {
+            }
+          if (level == 0)
+            {
+              break;
+            }
+          std::vector<uint32_t> finer (graphs[level - 1].size ());
+          for (uint32_t v = 0; v < finer.size (); ++v)
+            {
+              finer[v] = trial[coarseOf[level - 1][v]];
+            }
+          trial.swap (finer);
+        }
+      Quality quality = Measure (graph, maxLoads, trial);
+      if (seed == seeds.begin () || quality.IsBetterThan (best))
+        {
+          best = quality;
+          side.swap (trial);
+        }
+    }
+}
+
+void
+TopologyPartitioner::Split (const std::vector<uint32_t> &subset, uint32_t first, uint32_t n, double imbalance)
+{
+  NS_LOG_FUNCTION (this << subset.size () << first << n << imbalance);
+  if (n == 1 || subset.size () <= 1)
+    {
+      for (std::vector<uint32_t>::const_iterator v = subset.begin (); v != subset.end (); ++v)
+        {
+          m_partitionOf[*v] = first;
+        }
+      return;
+    }
+  // The graph of the subset, with the links to the other vertices left out
+  std::map<uint32_t, uint32_t> index;
+  for (uint32_t i = 0; i < subset.size (); ++i)
+    {
+      index[subset[i]] = i;
+    }
+  Graph graph (subset.size ());
+  double total = 0;
+  for (uint32_t i = 0; i < subset.size (); ++i)
+    {
+      const Vertex &vertex = m_vertices[subset[i]];
+      graph[i].load = vertex.load;
+      graph[i].degree = 0;
+      total += vertex.load;
+      for (std::map<uint32_t, double>::const_iterator j = vertex.links.begin (); j != vertex.links.end (); ++j)
+        {
+          std::map<uint32_t, uint32_t>::const_iterator k = index.find (j->first);
+          if (k != index.end ())
+            {
+              graph[i].links[k->second] = j->second;
+              graph[i].degree += j->second;
+            }
+        }
+    }
+  uint32_t n0 = n / 2;
+  std::vector<uint32_t> side;
+  Bisect (graph, total * n0 / n, imbalance, side);
+  std::vector<uint32_t> subsets[2];
+  for (uint32_t i = 0; i < subset.size (); ++i)
+    {
+      subsets[side[i]].push_back (subset[i]);
+    }
+  Split (subsets[0], first, n0, imbalance);
+  Split (subsets[1], first + n0, n - n0, imbalance);
+}
+
+void
+TopologyPartitioner::Renumber (uint32_t n)
+{
+  std::vector<uint32_t> number (n, NONE);
+  uint32_t used = 0;
+  for (uint32_t v = 0; v < m_vertices.size (); ++v)
+    {
+      if (number[m_partitionOf[v]] == NONE)
+        {
+          number[m_partitionOf[v]] = used++;
+        }
+    }
+  std::vector<double> loads (n, 0);
+  for (uint32_t p = 0; p < n; ++p)
+    {
+      if (number[p] == NONE)
+        {
+          number[p] = used++;
+        }
+      loads[number[p]] = m_loads[p];
+    }
+  m_loads = loads;
+  for (uint32_t v = 0; v < m_vertices.size (); ++v)
+    {
+      m_partitionOf[v] = number[m_partitionOf[v]];
+    }
+}
+
+void
+TopologyPartitioner::Partition (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ASSERT_MSG (n != 0, "At least one partition is needed");
+  BuildGraph ();
+  std::vector<uint32_t> all;
+  for (uint32_t v = 0; v < m_vertices.size (); ++v)
+    {
+      all.push_back (v);
+    }
+  m_partitionOf.assign (m_vertices.size (), NONE);
+  // The imbalances of the nested bisections add up
+  uint32_t depth = 0;
+  while ((1u << depth) < n)
+    {
+      depth++;
+    }
+  Split (all, 0, n, m_imbalance / std::max (depth, 1u));
+  m_loads.assign (n, 0);
+  for (uint32_t v = 0; v < m_vertices.size (); ++v)
+    {
+      m_loads[m_partitionOf[v]] += m_vertices[v].load;
+    }
+  Renumber (n);
+  NS_LOG_LOGIC ("cut " << GetNCutLinks () << " links of weight " << GetCutWeight ());
+}
+
+void
+TopologyPartitioner::Assign (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      m_nodes[i]->SetAttribute ("SystemId", UintegerValue (GetPartition (m_nodes[i])));
+    }
+}
+
+uint32_t
+TopologyPartitioner::GetPartition (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator i = m_index.find (node->GetId ());
+  NS_ASSERT_MSG (i != m_index.end () && i->second < m_vertexOf.size (), "Node " << node->GetId () << " was not partitioned");
+  return m_partitionOf[m_vertexOf[i->second]];
+}
+
+double
+TopologyPartitioner::GetLoad (uint32_t partition) const
+{
+  NS_ASSERT (partition < m_loads.size ());
+  return m_loads[partition];
+}
+
+uint32_t
+TopologyPartitioner::GetNCutLinks (void) const
+{
+  uint32_t cut = 0;
+  for (std::vector<Link>::const_iterator link = m_links.begin (); link != m_links.end (); ++link)
+    {
+      if (m_partitionOf[m_vertexOf[link->a]] != m_partitionOf[m_vertexOf[link->b]])
+        {
+          cut++;
+        }
+    }
+  return cut;
+}
+
+double
+TopologyPartitioner::GetCutWeight (void) const
+{
+  double cut = 0;
+  for (std::vector<Link>::const_iterator link = m_links.begin (); link != m_links.end (); ++link)
+    {
+      if (m_partitionOf[m_vertexOf[link->a]] != m_partitionOf[m_vertexOf[link->b]])
+        {
+          cut += link->weight;
+        }
+    }
+  return cut;
+}
+
+} // namespace ns3
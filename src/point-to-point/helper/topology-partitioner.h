@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TOPOLOGY_PARTITIONER_H
+#define TOPOLOGY_PARTITIONER_H
+
+#include "ns3/node-container.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \brief Assign the system ids of the nodes of a built topology
+ *
+ * Distributed and multithreaded simulations run the nodes of each system
+ * id in their own partition, and every link between two partitions costs
+ * messages and synchronisation. Instead of assigning the system ids by hand
+ * when the nodes are created, build the whole topology, Add () its nodes
+ * to a TopologyPartitioner, and Partition () it: the links are read from
+ * the channels of the devices of the nodes, and each node gets a partition
+ * such that the weight of the links between partitions is small while the
+ * load of the partitions stays balanced.
+ *
+ * The load of a node is its weight, 1 unless SetNodeWeight () says
+ * otherwise, plus half the weight of each of its links, which stands for
+ * the packets it sends and receives. The weight of a link is 1, or the
+ * value of the callback given to SetLinkWeightCallback (), for instance
+ * the traffic expected on it. Only point-to-point links with a delay may be
+ * cut: the nodes joined by any other channel always share a partition.
+ *
+ * The partitions are split off by recursive bisection, each one
+ * multilevel like those of METIS. The graph is first coarsened by merging
+ * nodes with the neighbours they are most heavily linked to, so that
+ * tightly knit groups become single vertices. One side of the coarsest
+ * graph is grown from a vertex, by the neighbouring vertices which add the
+ * least to the cut, until it holds its share of the load. The groups are
+ * then split back level by level, and at each level Fiduccia-Mattheyses
+ * passes improve the bisection: every vertex moves once to the other side,
+ * the move which reduces the cut the most first, even if it increases it,
+ * and the best bisection seen, with no side loaded beyond its share plus
+ * its part of the allowed imbalance, is kept. This is done from a few
+ * vertices spread over the graph, and the best bisection wins.
+ *
+ * Fat trees have full bisection bandwidth: with the same weight on every
+ * link, cutting every top of rack switch from half of its aggregation
+ * switches may cost as little as cutting the pods apart. Weigh the links
+ * by the traffic expected on them, which is higher within the pods as soon
+ * as some of the traffic stays in them, to get the pods kept whole and the
+ * links to the core switches cut.
+ *
+ * Once the nodes have their system ids, Assign () them and let
+ * PointToPointHelper::UpdateChannels () turn the cut links into remote
+ * channels.
+ */
+class TopologyPartitioner
+{
+public:
+  /**
+   * Weight of the link between two nodes
+   */
+  typedef Callback<double, Ptr<Node>, Ptr<Node> > LinkWeightCallback;
+
+  TopologyPartitioner ();
+
+  /**
+   * \param node a node to partition
+   */
+  void Add (Ptr<Node> node);
+  /**
+   * \param c nodes to partition
+   */
+  void Add (NodeContainer c);
+  /**
+   * \param node a node added to this partitioner
+   * \param weight the cost of the node itself, 1 by default
+   */
+  void SetNodeWeight (Ptr<Node> node, double weight);
+  /**
+   * \param cb the weight of the link between two nodes, 1 for every link
+   * by default
+   */
+  void SetLinkWeightCallback (LinkWeightCallback cb);
+  /**
+   * \param imbalance how much more than the average load a partition may
+   * carry, as a fraction of it, 0.05 by default
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * \brief Divide the nodes added so far into partitions
+   * \param n the number of partitions
+   *
+   * The partition of the first node added is 0, the partition numbers
+   * then follow the order in which the nodes were added. The system ids of
+   * the nodes are not changed until Assign ().
+   */
+  void Partition (uint32_t n);
+  /**
+   * \brief Set the system id of every node to its partition
+   */
+  void Assign (void) const;
+
+  /**
+   * \param node a node added to this partitioner
+   * \returns its partition
+   */
+  uint32_t GetPartition (Ptr<Node> node) const;
+  /**
+   * \param partition a partition
+   * \returns the sum of the loads of its nodes
+   */
+  double GetLoad (uint32_t partition) const;
+  /**
+   * \returns the number of links between two partitions
+   */
+  uint32_t GetNCutLinks (void) const;
+  /**
+   * \returns the weight of the links between two partitions
+   */
+  double GetCutWeight (void) const;
+
+private:
+  static const uint32_t NONE = 0xffffffff;
+
+  /* A set of nodes which cannot be split, and its links to the other ones. */
+  struct Vertex
+  {
+    double load;
+    double degree;                           //!< weight of the links to other vertices
+    std::map<uint32_t, double> links;        //!< weight of the links to each other vertex
+  };
+  /* A link which may be cut, between two nodes. */
+  struct Link
+  {
+    uint32_t a;
+    uint32_t b;
+    double weight;
+  };
+
+  typedef std::vector<Vertex> Graph;
+  /* Bisections compare by overload, then cut, then balance. */
+  struct Quality
+  {
+    double overload;                         //!< load over the maximum of the most loaded side, at least 1
+    double cut;
+    double balance;                          //!< load over the maximum of the most loaded side
+    bool IsBetterThan (const Quality &other) const;
+  };
+
+  /* Group the nodes into vertices and weigh the vertices and links. */
+  void BuildGraph (void);
+  /*
+   * Split the vertices of subset between partitions first to first + n - 1,
+   * by bisections of the given imbalance.
+   */
+  void Split (const std::vector<uint32_t> &subset, uint32_t first, uint32_t n, double imbalance);
+  /* Divide a graph into side 0, of load close to target, and side 1. */
+  static void Bisect (const Graph &graph, double target, double imbalance, std::vector<uint32_t> &side);
+  /*
+   * Merge pairs of vertices of fine, along the heaviest links first and up
+   * to maxLoad, into coarse; coarseOf is the vertex of coarse of each vertex
+   * of fine. Return false if this hardly shrinks the graph.
+   */
+  static bool Coarsen (const Graph &fine, double maxLoad, Graph &coarse, std::vector<uint32_t> &coarseOf);
+  /* Return the vertices to grow bisections from, the farthest from vertex 0 first. */
+  static std::vector<uint32_t> Seeds (const Graph &graph);
+  /* Grow side 0 from seed up to target, the rest is side 1. */
+  static void Grow (const Graph &graph, double target, uint32_t seed, std::vector<uint32_t> &side);
+  /* Return how good a bisection is. */
+  static Quality Measure (const Graph &graph, const double maxLoads[2], const std::vector<uint32_t> &side);
+  /*
+   * Improve a bisection by a Fiduccia-Mattheyses pass, return true if it is
+   * better, that is less overloaded, or with a smaller cut, or better
+   * balanced.
+   */
+  static bool Improve (const Graph &graph, const double maxLoads[2], std::vector<uint32_t> &side);
+  /* Number the partitions in the order of their first node. */
+  void Renumber (uint32_t n);
+
+  std::vector<Ptr<Node> > m_nodes;
+  std::map<uint32_t, uint32_t> m_index;      //!< index in m_nodes of each node id
+  std::vector<double> m_nodeWeights;
+  LinkWeightCallback m_linkWeight;
+  double m_imbalance;
+
+  std::vector<Link> m_links;
+  std::vector<uint32_t> m_vertexOf;          //!< vertex of each node
+  Graph m_vertices;
+  std::vector<uint32_t> m_partitionOf;       //!< partition of each vertex
+  std::vector<double> m_loads;               //!< load of each partition
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_PARTITIONER_H */
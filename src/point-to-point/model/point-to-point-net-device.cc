@@ -178,6 +178,21 @@ PointToPointNetDevice::ProcessHeader (Ptr<Packet> p, uint16_t& param)
   return true;
 }
 
+bool
+PointToPointNetDevice::MarkEcn (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_node == 0)
+    {
+      return false;
+    }
+  PppHeader ppp;
+  p->RemoveHeader (ppp);
+  bool marked = m_node->MarkEcn (p, PppToEther (ppp.GetProtocol ()));
+  p->AddHeader (ppp);
+  return marked;
+}
+
 void
 PointToPointNetDevice::DoDispose ()
 {
@@ -292,6 +307,7 @@ PointToPointNetDevice::SetQueue (Ptr<Queue> q)
 {
   NS_LOG_FUNCTION (this << q);
   m_queue = q;
+  m_queue->SetMarkCallback (MakeCallback (&PointToPointNetDevice::MarkEcn, this));
 }
 
 void
@@ -221,6 +221,15 @@ private:
    */
   bool ProcessHeader (Ptr<Packet> p, uint16_t& param);
 
+  /**
+   * Marks a frame of the transmit queue Congestion Experienced, see
+   * Queue::SetMarkCallback (). The PPP header is set aside while the
+   * node's marker for the frame's protocol rewrites its header.
+   * \param p Packet with its PPP header
+   * \return Returns false if the packet is not ECN capable.
+   */
+  bool MarkEcn (Ptr<Packet> p);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
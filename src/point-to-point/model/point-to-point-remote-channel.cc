@@ -46,12 +46,32 @@ PointToPointRemoteChannel::GetTypeId (void)
 
 PointToPointRemoteChannel::PointToPointRemoteChannel ()
 {
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_src[i] = 0;
+      m_dstNode[i] = 0;
+      m_dstIfIndex[i] = 0;
+    }
 }
 
 PointToPointRemoteChannel::~PointToPointRemoteChannel ()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  NS_ASSERT_MSG (device->GetNode () != 0, "Add the device to its node before attaching it");
+
+  uint32_t wire = GetNDevices ();
+  PointToPointChannel::Attach (device);
+  m_src[wire] = PeekPointer (device);
+  // The device is the destination of the other wire
+  m_dstNode[1 - wire] = device->GetNode ()->GetId ();
+  m_dstIfIndex[1 - wire] = device->GetIfIndex ();
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart (
   Ptr<Packet> p,
@@ -63,16 +83,11 @@ PointToPointRemoteChannel::TransmitStart (
 
   IsInitialized ();
 
-  uint32_t wire = src == GetSource (0) ? 0 : 1;
-  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+  uint32_t wire = PeekPointer (src) == m_src[0] ? 0 : 1;
 
-#ifdef NS3_MPI
   // Calculate the rxTime (absolute)
   Time rxTime = Simulator::Now () + txTime + GetDelay ();
-  MpiInterface::SendPacket (p, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  MpiInterface::SendPacket (p, rxTime, m_dstNode[wire], m_dstIfIndex[wire]);
   return true;
 }
 
@@ -38,7 +38,16 @@ public:
   static TypeId GetTypeId (void);
   PointToPointRemoteChannel ();
   ~PointToPointRemoteChannel ();
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
+
+private:
+  // The ends of the link, found when they attach: when the simulator runs
+  // the partitions on threads, the remote device and node must not even be
+  // referenced by a Ptr.
+  const PointToPointNetDevice *m_src[2];
+  uint32_t m_dstNode[2];
+  uint32_t m_dstIfIndex[2];
 };
 }
 
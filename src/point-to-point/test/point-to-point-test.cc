@@ -3,6 +3,10 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
 
 using namespace ns3;
 
@@ -55,6 +59,100 @@ PointToPointTest::DoRun (void)
 
   Simulator::Destroy ();
 }
+
+/**
+ * A link between two partitions of the multithreaded simulator delivers
+ * the packets at the same times as a sequential run.
+ */
+class PointToPointThreadedTest : public TestCase
+{
+public:
+  PointToPointThreadedTest ();
+
+  virtual void DoRun (void);
+
+private:
+  std::vector<Time> Transfer (bool threaded);
+  void SendOnePacket (Ptr<NetDevice> device);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_arrivals;
+  uint32_t m_receiverSystemId;
+};
+
+PointToPointThreadedTest::PointToPointThreadedTest ()
+  : TestCase ("PointToPoint link between threads")
+{
+}
+
+void
+PointToPointThreadedTest::SendOnePacket (Ptr<NetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointThreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_arrivals.push_back (Simulator::Now ());
+  m_receiverSystemId = Simulator::GetSystemId ();
+  return true;
+}
+
+std::vector<Time>
+PointToPointThreadedTest::Transfer (bool threaded)
+{
+  m_arrivals.clear ();
+  m_receiverSystemId = 0;
+  if (threaded)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+      MpiInterface::Enable (0, 0);
+    }
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (threaded ? 1 : 0);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = p2p.Install (a, b);
+  devices.Get (1)->SetReceiveCallback (MakeCallback (&PointToPointThreadedTest::Receive, this));
+
+  // Two packets back to back, then one after the link is idle again
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::ScheduleWithContext (a->GetId (), MilliSeconds (1000 + 5 * (i / 2)),
+                                      &PointToPointThreadedTest::SendOnePacket, this, devices.Get (0));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  if (threaded)
+    {
+      MpiInterface::Disable ();
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+    }
+  return m_arrivals;
+}
+
+void
+PointToPointThreadedTest::DoRun (void)
+{
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::MultithreadedSimulatorImpl", &tid))
+    {
+      // Built without threads
+      return;
+    }
+  std::vector<Time> expected = Transfer (false);
+  std::vector<Time> arrivals = Transfer (true);
+  NS_TEST_ASSERT_MSG_EQ (expected.size (), 3, "Every packet should arrive");
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), expected.size (), "Every packet should arrive across threads");
+  for (uint32_t i = 0; i < arrivals.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (arrivals[i], expected[i], "Arrival time of packet " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_receiverSystemId, 1, "The receiver runs in its own partition");
+}
 //-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
@@ -66,6 +164,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointThreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
@@ -0,0 +1,333 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/topology-partitioner.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/data-rate.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace ns3;
+
+/**
+ * A fat tree of k = 4, with more traffic expected within the pods than
+ * through the core, is cut between its pods and the core switches.
+ */
+class FatTreePartitionTest : public TestCase
+{
+public:
+  FatTreePartitionTest ();
+
+  virtual void DoRun (void);
+
+private:
+  double LinkWeight (Ptr<Node> a, Ptr<Node> b);
+  void Check (uint32_t n, uint32_t cut);
+
+  static const uint32_t PODS = 4;
+
+  TopologyPartitioner m_partitioner;
+  NodeContainer m_core;
+  NodeContainer m_pods[PODS];
+};
+
+FatTreePartitionTest::FatTreePartitionTest ()
+  : TestCase ("Fat tree pods are not split")
+{
+}
+
+double
+FatTreePartitionTest::LinkWeight (Ptr<Node> a, Ptr<Node> b)
+{
+  for (uint32_t i = 0; i < m_core.GetN (); i++)
+    {
+      if (m_core.Get (i) == a || m_core.Get (i) == b)
+        {
+          return 1;
+        }
+    }
+  return 2;
+}
+
+void
+FatTreePartitionTest::Check (uint32_t n, uint32_t cut)
+{
+  m_partitioner.Partition (n);
+  std::set<uint32_t> used;
+  for (uint32_t p = 0; p < PODS; p++)
+    {
+      uint32_t partition = m_partitioner.GetPartition (m_pods[p].Get (0));
+      for (uint32_t i = 1; i < m_pods[p].GetN (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_partitioner.GetPartition (m_pods[p].Get (i)), partition,
+                                 "Node " << i << " of pod " << p << " in " << n << " partitions");
+        }
+      used.insert (partition);
+    }
+  NS_TEST_EXPECT_MSG_EQ (used.size (), n, "Every partition has pods");
+  NS_TEST_EXPECT_MSG_EQ (m_partitioner.GetNCutLinks (), cut, "Only links to the core switches are cut");
+  double total = 0;
+  for (uint32_t p = 0; p < n; p++)
+    {
+      total += m_partitioner.GetLoad (p);
+    }
+  for (uint32_t p = 0; p < n; p++)
+    {
+      NS_TEST_EXPECT_MSG_LT (m_partitioner.GetLoad (p), 1.05 * total / n + 1e-9, "Load of partition " << p);
+    }
+}
+
+void
+FatTreePartitionTest::DoRun (void)
+{
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  m_core.Create (4);
+  for (uint32_t p = 0; p < PODS; p++)
+    {
+      NodeContainer hosts, tors, aggrs;
+      hosts.Create (4);
+      tors.Create (2);
+      aggrs.Create (2);
+      for (uint32_t t = 0; t < 2; t++)
+        {
+          for (uint32_t h = 0; h < 2; h++)
+            {
+              p2p.Install (hosts.Get (2 * t + h), tors.Get (t));
+            }
+          for (uint32_t a = 0; a < 2; a++)
+            {
+              p2p.Install (tors.Get (t), aggrs.Get (a));
+              // Aggregation switch a of each pod reaches core switches 2a and 2a+1
+              p2p.Install (aggrs.Get (a), m_core.Get (2 * a + t));
+            }
+        }
+      m_pods[p].Add (hosts);
+      m_pods[p].Add (tors);
+      m_pods[p].Add (aggrs);
+      m_partitioner.Add (m_pods[p]);
+    }
+  m_partitioner.Add (m_core);
+  m_partitioner.SetLinkWeightCallback (MakeCallback (&FatTreePartitionTest::LinkWeight, this));
+
+  m_partitioner.Partition (1);
+  NS_TEST_ASSERT_MSG_EQ (m_partitioner.GetNCutLinks (), 0, "Nothing to cut");
+  // Each core switch stays with one pod, its 3 other links are cut
+  Check (4, 12);
+  Check (2, 8);
+  Simulator::Destroy ();
+}
+
+/**
+ * The node weights and the link weights steer the cut.
+ */
+class PartitionWeightTest : public TestCase
+{
+public:
+  PartitionWeightTest ();
+
+  virtual void DoRun (void);
+
+private:
+  double LinkWeight (Ptr<Node> a, Ptr<Node> b);
+
+  NodeContainer m_nodes;
+};
+
+PartitionWeightTest::PartitionWeightTest ()
+  : TestCase ("Partitions follow the node and link weights")
+{
+}
+
+double
+PartitionWeightTest::LinkWeight (Ptr<Node> a, Ptr<Node> b)
+{
+  // Heavy links 0-1 and 2-3
+  uint32_t i = std::min (a->GetId (), b->GetId ()) - m_nodes.Get (0)->GetId ();
+  uint32_t j = std::max (a->GetId (), b->GetId ()) - m_nodes.Get (0)->GetId ();
+  return j == i + 1 && i % 2 == 0 ? 10 : 1;
+}
+
+void
+PartitionWeightTest::DoRun (void)
+{
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+
+  // A chain of 6 nodes; the first one is heavy
+  NodeContainer chain;
+  chain.Create (6);
+  for (uint32_t i = 0; i + 1 < chain.GetN (); i++)
+    {
+      p2p.Install (chain.Get (i), chain.Get (i + 1));
+    }
+  TopologyPartitioner partitioner;
+  partitioner.Add (chain);
+  partitioner.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (chain.Get (2)), 0, "The chain is cut in its middle");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (chain.Get (3)), 1, "The chain is cut in its middle");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetLoad (0), 5.5, "Load of the first half");
+  partitioner.SetNodeWeight (chain.Get (0), 4);
+  partitioner.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (chain.Get (1)), 0, "A heavy node needs fewer neighbours");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (chain.Get (2)), 1, "A heavy node needs fewer neighbours");
+
+  // Links without delay are never cut
+  NodeContainer pair;
+  pair.Create (2);
+  p2p.SetChannelAttribute ("Delay", StringValue ("0s"));
+  p2p.Install (pair);
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  p2p.Install (pair.Get (1), chain.Get (0));
+  partitioner.Add (pair);
+  partitioner.Partition (8);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (pair.Get (0)), partitioner.GetPartition (pair.Get (1)),
+                         "A link without delay joins its nodes");
+
+  // A ring of 4 nodes is cut across its light links
+  m_nodes.Create (4);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      p2p.Install (m_nodes.Get (i), m_nodes.Get ((i + 1) % m_nodes.GetN ()));
+    }
+  TopologyPartitioner ring;
+  ring.Add (m_nodes);
+  ring.SetLinkWeightCallback (MakeCallback (&PartitionWeightTest::LinkWeight, this));
+  ring.Partition (2);
+  NS_TEST_EXPECT_MSG_EQ (ring.GetPartition (m_nodes.Get (0)), ring.GetPartition (m_nodes.Get (1)), "Heavy link 0-1 is kept");
+  NS_TEST_EXPECT_MSG_EQ (ring.GetPartition (m_nodes.Get (2)), ring.GetPartition (m_nodes.Get (3)), "Heavy link 2-3 is kept");
+  NS_TEST_EXPECT_MSG_EQ (ring.GetNCutLinks (), 2, "The light links are cut");
+  NS_TEST_EXPECT_MSG_EQ (ring.GetCutWeight (), 2, "The light links are cut");
+  Simulator::Destroy ();
+}
+
+/**
+ * Once assigned, the partitions of a chain run on their own threads, and
+ * the links between them become remote channels.
+ */
+class PartitionChannelsTest : public TestCase
+{
+public:
+  PartitionChannelsTest ();
+
+  virtual void DoRun (void);
+
+private:
+  void SendOnePacket (Ptr<NetDevice> device);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Time m_arrival;
+  uint32_t m_receiverSystemId;
+};
+
+PartitionChannelsTest::PartitionChannelsTest ()
+  : TestCase ("Cut links become remote channels")
+{
+}
+
+void
+PartitionChannelsTest::SendOnePacket (Ptr<NetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PartitionChannelsTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_arrival = Simulator::Now ();
+  m_receiverSystemId = Simulator::GetSystemId ();
+  return true;
+}
+
+void
+PartitionChannelsTest::DoRun (void)
+{
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::MultithreadedSimulatorImpl", &tid))
+    {
+      // Built without threads
+      return;
+    }
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  MpiInterface::Enable (0, 0);
+
+  // Nodes all have system id 0 when the links are installed
+  NodeContainer chain;
+  chain.Create (4);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices[3];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices[i] = p2p.Install (chain.Get (i), chain.Get (i + 1));
+    }
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<PointToPointRemoteChannel> (devices[1].Get (0)->GetChannel ()), 0,
+                         "No remote channel in one partition");
+
+  TopologyPartitioner partitioner;
+  partitioner.Add (chain);
+  partitioner.Partition (2);
+  partitioner.Assign ();
+  p2p.UpdateChannels (chain);
+  NS_TEST_ASSERT_MSG_EQ (chain.Get (2)->GetSystemId (), 1, "System ids are assigned");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Channel> channel = devices[i].Get (0)->GetChannel ();
+      NS_TEST_EXPECT_MSG_EQ (channel, devices[i].Get (1)->GetChannel (), "Both devices of link " << i << " share a channel");
+      NS_TEST_EXPECT_MSG_EQ ((DynamicCast<PointToPointRemoteChannel> (channel) != 0), (i == 1), "Only link 1 is remote");
+    }
+  TimeValue delay;
+  devices[1].Get (0)->GetChannel ()->GetAttribute ("Delay", delay);
+  NS_TEST_EXPECT_MSG_EQ (delay.Get (), MilliSeconds (2), "The remote channel keeps the delay");
+
+  m_receiverSystemId = 0;
+  devices[1].Get (1)->SetReceiveCallback (MakeCallback (&PartitionChannelsTest::Receive, this));
+  Simulator::ScheduleWithContext (chain.Get (1)->GetId (), Seconds (1),
+                                  &PartitionChannelsTest::SendOnePacket, this, devices[1].Get (0));
+  Simulator::Run ();
+  // 1002 bytes with the PPP header at 5Mbps, then the delay
+  Time txTime = Seconds (DataRate ("5Mbps").CalculateTxTime (1002));
+  NS_TEST_EXPECT_MSG_EQ (m_arrival, Seconds (1) + txTime + MilliSeconds (2), "Arrival time across the cut");
+  NS_TEST_EXPECT_MSG_EQ (m_receiverSystemId, 1, "The receiver runs in the other partition");
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+static class TopologyPartitionerTestSuite : public TestSuite
+{
+public:
+  TopologyPartitionerTestSuite ()
+    : TestSuite ("topology-partitioner", UNIT)
+  {
+    AddTestCase (new FatTreePartitionTest, TestCase::QUICK);
+    AddTestCase (new PartitionWeightTest, TestCase::QUICK);
+    AddTestCase (new PartitionChannelsTest, TestCase::QUICK);
+  }
+} g_topologyPartitionerTestSuite;
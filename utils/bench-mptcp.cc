@@ -0,0 +1,540 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Micro-benchmarks of the MPTCP connection level data structures.
+ */
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "ns3/mp-tcp-subflow.h"
+#include "ns3/tcp-header.h"
+#include <iostream>
+#include <queue>
+#include <list>
+#include <deque>
+
+using namespace ns3;
+
+static const uint32_t MB = 1024 * 1024;
+static const uint32_t SEGMENT = 1400;
+
+/*
+ * The per-byte queue DataBuffer used before the byte counting buffer, kept here
+ * as a reference point.
+ */
+class LegacyDataBuffer
+{
+public:
+  LegacyDataBuffer (uint32_t size) : bufMaxSize (size) {}
+  uint32_t Add (uint32_t size)
+  {
+    uint32_t toWrite = std::min (size, (bufMaxSize - (uint32_t) buffer.size ()));
+    for (uint32_t qty = 0; qty < toWrite; qty++)
+      buffer.push ((uint8_t) qty);
+    return toWrite;
+  }
+  Ptr<Packet> CreatePacket (uint32_t size)
+  {
+    uint32_t quantity = std::min (size, (uint32_t) buffer.size ());
+    for (uint32_t i = 0; i < quantity; i++)
+      buffer.pop ();
+    return Create<Packet> (quantity);
+  }
+  uint32_t ReadPacket (Ptr<Packet> pkt, uint32_t dataLen)
+  {
+    uint32_t toWrite = std::min (dataLen, (bufMaxSize - (uint32_t) buffer.size ()));
+    for (uint32_t i = 0; i < toWrite; i++)
+      buffer.push (0);
+    return toWrite;
+  }
+  uint32_t Retrieve (uint32_t size)
+  {
+    uint32_t quantity = std::min (size, (uint32_t) buffer.size ());
+    for (uint32_t i = 0; i < quantity; i++)
+      buffer.pop ();
+    return quantity;
+  }
+private:
+  std::queue<uint8_t> buffer;
+  uint32_t bufMaxSize;
+};
+
+// Sender side: application fills the buffer, segments are carved out of it.
+template <typename T>
+static void
+FillDrainTx (T &buffer, uint32_t mb)
+{
+  for (uint32_t i = 0; i < mb; i++)
+    {
+      buffer.Add (MB);
+      for (uint32_t sent = 0; sent < MB; sent += SEGMENT)
+        buffer.CreatePacket (SEGMENT);
+    }
+}
+
+// Receiver side: segments are copied in, application reads the buffer.
+template <typename T>
+static void
+FillDrainRx (T &buffer, uint32_t mb)
+{
+  Ptr<Packet> p = Create<Packet> (SEGMENT);
+  for (uint32_t i = 0; i < mb; i++)
+    {
+      for (uint32_t rcvd = 0; rcvd < MB; rcvd += SEGMENT)
+        buffer.ReadPacket (p, SEGMENT);
+      buffer.Retrieve (MB + SEGMENT);
+    }
+}
+
+static void
+Report (SystemWallClockMs &time, uint32_t mb, char const *name)
+{
+  uint64_t deltaMs = time.End ();
+  std::cout << (double) deltaMs / mb << " ms/MB"
+            << " (" << deltaMs << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+static void
+ReportPerOp (SystemWallClockMs &time, uint32_t ops, char const *op, char const *param, uint32_t value, char const *name)
+{
+  uint64_t deltaMs = time.End ();
+  std::cout << (double) deltaMs * 1000000 / ops << " ns/" << op
+            << " (" << param << " " << value << ", " << deltaMs << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+static void
+BenchDataBuffer (uint32_t mb)
+{
+  SystemWallClockMs time;
+  {
+    LegacyDataBuffer buffer (2 * MB);
+    time.Start ();
+    FillDrainTx (buffer, mb);
+    Report (time, mb, "DataBuffer tx fill/drain, per-byte queue");
+  }
+  {
+    DataBuffer buffer (2 * MB);
+    time.Start ();
+    FillDrainTx (buffer, mb);
+    Report (time, mb, "DataBuffer tx fill/drain, byte counting");
+  }
+  {
+    DataBuffer buffer (2 * MB);
+    buffer.SetPayloadMode (true);
+    time.Start ();
+    FillDrainTx (buffer, mb);
+    Report (time, mb, "DataBuffer tx fill/drain, payload chunks");
+  }
+  {
+    LegacyDataBuffer buffer (2 * MB);
+    time.Start ();
+    FillDrainRx (buffer, mb);
+    Report (time, mb, "DataBuffer rx fill/drain, per-byte queue");
+  }
+  {
+    DataBuffer buffer (2 * MB);
+    time.Start ();
+    FillDrainRx (buffer, mb);
+    Report (time, mb, "DataBuffer rx fill/drain, byte counting");
+  }
+  {
+    DataBuffer buffer (2 * MB);
+    buffer.SetPayloadMode (true);
+    time.Start ();
+    FillDrainRx (buffer, mb);
+    Report (time, mb, "DataBuffer rx fill/drain, payload chunks");
+  }
+}
+
+/*
+ * The list based mapDSN used before DSNMappingQueue, every lookup and discard
+ * walks the whole list.
+ */
+class LegacyDSNMappingList
+{
+public:
+  ~LegacyDSNMappingList ()
+  {
+    for (std::list<DSNMapping *>::iterator it = mapDSN.begin (); it != mapDSN.end (); ++it)
+      delete *it;
+  }
+  void push_back (DSNMapping *mapping)
+  {
+    mapDSN.push_back (mapping);
+  }
+  DSNMapping *Find (uint32_t seq)
+  {
+    for (std::list<DSNMapping *>::iterator it = mapDSN.begin (); it != mapDSN.end (); ++it)
+      if ((*it)->subflowSeqNumber == seq)
+        return *it;
+    return 0;
+  }
+  uint32_t DiscardUpTo (uint32_t ack)
+  {
+    uint32_t count = 0;
+    std::list<DSNMapping *>::iterator current = mapDSN.begin ();
+    while (current != mapDSN.end ())
+      {
+        DSNMapping *ptrDSN = *current;
+        if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
+          {
+            current = mapDSN.erase (current);
+            delete ptrDSN;
+            count++;
+          }
+        else
+          ++current;
+      }
+    return count;
+  }
+private:
+  std::list<DSNMapping *> mapDSN;
+};
+
+// Subflow sender with a full window: every new ACK discards the acked segment,
+// looks up the next unacked one (as ReceivedAck/NewAck do) and sends a new segment.
+template <typename T>
+static uint32_t
+AckClock (T &mapDSN, uint32_t cwnd, uint32_t acks)
+{
+  uint32_t seq = 1;
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < cwnd; i++, seq += SEGMENT)
+    mapDSN.push_back (new DSNMapping (0, seq, SEGMENT, seq, 0));
+  uint32_t ack = 1;
+  for (uint32_t i = 0; i < acks; i++, seq += SEGMENT)
+    {
+      ack += SEGMENT;
+      mapDSN.DiscardUpTo (ack);
+      found += (mapDSN.Find (ack) != 0);
+      mapDSN.push_back (new DSNMapping (0, seq, SEGMENT, seq, 0));
+    }
+  return found;
+}
+
+static void
+BenchDSNMapping (uint32_t acks)
+{
+  SystemWallClockMs time;
+  uint32_t cwnds[] = { 10, 100, 1000, 10000 };
+  for (uint32_t i = 0; i < sizeof (cwnds) / sizeof (cwnds[0]); i++)
+    {
+      {
+        LegacyDSNMappingList mapDSN;
+        time.Start ();
+        AckClock (mapDSN, cwnds[i], acks);
+        ReportPerOp (time, acks, "ack", "cwnd", cwnds[i], "mapDSN ack processing, linear list");
+      }
+      {
+        DSNMappingQueue mapDSN;
+        time.Start ();
+        AckClock (mapDSN, cwnds[i], acks);
+        ReportPerOp (time, acks, "ack", "cwnd", cwnds[i], "mapDSN ack processing, indexed queue");
+      }
+    }
+}
+
+// Same fields as DSNMapping but allocated through the global heap.
+struct LegacyDSNMapping
+{
+  LegacyDSNMapping (uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack)
+    : dataSeqNumber (dSeqNum), dataLevelLength (dLvlLen), subflowSeqNumber (sflowSeqNum),
+      acknowledgement (ack), dupAckCount (0), subflowIndex (sFlowIdx) {}
+  virtual ~LegacyDSNMapping () {}
+  uint64_t dataSeqNumber;
+  uint16_t dataLevelLength;
+  uint32_t subflowSeqNumber;
+  uint32_t acknowledgement;
+  uint32_t dupAckCount;
+  uint8_t subflowIndex;
+};
+
+// A window of mappings is kept alive, each step frees the oldest one and allocates a new one.
+template <typename T>
+static void
+AllocChurn (uint32_t cwnd, uint32_t count)
+{
+  std::deque<T *> window;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      window.push_back (new T (0, i, SEGMENT, i, 0));
+      if (window.size () > cwnd)
+        {
+          delete window.front ();
+          window.pop_front ();
+        }
+    }
+  while (!window.empty ())
+    {
+      delete window.front ();
+      window.pop_front ();
+    }
+}
+
+static void
+BenchDSNMappingAlloc (uint32_t count)
+{
+  SystemWallClockMs time;
+  uint32_t cwnds[] = { 100, 10000 };
+  for (uint32_t i = 0; i < sizeof (cwnds) / sizeof (cwnds[0]); i++)
+    {
+      time.Start ();
+      AllocChurn<LegacyDSNMapping> (cwnds[i], count);
+      ReportPerOp (time, count, "alloc", "cwnd", cwnds[i], "DSNMapping new/delete, heap");
+      time.Start ();
+      AllocChurn<DSNMapping> (cwnds[i], count);
+      ReportPerOp (time, count, "alloc", "cwnd", cwnds[i], "DSNMapping new/delete, pool");
+    }
+  std::cout << "DSNMapping pool: " << DSNMapping::GetLiveCount () << " live, "
+            << DSNMapping::GetPeakCount () << " peak" << std::endl;
+}
+
+/*
+ * The list based unOrdered buffer used before DSNReassemblyQueue, insertion looks for
+ * its place from the head and every drain walks the whole list.
+ */
+class LegacyReassemblyList
+{
+public:
+  ~LegacyReassemblyList ()
+  {
+    for (std::list<DSNMapping *>::iterator it = unOrdered.begin (); it != unOrdered.end (); ++it)
+      delete *it;
+  }
+  bool Insert (DSNMapping *toStore)
+  {
+    for (std::list<DSNMapping *>::iterator it = unOrdered.begin (); it != unOrdered.end (); ++it)
+      {
+        if (toStore->dataSeqNumber == (*it)->dataSeqNumber)
+          {
+            delete toStore;
+            return false;
+          }
+        else if (toStore->dataSeqNumber < (*it)->dataSeqNumber)
+          {
+            unOrdered.insert (it, toStore);
+            return true;
+          }
+      }
+    unOrdered.push_back (toStore);
+    return true;
+  }
+  void Drain (uint64_t &nextRxSequence)
+  {
+    std::list<DSNMapping *>::iterator current = unOrdered.begin ();
+    while (current != unOrdered.end ())
+      {
+        DSNMapping *ptrDSN = *current;
+        if (ptrDSN->dataSeqNumber <= nextRxSequence)
+          {
+            nextRxSequence += ptrDSN->dataLevelLength;
+            current = unOrdered.erase (current);
+            delete ptrDSN;
+          }
+        else
+          ++current;
+      }
+  }
+private:
+  std::list<DSNMapping *> unOrdered;
+};
+
+class ReassemblyQueue
+{
+public:
+  bool Insert (DSNMapping *toStore)
+  {
+    return unOrdered.Insert (toStore);
+  }
+  void Drain (uint64_t &nextRxSequence)
+  {
+    DSNMapping *ptrDSN;
+    while ((ptrDSN = unOrdered.Front ()) != 0 && ptrDSN->dataSeqNumber <= nextRxSequence)
+      {
+        nextRxSequence += ptrDSN->dataLevelLength;
+        unOrdered.PopFront ();
+      }
+  }
+private:
+  DSNReassemblyQueue unOrdered;
+};
+
+// Segments are spread round robin over subflows and the first segment of each
+// reorder window arrives last, so 'depth' segments wait in the queue each time.
+// Every arrival is followed by a drain attempt, as in ReceivedData.
+template <typename T>
+static void
+Reorder (uint32_t depth, uint32_t segments)
+{
+  T unOrdered;
+  uint64_t nextRxSequence = 0;
+  uint32_t subflows = 8;
+  for (uint32_t base = 0; base + depth <= segments; base += depth)
+    {
+      for (uint32_t i = 1; i <= depth; i++)
+        {
+          uint32_t seg = base + (i % depth);
+          unOrdered.Insert (new DSNMapping (seg % subflows, (uint64_t) seg * SEGMENT, SEGMENT, seg / subflows * SEGMENT, 0));
+          unOrdered.Drain (nextRxSequence);
+        }
+    }
+  NS_ASSERT (nextRxSequence == (uint64_t) (segments - segments % depth) * SEGMENT);
+}
+
+static void
+BenchReassembly (uint32_t segments)
+{
+  SystemWallClockMs time;
+  uint32_t depths[] = { 16, 256, 4096 };
+  for (uint32_t i = 0; i < sizeof (depths) / sizeof (depths[0]); i++)
+    {
+      time.Start ();
+      Reorder<LegacyReassemblyList> (depths[i], segments);
+      ReportPerOp (time, segments, "segment", "reorder depth", depths[i], "unOrdered reassembly, linear list");
+      time.Start ();
+      Reorder<ReassemblyQueue> (depths[i], segments);
+      ReportPerOp (time, segments, "segment", "reorder depth", depths[i], "unOrdered reassembly, indexed queue");
+    }
+}
+
+// Per-segment subflow demultiplexing as done by LookupSubflow, with segments
+// arriving round robin over NdiffPorts subflows. The linear search is the
+// former loop over the subflows container.
+static uint32_t
+LinearDemux (std::vector<MpTcpSubflowTuple> &tuples, uint32_t segments)
+{
+  std::vector<Ptr<MpTcpSubFlow> > subflows;
+  for (uint32_t i = 0; i < tuples.size (); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = CreateObject<MpTcpSubFlow> ();
+      sFlow->sAddr = tuples[i].sAddr;
+      sFlow->sPort = tuples[i].sPort;
+      sFlow->dAddr = tuples[i].dAddr;
+      sFlow->dPort = tuples[i].dPort;
+      subflows.push_back (sFlow);
+    }
+  uint32_t sum = 0;
+  for (uint32_t seg = 0; seg < segments; seg++)
+    {
+      MpTcpSubflowTuple &tuple = tuples[seg % tuples.size ()];
+      Ptr<MpTcpSubFlow> sFlow = 0;
+      for (uint32_t i = 0; i < subflows.size (); i++)
+        {
+          sFlow = subflows[i];
+          if (sFlow->sAddr == tuple.sAddr && sFlow->dAddr == tuple.dAddr && sFlow->sPort == tuple.sPort && sFlow->dPort == tuple.dPort)
+            {
+              sum += i;
+              break;
+            }
+        }
+    }
+  return sum;
+}
+
+static uint32_t
+HashedDemux (std::vector<MpTcpSubflowTuple> &subflows, uint32_t segments)
+{
+  MpTcpSubflowIndex subflowIndex;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      subflowIndex.Insert (subflows[i], i);
+    }
+  uint32_t sum = 0;
+  for (uint32_t seg = 0; seg < segments; seg++)
+    {
+      sum += subflowIndex.Find (subflows[seg % subflows.size ()]);
+    }
+  return sum;
+}
+
+static void
+BenchSubflowDemux (uint32_t segments)
+{
+  SystemWallClockMs time;
+  uint32_t counts[] = { 2, 8, 32 };
+  for (uint32_t i = 0; i < sizeof (counts) / sizeof (counts[0]); i++)
+    {
+      std::vector<MpTcpSubflowTuple> subflows;
+      for (uint32_t j = 0; j < counts[i]; j++)
+        {
+          subflows.push_back (MpTcpSubflowTuple (Ipv4Address ("10.1.1.1"), 49153 + j, Ipv4Address ("10.2.1.1"), 5000));
+        }
+      time.Start ();
+      uint32_t linear = LinearDemux (subflows, segments);
+      ReportPerOp (time, segments, "segment", "subflows", counts[i], "subflow demux, linear search");
+      time.Start ();
+      uint32_t hashed = HashedDemux (subflows, segments);
+      ReportPerOp (time, segments, "segment", "subflows", counts[i], "subflow demux, hashed index");
+      NS_ASSERT (linear == hashed);
+    }
+}
+
+// Per-segment header handling on the receive path: the data segment header is
+// parsed out of the packet, then copied as ForwardUp and the sockets do.
+static void
+BenchTcpHeader (uint32_t segments)
+{
+  SystemWallClockMs time;
+  uint32_t counts[] = { 1, 2 };
+  for (uint32_t i = 0; i < sizeof (counts) / sizeof (counts[0]); i++)
+    {
+      TcpHeader header;
+      uint8_t olen = 0;
+      for (uint32_t j = 0; j < counts[i]; j++)
+        {
+          header.AddOptDSN (OPT_DSN, j * SEGMENT, SEGMENT, j, 0, 0);
+          olen += 20;
+        }
+      header.SetLength (5 + olen / 4);
+      Ptr<Packet> p = Create<Packet> (SEGMENT);
+      p->AddHeader (header);
+      uint64_t sum = 0;
+      time.Start ();
+      for (uint32_t seg = 0; seg < segments; seg++)
+        {
+          TcpHeader parsed;
+          p->PeekHeader (parsed);
+          TcpHeader copy (parsed);
+          sum += ((OptDataSeqMapping *) copy.GetOptions ()[0])->dataLevelLength;
+        }
+      ReportPerOp (time, segments, "segment", "DSN options", counts[i], "TcpHeader parse and copy");
+      NS_ASSERT (sum == (uint64_t) segments * SEGMENT);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t mb = 64;
+  uint32_t acks = 100000;
+  CommandLine cmd;
+  cmd.AddValue ("mb", "Number of MB pushed through each buffer", mb);
+  cmd.AddValue ("acks", "Number of ACKs processed for each mapDSN window size", acks);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Running bench-mptcp with mb=" << mb << " acks=" << acks << std::endl;
+  BenchDataBuffer (mb);
+  BenchDSNMapping (acks);
+  BenchDSNMappingAlloc (100 * acks);
+  BenchReassembly (acks);
+  BenchSubflowDemux (100 * acks);
+  BenchTcpHeader (10 * acks);
+
+  return 0;
+}
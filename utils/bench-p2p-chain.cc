@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure how many packets per second go through a chain of
+ * point-to-point links, first with the default packets, then with lean
+ * ones (see Packet::EnableLeanMode). Each node in the middle of the
+ * chain copies the packets it receives, peeks their flow id tag, and
+ * replaces their LLC/SNAP header before sending them on, as a router
+ * would.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <iostream>
+
+using namespace ns3;
+
+static uint32_t g_received;
+
+static bool
+Forward (Ptr<NetDevice> next, Ptr<NetDevice> device, Ptr<const Packet> packet,
+         uint16_t protocol, const Address &from)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  FlowIdTag tag;
+  copy->PeekPacketTag (tag);
+  LlcSnapHeader llc;
+  copy->RemoveHeader (llc);
+  copy->AddHeader (llc);
+  next->Send (copy, next->GetBroadcast (), protocol);
+  return true;
+}
+
+static bool
+Sink (Ptr<NetDevice> device, Ptr<const Packet> packet,
+      uint16_t protocol, const Address &from)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  FlowIdTag tag;
+  copy->RemovePacketTag (tag);
+  LlcSnapHeader llc;
+  copy->RemoveHeader (llc);
+  g_received++;
+  return true;
+}
+
+static void
+SendPacket (Ptr<NetDevice> device, uint32_t size, Time interval, uint32_t left)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddPacketTag (FlowIdTag (1));
+  LlcSnapHeader llc;
+  llc.SetType (0x0800);
+  p->AddHeader (llc);
+  device->Send (p, device->GetBroadcast (), 0x0800);
+  if (left > 1)
+    {
+      Simulator::Schedule (interval, &SendPacket, device, size, interval, left - 1);
+    }
+}
+
+static void
+RunBench (Ptr<NetDevice> source, uint32_t size, Time interval, uint32_t n,
+          uint32_t hops, char const *name)
+{
+  g_received = 0;
+  Simulator::Schedule (Seconds (0), &SendPacket, source, size, interval, n);
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  double ps = g_received;
+  ps *= 1000;
+  ps /= deltaMs;
+  std::cout << ps << " packets/s, " << ps * hops << " hops/s"
+            << " (" << deltaMs << " ms elapsed, "
+            << g_received << "/" << n << " delivered)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t nodes = 8;
+  uint32_t size = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "number of packets to send through the chain", n);
+  cmd.AddValue ("nodes", "number of nodes of the chain, at least 2", nodes);
+  cmd.AddValue ("size", "payload size of the packets", size);
+  cmd.Parse (argc, argv);
+  if (nodes < 2)
+    {
+      std::cerr << "Error-- the chain needs at least 2 nodes" << std::endl;
+      return 1;
+    }
+
+  DataRate rate ("1Gbps");
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+
+  NodeContainer chain;
+  chain.Create (nodes);
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i + 1 < nodes; i++)
+    {
+      links.push_back (p2p.Install (chain.Get (i), chain.Get (i + 1)));
+    }
+  for (uint32_t i = 0; i + 2 < nodes; i++)
+    {
+      links[i].Get (1)->SetReceiveCallback (MakeBoundCallback (&Forward, links[i + 1].Get (0)));
+    }
+  links[nodes - 2].Get (1)->SetReceiveCallback (MakeCallback (&Sink));
+
+  // send at the line rate: LLC/SNAP and PPP headers included
+  Time interval = Seconds (rate.CalculateTxTime (size + 8 + 2));
+  uint32_t hops = nodes - 1;
+
+  std::cout << "Running bench-p2p-chain with n=" << n << ", "
+            << nodes << " nodes, " << size << " byte packets" << std::endl;
+#ifdef NS3_LEAN_PACKETS
+  std::cout << "Built with --enable-lean-packets: every packet is lean." << std::endl;
+  RunBench (links[0].Get (0), size, interval, n, hops, "Lean packets, inline tags");
+#else
+  RunBench (links[0].Get (0), size, interval, n, hops, "Default packets");
+  Packet::EnableLeanMode ();
+  RunBench (links[0].Get (0), size, interval, n, hops, "Lean packets");
+#endif
+
+  Simulator::Destroy ();
+  return 0;
+}
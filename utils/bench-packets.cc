@@ -273,6 +273,10 @@ int main (int argc, char *argv[])
         {
           Packet::EnablePrinting ();
         }
+      if (strncmp ("--lean", argv[0], strlen ("--lean")) == 0)
+        {
+          Packet::EnableLeanMode ();
+        }
       argc--;
       argv++;
   }
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
 #include <string.h>
 
 #include "ns3/core-module.h"
@@ -63,7 +64,7 @@ public:
     m_total = total;
   }
     
-  void RunBench (void);
+  double RunBench (void);
 private:
   void Cb (void);
   
@@ -73,7 +74,7 @@ private:
   uint32_t m_count;
 };
 
-void
+double
 Bench::RunBench (void) 
 {
   SystemWallClockMs time;
@@ -107,6 +108,8 @@ Bench::RunBench (void)
 
   // Clean up scheduler
   Simulator::Destroy ();
+  m_count = 0;
+  return simu;
 }
 
 void
@@ -134,6 +137,8 @@ GetRandomStream (std::string filename)
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
+      // Same draws for every scheduler
+      erv->SetStream (1);
       stream = erv;
     }
   else
@@ -186,6 +191,8 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
@@ -200,11 +207,21 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in s.\n"
+             "\n"
+             "To replay the events of a real simulation, record them with\n"
+             "the LadderScheduler in a debug build, for instance:\n"
+             "  NS_LOG=LadderScheduler=logic ./waf --run \"FatTree\n"
+             "    --SchedulerType=ns3::LadderScheduler\" 2>&1 |\n"
+             "    awk '$1 == \"delay\" { print $2 }' > fattree.txt\n"
+             "then run with --file=fattree.txt --pop=<events pending in the\n"
+             "simulation> --all, in an optimized build.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "run every scheduler but the ListScheduler in turn on the same events", schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
@@ -215,58 +232,97 @@ int main (int argc, char *argv[])
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
-  Simulator::SetScheduler (factory);
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+    }
+  else
+    {
+      std::string type = "ns3::MapScheduler";
+      if (schedCal)  { type = "ns3::CalendarScheduler"; }
+      if (schedHeap) { type = "ns3::HeapScheduler";     }
+      if (schedList) { type = "ns3::ListScheduler";     }
+      if (schedLadder) { type = "ns3::LadderScheduler"; }
+      schedulers.push_back (type);
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+
+  std::map<std::string, double> average;
+  for (uint32_t s = 0; s < schedulers.size (); s++)
+    {
+      ObjectFactory factory (schedulers[s]);
+      Simulator::SetScheduler (factory);
+
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+      Bench *bench = new Bench (pop, total);
+      bench->SetRandomStream (GetRandomStream (filename));
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
        
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
-    {
-      std::cout << std::setw (g_fwidth) << i;
-      
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
+
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      double simu = 0;
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+      
+          simu += bench->RunBench ();
+        }
+      average[schedulers[s]] = simu / runs;
+      delete bench;
+    }
+
+  if (schedulers.size () > 1)
+    {
+      LOG ("");
+      LOG (std::left << std::setw (3 * g_fwidth) << "Scheduler" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)");
+      for (uint32_t s = 0; s < schedulers.size (); s++)
+        {
+          double simu = average[schedulers[s]];
+          LOG (std::left << std::setw (3 * g_fwidth) << schedulers[s] <<
+               std::left << std::setw (g_fwidth) << simu <<
+               std::left << std::setw (g_fwidth) << (total / simu));
+        }
     }
 
   LOG ("");
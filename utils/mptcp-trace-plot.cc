@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Converts the records written by ns3::MpTcpFileTraceSink into gnuplot files,
+ * one <output>_PLOT_<flowId>.data file per flow with one plot per traced series
+ * and one dataset per subflow.
+ */
+#include "ns3/command-line.h"
+#include "ns3/gnuplot.h"
+#include "ns3/mp-tcp-trace-sink.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+using namespace ns3;
+
+typedef std::map<uint8_t, Gnuplot2dDataset> SubflowDatasets_t;    // Keyed by subflow
+typedef std::map<uint8_t, SubflowDatasets_t> SeriesDatasets_t;    // Keyed by series
+typedef std::map<uint32_t, SeriesDatasets_t> FlowDatasets_t;      // Keyed by flowId
+
+static void
+WriteFlow (const std::string &output, uint32_t flowId, SeriesDatasets_t &series)
+{
+  std::ostringstream prefix;
+  prefix << output << "_PLOT_" << flowId;
+  GnuplotCollection gnu;
+  for (SeriesDatasets_t::iterator it = series.begin (); it != series.end (); ++it)
+    {
+      const char *name = MpTcpTraceSink::GetSeriesName ((MpTcpTrace_t) it->first);
+      std::ostringstream oss;
+      oss << "set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
+          "set output \"" << prefix.str () << "_" << name << ".eps" << "\"\n"
+          "set xlabel \"Time (s)\\n\" offset 0,0\n"
+          "set ylabel \"" << name << "\" offset 0,0\n"
+          "set grid\n"
+          "set lmargin 10.0\n"
+          "set rmargin 2.0\n"
+          "set yrange [:]\n"
+          "set xrange [:]\n"
+          "set title noenhanced\n"
+          "unset key; set key bmargin center horizontal Left reverse noenhanced autotitles nobox\n";
+      Gnuplot graph;
+      graph.AppendExtra (oss.str ());
+      oss.str ("");
+      oss << "Flow " << flowId << " " << name;
+      graph.SetTitle (oss.str ());
+      for (SubflowDatasets_t::iterator sf = it->second.begin (); sf != it->second.end (); ++sf)
+        {
+          graph.AddDataset (sf->second);
+        }
+      gnu.AddPlot (graph);
+    }
+  std::ofstream os ((prefix.str () + ".data").c_str ());
+  gnu.GenerateOutput (os);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string trace = "mptcp-trace.bin";
+  std::string output = "mptcp";
+  int64_t flow = -1;
+  CommandLine cmd;
+  cmd.AddValue ("trace", "File written by ns3::MpTcpFileTraceSink", trace);
+  cmd.AddValue ("output", "Prefix of the generated gnuplot files", output);
+  cmd.AddValue ("flow", "Only convert this flowId, all flows if negative", flow);
+  cmd.Parse (argc, argv);
+
+  MpTcpTraceReader reader (trace);
+  if (!reader.IsValid ())
+    {
+      std::cerr << trace << " is not an MPTCP trace file" << std::endl;
+      return 1;
+    }
+
+  FlowDatasets_t flows;
+  MpTcpTraceRecord record;
+  uint64_t records = 0;
+  while (reader.Read (record))
+    {
+      if (flow >= 0 && record.flowId != flow)
+        continue;
+      SubflowDatasets_t &datasets = flows[record.flowId][record.series];
+      SubflowDatasets_t::iterator it = datasets.find (record.subflow);
+      if (it == datasets.end ())
+        {
+          Gnuplot2dDataset dataSet;
+          dataSet.SetStyle (Gnuplot2dDataset::LINES_POINTS);
+          std::ostringstream title;
+          if (record.subflow == MpTcpTraceRecord::CONNECTION_LEVEL)
+            title << "Connection";
+          else
+            title << "SF " << (int) record.subflow;
+          dataSet.SetTitle (title.str ());
+          it = datasets.insert (std::make_pair (record.subflow, dataSet)).first;
+        }
+      it->second.Add (record.time, record.value);
+      records++;
+    }
+
+  for (FlowDatasets_t::iterator it = flows.begin (); it != flows.end (); ++it)
+    {
+      WriteFlow (output, it->first, it->second);
+    }
+  std::cout << records << " records of " << flows.size () << " flows converted" << std::endl;
+  return 0;
+}